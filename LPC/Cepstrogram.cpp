@@ -28,6 +28,8 @@
 #include "NUM2.h"
 #include "Sound_and_Spectrum.h"
 #include "Sound_extensions.h"
+#include "MelderThread.h"
+#include <atomic>
 
 #define TOLOG(x) ((1 / NUMln10) * log ((x) + 1e-30))
 #define TO10LOG(x) ((10 / NUMln10) * log ((x) + 1e-30))
@@ -267,53 +269,256 @@ autoPowerCepstrogram Matrix_to_PowerCepstrogram (Matrix me) {
 	}
 }
 
+/*
+	The frames of a PowerCepstrogram are analysed in parallel, each thread in a workspace of its own.
+	The workspace also has what the CPPS of a frame needs, i.e. a PowerCepstrum with the quefrency sampling of the PowerCepstrogram.
+*/
+Thing_define (PowerCepstrogram_Workspace, Thing) { public:
+	autoNUMvector <double> fft, fftWorkspace, cepstrum, smoothed, fitWorkspace;
+	autoPowerCepstrum frame, dB;
+};
+
+Thing_implement (PowerCepstrogram_Workspace, Thing, 0);
+
+static autoPowerCepstrogram_Workspace PowerCepstrogram_Workspace_create (NUMfft_Table fftTable, double qmax, long nq, int fitMethod) {
+	autoPowerCepstrogram_Workspace me = Thing_new (PowerCepstrogram_Workspace);
+	my fft.reset (1, fftTable -> n);
+	my fftWorkspace.reset (1, NUMfft_Table_getWorkspaceSize (fftTable));
+	my cepstrum.reset (1, nq);
+	my smoothed.reset (1, nq);
+	my frame = PowerCepstrum_create (qmax, nq);
+	my dB = PowerCepstrum_create (qmax, nq);
+	my fitWorkspace.reset (1, PowerCepstrum_getWorkspaceSize (my frame.get(), fitMethod));
+	return me;
+}
+
+/*
+	What Sound_into_Sound, Vector_subtractMean, Sounds_multiply, Sound_to_Spectrum and Spectrum_to_PowerCepstrum
+	do to one frame, in the same order (so with the same result), but without creating any objects.
+	The power cepstrum goes into cepstrum[1..nfft/2+1].
+*/
+static void Sound_into_PowerCepstrum_frame (Sound me, Sound window, double startTime, NUMfft_Table fftTable, PowerCepstrogram_Workspace workspace, double *cepstrum) {
+	long numberOfSamples = window -> nx, nfft = fftTable -> n, nq = nfft / 2 + 1;
+	double *fft = workspace -> fft.peek(), *fftWorkspace = workspace -> fftWorkspace.peek();
+	long index = Sampled_xToNearestIndex (me, startTime);
+	for (long i = 1; i <= numberOfSamples; i ++) {
+		long j = index - 1 + i;
+		fft [i] = j < 1 || j > my nx ? 0.0 : my z [1] [j];
+	}
+	double sum = 0.0;
+	for (long i = 1; i <= numberOfSamples; i ++) {
+		sum += fft [i];
+	}
+	double mean = sum / numberOfSamples;
+	for (long i = 1; i <= numberOfSamples; i ++) {
+		fft [i] = (fft [i] - mean) * window -> z [1] [i];
+	}
+	for (long i = numberOfSamples + 1; i <= nfft; i ++) {
+		fft [i] = 0.0;
+	}
+	NUMfft_forward_withWorkspace (fftTable, fft, fftWorkspace);
+	/*
+		The natural logarithm of the power spectrum, as a real spectrum in the layout of NUMfft_backward.
+	*/
+	double scaling = window -> dx, spectrumScaling = 1.0 / (window -> dx * nfft);
+	double dc = fft [1] * scaling, nyquist = fft [nfft] * scaling;
+	fft [1] = log (dc * dc + 0.0 + 1e-300) * spectrumScaling;
+	for (long i = 2; i < nq; i ++) {
+		double re = fft [i + i - 2] * scaling, im = fft [i + i - 1] * scaling;
+		fft [i + i - 2] = log (re * re + im * im + 1e-300) * spectrumScaling;
+		fft [i + i - 1] = 0.0;
+	}
+	fft [nfft] = log (nyquist * nyquist + 0.0 + 1e-300) * spectrumScaling;
+	NUMfft_backward_withWorkspace (fftTable, fft, fftWorkspace);
+	for (long i = 1; i <= nq; i ++) {
+		cepstrum [i] = fft [i] * fft [i];
+	}
+}
+
+/*
+	The analysis geometry of Sound_to_PowerCepstrogram: the resampled and pre-emphasized sound, the window and the frames.
+*/
+static autoSound Sound_preparePowerCepstrogramAnalysis (Sound me, double pitchFloor, double dt, double maximumFrequency, double preEmphasisFrequency,
+	autoSound *p_window, autoNUMfft_Table *p_fftTable, long *p_numberOfFrames, double *p_t1)
+{
+	// minimum analysis window has 3 periods of lowest pitch
+	double analysisWidth = 3.0  / pitchFloor;
+	double windowDuration = 2.0 * analysisWidth; /* gaussian window */
+
+	// Convenience: analyse the whole sound into one Cepstrogram_frame
+	if (windowDuration > my dx * my nx) {
+		windowDuration = my dx * my nx;
+	}
+	double samplingFrequency = 2 * maximumFrequency;
+	autoSound sound = Sound_resample (me, samplingFrequency, 50);
+	Sound_preEmphasis (sound.get(), preEmphasisFrequency);
+	Sampled_shortTermAnalysis (me, windowDuration, dt, p_numberOfFrames, p_t1);
+	*p_window = Sound_createGaussian (windowDuration, samplingFrequency);
+	// find out the size of the FFT
+	long nfft = 2;
+	while (nfft < (*p_window) -> nx) nfft *= 2;
+	NUMfft_Table_init (p_fftTable, nfft);
+	return sound;
+}
+
 autoPowerCepstrogram Sound_to_PowerCepstrogram (Sound me, double pitchFloor, double dt, double maximumFrequency, double preEmphasisFrequency) {
 	try {
-		// minimum analysis window has 3 periods of lowest pitch
-		double analysisWidth = 3.0  / pitchFloor;
-		double windowDuration = 2.0 * analysisWidth; /* gaussian window */
+		autoSound window;
+		autoNUMfft_Table fftTable;
 		long nFrames;
-
-		// Convenience: analyse the whole sound into one Cepstrogram_frame
-		if (windowDuration > my dx * my nx) {
-			windowDuration = my dx * my nx;
-		}
-		double t1, samplingFrequency = 2 * maximumFrequency;
-		autoSound sound = Sound_resample (me, samplingFrequency, 50);
-		Sound_preEmphasis (sound.get(), preEmphasisFrequency);
-		Sampled_shortTermAnalysis (me, windowDuration, dt, & nFrames, & t1);
-		autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
-		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
-		// find out the size of the FFT
-		long nfft = 2;
-		while (nfft < sframe -> nx) nfft *= 2;
-		long nq = nfft / 2 + 1;
+		double t1;
+		autoSound sound = Sound_preparePowerCepstrogramAnalysis (me, pitchFloor, dt, maximumFrequency, preEmphasisFrequency, & window, & fftTable, & nFrames, & t1);
+		double windowDuration = window -> xmax - window -> xmin, samplingFrequency = 1.0 / window -> dx;
+		long nfft = fftTable. n, nq = nfft / 2 + 1;
 		double qmax = 0.5 * nfft / samplingFrequency, dq = qmax / (nq - 1);
 		autoPowerCepstrogram thee = PowerCepstrogram_create (my xmin, my xmax, nFrames, dt, t1, 0, qmax, nq, dq, 0);
 
 		autoMelderProgress progress (U"Cepstrogram analysis");
 
-		for (long iframe = 1; iframe <= nFrames; iframe++) {
-			double t = Sampled_indexToX (thee.get(), iframe);
-			Sound_into_Sound (sound.get(), sframe.get(), t - windowDuration / 2);
-			Vector_subtractMean (sframe.get());
-			Sounds_multiply (sframe.get(), window.get());
-			autoSpectrum spec = Sound_to_Spectrum (sframe.get(), 1); // FFT yes
-			autoPowerCepstrum cepstrum = Spectrum_to_PowerCepstrum (spec.get());
-			for (long i = 1; i <= nq; i++) {
-				thy z[i][iframe] = cepstrum -> z[1][i];
-			}
-			if ((iframe % 10) == 1) {
-				Melder_progress ((double) iframe / nFrames, U"PowerCepstrogram analysis of frame ",
-					iframe, U" out of ", nFrames, U".");
+		const long numberOfFramesPerChunk = 16;
+		long numberOfThreads = MelderThread_getNumberOfThreads ();
+		long numberOfChunks = (nFrames - 1) / numberOfFramesPerChunk + 1;
+		if (numberOfThreads > numberOfChunks) numberOfThreads = numberOfChunks;
+		std::vector <autoPowerCepstrogram_Workspace> workspaces;
+		for (long ithread = 1; ithread <= numberOfThreads; ithread ++)
+			workspaces. push_back (PowerCepstrogram_Workspace_create (& fftTable, qmax, nq, 1));
+
+		std::atomic <long> numberOfFramesDone (0);
+		MelderThread_parallelFor (1, nFrames, numberOfFramesPerChunk, [&] (long firstFrame, long lastFrame, int threadNumber) {
+			PowerCepstrogram_Workspace workspace = workspaces [threadNumber - 1]. get ();
+			double *cepstrum = workspace -> cepstrum.peek();
+			for (long iframe = firstFrame; iframe <= lastFrame; iframe ++) {
+				double t = Sampled_indexToX (thee.get(), iframe);
+				Sound_into_PowerCepstrum_frame (sound.get(), window.get(), t - windowDuration / 2, & fftTable, workspace, cepstrum);
+				for (long i = 1; i <= nq; i++) {
+					thy z[i][iframe] = cepstrum [i];
+				}
 			}
-		}
+			long numberOfFramesDoneSoFar = numberOfFramesDone += lastFrame - firstFrame + 1;
+			if (MelderThread_isMainThread ())
+				Melder_progress ((double) numberOfFramesDoneSoFar / nFrames, U"PowerCepstrogram analysis of frame ",
+					numberOfFramesDoneSoFar, U" out of ", nFrames, U".");
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": no PowerCepstrogram created.");
 	}
 }
 
+double Sound_getCPPS (Sound me, double pitchFloor, double dt, double maximumFrequency, double preEmphasisFrequency,
+	bool subtractTiltBeforeSmoothing, double timeAveragingWindow, double quefrencyAveragingWindow,
+	double peakSearchPitchFloor, double peakSearchPitchCeiling, int interpolation, double qstartFit, double qendFit, int lineType, int fitMethod)
+{
+	try {
+		autoSound window;
+		autoNUMfft_Table fftTable;
+		long nFrames;
+		double t1;
+		autoSound sound = Sound_preparePowerCepstrogramAnalysis (me, pitchFloor, dt, maximumFrequency, preEmphasisFrequency, & window, & fftTable, & nFrames, & t1);
+		double windowDuration = window -> xmax - window -> xmin, samplingFrequency = 1.0 / window -> dx;
+		long nfft = fftTable. n, nq = nfft / 2 + 1;
+		double qmax = 0.5 * nfft / samplingFrequency, dq = qmax / (nq - 1);
+
+		/*
+			The smoothing windows of PowerCepstrogram_smooth.
+			A smoothed frame is the average of the frames from iframe - leftFrames to iframe + rightFrames,
+			so only the frames that are that close to the frames of the current block have to be kept.
+		*/
+		long numberOfTimeAveragingFrames = (long) floor (timeAveragingWindow / dt);
+		long leftFrames = 0, rightFrames = 0;
+		if (numberOfTimeAveragingFrames > 1) {
+			leftFrames = numberOfTimeAveragingFrames / 2;
+			rightFrames = numberOfTimeAveragingFrames % 2 == 0 ? leftFrames - 1 : leftFrames;
+		}
+		long numberOfQuefrencyBins = (long) floor (quefrencyAveragingWindow / dq);
+
+		const long numberOfFramesPerBlock = 256, numberOfFramesPerChunk = 8;
+		long capacity = numberOfFramesPerBlock + leftFrames + rightFrames;
+		autoNUMmatrix <double> ring (0, capacity - 1, 1, nq);
+		double **cepstra = ring.peek();   // frame iframe is in row (iframe - 1) % capacity
+		autoNUMvector <double> cpp (1, numberOfFramesPerBlock);
+
+		long numberOfThreads = MelderThread_getNumberOfThreads ();
+		long numberOfChunks = (capacity - 1) / numberOfFramesPerChunk + 1;
+		if (numberOfThreads > numberOfChunks) numberOfThreads = numberOfChunks;
+		std::vector <autoPowerCepstrogram_Workspace> workspaces;
+		for (long ithread = 1; ithread <= numberOfThreads; ithread ++)
+			workspaces. push_back (PowerCepstrogram_Workspace_create (& fftTable, qmax, nq, fitMethod));
+
+		autoMelderProgress progress (U"CPPS analysis");
+
+		double sum = 0.0;
+		long lastFrameAnalysed = 0;
+		for (long firstFrameOfBlock = 1; firstFrameOfBlock <= nFrames; firstFrameOfBlock += numberOfFramesPerBlock) {
+			long lastFrameOfBlock = firstFrameOfBlock + numberOfFramesPerBlock - 1;
+			if (lastFrameOfBlock > nFrames) lastFrameOfBlock = nFrames;
+			/*
+				Analyse the frames that the block needs and that are not there yet;
+				they take the places of frames that no block needs any more.
+			*/
+			long lastFrameNeeded = lastFrameOfBlock + rightFrames;
+			if (lastFrameNeeded > nFrames) lastFrameNeeded = nFrames;
+			if (lastFrameNeeded > lastFrameAnalysed) {
+				MelderThread_parallelFor (lastFrameAnalysed + 1, lastFrameNeeded, numberOfFramesPerChunk, [&] (long firstFrame, long lastFrame, int threadNumber) {
+					PowerCepstrogram_Workspace workspace = workspaces [threadNumber - 1]. get ();
+					for (long iframe = firstFrame; iframe <= lastFrame; iframe ++) {
+						double t = t1 + (iframe - 1) * dt;   // Sampled_indexToX
+						double *cepstrum = cepstra [(iframe - 1) % capacity];
+						Sound_into_PowerCepstrum_frame (sound.get(), window.get(), t - windowDuration / 2, & fftTable, workspace, cepstrum);
+						if (subtractTiltBeforeSmoothing) {
+							double *z = workspace -> frame -> z [1];
+							for (long i = 1; i <= nq; i ++) z [i] = cepstrum [i];
+							PowerCepstrum_subtractTilt_inline_withWorkspace (workspace -> frame.get(), qstartFit, qendFit, lineType, fitMethod, workspace -> fitWorkspace.peek());
+							for (long i = 1; i <= nq; i ++) cepstrum [i] = z [i];
+						}
+					}
+				});
+				lastFrameAnalysed = lastFrameNeeded;
+			}
+			/*
+				Smooth the frames of the block, first across time and then across quefrency,
+				and measure their cepstral peak prominences.
+			*/
+			MelderThread_parallelFor (firstFrameOfBlock, lastFrameOfBlock, numberOfFramesPerChunk, [&] (long firstFrame, long lastFrame, int threadNumber) {
+				PowerCepstrogram_Workspace workspace = workspaces [threadNumber - 1]. get ();
+				double *smoothed = workspace -> smoothed.peek(), *z = workspace -> frame -> z [1];
+				for (long iframe = firstFrame; iframe <= lastFrame; iframe ++) {
+					long jfrom = iframe - leftFrames, jto = iframe + rightFrames;
+					jfrom = jfrom < 1 ? 1 : jfrom;
+					jto = jto > nFrames ? nFrames : jto;
+					for (long i = 1; i <= nq; i ++) {
+						double average = 0.0;
+						for (long j = jfrom; j <= jto; j ++) {
+							average += cepstra [(j - 1) % capacity] [i];
+						}
+						smoothed [i] = average / (jto - jfrom + 1);
+					}
+					if (numberOfQuefrencyBins > 1) {
+						NUMvector_smoothByMovingAverage (smoothed, nq, numberOfQuefrencyBins, z);
+					} else {
+						for (long i = 1; i <= nq; i ++) z [i] = smoothed [i];
+					}
+					double qpeak;
+					cpp [iframe - firstFrameOfBlock + 1] = PowerCepstrum_getPeakProminence_withWorkspace (workspace -> frame.get(),
+						peakSearchPitchFloor, peakSearchPitchCeiling, interpolation, qstartFit, qendFit, lineType, fitMethod, & qpeak,
+						workspace -> dB.get(), workspace -> fitWorkspace.peek());
+				}
+			});
+			for (long iframe = firstFrameOfBlock; iframe <= lastFrameOfBlock; iframe ++) {
+				double value = cpp [iframe - firstFrameOfBlock + 1];
+				if (value == NUMundefined) {
+					Melder_throw (U"The cepstral peak prominence of frame ", iframe, U" is undefined.");
+				}
+				sum += value;
+			}
+			Melder_progress ((double) lastFrameOfBlock / nFrames, U"CPPS analysis of frame ", lastFrameOfBlock, U" out of ", nFrames, U".");
+		}
+		return sum / nFrames;
+	} catch (MelderError) {
+		Melder_throw (me, U": no CPPS value calculated.");
+	}
+}
+
 autoCepstrum Spectrum_to_Cepstrum_hillenbrand (Spectrum me);
 autoCepstrum Spectrum_to_Cepstrum_hillenbrand (Spectrum me) {
 	try {
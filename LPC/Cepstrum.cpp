@@ -217,56 +217,69 @@ void PowerCepstrum_drawTiltLine (PowerCepstrum me, Graphics g, double qmin, doub
  */
 void PowerCepstrum_fitTiltLine (PowerCepstrum me, double qmin, double qmax, double *p_a, double *p_intercept, int lineType, int method) {
 	try {
-		double a, intercept;
-		if (qmax <= qmin) {
-			qmin = my xmin; qmax = my xmax;
-		}
+		autoNUMvector<double> workspace (1, PowerCepstrum_getWorkspaceSize (me, method));
+		PowerCepstrum_fitTiltLine_withWorkspace (me, qmin, qmax, p_a, p_intercept, lineType, method, workspace.peek());
+	} catch (MelderError) {
+		Melder_throw (me, U": couldn't fit a line.");
+	}
+}
 
-		long imin, imax;
-		if (! Matrix_getWindowSamplesX (me, qmin, qmax, & imin, & imax)) {
-			return;
-		}
-		imin = (lineType == 2 && imin == 1) ? 2 : imin; // log(0) is undefined!
-		long numberOfPoints = imax - imin + 1;
-		if (numberOfPoints < 2) {
-			Melder_throw (U"Not enough points for fit.");
+long PowerCepstrum_getWorkspaceSize (PowerCepstrum me, int method) {
+	return 2 * (my nx + 1) + NUMlineFit_getWorkspaceSize (my nx, method == 3 ? 2 : method);
+}
+
+void PowerCepstrum_fitTiltLine_withWorkspace (PowerCepstrum me, double qmin, double qmax, double *p_a, double *p_intercept, int lineType, int method, double *workspace) {
+	double a, intercept;
+	if (qmax <= qmin) {
+		qmin = my xmin; qmax = my xmax;
+	}
+
+	long imin, imax;
+	if (! Matrix_getWindowSamplesX (me, qmin, qmax, & imin, & imax)) {
+		return;
+	}
+	imin = (lineType == 2 && imin == 1) ? 2 : imin; // log(0) is undefined!
+	long numberOfPoints = imax - imin + 1;
+	if (numberOfPoints < 2) {
+		Melder_throw (me, U": not enough points for fit.");
+	}
+	double *x = workspace, *y = workspace + my nx + 1, *fitWorkspace = workspace + 2 * (my nx + 1);   // x[1..nx+1], y[1..nx+1]
+	for (long i = 1; i <= numberOfPoints; i++) {
+		long isamp = imin + i - 1;
+		x[i] = my x1 + (isamp - 1) * my dx;
+		if (lineType == 2) {
+			x[i] = log (x[i]);
 		}
-		autoNUMvector<double> y (1, numberOfPoints);
-		autoNUMvector<double> x (1, numberOfPoints);
-		for (long i = 1; i <= numberOfPoints; i++) {
-			long isamp = imin + i - 1;
-			x[i] = my x1 + (isamp - 1) * my dx;
-			if (lineType == 2) {
-				x[i] = log (x[i]);
+		y[i] = my v_getValueAtSample (isamp, 1, 0);
+	}
+	if (method == 3) { // try local maxima first; they go into the front of x and y, which have been read by then
+		long numberOfLocalPeaks = 0;
+		// forget y[1] if y[2]<y[1] and y[n] if y[n-1]<y[n] !
+		y[numberOfPoints + 1] = y[numberOfPoints];
+		for (long i = 2; i <= numberOfPoints; i++) {
+			if (y[i - 1] <= y[i] && y[i] > y[i + 1]) {
+				++ numberOfLocalPeaks;
 			}
-			y[i] = my v_getValueAtSample (isamp, 1, 0);
 		}
-		if (method == 3) { // try local maxima first
-			autoNUMvector<double> ym (1, numberOfPoints / 2 + 1);
-			autoNUMvector<double> xm (1, numberOfPoints / 2 + 1);
-			long numberOfLocalPeaks = 0;
-			// forget y[1] if y[2]<y[1] and y[n] if y[n-1]<y[n] !
+		if (numberOfLocalPeaks > numberOfPoints / 10) {
+			long ipeak = 0;
+			double yprevious = y[1];
 			for (long i = 2; i <= numberOfPoints; i++) {
-				if (y[i - 1] <= y[i] && y[i] > y[i + 1]) {
-					ym[++numberOfLocalPeaks] = y[i];
-					xm[numberOfLocalPeaks] = x[i];
-				}
-			}
-			if (numberOfLocalPeaks > numberOfPoints / 10) {
-				for (long i = 1; i <= numberOfLocalPeaks; i++) {
-					x[i] = xm[i]; y[i] = ym[i];
+				double ycurrent = y[i];
+				if (yprevious <= ycurrent && ycurrent > y[i + 1]) {
+					++ ipeak;
+					x[ipeak] = x[i]; y[ipeak] = ycurrent;
 				}
-				numberOfPoints = numberOfLocalPeaks;
+				yprevious = ycurrent;
 			}
-			method = 2; // robust fit of peaks
+			numberOfPoints = numberOfLocalPeaks;
 		}
-		// fit a straight line through (x,y)'s
-		NUMlineFit (x.peek(), y.peek(), numberOfPoints, & a, & intercept, method);
-		if (p_intercept) { *p_intercept = intercept; }
-		if (p_a) { *p_a = a; }
-	} catch (MelderError) {
-		Melder_throw (me, U": couldn't fit a line.");
+		method = 2; // robust fit of peaks
 	}
+	// fit a straight line through (x,y)'s
+	NUMlineFit_withWorkspace (x, y, numberOfPoints, & a, & intercept, method, fitWorkspace);
+	if (p_intercept) { *p_intercept = intercept; }
+	if (p_a) { *p_a = a; }
 }
 
 #if 0
@@ -307,6 +320,12 @@ void PowerCepstrum_subtractTilt_inline (PowerCepstrum me, double qstartFit, doub
 	PowerCepstrum_subtractTiltLine_inline (me, slope, intercept, lineType);
 }
 
+void PowerCepstrum_subtractTilt_inline_withWorkspace (PowerCepstrum me, double qstartFit, double qendFit, int lineType, int fitMethod, double *workspace) {
+	double slope, intercept;
+	PowerCepstrum_fitTiltLine_withWorkspace (me, qstartFit, qendFit, &slope, &intercept, lineType, fitMethod, workspace);
+	PowerCepstrum_subtractTiltLine_inline (me, slope, intercept, lineType);
+}
+
 autoPowerCepstrum PowerCepstrum_subtractTilt (PowerCepstrum me, double qstartFit, double qendFit, int lineType, int fitMethod) {
 	try {
 		autoPowerCepstrum thee = Data_copy (me);
@@ -348,13 +367,17 @@ autoPowerCepstrum PowerCepstrum_smooth (PowerCepstrum me, double quefrencyAverag
 }
 
 void PowerCepstrum_getMaximumAndQuefrency (PowerCepstrum me, double pitchFloor, double pitchCeiling, int interpolation, double *p_peakdB, double *p_quefrency) {
-	double peakdB, quefrency;
 	autoPowerCepstrum thee = Data_copy (me);
+	PowerCepstrum_getMaximumAndQuefrency_withWorkspace (me, pitchFloor, pitchCeiling, interpolation, p_peakdB, p_quefrency, thee.get());
+}
+
+void PowerCepstrum_getMaximumAndQuefrency_withWorkspace (PowerCepstrum me, double pitchFloor, double pitchCeiling, int interpolation, double *p_peakdB, double *p_quefrency, PowerCepstrum thee) {
+	double peakdB, quefrency;
 	double lowestQuefrency = 1.0 / pitchCeiling, highestQuefrency = 1.0 / pitchFloor;
 	for (long i = 1; i <= my nx; i ++) {
 		thy z[1][i] = my v_getValueAtSample (i, 1, 0); // 10 log val^2
 	}
-	Vector_getMaximumAndX ((Vector) thee.get(), lowestQuefrency, highestQuefrency, 1, interpolation, & peakdB, & quefrency);   // FIXME cast
+	Vector_getMaximumAndX ((Vector) thee, lowestQuefrency, highestQuefrency, 1, interpolation, & peakdB, & quefrency);   // FIXME cast
 	if (p_peakdB) {
 		*p_peakdB = peakdB;
 	}
@@ -437,9 +460,15 @@ double PowerCepstrum_getPeakProminence_hillenbrand (PowerCepstrum me, double pit
 }
 
 double PowerCepstrum_getPeakProminence (PowerCepstrum me, double pitchFloor, double pitchCeiling, int interpolation, double qstartFit, double qendFit, int lineType, int fitMethod, double *p_qpeak) {
+	autoPowerCepstrum thee = Data_copy (me);
+	autoNUMvector<double> workspace (1, PowerCepstrum_getWorkspaceSize (me, fitMethod));
+	return PowerCepstrum_getPeakProminence_withWorkspace (me, pitchFloor, pitchCeiling, interpolation, qstartFit, qendFit, lineType, fitMethod, p_qpeak, thee.get(), workspace.peek());
+}
+
+double PowerCepstrum_getPeakProminence_withWorkspace (PowerCepstrum me, double pitchFloor, double pitchCeiling, int interpolation, double qstartFit, double qendFit, int lineType, int fitMethod, double *p_qpeak, PowerCepstrum thee, double *workspace) {
 	double slope, intercept, qpeak, peakdB;
-	PowerCepstrum_fitTiltLine (me, qstartFit, qendFit, &slope, &intercept, lineType, fitMethod);
-	PowerCepstrum_getMaximumAndQuefrency (me, pitchFloor, pitchCeiling, interpolation, & peakdB, & qpeak);
+	PowerCepstrum_fitTiltLine_withWorkspace (me, qstartFit, qendFit, &slope, &intercept, lineType, fitMethod, workspace);
+	PowerCepstrum_getMaximumAndQuefrency_withWorkspace (me, pitchFloor, pitchCeiling, interpolation, & peakdB, & qpeak, thee);
 	double xq = lineType == 2 ? log(qpeak) : qpeak;
 	double db_background = slope * xq + intercept;
 	double cpp = peakdB - db_background;
@@ -101,6 +101,16 @@ void PowerCepstrum_fitTiltLine (PowerCepstrum me, double qmin, double qmax, doub
 autoPowerCepstrum PowerCepstrum_subtractTilt (PowerCepstrum me, double qstartFit, double qendFit, int lineType, int fitMethod);
 void PowerCepstrum_subtractTilt_inline (PowerCepstrum me, double qstartFit, double qendFit, int lineType, int fitMethod);
 
+/*
+	The _withWorkspace versions allocate nothing, so that they can analyse many frames, in several threads at once.
+	workspace[1..PowerCepstrum_getWorkspaceSize (me, fitMethod)]; thee is a PowerCepstrum with the same sampling as me.
+*/
+long PowerCepstrum_getWorkspaceSize (PowerCepstrum me, int fitMethod);
+void PowerCepstrum_fitTiltLine_withWorkspace (PowerCepstrum me, double qmin, double qmax, double *slope, double *intercept, int lineType, int method, double *workspace);
+void PowerCepstrum_subtractTilt_inline_withWorkspace (PowerCepstrum me, double qstartFit, double qendFit, int lineType, int fitMethod, double *workspace);
+void PowerCepstrum_getMaximumAndQuefrency_withWorkspace (PowerCepstrum me, double pitchFloor, double pitchCeiling, int interpolation, double *maximum, double *quefrency, PowerCepstrum thee);
+double PowerCepstrum_getPeakProminence_withWorkspace (PowerCepstrum me, double pitchFloor, double pitchCeiling, int interpolation, double qstartFit, double qendFit, int lineType, int fitMethod, double *qpeak, PowerCepstrum thee, double *workspace);
+
 void PowerCepstrum_smooth_inline (PowerCepstrum me, double quefrencyAveragingWindow, long numberOfIterations);
 autoPowerCepstrum PowerCepstrum_smooth (PowerCepstrum me, double quefrencyAveragingWindow, long numberOfIterations);
 
@@ -83,7 +83,7 @@ void LPC_Frame_into_Formant_Frame (LPC_Frame me, Formant_Frame thee, double samp
 	Roots_into_Formant_Frame (r.get(), thee, 1 / samplingPeriod, margin);
 }
 
-autoFormant LPC_to_Formant (LPC me, double margin) {
+static autoFormant _LPC_to_Formant (LPC me, double margin, bool fast) {
 	try {
 		double samplingFrequency = 1.0 / my samplingPeriod;
 		long nmax = my maxnCoefficients, err = 0;
@@ -98,6 +98,23 @@ autoFormant LPC_to_Formant (LPC me, double margin) {
 
 		autoFormant thee = Formant_create (my xmin, my xmax, my nx, my dx, my x1, (nmax + 1) / 2);
 
+		/*
+			In the fast mode, the roots of each frame are found by the Aberth iteration,
+			starting from the roots of the previous frame, which are usually close;
+			the companion matrix is only used if the iteration fails.
+			Everything except the formants themselves is allocated here, once.
+		*/
+		autoPolynomial polynomial;
+		autoRoots roots, rootsInUnitCircle;
+		autoNUMvector <double> workspace;
+		if (fast && nmax > 0) {
+			polynomial = Polynomial_create (-1, 1, nmax);
+			roots = Roots_create (nmax);
+			rootsInUnitCircle = Roots_create (nmax);
+			workspace.reset (1, nmax * (nmax + 3));
+		}
+		bool previousFrameHasRoots = false;
+
 		autoMelderProgress progress (U"LPC to Formant");
 
 		for (long i = 1; i <= my nx; i++) {
@@ -107,7 +124,28 @@ autoFormant LPC_to_Formant (LPC me, double margin) {
 			// Initialisation of Formant_Frame is taken care of in Roots_into_Formant_Frame!
 
 			try {
-				LPC_Frame_into_Formant_Frame (lpc, formant, my samplingPeriod, margin);
+				if (fast) {
+					formant -> intensity = lpc -> gain;
+					bool warmStart = previousFrameHasRoots;
+					previousFrameHasRoots = false;
+					if (lpc -> nCoefficients > 0) {
+						LPC_Frame_into_Polynomial (lpc, polynomial.get());
+						if (! Polynomial_into_Roots_aberth (polynomial.get(), roots.get(), warmStart)) {
+							if (Polynomial_into_Roots (polynomial.get(), roots.get(), & workspace [1]) < polynomial -> numberOfCoefficients - 1) {
+								err++;
+							}
+						}
+						previousFrameHasRoots = true;
+						rootsInUnitCircle -> max = roots -> max;
+						for (long iroot = 1; iroot <= roots -> max; iroot ++) {
+							rootsInUnitCircle -> v [iroot] = roots -> v [iroot];
+						}
+						Roots_fixIntoUnitCircle (rootsInUnitCircle.get());
+						Roots_into_Formant_Frame (rootsInUnitCircle.get(), formant, samplingFrequency, margin);
+					}
+				} else {
+					LPC_Frame_into_Formant_Frame (lpc, formant, my samplingPeriod, margin);
+				}
 			} catch (MelderError) {
 				Melder_clearError();
 				err++;
@@ -129,6 +167,14 @@ autoFormant LPC_to_Formant (LPC me, double margin) {
 	}
 }
 
+autoFormant LPC_to_Formant (LPC me, double margin) {
+	return _LPC_to_Formant (me, margin, false);
+}
+
+autoFormant LPC_to_Formant_fast (LPC me, double margin) {
+	return _LPC_to_Formant (me, margin, true);
+}
+
 void Formant_Frame_into_LPC_Frame (Formant_Frame me, LPC_Frame thee, double samplingPeriod) {
 	long m = 2, n = 2 * my nFormants;
 
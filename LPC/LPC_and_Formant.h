@@ -24,6 +24,10 @@
 
 autoFormant LPC_to_Formant (LPC me, double margin);
 
+autoFormant LPC_to_Formant_fast (LPC me, double margin);
+/* Gives the same formants as LPC_to_Formant (within rounding), but solves each frame's polynomial
+ * with the Aberth iteration, starting from the roots of the previous frame. */
+
 autoLPC Formant_to_LPC (Formant me, double samplingPeriod);
 
 void LPC_Frame_into_Formant_Frame (LPC_Frame me, Formant_Frame thee, double samplingPeriod, double margin);
@@ -25,11 +25,18 @@
 autoPolynomial LPC_Frame_to_Polynomial (LPC_Frame me) {
 	long degree = (long) my nCoefficients;
 	autoPolynomial thee = Polynomial_create (-1, 1, degree);
+	LPC_Frame_into_Polynomial (me, thee.get());
+	return thee;
+}
+
+void LPC_Frame_into_Polynomial (LPC_Frame me, Polynomial thee) {
+	long degree = (long) my nCoefficients;
+	Melder_assert (thy _capacity > degree);
+	thy numberOfCoefficients = degree + 1;
 	for (long i = 1; i <= degree; i++) {
 		thy coefficients[i] = my a[degree - i + 1];
 	}
 	thy coefficients[degree + 1] = 1.0;
-	return thee;
 }
 
 autoPolynomial LPC_to_Polynomial (LPC me, double time) {
@@ -32,4 +32,7 @@ autoPolynomial LPC_to_Polynomial (LPC me, double t);
 
 autoPolynomial LPC_Frame_to_Polynomial (LPC_Frame me);
 
+void LPC_Frame_into_Polynomial (LPC_Frame me, Polynomial thee);
+/* Preconditions: thy _capacity > my nCoefficients; sets thy numberOfCoefficients. */
+
 #endif /* _LPC_and_Polynomial_h_ */
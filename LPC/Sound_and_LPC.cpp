@@ -30,6 +30,8 @@
 #include "Vector.h"
 #include "Spectrum.h"
 #include "NUM2.h"
+#include "MelderThread.h"
+#include <atomic>
 
 #define LPC_METHOD_AUTO 1
 #define LPC_METHOD_COVAR 2
@@ -71,17 +73,28 @@ void LPC_Frame_and_Sound_filterInverse (LPC_Frame me, Sound thee, int channel) {
 	}
 }
 
-static int Sound_into_LPC_Frame_auto (Sound me, LPC_Frame thee) {
+/*
+	The frame analyses below work on the windowed samples x[1..n] of a frame,
+	and use work[1..LPC_workspaceSize (m, n)] as scratch space, which they clear themselves.
+*/
+static long LPC_workspaceSize (long m, long n) {
+	long size = 3 * m + 3;   // marple; auto needs 3 * m + 2
+	if (m * (m + 1) / 2 + 4 * m + 2 > size) size = m * (m + 1) / 2 + 4 * m + 2;   // covar
+	if (n + n + m > size) size = n + n + m;   // burg
+	return size;
+}
+
+static int LPC_Frame_analyse_auto (LPC_Frame thee, const double x[], long n, double work[]) {
 	long i = 1; // For error condition at end
 	long m = thy nCoefficients;
 
-	autoNUMvector<double> r (1, m + 1);
-	autoNUMvector<double> a (1, m + 1);
-	autoNUMvector<double> rc (1, m);
+	for (long j = 1; j <= 3 * m + 2; j++) {
+		work[j] = 0.0;
+	}
+	double *r = work, *a = r + m + 1, *rc = a + m + 1;   // r[1..m+1], a[1..m+1], rc[1..m]
 
-	double  *x = my z[1];
 	for (i = 1; i <= m + 1; i++) {
-		for (long j = 1; j <= my nx - i + 1; j++) {
+		for (long j = 1; j <= n - i + 1; j++) {
 			r[i] += x[j] * x[j + i - 1];
 		}
 	}
@@ -130,15 +143,14 @@ end:
 	cc = & work[m+1)/2+m+m+1+m+1]
 	for (i=1; i<=m(m+1)/2+m+m+1+m+m+1;i++) work[i] = 0;
 */
-static int Sound_into_LPC_Frame_covar (Sound me, LPC_Frame thee) {
-	long i = 1, n = my nx, m = thy nCoefficients;
-	double *x = my z[1];
+static int LPC_Frame_analyse_covar (LPC_Frame thee, const double x[], long n, double work[]) {
+	long i = 1, m = thy nCoefficients;
 
-	autoNUMvector<double> b (1, m * (m + 1) / 2);
-	autoNUMvector<double> grc (1, m);
-	autoNUMvector<double> a (1, m + 1);
-	autoNUMvector<double> beta (1, m);
-	autoNUMvector<double> cc (1, m + 1);
+	for (long j = 1; j <= m * (m + 1) / 2 + 4 * m + 2; j++) {
+		work[j] = 0.0;
+	}
+	double *b = work, *grc = b + m * (m + 1) / 2, *a = grc + m, *beta = a + m + 1, *cc = beta + m;
+		// b[1..m(m+1)/2], grc[1..m], a[1..m+1], beta[1..m], cc[1..m+1]
 
 	thy gain = 0.0;
 	for (i = m + 1; i <= n; i++) {
@@ -223,23 +235,24 @@ end:
 	return 0; // Melder_warning ("Less coefficienst than asked for.");
 }
 
-static int Sound_into_LPC_Frame_burg (Sound me, LPC_Frame thee) {
-	int status = NUMburg (my z[1], my nx, thy a, thy nCoefficients, &thy gain);
-	thy gain *= my nx;
+static int LPC_Frame_analyse_burg (LPC_Frame thee, double x[], long n, double work[]) {
+	int status = NUMburg_withWorkspace (x, n, thy a, thy nCoefficients, &thy gain, work);
+	thy gain *= n;
 	for (long i = 1; i <= thy nCoefficients; i++) {
 		thy a[i] = -thy a[i];
 	}
 	return status;
 }
 
-static int Sound_into_LPC_Frame_marple (Sound me, LPC_Frame thee, double tol1, double tol2) {
-	long m = 1, n = my nx, mmax = thy nCoefficients;
+static int LPC_Frame_analyse_marple (LPC_Frame thee, const double x[], long n, double tol1, double tol2, double work[]) {
+	long m = 1, mmax = thy nCoefficients;
 	int status = 1;
-	double *a = thy a, *x = my z[1];
+	double *a = thy a;
 
-	autoNUMvector<double> c (1, mmax + 1);
-	autoNUMvector<double> d (1, mmax + 1);
-	autoNUMvector<double> r (1, mmax + 1);
+	for (long j = 1; j <= 3 * mmax + 3; j++) {
+		work[j] = 0.0;
+	}
+	double *c = work, *d = c + mmax + 1, *r = d + mmax + 1;   // c[1..mmax+1], d[1..mmax+1], r[1..mmax+1]
 	double e0 = 0.0;
 	for (long k = 1; k <= n; k++) {
 		e0 += x[k] * x[k];
@@ -368,10 +381,23 @@ end:
 	return status == 1 || status == 4 || status == 5;
 }
 
+Thing_define (Sound_to_LPC_Workspace, Thing) { public:
+	autoNUMvector <double> frame, work;
+};
+
+Thing_implement (Sound_to_LPC_Workspace, Thing, 0);
+
+static autoSound_to_LPC_Workspace Sound_to_LPC_Workspace_create (long numberOfSamples, int predictionOrder) {
+	autoSound_to_LPC_Workspace me = Thing_new (Sound_to_LPC_Workspace);
+	my frame.reset (1, numberOfSamples);
+	my work.reset (1, LPC_workspaceSize (predictionOrder, numberOfSamples));
+	return me;
+}
+
 static autoLPC _Sound_to_LPC (Sound me, int predictionOrder, double analysisWidth, double dt, double preEmphasisFrequency, int method, double tol1, double tol2) {
 	double t1, samplingFrequency = 1.0 / my dx;
 	double windowDuration = 2 * analysisWidth; /* gaussian window */
-	long nFrames, frameErrorCount = 0;
+	long nFrames;
 
 	if (floor (windowDuration / my dx) < predictionOrder + 1) {
 		Melder_throw (U"Analysis window duration too short.\n For a prediction order of ", predictionOrder,
@@ -383,8 +409,8 @@ static autoLPC _Sound_to_LPC (Sound me, int predictionOrder, double analysisWidt
 	}
 	Sampled_shortTermAnalysis (me, windowDuration, dt, & nFrames, & t1);
 	autoSound sound = Data_copy (me);
-	autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
 	autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
+	long numberOfSamples = window -> nx;
 	autoLPC thee = LPC_create (my xmin, my xmax, nFrames, dt, t1, predictionOrder, my dx);
 
 	autoMelderProgress progress (U"LPC analysis");
@@ -393,34 +419,62 @@ static autoLPC _Sound_to_LPC (Sound me, int predictionOrder, double analysisWidt
 		Sound_preEmphasis (sound.get(), preEmphasisFrequency);
 	}
 
-	for (long i = 1; i <= nFrames; i++) {
-		LPC_Frame lpcframe = (LPC_Frame) & thy d_frames[i];
-		double t = Sampled_indexToX (thee.get(), i);
-		LPC_Frame_init (lpcframe, predictionOrder);
-		Sound_into_Sound (sound.get(), sframe.get(), t - windowDuration / 2);
-		Vector_subtractMean (sframe.get());
-		Sounds_multiply (sframe.get(), window.get());
-		if (method == LPC_METHOD_AUTO) {
-			if (! Sound_into_LPC_Frame_auto (sframe.get(), lpcframe)) {
-				frameErrorCount++;
+	/*
+		The frames are analysed in parallel; every thread has its own frame and scratch space.
+		The coefficient vectors of the frames are allocated beforehand,
+		so that the analysis of a frame allocates nothing and does not depend on the other frames.
+	*/
+	for (long iframe = 1; iframe <= nFrames; iframe ++) {
+		LPC_Frame_init (& thy d_frames [iframe], predictionOrder);
+	}
+	const long numberOfFramesPerChunk = 8;
+	const long numberOfChunks = (nFrames - 1) / numberOfFramesPerChunk + 1;
+	long numberOfThreads = MelderThread_getNumberOfThreads ();
+	if (numberOfThreads > numberOfChunks) numberOfThreads = numberOfChunks;
+	std::vector <autoSound_to_LPC_Workspace> workspaces;
+	for (long ithread = 1; ithread <= numberOfThreads; ithread ++)
+		workspaces. push_back (Sound_to_LPC_Workspace_create (numberOfSamples, predictionOrder));
+
+	std::atomic <long> numberOfFramesDone (0), frameErrorCount (0);
+	MelderThread_parallelFor (1, nFrames, numberOfFramesPerChunk, [&] (long firstFrame, long lastFrame, int threadNumber) {
+		Melder_assert (threadNumber <= numberOfThreads);
+		Sound_to_LPC_Workspace workspace = workspaces [threadNumber - 1]. get ();
+		double *frame = workspace -> frame.peek(), *work = workspace -> work.peek(), *x = sound -> z [1];
+		for (long iframe = firstFrame; iframe <= lastFrame; iframe ++) {
+			LPC_Frame lpcframe = & thy d_frames [iframe];
+			double t = Sampled_indexToX (thee.get(), iframe);
+
+			/*
+				Take the frame from the first channel (as Sound_into_Sound), subtract its mean, and window it.
+			*/
+			long index = Sampled_xToNearestIndex (sound.get(), t - windowDuration / 2);
+			for (long i = 1; i <= numberOfSamples; i ++) {
+				long j = index - 1 + i;
+				frame [i] = j < 1 || j > sound -> nx ? 0.0 : x [j];
 			}
-		} else if (method == LPC_METHOD_COVAR) {
-			if (! Sound_into_LPC_Frame_covar (sframe.get(), lpcframe)) {
-				frameErrorCount++;
+			double sum = 0.0;
+			for (long i = 1; i <= numberOfSamples; i ++) {
+				sum += frame [i];
 			}
-		} else if (method == LPC_METHOD_BURG) {
-			if (! Sound_into_LPC_Frame_burg (sframe.get(), lpcframe)) {
-				frameErrorCount++;
+			double mean = sum / numberOfSamples;
+			for (long i = 1; i <= numberOfSamples; i ++) {
+				frame [i] = (frame [i] - mean) * window -> z [1] [i];
 			}
-		} else if (method == LPC_METHOD_MARPLE) {
-			if (! Sound_into_LPC_Frame_marple (sframe.get(), lpcframe, tol1, tol2)) {
-				frameErrorCount++;
+
+			int status =
+				method == LPC_METHOD_AUTO ? LPC_Frame_analyse_auto (lpcframe, frame, numberOfSamples, work) :
+				method == LPC_METHOD_COVAR ? LPC_Frame_analyse_covar (lpcframe, frame, numberOfSamples, work) :
+				method == LPC_METHOD_BURG ? LPC_Frame_analyse_burg (lpcframe, frame, numberOfSamples, work) :
+				LPC_Frame_analyse_marple (lpcframe, frame, numberOfSamples, tol1, tol2, work);
+			if (! status) {
+				frameErrorCount ++;
 			}
 		}
-		if ((i % 10) == 1) {
-			Melder_progress ( (double) i / nFrames, U"LPC analysis of frame ", i, U" out of ", nFrames, U".");
-		}
-	}
+		long numberOfFramesDoneSoFar = numberOfFramesDone += lastFrame - firstFrame + 1;
+		if (MelderThread_isMainThread ())
+			Melder_progress ((double) numberOfFramesDoneSoFar / nFrames, U"LPC analysis of frame ", numberOfFramesDoneSoFar, U" out of ", nFrames, U".");
+	});
+	trace ((long) frameErrorCount, U" of ", nFrames, U" frames have fewer coefficients than asked for or are ill-conditioned.");
 	return thee;
 }
 
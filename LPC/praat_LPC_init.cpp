@@ -685,6 +685,12 @@ DIRECT (NEW_LPC_to_Formant_keep_all) {
 	CONVERT_EACH_END (my name)
 }
 
+DIRECT (NEW_LPC_to_Formant_fast) {
+	CONVERT_EACH (LPC)
+		autoFormant result = LPC_to_Formant_fast (me, 50.0);
+	CONVERT_EACH_END (my name)
+}
+
 FORM (NEW_LPC_to_LFCC, U"LPC: To LFCC", U"LPC: To LFCC...") {
 	INTEGERVAR (numberOfCoefficients, U"Number of coefficients", U"0")
 	OK
@@ -791,6 +797,40 @@ DO
 }
 
 
+FORM (REAL_Sound_getCPPS, U"Sound: Get CPPS", nullptr) {
+	LABEL (U"", U"Analysis:")
+	POSITIVEVAR (pitchFloor, U"Pitch floor (Hz)", U"60.0")
+	POSITIVEVAR (timeStep,U"Time step (s)", U"0.002")
+	POSITIVEVAR (maximumFrequency, U"Maximum frequency (Hz)", U"5000.0")
+	POSITIVEVAR (preEmphasisFrequency, U"Pre-emphasis from (Hz)", U"50")
+	LABEL (U"", U"Smoothing:")
+	BOOLEANVAR (subtractTiltBeforeSmoothing, U"Subtract tilt before smoothing", true)
+	REALVAR (smoothingWindowDuration, U"Time averaging window (s)", U"0.02")
+	REALVAR (quefrencySmoothingWindowDuration, U"Quefrency averaging window (s)", U"0.0005")
+	LABEL (U"", U"Peak search:")
+	REALVAR (fromPitch, U"left Peak search pitch range (Hz)", U"60.0")
+	REALVAR (toPitch, U"right Peak search pitch range (Hz)", U"330.0")
+	RADIOVAR (interpolationMethod, U"Interpolation", 2)
+		RADIOBUTTON (U"None")
+		RADIOBUTTON (U"Parabolic")
+		RADIOBUTTON (U"Cubic")
+		RADIOBUTTON (U"Sinc70")
+	LABEL (U"", U"Tilt line:")
+	REALVAR (fromQuefrency_tiltLine, U"left Tilt line quefrency range (s)", U"0.001")
+	REALVAR (toQuefrency_tiltLine, U"right Tilt line quefrency range (s)", U"0.0 (= end)")
+	OPTIONMENUVAR (lineType, U"Line type", 2)
+		OPTION (U"Straight")
+		OPTION (U"Exponential decay")
+	OPTIONMENUVAR (fitMethod, U"Fit method", 2)
+		OPTION (U"Least squares")
+		OPTION (U"Robust")
+	OK
+DO
+	NUMBER_ONE (Sound)
+		double result = Sound_getCPPS (me, pitchFloor, timeStep, maximumFrequency, preEmphasisFrequency, subtractTiltBeforeSmoothing, smoothingWindowDuration, quefrencySmoothingWindowDuration, fromPitch, toPitch, interpolationMethod - 1, fromQuefrency_tiltLine, toQuefrency_tiltLine, lineType, fitMethod);
+	NUMBER_ONE_END (U" dB");
+}
+
 FORM (NEW_Sound_to_PowerCepstrogram_hillenbrand, U"Sound: To PowerCepstrogram (hillenbrand)", U"Sound: To PowerCepstrogram...") {
 	POSITIVEVAR (pitchFloor, U"Pitch floor (Hz)", U"60.0")
 	POSITIVEVAR (timeStep, U"Time step (s)", U"0.002")
@@ -1122,6 +1162,7 @@ void praat_uvafon_LPC_init () {
 	praat_addAction1 (classLPC, 0, U"Analyse", 0, 0, 0);
 	praat_addAction1 (classLPC, 0, U"To Formant", 0, 0, NEW_LPC_to_Formant);
 	praat_addAction1 (classLPC, 0, U"To Formant (keep all)", 0, 0, NEW_LPC_to_Formant_keep_all);
+	praat_addAction1 (classLPC, 0, U"To Formant (fast)", 0, praat_HIDDEN, NEW_LPC_to_Formant_fast);
 	praat_addAction1 (classLPC, 0, U"To LFCC...", 0, 0, NEW_LPC_to_LFCC);
 	praat_addAction1 (classLPC, 0, U"To Spectrogram...", 0, 0, NEW_LPC_to_Spectrogram);
 	praat_addAction1 (classLPC, 0, U"To LineSpectralFrequencies...", 0, 0, NEW_LPC_to_LineSpectralFrequencies);
@@ -1142,6 +1183,7 @@ void praat_uvafon_LPC_init () {
 	praat_addAction1 (classSound, 0, U"To Formant (robust)...", U"To Formant (sl)...", 2, NEW_Sound_to_Formant_robust);
 	praat_addAction1 (classSound, 0, U"To PowerCepstrogram...", U"To Harmonicity (gne)...", 1, NEW_Sound_to_PowerCepstrogram);
 	praat_addAction1 (classSound, 0, U"To PowerCepstrogram (hillenbrand)...", U"To Harmonicity (gne)...", praat_HIDDEN + praat_DEPTH_1, NEW_Sound_to_PowerCepstrogram_hillenbrand);
+	praat_addAction1 (classSound, 1, U"Get CPPS...", U"To PowerCepstrogram (hillenbrand)...", praat_HIDDEN + praat_DEPTH_1, REAL_Sound_getCPPS);
 	
 	praat_addAction1 (classVocalTract, 0, U"Draw segments...", U"Draw", 0, GRAPHICS_VocalTract_drawSegments);
 	praat_addAction1 (classVocalTract, 1, U"Get length", U"Draw segments...", 0, REAL_VocalTract_getLength);
@@ -2087,13 +2087,19 @@ aa = & work[n+n+1];
 for (i=1; i<=n+n+n; i++) work[i]=0;
 */
 int NUMburg (double x[], long n, double a[], int m, double *xms) {
+	autoNUMvector<double> workspace (1, n + n + m);
+	return NUMburg_withWorkspace (x, n, a, m, xms, workspace.peek());
+}
+
+int NUMburg_withWorkspace (double x[], long n, double a[], int m, double *xms, double *workspace) {
 	for (long j = 1; j <= m; j++) {
 		a[j] = 0.0;
 	}
 
-	autoNUMvector<double> b1 (1, n);
-	autoNUMvector<double> b2 (1, n);
-	autoNUMvector<double> aa (1, m);
+	for (long j = 1; j <= n + n + m; j++) {
+		workspace[j] = 0.0;
+	}
+	double *b1 = workspace, *b2 = workspace + n, *aa = workspace + n + n;   // b1[1..n], b2[1..n], aa[1..m]
 
 	// (3)
 
@@ -2656,58 +2662,67 @@ long NUMgetIndexFromProbability (double *probs, long nprobs, double p) {
 
 // straight line fitting
 
-void NUMlineFit_theil (double *x, double *y, long numberOfPoints, double *p_m, double *p_intercept, bool incompleteMethod) {
-	try {
-		/* Theil's incomplete method:
-		 * Split (x[i],y[i]) as
-		 * (x[i],y[i]), (x[N+i],y[N=i], i=1..numberOfPoints/2
-		 * m[i] = (y[N+i]-y[i])/(x[N+i]-x[i])
-		 * m = median (m[i])
-		 * b = median(y[i]-m*x[i])
-		 */
-		double m, intercept;
-		if (numberOfPoints <= 0) {
-			m = intercept = NUMundefined;
-		} else if (numberOfPoints == 1) {
-			intercept = y[1];
-			m = 0;
-		} else if (numberOfPoints == 2) {
-			m = (y[2] - y[1]) / (x[2] - x[1]);
-			intercept = y[1] - m * x[1];
-		} else {
-			long numberOfCombinations;
-			autoNUMvector<double> mbs;
-			if (incompleteMethod) { // incomplete method
-				numberOfCombinations = numberOfPoints / 2;
-				mbs.reset (1, numberOfPoints); //
-				long n2 = numberOfPoints % 2 == 1 ? numberOfCombinations + 1 : numberOfCombinations;
-				for (long i = 1; i <= numberOfCombinations; i++) {
-					mbs[i] = (y[n2 + i] - y[i]) / (x[n2 + i] - x[i]);
-				}
-			} else { // use all combinations
-				numberOfCombinations = (numberOfPoints - 1) * numberOfPoints / 2;
-				mbs.reset (1, numberOfCombinations);
-				long index = 0;
-				for (long i = 1; i < numberOfPoints; i++) {
-					for (long j = i + 1; j <= numberOfPoints; j++) {
-						mbs[++index] = (y[j] - y[i]) / (x[j] - x[i]);
-					}
+static long NUMlineFit_theil_getWorkspaceSize (long numberOfPoints, bool incompleteMethod) {
+	return incompleteMethod || numberOfPoints < 3 ? numberOfPoints : (numberOfPoints - 1) * numberOfPoints / 2;
+}
+
+static void NUMlineFit_theil_withWorkspace (double *x, double *y, long numberOfPoints, double *p_m, double *p_intercept, bool incompleteMethod, double *mbs) {
+	/* Theil's incomplete method:
+	 * Split (x[i],y[i]) as
+	 * (x[i],y[i]), (x[N+i],y[N=i], i=1..numberOfPoints/2
+	 * m[i] = (y[N+i]-y[i])/(x[N+i]-x[i])
+	 * m = median (m[i])
+	 * b = median(y[i]-m*x[i])
+	 */
+	double m, intercept;
+	if (numberOfPoints <= 0) {
+		m = intercept = NUMundefined;
+	} else if (numberOfPoints == 1) {
+		intercept = y[1];
+		m = 0;
+	} else if (numberOfPoints == 2) {
+		m = (y[2] - y[1]) / (x[2] - x[1]);
+		intercept = y[1] - m * x[1];
+	} else {
+		long numberOfCombinations;
+		if (incompleteMethod) { // incomplete method
+			numberOfCombinations = numberOfPoints / 2;
+			long n2 = numberOfPoints % 2 == 1 ? numberOfCombinations + 1 : numberOfCombinations;
+			for (long i = 1; i <= numberOfCombinations; i++) {
+				mbs[i] = (y[n2 + i] - y[i]) / (x[n2 + i] - x[i]);
+			}
+		} else { // use all combinations
+			numberOfCombinations = (numberOfPoints - 1) * numberOfPoints / 2;
+			long index = 0;
+			for (long i = 1; i < numberOfPoints; i++) {
+				for (long j = i + 1; j <= numberOfPoints; j++) {
+					mbs[++index] = (y[j] - y[i]) / (x[j] - x[i]);
 				}
 			}
-			NUMsort_d (numberOfCombinations, mbs.peek());
-			m = NUMquantile (numberOfCombinations, mbs.peek(), 0.5);
-			for (long i = 1; i <= numberOfPoints; i++) {
-				mbs[i] = y[i] - m * x[i];
-			}
-			NUMsort_d (numberOfPoints, mbs.peek());
-			intercept = NUMquantile (numberOfPoints, mbs.peek(), 0.5);
 		}
-		if (p_m) {
-			*p_m = m;
+		NUMsort_d (numberOfCombinations, mbs);
+		m = NUMquantile (numberOfCombinations, mbs, 0.5);
+		for (long i = 1; i <= numberOfPoints; i++) {
+			mbs[i] = y[i] - m * x[i];
 		}
-		if (p_intercept) {
-			*p_intercept = intercept;
+		NUMsort_d (numberOfPoints, mbs);
+		intercept = NUMquantile (numberOfPoints, mbs, 0.5);
+	}
+	if (p_m) {
+		*p_m = m;
+	}
+	if (p_intercept) {
+		*p_intercept = intercept;
+	}
+}
+
+void NUMlineFit_theil (double *x, double *y, long numberOfPoints, double *p_m, double *p_intercept, bool incompleteMethod) {
+	try {
+		autoNUMvector<double> mbs;
+		if (numberOfPoints > 2) {
+			mbs.reset (1, NUMlineFit_theil_getWorkspaceSize (numberOfPoints, incompleteMethod));
 		}
+		NUMlineFit_theil_withWorkspace (x, y, numberOfPoints, p_m, p_intercept, incompleteMethod, mbs.peek());
 	} catch (MelderError) {
 		Melder_throw (U"No line fit (Theil's method)");
 	}
@@ -2746,6 +2761,18 @@ void NUMlineFit (double *x, double *y, long numberOfPoints, double *m, double *i
 	}
 }
 
+long NUMlineFit_getWorkspaceSize (long numberOfPoints, int method) {
+	return method == 1 ? 0 : NUMlineFit_theil_getWorkspaceSize (numberOfPoints, method != 3);
+}
+
+void NUMlineFit_withWorkspace (double *x, double *y, long numberOfPoints, double *m, double *intercept, int method, double *workspace) {
+	if (method == 1) {
+		NUMlineFit_LS (x, y, numberOfPoints, m, intercept);
+	} else {
+		NUMlineFit_theil_withWorkspace (x, y, numberOfPoints, m, intercept, method != 3, workspace);
+	}
+}
+
 // IEEE: Programs for digital signal processing section 4.3 LPTRN
 // lpc[1..n] to rc[1..n]
 void NUMlpc_lpc_to_rc (double *lpc, long p, double *rc) {
@@ -1008,6 +1008,12 @@ int NUMburg (double x[], long n, double a[], int m, double *xms);
 	Spectrum Analysis, IEEE Press, 1978, 252-255.
 */
 
+int NUMburg_withWorkspace (double x[], long n, double a[], int m, double *xms, double *workspace);
+/*
+	As NUMburg, but with workspace[1..2*n+m] as scratch space instead of memory of its own,
+	so that it can be called for many frames (and from several threads) without allocating.
+*/
+
 void NUMdmatrix_to_dBs (double **m, long rb, long re, long cb, long ce,
 	double ref, double factor, double floor);
 /*
@@ -1159,6 +1165,8 @@ struct structNUMfft_Table
   long n;
   double *trigcache;
   long *splitcache;
+  long bluesteinSize; /* 0 if the transform is done directly by FFTPACK */
+  double *bluesteinCache;
 };
 
 typedef struct structNUMfft_Table_f *NUMfft_Table_f;
@@ -1167,7 +1175,27 @@ typedef struct structNUMfft_Table *NUMfft_Table;
 void NUMfft_Table_init_f (NUMfft_Table_f table, long n);
 void NUMfft_Table_init (NUMfft_Table table, long n);
 /*
-	n : data size
+	n : data size, which can be any positive number.
+	Sizes whose prime factors are 2, 3 and 5 only are transformed fastest.
+	If n has a large prime factor, for which the FFTPACK transform would approach n^2 operations,
+	the table is set up for Bluestein's algorithm instead, which works via a power-of-two convolution.
+*/
+
+long NUMfft_getGoodSize (long minimumSize);
+/*
+	Returns the smallest even size >= minimumSize that has no prime factors other than 2, 3 and 5.
+	This is never larger than the next power of two and typically much closer to minimumSize.
+	Use this for transforms that only need "at least minimumSize" points, e.g. zero padding against wrap-around.
+*/
+
+void NUMfft_Table_initForMinimumSize (NUMfft_Table table, long minimumSize);
+/*
+	Initializes the table for size NUMfft_getGoodSize (minimumSize); the size chosen is then in table -> n.
+*/
+
+long NUMfft_Table_getWorkspaceSize (NUMfft_Table table);
+/*
+	The number of elements needed by the workspace of NUMfft_forward_withWorkspace and NUMfft_backward_withWorkspace.
 */
 
 struct autoNUMfft_Table : public structNUMfft_Table {
@@ -1175,10 +1203,13 @@ struct autoNUMfft_Table : public structNUMfft_Table {
                 n = 0;
                 trigcache = 0;
                 splitcache = 0;
+                bluesteinSize = 0;
+                bluesteinCache = 0;
         }
         ~autoNUMfft_Table () {
                 NUMvector_free (trigcache, 0);
                 NUMvector_free (splitcache, 0);
+                NUMvector_free (bluesteinCache, 0);
         }
 };
 
@@ -1270,6 +1301,24 @@ void NUMfft_backward (NUMfft_Table table, double *data);
              sequence by n.
 */
 
+void NUMfft_forward_withWorkspace (NUMfft_Table table, double *data, double *workspace);
+void NUMfft_backward_withWorkspace (NUMfft_Table table, double *data, double *workspace);
+/*
+	As NUMfft_forward and NUMfft_backward, but with workspace [1..NUMfft_Table_getWorkspaceSize (table)] as scratch space
+	instead of the table's own; the table is then only read,
+	so that several threads can share it if each has its own workspace.
+*/
+
+long NUMfft_Table_getBatchWorkspaceSize (NUMfft_Table table);
+void NUMfft_forward_batch (NUMfft_Table table, long numberOfFrames, double **data, double *workspace);
+void NUMfft_backward_batch (NUMfft_Table table, long numberOfFrames, double **data, double *workspace);
+/*
+	Transforms the frames data [1..numberOfFrames] [1..n] in place, each as NUMfft_forward or NUMfft_backward would.
+	Where the processor allows, several frames are interleaved and transformed together with SIMD instructions
+	(four frames with AVX2, two with SSE2); the results are identical to those of the one-frame transforms.
+	workspace [1..NUMfft_Table_getBatchWorkspaceSize (table)] is scratch space; the table is only read.
+*/
+
 /**** Compatibility with NR fft's */
 
 void NUMforwardRealFastFourierTransform_f (float  *data, long n);
@@ -1313,6 +1362,10 @@ void NUMlineFit (double *x, double *y, long numberOfPoints, double *m, double *i
  * 3 robust complete Theil (very slow for large N, O(N^2))
  */
 
+long NUMlineFit_getWorkspaceSize (long numberOfPoints, int method);
+void NUMlineFit_withWorkspace (double *x, double *y, long numberOfPoints, double *m, double *intercept, int method, double *workspace);
+/* As NUMlineFit, but with workspace[1..NUMlineFit_getWorkspaceSize (numberOfPoints, method)] instead of memory of its own. */
+
 void NUMlineFit_theil (double *x, double *y, long numberOfPoints, double *m, double *intercept, bool incompleteMethod);
 /*
  * Preconditions:
@@ -99,7 +99,7 @@ int NUMblas_dcopy (long *n, double *dx, long *incx, double *dy, long *incy) {
 	long i__1;
 
 	/* Local variables */
-	static long i__, m, ix, iy, mp1;
+	long i__, m, ix, iy, mp1;
 
 	--dy;
 	--dx;
@@ -444,9 +444,9 @@ int NUMblas_dger (long *m, long *n, double *alpha, double *x, long *incx, double
 	long a_dim1, a_offset, i__1, i__2;
 
 	/* Local variables */
-	static long info;
-	static double temp;
-	static long i__, j, ix, jy, kx;
+	long info;
+	double temp;
+	long i__, j, ix, jy, kx;
 
 #define a_ref(a_1,a_2) a[(a_2)*a_dim1 + a_1]
 	/* Test the input parameters. Parameter adjustments */
@@ -530,10 +530,10 @@ int NUMblas_dgemv (const char *trans, long *m, long *n, double *alpha, double *a
 	long a_dim1, a_offset, i__1, i__2;
 
 	/* Local variables */
-	static long info;
-	static double temp;
-	static long lenx, leny, i__, j;
-	static long ix, iy, jx, jy, kx, ky;
+	long info;
+	double temp;
+	long lenx, leny, i__, j;
+	long ix, iy, jx, jy, kx, ky;
 
 #define a_ref(a_1,a_2) a[(a_2)*a_dim1 + a_1]
 
@@ -697,11 +697,7 @@ int NUMblas_dgemv (const char *trans, long *m, long *n, double *alpha, double *a
 #undef a_ref
 
 double NUMblas_dlamch (const char *cmach) {
-	/* Initialized data */
-	static long first = TRUE;
-
 	/* System generated locals */
-	long i__1;
 	double ret_val;
 
 	/* Builtin functions */
@@ -711,13 +707,15 @@ double NUMblas_dlamch (const char *cmach) {
 	static double emin, prec, emax;
 	static long imin, imax;
 	static long lrnd;
-	static double rmin, rmax, t, rmach;
+	static double rmin, rmax, t;
+	double rmach = 0.0;
 	static double smal, sfmin;
 	static long it;
 	static double rnd, eps;
 
-	if (first) {
-		first = FALSE;
+	/* Compute the constants only once; the initialization of a local static is thread-safe. */
+	static const bool initialized = [] () -> bool {
+		long i__1;
 		dlamc2_ (&beta, &it, &lrnd, &eps, &imin, &rmin, &imax, &rmax);
 		base = (double) beta;
 		t = (double) it;
@@ -742,7 +740,9 @@ double NUMblas_dlamch (const char *cmach) {
 
 			sfmin = smal * (eps + 1.);
 		}
-	}
+		return true;
+	} ();
+	(void) initialized;
 
 	if (lsame_ (cmach, "E")) {
 		rmach = eps;
@@ -1396,9 +1396,9 @@ double NUMblas_dnrm2 (long *n, double *x, long *incx) {
 	double ret_val, d__1;
 
 	/* Local variables */
-	static double norm, scale, absxi;
-	static long ix;
-	static double ssq;
+	double norm, scale, absxi;
+	long ix;
+	double ssq;
 
 	--x;
 	/* Function Body */
@@ -1440,9 +1440,9 @@ int NUMblas_drot (long *n, double *dx, long *incx, double *dy, long *incy, doubl
 	long i__1;
 
 	/* Local variables */
-	static long i__;
-	static double dtemp;
-	static long ix, iy;
+	long i__;
+	double dtemp;
+	long ix, iy;
 
 	/* applies a plane rotation. jack dongarra, linpack, 3/11/78. modified
 	   12/3/93, array(1) declarations changed to array(*) Parameter
@@ -1493,7 +1493,7 @@ int NUMblas_dscal (long *n, double *da, double *dx, long *incx) {
 	long i__1, i__2;
 
 	/* Local variables */
-	static long i__, m, nincx, mp1;
+	long i__, m, nincx, mp1;
 
 	/* Parameter adjustments */
 	--dx;
@@ -2959,8 +2959,8 @@ long NUMblas_idamax (long *n, double *dx, long *incx) {
 	double d__1;
 
 	/* Local variables */
-	static double dmax__;
-	static long i__, ix;
+	double dmax__;
+	long i__, ix;
 
 	/* finds the index of element having max. absolute value. jack
 	   dongarra, linpack, 3/11/78. modified 3/93 to return if incx .le. 0.
@@ -7747,25 +7747,25 @@ int NUMlapack_dhseqr (const char *job, const char *compz, long *n, long *ilo, lo
 	char ch__1[2];
 
 	/* Local variables */
-	static long maxb;
-	static double absw;
-	static long ierr;
-	static double unfl, temp, ovfl;
-	static long i__, j, k, l;
-	static double s[225] /* was [15][15] */ , v[16];
-	static long itemp;
-	static long i1, i2;
-	static int initz, wantt, wantz;
-	static long ii, nh;
-	static long nr, ns;
-	static long nv;
-	static double vv[16];
-	static double smlnum;
-	static int lquery;
-	static long itn;
-	static double tau;
-	static long its;
-	static double ulp, tst1;
+	long maxb;
+	double absw;
+	long ierr;
+	double unfl, temp, ovfl;
+	long i__, j, k, l;
+	double s[225] /* was [15][15] */ , v[16];
+	long itemp;
+	long i1 = 0, i2 = 0;
+	int initz, wantt, wantz;
+	long ii, nh;
+	long nr, ns;
+	long nv;
+	double vv[16];
+	double smlnum;
+	int lquery;
+	long itn;
+	double tau;
+	long its;
+	double ulp, tst1;
 
 #define h___ref(a_1,a_2) h__[(a_2)*h_dim1 + a_1]
 #define s_ref(a_1,a_2) s[(a_2)*15 + a_1 - 16]
@@ -8418,7 +8418,7 @@ int NUMlapack_dlacpy (const char *uplo, long *m, long *n, double *a, long *lda,
 	long a_dim1, a_offset, b_dim1, b_offset, i__1, i__2;
 
 	/* Local variables */
-	static long i__, j;
+	long i__, j;
 
 	a_dim1 = *lda;
 	a_offset = 1 + a_dim1 * 1;
@@ -8822,21 +8822,21 @@ int NUMlapack_dlahqr (int *wantt, int *wantz, long *n, long *ilo, long *ihi, dou
 	double d__1, d__2;
 
 	/* Local variables */
-	static double h43h34, disc, unfl, ovfl;
-	static double work[1];
-	static long i__, j, k, l, m;
-	static double s, v[3];
-	static long i1, i2;
-	static double t1, t2, t3, v1, v2, v3;
-	static double h00, h10, h11, h12, h21, h22, h33, h44;
-	static long nh;
-	static double cs;
-	static long nr;
-	static double sn;
-	static long nz;
-	static double smlnum, ave, h33s, h44s;
-	static long itn, its;
-	static double ulp, sum, tst1;
+	double h43h34, disc, unfl, ovfl;
+	double work[1];
+	long i__, j, k, l, m;
+	double s, v[3];
+	long i1 = 0, i2 = 0;
+	double t1, t2, t3, v1, v2, v3;
+	double h00, h10, h11, h12, h21, h22, h33, h44;
+	long nh;
+	double cs;
+	long nr;
+	double sn;
+	long nz;
+	double smlnum, ave, h33s, h44s;
+	long itn, its;
+	double ulp, sum, tst1;
 
 #define h___ref(a_1,a_2) h__[(a_2)*h_dim1 + a_1]
 #define z___ref(a_1,a_2) z__[(a_2)*z_dim1 + a_1]
@@ -9856,10 +9856,10 @@ double NUMlapack_dlanhs (const char *norm, long *n, double *a, long *lda, double
 	double ret_val, d__1, d__2, d__3;
 
 	/* Local variables */
-	static long i__, j;
-	static double scale;
-	static double value;
-	static double sum;
+	long i__, j;
+	double scale;
+	double value = 0.0;
+	double sum;
 
 	a_dim1 = *lda;
 	a_offset = 1 + a_dim1 * 1;
@@ -10167,9 +10167,9 @@ int NUMlapack_dlanv2 (double *a, double *b, double *c__, double *d__, double *rt
 	double d__1, d__2;
 
 	/* Local variables */
-	static double temp, p, scale, bcmax, z__, bcmis, sigma;
-	static double aa, bb, cc, dd;
-	static double cs1, sn1, sab, sac, eps, tau;
+	double temp, p, scale, bcmax, z__, bcmis, sigma;
+	double aa, bb, cc, dd;
+	double cs1, sn1, sab, sac, eps, tau;
 
 	eps = NUMblas_dlamch ("P");
 	if (*c__ == 0.) {
@@ -10462,7 +10462,7 @@ double NUMlapack_dlapy2 (double *x, double *y) {
 	double ret_val, d__1;
 
 	/* Local variables */
-	static double xabs, yabs, w, z__;
+	double xabs, yabs, w, z__;
 
 	xabs = fabs (*x);
 	yabs = fabs (*y);
@@ -11100,11 +11100,11 @@ int NUMlapack_dlarfg (long *n, double *alpha, double *x, long *incx, double *tau
 	double d__1;
 
 	/* Local variables */
-	static double beta;
-	static long j;
-	static double xnorm;
-	static double safmin, rsafmn;
-	static long knt;
+	double beta;
+	long j;
+	double xnorm;
+	double safmin, rsafmn;
+	long knt;
 
 	--x;
 
@@ -11431,8 +11431,8 @@ int NUMlapack_dlarfx (const char *side, long *m, long *n, double *v, double *tau
 	double d__1;
 
 	/* Local variables */
-	static long j;
-	static double t1, t2, t3, t4, t5, t6, t7, t8, t9, v1, v2, v3, v4, v5, v6, v7, v8, v9, t10, v10, sum;
+	long j;
+	double t1, t2, t3, t4, t5, t6, t7, t8, t9, v1, v2, v3, v4, v5, v6, v7, v8, v9, t10, v10, sum;
 
 	--v;
 	c_dim1 = *ldc;
@@ -12372,7 +12372,7 @@ int NUMlapack_dlaset (const char *uplo, long *m, long *n, double *alpha, double
 	long a_dim1, a_offset, i__1, i__2, i__3;
 
 	/* Local variables */
-	static long i__, j;
+	long i__, j;
 
 	a_dim1 = *lda;
 	a_offset = 1 + a_dim1 * 1;
@@ -14241,8 +14241,8 @@ int NUMlapack_dlassq (long *n, double *x, long *incx, double *scale, double *sum
 	double d__1;
 
 	/* Local variables */
-	static double absxi;
-	static long ix;
+	double absxi;
+	long ix;
 
 	--x;
 
@@ -19757,7 +19757,7 @@ long NUMlapack_ieeeck (long *ispec, float *zero, float *one) {
 	long ret_val;
 
 	/* Local variables */
-	static float neginf, posinf, negzro, newzro, nan1, nan2, nan3, nan4, nan5, nan6;
+	float neginf, posinf, negzro, newzro, nan1, nan2, nan3, nan4, nan5, nan6;
 
 	ret_val = 1;
 
@@ -19872,13 +19872,13 @@ long NUMlapack_ilaenv (long *ispec, const char *name__, const char *opts, long *
 	long ret_val;
 
 	/* Local variables */
-	static long i__;
-	static long cname, sname;
-	static long nbmin;
-	static char c1[1], c2[2], c3[3], c4[2];
-	static long ic, nb;
-	static long iz, nx;
-	static char subnam[6];
+	long i__;
+	long cname, sname;
+	long nbmin;
+	char c1[1], c2[2], c3[3], c4[2];
+	long ic, nb;
+	long iz, nx;
+	char subnam[6];
 
 	(void) opts;
 	(void) n3;
@@ -0,0 +1,136 @@
+/* NUMfft_batch.cpp
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+	Batched real FFT: the FFTPACK passes of NUMfft_core.h, instantiated for vectors of frames.
+
+	Frame j of a batch goes into lane j of every vector element, so each lane performs exactly
+	the arithmetic of the scalar transform, in the same order; the results are bit-identical.
+	The twiddle factors stay scalar and are broadcast by the vector arithmetic.
+	(FMA contraction would break this identity, so the AVX2 instantiation does not enable FMA.)
+*/
+
+#include "NUM2.h"
+#include "melder.h"
+
+#define my me ->
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__) || defined (__aarch64__))
+	#define NUMfft_HAVE_VECTORS  1
+#else
+	#define NUMfft_HAVE_VECTORS  0
+#endif
+#if NUMfft_HAVE_VECTORS && (defined (__x86_64__) || defined (__i386__)) && ! defined (__clang__)
+	#define NUMfft_HAVE_AVX2  1
+#else
+	#define NUMfft_HAVE_AVX2  0
+#endif
+
+#define NUMfft_MAXIMUM_LANES  4
+
+#if NUMfft_HAVE_VECTORS
+
+namespace NUMfft_lanes2 {
+	typedef double Vector __attribute__ ((vector_size (16)));
+	#define FFT_DATA_TYPE Vector
+	#define FFT_LOCAL_TYPE Vector
+	#define FFT_TWIDDLE_TYPE double
+	#define FFT_PASSES_ONLY
+	#include "NUMfft_core.h"
+	#undef FFT_DATA_TYPE
+	#undef FFT_PASSES_ONLY
+	static const long numberOfLanes = 2;
+	#include "NUMfft_batch_lanes.h"
+}
+
+#if NUMfft_HAVE_AVX2
+#pragma GCC push_options
+#pragma GCC target ("avx2")
+namespace NUMfft_lanes4 {
+	typedef double Vector __attribute__ ((vector_size (32)));
+	#define FFT_DATA_TYPE Vector
+	#define FFT_LOCAL_TYPE Vector
+	#define FFT_TWIDDLE_TYPE double
+	#define FFT_PASSES_ONLY
+	#include "NUMfft_core.h"
+	#undef FFT_DATA_TYPE
+	#undef FFT_PASSES_ONLY
+	static const long numberOfLanes = 4;
+	#include "NUMfft_batch_lanes.h"
+}
+#pragma GCC pop_options
+#endif
+
+#endif
+
+static long numberOfLanesOnThisProcessor () {
+	static const long numberOfLanes = [] () -> long {
+		#if NUMfft_HAVE_AVX2
+			if (__builtin_cpu_supports ("avx2"))
+				return 4;
+		#endif
+		#if NUMfft_HAVE_VECTORS
+			return 2;   // SSE2 on x86_64, NEON on ARM
+		#else
+			return 1;
+		#endif
+	} ();
+	if (Melder_debug == 48)
+		return 1;
+	return numberOfLanes;
+}
+
+long NUMfft_Table_getBatchWorkspaceSize (NUMfft_Table me) {
+	/*
+		Two vector arrays of n elements (data and FFTPACK scratch), plus room for alignment.
+	*/
+	long vectorSize = 2 * NUMfft_MAXIMUM_LANES * my n + NUMfft_MAXIMUM_LANES;
+	long scalarSize = NUMfft_Table_getWorkspaceSize (me);
+	return vectorSize > scalarSize ? vectorSize : scalarSize;
+}
+
+static void NUMfft_batch (NUMfft_Table me, long numberOfFrames, double **data, double *workspace, bool forward) {
+	long iframe = 1;
+	if (my n > 1 && my bluesteinSize == 0) {
+		long numberOfLanes = numberOfLanesOnThisProcessor ();
+		#if NUMfft_HAVE_AVX2
+			if (numberOfLanes == 4)
+				for (; iframe + 3 <= numberOfFrames; iframe += 4)
+					NUMfft_lanes4::transform (me, & data [iframe], workspace, forward);
+		#endif
+		#if NUMfft_HAVE_VECTORS
+			if (numberOfLanes >= 2)
+				for (; iframe + 1 <= numberOfFrames; iframe += 2)
+					NUMfft_lanes2::transform (me, & data [iframe], workspace, forward);
+		#endif
+	}
+	for (; iframe <= numberOfFrames; iframe ++) {
+		if (forward)
+			NUMfft_forward_withWorkspace (me, data [iframe], workspace);
+		else
+			NUMfft_backward_withWorkspace (me, data [iframe], workspace);
+	}
+}
+
+void NUMfft_forward_batch (NUMfft_Table me, long numberOfFrames, double **data, double *workspace) {
+	NUMfft_batch (me, numberOfFrames, data, workspace, true);
+}
+
+void NUMfft_backward_batch (NUMfft_Table me, long numberOfFrames, double **data, double *workspace) {
+	NUMfft_batch (me, numberOfFrames, data, workspace, false);
+}
+
+/* End of file NUMfft_batch.cpp */
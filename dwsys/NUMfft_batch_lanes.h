@@ -0,0 +1,47 @@
+/* NUMfft_batch_lanes.h
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+	Included by NUMfft_batch.cpp inside a namespace that defines Vector and numberOfLanes,
+	after NUMfft_core.h has been included there for Vector.
+	Transforms the frames frames [0..numberOfLanes-1] [1..n] together.
+*/
+
+static void transform (NUMfft_Table me, double **frames, double *workspace, bool forward) {
+	long n = my n;
+	/*
+		Align to the size of a Vector; the workspace has room for this.
+	*/
+	uintptr_t address = (uintptr_t) & workspace [1];
+	address = (address + sizeof (Vector) - 1) & ~ (uintptr_t) (sizeof (Vector) - 1);
+	Vector *c = (Vector *) address, *ch = c + n;
+	for (long i = 0; i < n; i ++) {
+		for (long lane = 0; lane < numberOfLanes; lane ++) {
+			c [i] [lane] = frames [lane] [i + 1];
+		}
+	}
+	if (forward)
+		drftf1 (n, c, ch, my trigcache + n, my splitcache);
+	else
+		drftb1 (n, c, ch, my trigcache + n, my splitcache);
+	for (long i = 0; i < n; i ++) {
+		for (long lane = 0; lane < numberOfLanes; lane ++) {
+			frames [lane] [i + 1] = c [i] [lane];
+		}
+	}
+}
+
+/* End of file NUMfft_batch_lanes.h */
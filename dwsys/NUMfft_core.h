@@ -27,6 +27,18 @@
    original fortran), these routines can work on arbitrary length vectors
    that need not be powers of two in length. */
 
+/*
+	The passes can also be instantiated for vectors of several frames at once (see NUMfft_batch.cpp);
+	by default the local variables are doubles and the twiddle factors have the type of the data.
+*/
+#ifndef FFT_LOCAL_TYPE
+	#define FFT_LOCAL_TYPE double
+#endif
+#ifndef FFT_TWIDDLE_TYPE
+	#define FFT_TWIDDLE_TYPE FFT_DATA_TYPE
+#endif
+
+#ifndef FFT_PASSES_ONLY
 static void drfti1 (long n, FFT_DATA_TYPE * wa, long *ifac)
 {
 	static long ntryh[4] = { 4, 2, 3, 5 };
@@ -114,6 +126,7 @@ static void NUMrffti (long n, FFT_DATA_TYPE * wsave, long *ifac)
 		return;
 	drfti1 (n, wsave + n, ifac);
 }
+#endif
 
 /* void NUMcosqi(long n, FFT_DATA_TYPE *wsave, long *ifac){ static
    double pih = 1.57079632679489661923132169163975; static long k;
@@ -123,10 +136,10 @@ static void NUMrffti (long n, FFT_DATA_TYPE * wsave, long *ifac)
 
    NUMrffti(n, wsave+n,ifac); } */
 
-static void dradf2 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, FFT_DATA_TYPE * wa1)
+static void dradf2 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, FFT_TWIDDLE_TYPE * wa1)
 {
 	long i, k;
-	double ti2, tr2;
+	FFT_LOCAL_TYPE ti2, tr2;
 	long t0, t1, t2, t3, t4, t5, t6;
 
 	t1 = 0;
@@ -186,12 +199,12 @@ static void dradf2 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, F
 	}
 }
 
-static void dradf4 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, FFT_DATA_TYPE * wa1,
-	FFT_DATA_TYPE * wa2, FFT_DATA_TYPE * wa3)
+static void dradf4 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, FFT_TWIDDLE_TYPE * wa1,
+	FFT_TWIDDLE_TYPE * wa2, FFT_TWIDDLE_TYPE * wa3)
 {
 	static double hsqt2 = .70710678118654752440084436210485;
 	long i, k, t0, t1, t2, t3, t4, t5, t6;
-	double ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
+	FFT_LOCAL_TYPE ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
 
 	t0 = l1 * ido;
 
@@ -292,7 +305,7 @@ static void dradf4 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, F
 }
 
 static void dradfg (long ido, long ip, long l1, long idl1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * c1,
-	FFT_DATA_TYPE * c2, FFT_DATA_TYPE * ch, FFT_DATA_TYPE * ch2, FFT_DATA_TYPE * wa)
+	FFT_DATA_TYPE * c2, FFT_DATA_TYPE * ch, FFT_DATA_TYPE * ch2, FFT_TWIDDLE_TYPE * wa)
 {
 
 	static double tpi = 6.28318530717958647692528676655900577;
@@ -640,7 +653,7 @@ static void dradfg (long ido, long ip, long l1, long idl1, FFT_DATA_TYPE * cc, F
 	}
 }
 
-static void drftf1 (long n, FFT_DATA_TYPE * c, FFT_DATA_TYPE * ch, FFT_DATA_TYPE * wa, long *ifac)
+static void drftf1 (long n, FFT_DATA_TYPE * c, FFT_DATA_TYPE * ch, FFT_TWIDDLE_TYPE * wa, long *ifac)
 {
 	long i, k1, l1, l2;
 	long na, kh, nf;
@@ -710,10 +723,10 @@ static void drftf1 (long n, FFT_DATA_TYPE * c, FFT_DATA_TYPE * ch, FFT_DATA_TYPE
 		c[i] = ch[i];
 }
 
-static void dradb2 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, FFT_DATA_TYPE * wa1)
+static void dradb2 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, FFT_TWIDDLE_TYPE * wa1)
 {
 	long i, k, t0, t1, t2, t3, t4, t5, t6;
-	double ti2, tr2;
+	FFT_LOCAL_TYPE ti2, tr2;
 
 	t0 = l1 * ido;
 
@@ -770,13 +783,13 @@ static void dradb2 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, F
 	}
 }
 
-static void dradb3 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, FFT_DATA_TYPE * wa1,
-	FFT_DATA_TYPE * wa2)
+static void dradb3 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, FFT_TWIDDLE_TYPE * wa1,
+	FFT_TWIDDLE_TYPE * wa2)
 {
 	static double taur = -.5;
 	static double taui = .86602540378443864676372317075293618;
 	long i, k, t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10;
-	double ci2, ci3, di2, di3, cr2, cr3, dr2, dr3, ti2, tr2;
+	FFT_LOCAL_TYPE ci2, ci3, di2, di3, cr2, cr3, dr2, dr3, ti2, tr2;
 
 	t0 = l1 * ido;
 
@@ -839,12 +852,12 @@ static void dradb3 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, F
 	}
 }
 
-static void dradb4 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, FFT_DATA_TYPE * wa1,
-	FFT_DATA_TYPE * wa2, FFT_DATA_TYPE * wa3)
+static void dradb4 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, FFT_TWIDDLE_TYPE * wa1,
+	FFT_TWIDDLE_TYPE * wa2, FFT_TWIDDLE_TYPE * wa3)
 {
 	static double sqrt2 = 1.4142135623730950488016887242097;
 	long i, k, t0, t1, t2, t3, t4, t5, t6, t7, t8;
-	double ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
+	FFT_LOCAL_TYPE ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
 
 	t0 = l1 * ido;
 
@@ -940,7 +953,7 @@ static void dradb4 (long ido, long l1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * ch, F
 }
 
 static void dradbg (long ido, long ip, long l1, long idl1, FFT_DATA_TYPE * cc, FFT_DATA_TYPE * c1,
-	FFT_DATA_TYPE * c2, FFT_DATA_TYPE * ch, FFT_DATA_TYPE * ch2, FFT_DATA_TYPE * wa)
+	FFT_DATA_TYPE * c2, FFT_DATA_TYPE * ch, FFT_DATA_TYPE * ch2, FFT_TWIDDLE_TYPE * wa)
 {
 	static double tpi = 6.28318530717958647692528676655900577;
 	long idij, ipph, i, j, k, l, ik, is, t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12;
@@ -1295,7 +1308,7 @@ static void dradbg (long ido, long ip, long l1, long idl1, FFT_DATA_TYPE * cc, F
 	}
 }
 
-static void drftb1 (long n, FFT_DATA_TYPE * c, FFT_DATA_TYPE * ch, FFT_DATA_TYPE * wa, long *ifac)
+static void drftb1 (long n, FFT_DATA_TYPE * c, FFT_DATA_TYPE * ch, FFT_TWIDDLE_TYPE * wa, long *ifac)
 {
 	long i, k1, l1, l2;
 	long na;
@@ -1376,4 +1389,7 @@ static void drftb1 (long n, FFT_DATA_TYPE * c, FFT_DATA_TYPE * ch, FFT_DATA_TYPE
 		c[i] = ch[i];
 }
 
+#undef FFT_LOCAL_TYPE
+#undef FFT_TWIDDLE_TYPE
+
 /* End of file NUMfft_core.h */
@@ -60,10 +60,124 @@ void NUMreverseRealFastFourierTransform (double *data, long n) {
 	NUMfft_backward (& table, data);
 }
 
+/*
+	Bluestein's algorithm computes a DFT of any size n as a convolution with a "chirp",
+	which is done with complex power-of-two transforms of size m >= 2n - 1.
+	Layout of bluesteinCache [0..2n+5m-1] (indexes count doubles; all parts are interleaved complex numbers):
+		[0..2n-1]                chirp: w [k] = exp (-i pi k^2 / n), k = 0..n-1
+		[2n..2n+2m-1]            filter: the power-of-two transform of conj (w), wrapped around, divided by m
+		[2n+2m..2n+3m-1]         twiddle: exp (-2 pi i t / m), t = 0..m/2-1
+		[2n+3m..2n+5m-1]         scratch: the default workspace (m complex numbers)
+*/
+#define BLUESTEIN_CHIRP(me)  (my bluesteinCache)
+#define BLUESTEIN_FILTER(me)  (my bluesteinCache + 2 * my n)
+#define BLUESTEIN_TWIDDLE(me)  (my bluesteinCache + 2 * my n + 2 * my bluesteinSize)
+#define BLUESTEIN_SCRATCH(me)  (my bluesteinCache + 2 * my n + 3 * my bluesteinSize)
+
+/* In-place iterative radix-2 complex transform of size m; isign = -1 is forward, +1 is backward (unnormalized). */
+static void complexPowerOfTwoTransform (long m, double *a, const double *twiddle, int isign) {
+	for (long i = 1, j = 0; i < m; i ++) {   // bit reversal
+		long bit = m >> 1;
+		for (; j & bit; bit >>= 1) {
+			j ^= bit;
+		}
+		j ^= bit;
+		if (i < j) {
+			double tmp = a [2 * i]; a [2 * i] = a [2 * j]; a [2 * j] = tmp;
+			tmp = a [2 * i + 1]; a [2 * i + 1] = a [2 * j + 1]; a [2 * j + 1] = tmp;
+		}
+	}
+	for (long length = 2; length <= m; length <<= 1) {
+		long half = length >> 1, step = m / length;
+		for (long start = 0; start < m; start += length) {
+			for (long k = 0; k < half; k ++) {
+				double wr = twiddle [2 * k * step], wi = isign * twiddle [2 * k * step + 1];
+				double *u = & a [2 * (start + k)], *v = & a [2 * (start + k + half)];
+				double vr = v [0] * wr - v [1] * wi, vi = v [0] * wi + v [1] * wr;
+				v [0] = u [0] - vr; v [1] = u [1] - vi;
+				u [0] += vr; u [1] += vi;
+			}
+		}
+	}
+}
+
+/* z [0..2n-1] contains complex input, z [2n..2m-1] is overwritten; on output z [0..2n-1] contains its DFT. */
+static void bluesteinTransform (NUMfft_Table me, double *z) {
+	long n = my n, m = my bluesteinSize;
+	const double *w = BLUESTEIN_CHIRP (me), *filter = BLUESTEIN_FILTER (me), *twiddle = BLUESTEIN_TWIDDLE (me);
+	for (long k = 0; k < n; k ++) {
+		double re = z [2 * k], im = z [2 * k + 1];
+		z [2 * k] = re * w [2 * k] - im * w [2 * k + 1];
+		z [2 * k + 1] = re * w [2 * k + 1] + im * w [2 * k];
+	}
+	for (long k = 2 * n; k < 2 * m; k ++) {
+		z [k] = 0.0;
+	}
+	complexPowerOfTwoTransform (m, z, twiddle, -1);
+	for (long k = 0; k < m; k ++) {
+		double re = z [2 * k], im = z [2 * k + 1];
+		z [2 * k] = re * filter [2 * k] - im * filter [2 * k + 1];
+		z [2 * k + 1] = re * filter [2 * k + 1] + im * filter [2 * k];
+	}
+	complexPowerOfTwoTransform (m, z, twiddle, +1);
+	for (long k = 0; k < n; k ++) {
+		double re = z [2 * k], im = z [2 * k + 1];
+		z [2 * k] = re * w [2 * k] - im * w [2 * k + 1];
+		z [2 * k + 1] = re * w [2 * k + 1] + im * w [2 * k];
+	}
+}
+
+static void bluestein_forward (NUMfft_Table me, double *data, double *z) {
+	long n = my n;
+	for (long k = 0; k < n; k ++) {
+		z [2 * k] = data [k + 1];
+		z [2 * k + 1] = 0.0;
+	}
+	bluesteinTransform (me, z);
+	/*
+		Store in FFTPACK order: r0, r1, i1, r2, i2, ... [, r(n/2)].
+	*/
+	data [1] = z [0];
+	for (long j = 1; 2 * j < n; j ++) {
+		data [2 * j] = z [2 * j];
+		data [2 * j + 1] = z [2 * j + 1];
+	}
+	if (n % 2 == 0) {
+		data [n] = z [n];
+	}
+}
+
+static void bluestein_backward (NUMfft_Table me, double *data, double *z) {
+	long n = my n;
+	/*
+		Unpack the Hermitian spectrum as its complex conjugate;
+		the real part of the forward transform of that is the unnormalized inverse.
+	*/
+	z [0] = data [1];
+	z [1] = 0.0;
+	for (long j = 1; 2 * j < n; j ++) {
+		z [2 * j] = z [2 * (n - j)] = data [2 * j];
+		z [2 * j + 1] = - data [2 * j + 1];
+		z [2 * (n - j) + 1] = data [2 * j + 1];
+	}
+	if (n % 2 == 0) {
+		z [n] = data [n];
+		z [n + 1] = 0.0;
+	}
+	bluesteinTransform (me, z);
+	for (long k = 0; k < n; k ++) {
+		data [k + 1] = z [2 * k];
+	}
+}
+
 void NUMfft_forward (NUMfft_Table me, double *data) {
 	if (my n == 1) {
 		return;
 	}
+	if (my bluesteinSize > 0) {
+		bluestein_forward (me, data, BLUESTEIN_SCRATCH (me));
+		return;
+	}
 	drftf1 (my n, &data[1], my trigcache, my trigcache + my n, my splitcache);
 }
 
@@ -71,16 +185,131 @@ void NUMfft_backward (NUMfft_Table me, double *data) {
 	if (my n == 1) {
 		return;
 	}
+	if (my bluesteinSize > 0) {
+		bluestein_backward (me, data, BLUESTEIN_SCRATCH (me));
+		return;
+	}
 	drftb1 (my n, &data[1], my trigcache, my trigcache + my n, my splitcache);
 }
 
+void NUMfft_forward_withWorkspace (NUMfft_Table me, double *data, double *workspace) {
+	if (my n == 1) {
+		return;
+	}
+	if (my bluesteinSize > 0) {
+		bluestein_forward (me, data, &workspace[1]);
+		return;
+	}
+	drftf1 (my n, &data[1], &workspace[1], my trigcache + my n, my splitcache);
+}
+
+void NUMfft_backward_withWorkspace (NUMfft_Table me, double *data, double *workspace) {
+	if (my n == 1) {
+		return;
+	}
+	if (my bluesteinSize > 0) {
+		bluestein_backward (me, data, &workspace[1]);
+		return;
+	}
+	drftb1 (my n, &data[1], &workspace[1], my trigcache + my n, my splitcache);
+}
+
+long NUMfft_Table_getWorkspaceSize (NUMfft_Table me) {
+	return my bluesteinSize > 0 ? 2 * my bluesteinSize : my n;
+}
+
+/*
+	FFTPACK handles a prime factor p with a generic pass of order n * p operations,
+	which makes sizes with a large prime factor nearly quadratic.
+	Returns the power-of-two size for Bluestein's algorithm if that is expected to be cheaper, else 0.
+*/
+static long bluesteinSizeIfFaster (long n) {
+	double fftpackCost = 0.0;
+	long largestFactor = 1, remainder = n;
+	for (long factor = 2; factor * factor <= remainder; factor ++) {
+		while (remainder % factor == 0) {
+			fftpackCost += factor;
+			largestFactor = factor;
+			remainder /= factor;
+		}
+	}
+	if (remainder > 1) {
+		fftpackCost += remainder;
+		if (remainder > largestFactor) largestFactor = remainder;
+	}
+	if (largestFactor <= 5) {
+		return 0;
+	}
+	fftpackCost *= n;
+	long m = 1, log2m = 0;
+	while (m < 2 * n - 1) {
+		m *= 2;
+		log2m ++;
+	}
+	double bluesteinCost = 10.0 * m * log2m + 30.0 * n;
+	return bluesteinCost < fftpackCost ? m : 0;
+}
+
 void NUMfft_Table_init (NUMfft_Table me, long n) {
 	my n = n;
+	my bluesteinSize = bluesteinSizeIfFaster (n);
+	if (my bluesteinSize > 0) {
+		long m = my bluesteinSize;
+		my bluesteinCache = NUMvector <double> (0, 2 * n + 5 * m - 1);
+		double *w = BLUESTEIN_CHIRP (me), *filter = BLUESTEIN_FILTER (me), *twiddle = BLUESTEIN_TWIDDLE (me);
+		for (long t = 0; t < m / 2; t ++) {
+			double phi = - 2.0 * NUMpi * t / m;
+			twiddle [2 * t] = cos (phi);
+			twiddle [2 * t + 1] = sin (phi);
+		}
+		for (long k = 0; k < n; k ++) {
+			/* k^2 modulo 2n keeps the phase argument small and exact */
+			int64 k2 = ((int64) k * (int64) k) % (2 * (int64) n);
+			double phi = - NUMpi * (double) k2 / n;
+			w [2 * k] = cos (phi);
+			w [2 * k + 1] = sin (phi);
+		}
+		for (long j = 0; j < 2 * m; j ++) {
+			filter [j] = 0.0;
+		}
+		filter [0] = w [0];
+		filter [1] = - w [1];
+		for (long j = 1; j < n; j ++) {
+			filter [2 * j] = filter [2 * (m - j)] = w [2 * j];
+			filter [2 * j + 1] = filter [2 * (m - j) + 1] = - w [2 * j + 1];
+		}
+		complexPowerOfTwoTransform (m, filter, twiddle, -1);
+		for (long j = 0; j < 2 * m; j ++) {
+			filter [j] /= m;
+		}
+		return;
+	}
 	my trigcache = NUMvector <double> (0, 3 * n - 1);
 	my splitcache = NUMvector <long> (0, 31);
 	NUMrffti (n, my trigcache, my splitcache);
 }
 
+long NUMfft_getGoodSize (long minimumSize) {
+	long best = 2;
+	while (best < minimumSize) {
+		best *= 2;
+	}
+	for (long fiveThree = 2; fiveThree < best; fiveThree *= 5) {   // the factor 2 makes every candidate even
+		for (long size = fiveThree; size < best; size *= 3) {
+			long candidate = size;
+			while (candidate < minimumSize) {
+				candidate *= 2;
+			}
+			if (candidate < best) best = candidate;
+		}
+	}
+	return best;
+}
+
+void NUMfft_Table_initForMinimumSize (NUMfft_Table me, long minimumSize) {
+	NUMfft_Table_init (me, NUMfft_getGoodSize (minimumSize));
+}
+
 void NUMrealft (double *data, long n, int isign) {
 	isign == 1 ? NUMforwardRealFastFourierTransform (data, n) :
 	NUMreverseRealFastFourierTransform (data, n);
@@ -46,19 +46,19 @@
 #include <errno.h>
 
 /*
-  Precondition: size (my buffer) >= nbuf
+  Precondition: size (monoBuffer) >= nbuf
 */
-static void _LongSound_to_multichannel_buffer (LongSound me, short *buffer, long nbuf, int nchannels, int ichannel, long ibuf) {
+static void _LongSound_to_multichannel_buffer (LongSound me, short *monoBuffer, short *buffer, long nbuf, int nchannels, int ichannel, long ibuf) {
 	long numberOfReads = (my nx - 1) / nbuf + 1;
 	long n_to_read = 0;
 
 	if (ibuf <= numberOfReads) {
 		n_to_read = ibuf == numberOfReads ? (my nx - 1) % nbuf + 1 : nbuf;
 		long imin = (ibuf - 1) * nbuf + 1;
-		LongSound_readAudioToShort (me, my buffer, imin, n_to_read);
+		LongSound_readAudioToShort (me, monoBuffer, imin, n_to_read);
 
 		for (long i = 1; i <= n_to_read; i++) {
-			buffer[nchannels * (i - 1) + ichannel] = my buffer[i];
+			buffer[nchannels * (i - 1) + ichannel] = monoBuffer[i - 1];
 		}
 	}
 	if (ibuf >= numberOfReads) {
@@ -70,7 +70,7 @@ static void _LongSound_to_multichannel_buffer (LongSound me, short *buffer, long
 
 void LongSounds_writeToStereoAudioFile16 (LongSound me, LongSound thee, int audioFileType, MelderFile file) {
 	try {
-		long nbuf = my nmax < thy nmax ? my nmax : thy nmax;
+		long nbuf = 4 * LongSound_BLOCK_SIZE;
 		long nx = my nx > thy nx ? my nx : thy nx;
 		long numberOfReads = (nx - 1) / nbuf + 1, numberOfBitsPerSamplePoint = 16;
 
@@ -83,24 +83,22 @@ void LongSounds_writeToStereoAudioFile16 (LongSound me, LongSound thee, int audi
 		}
 
 		/*
-			Allocate a stereo buffer of size (2 * the smallest)!
-			WE SUPPOSE THAT SMALL IS LARGE ENOUGH.
-			Read the same number of samples from both files, despite
-			potential differences in internal buffer size.
+			Read the same number of samples from both files into a stereo buffer.
 		*/
 
 		long nchannels = 2;
 		autoNUMvector<short> buffer (1, nchannels * nbuf);
+		autoNUMvector<short> monoBuffer ((long) 0, nbuf);
 
 		autoMelderFile f  = MelderFile_create (file);
 		MelderFile_writeAudioFileHeader (file, audioFileType, (long) floor (my sampleRate), nx, nchannels, numberOfBitsPerSamplePoint);
 
 		for (long i = 1; i <= numberOfReads; i++) {
 			long n_to_write = i == numberOfReads ? (nx - 1) % nbuf + 1 : nbuf;
-			_LongSound_to_multichannel_buffer (me, buffer.peek(), nbuf, nchannels, 1, i);
-			_LongSound_to_multichannel_buffer (thee, buffer.peek(), nbuf, nchannels, 2, i);
+			_LongSound_to_multichannel_buffer (me, monoBuffer.peek(), buffer.peek(), nbuf, nchannels, 1, i);
+			_LongSound_to_multichannel_buffer (thee, monoBuffer.peek(), buffer.peek(), nbuf, nchannels, 2, i);
 			MelderFile_writeShortToAudio (file, nchannels, Melder_defaultAudioFileEncoding (audioFileType,
-                numberOfBitsPerSamplePoint), buffer.peek(), n_to_write);
+                numberOfBitsPerSamplePoint), & buffer [1], n_to_write);
 		}
 		MelderFile_writeAudioFileTrailer (file, audioFileType, (long) floor (my sampleRate), nx, nchannels, numberOfBitsPerSamplePoint);
 		f.close ();
@@ -159,22 +157,18 @@ static void MelderFile_truncate (MelderFile me, long size) {
 }
 
 static void writePartToOpenFile16 (LongSound me, int audioFileType, long imin, long n, MelderFile file) {
-	long offset = imin;
-	long numberOfBuffers = (n - 1) / my nmax + 1, numberOfBitsPerSamplePoint = 16;
-	long numberOfSamplesInLastBuffer = (n - 1) % my nmax + 1;
+	long offset = imin, nmax = 4 * LongSound_BLOCK_SIZE;
+	long numberOfBuffers = (n - 1) / nmax + 1, numberOfBitsPerSamplePoint = 16;
+	long numberOfSamplesInLastBuffer = (n - 1) % nmax + 1;
 	if (file -> filePointer) {
+		autoNUMvector <int16> buffer ((long) 0, (nmax + 1) * my numberOfChannels);
 		for (long ibuffer = 1; ibuffer <= numberOfBuffers; ibuffer ++) {
-			long numberOfSamplesToCopy = ibuffer < numberOfBuffers ? my nmax : numberOfSamplesInLastBuffer;
-			LongSound_readAudioToShort (me, my buffer, offset, numberOfSamplesToCopy);
+			long numberOfSamplesToCopy = ibuffer < numberOfBuffers ? nmax : numberOfSamplesInLastBuffer;
+			LongSound_readAudioToShort (me, buffer.peek(), offset, numberOfSamplesToCopy);
 			offset += numberOfSamplesToCopy;
-			MelderFile_writeShortToAudio (file, my numberOfChannels, Melder_defaultAudioFileEncoding (audioFileType, numberOfBitsPerSamplePoint), my buffer, numberOfSamplesToCopy);
+			MelderFile_writeShortToAudio (file, my numberOfChannels, Melder_defaultAudioFileEncoding (audioFileType, numberOfBitsPerSamplePoint), buffer.peek(), numberOfSamplesToCopy);
 		}
 	}
-
-	//  We "have" no samples any longer.
-	
-	my imin = 1;
-	my imax = 0;
 }
 
 void LongSounds_appendToExistingSoundFile (OrderedOf<structSampled>* me, MelderFile file) {
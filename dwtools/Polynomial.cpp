@@ -1170,69 +1170,187 @@ void Roots_draw (Roots me, Graphics g, double rmin, double rmax, double imin, do
 	}
 }
 
-autoRoots Polynomial_to_Roots (Polynomial me) {
-	try {
-		long np1 = my numberOfCoefficients, n = np1 - 1, n2 = n * n;
+long Polynomial_into_Roots (Polynomial me, Roots r, double *workspace) {
+	long np1 = my numberOfCoefficients, n = np1 - 1, n2 = n * n;
 
-		if (n < 1) {
-			Melder_throw (U"Cannot find roots of a constant function.");
-		}
+	Melder_assert (n >= 1);
+	Melder_assert (r -> min == 1);
 
-		// Allocate storage for Hessenberg matrix (n * n) plus real and imaginary
-		// parts of eigenvalues wr[1..n] and wi[1..n].
+	// Storage for Hessenberg matrix (n * n) plus real and imaginary
+	// parts of eigenvalues wr[1..n] and wi[1..n], plus the working storage of NUMlapack_dhseqr.
 
-		autoNUMvector<double> hes (1, n2 + n + n);
-		double *wr = &hes[n2];
-		double *wi = &hes[n2 + n];
+	double *hes = workspace - 1;
+	double *wr = &hes[n2];
+	double *wi = &hes[n2 + n];
+	double *work = &hes[n2 + n + n];
+	for (long i = 1; i <= n2 + n + n; i++) {
+		hes[i] = 0.0;
+	}
 
-		// Fill the upper Hessenberg matrix (storage is Fortran)
-		// C: [i][j] -> Fortran: (j-1)*n + i
+	// Fill the upper Hessenberg matrix (storage is Fortran)
+	// C: [i][j] -> Fortran: (j-1)*n + i
 
-		for (long i = 1; i <= n; i++) {
-			hes[ (i - 1) *n + 1] = - (my coefficients[np1 - i] / my coefficients[np1]);
-			if (i < n) {
-				hes[ (i - 1) *n + 1 + i] = 1;
-			}
+	for (long i = 1; i <= n; i++) {
+		hes[ (i - 1) *n + 1] = - (my coefficients[np1 - i] / my coefficients[np1]);
+		if (i < n) {
+			hes[ (i - 1) *n + 1 + i] = 1;
 		}
+	}
 
-		// Find out the working storage needed
+	// Find eigenvalues; NUMlapack_dhseqr needs max (1, n) elements of working storage.
 
-		char job = 'E', compz = 'N';
-		long ilo = 1, ihi = n, ldh = n, ldz = n, lwork = -1, info;
-		double *z = 0, wt[1];
-		NUMlapack_dhseqr (&job, &compz, &n, &ilo, &ihi, &hes[1], &ldh, &wr[1], &wi[1], z, &ldz, wt, &lwork, &info);
-		if (info != 0) {
-			if (info < 0) {
-				Melder_throw (U"Programming error. Argument ", info, U" in NUMlapack_dhseqr has illegal value.");
-			}
-		}
-		lwork = (long) floor (wt[0]);
-		autoNUMvector<double> work (1, lwork);
+	char job = 'E', compz = 'N';
+	long ilo = 1, ihi = n, ldh = n, ldz = n, lwork = n, info;
+	double *z = 0;
+	NUMlapack_dhseqr (&job, &compz, &n, &ilo, &ihi, &hes[1], &ldh, &wr[1], &wi[1], z, &ldz, &work[1], &lwork, &info);
+	long nrootsfound = n;
+	long ioffset = 0;
+	if (info > 0) {
+		// if INFO = i, NUMlapack_dhseqr failed to compute all of the eigenvalues. Elements i+1:n of
+		// WR and WI contain those eigenvalues which have been successfully computed
+		nrootsfound -= info;
+		ioffset = info;
+	}
+	Melder_assert (info >= 0);   // otherwise an argument of NUMlapack_dhseqr has an illegal value
 
-		// Find eigenvalues.
+	r -> max = nrootsfound;
+	for (long i = 1; i <= nrootsfound; i++) {
+		(r -> v[i]).re = wr[ioffset + i];
+		(r -> v[i]).im = wi[ioffset + i];
+	}
+	if (nrootsfound > 0) {
+		Roots_and_Polynomial_polish (r, me);
+	}
+	return nrootsfound;
+}
 
-		NUMlapack_dhseqr (&job, &compz, &n, &ilo, &ihi, &hes[1], &ldh, &wr[1], &wi[1], z, &ldz, &work[1], &lwork, &info);
-		long nrootsfound = n;
-		long ioffset = 0;
-		if (info > 0) {
-			// if INFO = i, NUMlapack_dhseqr failed to compute all of the eigenvalues. Elements i+1:n of
-			// WR and WI contain those eigenvalues which have been successfully computed
-			nrootsfound -= info;
-			if (nrootsfound < 1) {
-				Melder_throw (U"No roots found.");
+/*
+	Simultaneous iteration of Aberth and Ehrlich:
+		z[k] -= w[k], with w[k] = (p/p')(z[k]) / (1 - (p/p')(z[k]) * sum (j != k) 1 / (z[k] - z[j])),
+	in which every correction already uses the corrections of the roots before it.
+	The iteration converges cubically to simple roots and costs O(n^2) per sweep,
+	so that a few sweeps from a good start are much cheaper than an eigenvalue decomposition of the companion matrix.
+*/
+bool Polynomial_into_Roots_aberth (Polynomial me, Roots r, bool warmStart) {
+	long n = my numberOfCoefficients - 1, maximumNumberOfSweeps = 60;
+	if (n < 1) {
+		Melder_throw (U"Cannot find roots of a constant function.");
+	}
+	Melder_assert (r -> min == 1);
+	dcomplex *z = r -> v;
+	if (! warmStart || r -> max != n) {
+		/*
+			Start on a circle whose radius is the geometric mean of the absolute values of the roots,
+			turned away from the real axis, so that no start is real or the conjugate of another start.
+		*/
+		double radius = pow (fabs (my coefficients [1] / my coefficients [n + 1]), 1.0 / n);
+		if (! (radius > 0.0 && radius < 1e300)) {   // also if a coefficient is zero, infinite or undefined
+			radius = 1.0;
+		}
+		for (long k = 1; k <= n; k ++) {
+			double phi = 2.0 * NUMpi * (k - 1) / n + 0.4;
+			z [k] = dcomplex_create (radius * cos (phi), radius * sin (phi));
+		}
+	} else {
+		/*
+			Start from the roots that are in r already. The iteration would keep real starts real
+			and conjugate starts conjugate, so we turn them over a small angle,
+			which allows two real roots to become a pair and vice versa.
+		*/
+		double c = cos (1e-3), s = sin (1e-3);
+		for (long k = 1; k <= n; k ++) {
+			double re = z [k].re, im = z [k].im;
+			z [k] = dcomplex_create (re * c - im * s, re * s + im * c);
+		}
+	}
+	r -> max = n;
+
+	dcomplex one = dcomplex_create (1.0, 0.0);
+	long numberOfConvergedRoots = 0;
+	for (long isweep = 1; isweep <= maximumNumberOfSweeps && numberOfConvergedRoots < n; isweep ++) {
+		numberOfConvergedRoots = 0;
+		for (long k = 1; k <= n; k ++) {
+			dcomplex p, dp;
+			Polynomial_evaluateWithDerivative_z (me, & z [k], & p, & dp);
+			if (p.re == 0.0 && p.im == 0.0) {
+				numberOfConvergedRoots ++;
+				continue;
+			}
+			if (dp.re == 0.0 && dp.im == 0.0) {
+				return false;
+			}
+			dcomplex ratio = dcomplex_div (p, dp), sum = dcomplex_create (0.0, 0.0);
+			for (long j = 1; j <= n; j ++) {
+				if (j != k) {
+					double dre = z [k].re - z [j].re, dim = z [k].im - z [j].im;   // 1 / (dre + i dim) written out: this is the inner loop
+					double abs2 = dre * dre + dim * dim;
+					if (abs2 == 0.0) {
+						return false;
+					}
+					sum.re += dre / abs2;
+					sum.im -= dim / abs2;
+				}
+			}
+			dcomplex w = dcomplex_div (ratio, dcomplex_sub (one, dcomplex_mul (ratio, sum)));
+			z [k] = dcomplex_sub (z [k], w);
+			if (dcomplex_abs (w) <= 1e-14 * dcomplex_abs (z [k])) {
+				numberOfConvergedRoots ++;
 			}
-			Melder_warning (U"Calculated only ", nrootsfound, U" roots.");
-			ioffset = info;
-		} else if (info < 0) {
-			Melder_throw (U"Programming error. Argument ", info, U" in NUMlapack_dhseqr has illegal value.");
 		}
+	}
+	if (numberOfConvergedRoots < n) {
+		return false;
+	}
+
+	/*
+		Make the roots come out as those of Polynomial_into_Roots:
+		pairs (a+bi, a-bi) with b > 0 next to each other, followed by the real roots, which are exactly real.
+		First move the roots in the upper half plane to the front, and the real roots to the back.
+	*/
+	long numberOfUpperRoots = 0, numberOfRealRoots = 0;
+	for (long k = 1; k <= n - numberOfRealRoots; k ++) {
+		if (fabs (z [k].im) <= 1e-7 * dcomplex_abs (z [k])) {
+			dcomplex real = z [k];
+			z [k] = z [n - numberOfRealRoots];
+			z [n - numberOfRealRoots] = real;
+			numberOfRealRoots ++;
+			k --;   // look at the root that came in its place
+		} else if (z [k].im > 0.0) {
+			dcomplex upper = z [k];
+			z [k] = z [++ numberOfUpperRoots];
+			z [numberOfUpperRoots] = upper;
+		}
+	}
+	if (2 * numberOfUpperRoots + numberOfRealRoots != n) {
+		return false;   // unpaired complex roots
+	}
+	for (long k = numberOfUpperRoots; k >= 1; k --) {
+		dcomplex upper = z [k];
+		z [2 * k - 1] = upper;
+		z [2 * k] = dcomplex_conjugate (upper);
+	}
+	for (long k = n - numberOfRealRoots + 1; k <= n; k ++) {
+		z [k].im = 0.0;
+	}
+	Roots_and_Polynomial_polish (r, me);
+	return true;
+}
 
-		autoRoots thee = Roots_create (nrootsfound);
-		for (long i = 1; i <= nrootsfound; i++) {
-			(thy v[i]).re = wr[ioffset + i];
-			(thy v[i]).im = wi[ioffset + i];
+autoRoots Polynomial_to_Roots (Polynomial me) {
+	try {
+		long n = my numberOfCoefficients - 1;
+		if (n < 1) {
+			Melder_throw (U"Cannot find roots of a constant function.");
+		}
+		autoNUMvector<double> workspace (1, n * (n + 3));
+		autoRoots thee = Roots_create (n);
+		long numberOfRootsFound = Polynomial_into_Roots (me, thee.get(), &workspace[1]);
+		if (numberOfRootsFound < 1) {
+			Melder_throw (U"No roots found.");
+		}
+		if (numberOfRootsFound < n) {
+			Melder_warning (U"Calculated only ", numberOfRootsFound, U" roots.");
 		}
-		Roots_and_Polynomial_polish (thee.get(), me);
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": no roots can be calculated.");
@@ -205,6 +205,22 @@ autoSpectrum Roots_to_Spectrum (Roots me, double nyquistFrequency, long numberOf
 autoRoots Polynomial_to_Roots (Polynomial me);
 /* Find roots of polynomial and polish them */
 
+long Polynomial_into_Roots (Polynomial me, Roots r, double *workspace);
+/* Like Polynomial_to_Roots, but without allocating memory, so that it can run in several threads at once.
+ * r must have room for (n = my numberOfCoefficients - 1 >= 1) roots; r -> max is set to the number of roots found,
+ * which is also returned, and which is less than n if the eigenvalue computation did not converge for all roots.
+ * Instead of warning or throwing, the caller decides what to do with a shortage.
+ * workspace [0 .. n * (n + 3) - 1]
+ */
+
+bool Polynomial_into_Roots_aberth (Polynomial me, Roots r, bool warmStart);
+/* Like Polynomial_into_Roots, but with the iteration of Aberth and Ehrlich, which needs no workspace.
+ * If warmStart and r already holds n roots (e.g. those of the previous frame of an analysis), these are the starting values;
+ * otherwise the iteration starts from a circle.
+ * Returns false if the iteration does not converge or does not come up with real roots and conjugate pairs;
+ * the contents of r are then undefined, and the caller can fall back on Polynomial_into_Roots.
+ */
+
 double Polynomial_findOneSimpleRealRoot_nr (Polynomial me, double xmin, double xmax);
 double Polynomial_findOneSimpleRealRoot_ridders (Polynomial me, double xmin, double xmax);
 /* Preconditions: there must be exactly one root in the [xmin, xmax] interval;
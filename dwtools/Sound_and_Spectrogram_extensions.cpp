@@ -31,6 +31,8 @@
 #include "Sound_to_Pitch.h"
 #include "Vector.h"
 #include "NUM2.h"
+#include "MelderThread.h"
+#include <atomic>
 
 #define MIN(m,n) ((m) < (n) ? (m) : (n))
 // prototypes
@@ -63,59 +65,112 @@ static void _Spectrogram_windowCorrection (Spectrogram me, long numberOfSamples_
 	}
 }
 
-static autoSpectrum Sound_to_Spectrum_power (Sound me) {
-	try {
-		autoSpectrum thee = Sound_to_Spectrum (me, true);
-		double scale = 2.0 * thy dx / (my xmax - my xmin);
-
-		// factor '2' because we combine positive and negative frequencies
-		// thy dx : width of frequency bin
-		// my xmax - my xmin : duration of sound
-
-		double *re = thy z[1], *im = thy z[2];
-		for (long i = 1; i <= thy nx; i++) {
-			double power = scale * (re[i] * re[i] + im[i] * im [i]);
-			re[i] = power; im[i] = 0;
-		}
-
-		// Correction of frequency bins at 0 Hz and nyquist: don't count for two.
+/*
+	The frames of a filter-bank analysis are analysed in parallel.
+	Every frame is multiplied by a Gaussian window and zero-padded to a power of two;
+	its power spectrum is computed exactly as Sound_to_Spectrum (frame, true) followed by
+	a conversion to power (scaled by 2 * binWidth / windowDuration, with half weight at 0 Hz and at the Nyquist frequency)
+	would do, but with one FFT table for the whole analysis (which the threads only read)
+	and with per-thread buffers and FFT workspaces instead of new objects.
+	The filter bank is computed once per analysis: for every filter, the band of frequency bins
+	in which it has weights, and those weights.
+*/
+struct FilterBank {
+	long numberOfFilters, numberOfFrequencies;
+	double frequencyStep;   // the width of a frequency bin, in Hz; bin 1 is at 0 Hz
+	autoNUMvector <long> firstBin, lastBin;
+	autoNUMmatrix <double> weights;   // weights [ifilter] [firstBin [ifilter] .. lastBin [ifilter]]
+};
+
+static void FilterBank_init (FilterBank *me, long numberOfFilters, long numberOfFrequencies, double frequencyStep) {
+	my numberOfFilters = numberOfFilters;
+	my numberOfFrequencies = numberOfFrequencies;
+	my frequencyStep = frequencyStep;
+	my firstBin.reset (1, numberOfFilters);
+	my lastBin.reset (1, numberOfFilters);
+	my weights.reset (1, numberOfFilters, 1, numberOfFrequencies);
+}
 
-		re[1] *= 0.5; re[thy nx] *= 0.5;
-		return thee;
-	} catch (MelderError) {
-		Melder_throw (me, U": no Spectrum with spectral power created.");
+static void FilterBank_filterFrame (FilterBank *me, const double power [], Matrix thee, long frame) {
+	for (long ifilter = 1; ifilter <= my numberOfFilters; ifilter ++) {
+		const double *weights = my weights [ifilter];
+		double p = 0.0;
+		for (long ifreq = my firstBin [ifilter]; ifreq <= my lastBin [ifilter]; ifreq ++)
+			p += weights [ifreq] * power [ifreq];
+		thy z [ifilter] [frame] = p;
 	}
 }
 
-static void Sound_into_BarkSpectrogram_frame (Sound me, BarkSpectrogram thee, long frame) {
-	autoSpectrum him = Sound_to_Spectrum_power (me);
-	long numberOfFrequencies = his nx;
-	autoNUMvector<double> z (1, numberOfFrequencies);
-
-	for (long ifreq = 1; ifreq <= numberOfFrequencies; ifreq++) {
-		double fhz = his x1 + (ifreq - 1) * his dx;
-		z[ifreq] = thy v_hertzToFrequency (fhz);
-	}
+static long Sound_getFilterBankGeometry (Sound me, double windowDuration, long *numberOfFrequencies, double *frequencyStep) {
+	double samplingFrequency = 1.0 / my dx;
+	autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
+	long numberOfSamples_fft = 2;
+	while (numberOfSamples_fft < sframe -> nx) numberOfSamples_fft *= 2;
+	*numberOfFrequencies = numberOfSamples_fft / 2 + 1;
+	*frequencyStep = 1.0 / (sframe -> dx * numberOfSamples_fft);
+	return numberOfSamples_fft;
+}
 
-	for (long i = 1; i <= thy ny; i++) {
-		double p = 0;
-		double z0 = thy y1 + (i - 1) * thy dy;
-		double *pow = his z[1]; // TODO ??
-		for (long ifreq = 1; ifreq <= numberOfFrequencies; ifreq++) {
-			// Sekey & Hanson filter is defined in the power domain.
-			// We therefore multiply the power with a (and not a^2).
-			// integral (F(z),z=0..25) = 1.58/9
-
-			double a = NUMsekeyhansonfilter_amplitude (z0, z[ifreq]);
-			p += a * pow[ifreq] ;
+/*
+	Calls filterFrame (power, iframe) for every frame of thee, with power [1..numberOfFrequencies] the power spectrum of the frame.
+	Returns the number of samples in the window, for _Spectrogram_windowCorrection.
+*/
+template <class FilterFrame>
+static long Sound_analyseFilterBankFrames (Sound me, Matrix thee, double windowDuration, const char32 *title, const FilterFrame& filterFrame) {
+	double samplingFrequency = 1.0 / my dx;
+	autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
+	autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
+	long numberOfSamples = sframe -> nx;
+	long numberOfFrequencies;
+	double frequencyStep;
+	long numberOfSamples_fft = Sound_getFilterBankGeometry (me, windowDuration, & numberOfFrequencies, & frequencyStep);
+	double amplitudeScaling = sframe -> dx;
+	double powerScaling = 2.0 * frequencyStep / (sframe -> xmax - sframe -> xmin);
+	autoNUMfft_Table fftTable;
+	NUMfft_Table_init (& fftTable, numberOfSamples_fft);
+
+	long numberOfThreads = MelderThread_getNumberOfThreads ();
+	if (numberOfThreads > thy nx) numberOfThreads = thy nx;
+	autoNUMmatrix <double> frames (1, numberOfThreads, 1, numberOfSamples_fft);
+	autoNUMmatrix <double> powers (1, numberOfThreads, 1, numberOfFrequencies);
+	autoNUMmatrix <double> fftWorkspaces (1, numberOfThreads, 1, NUMfft_Table_getWorkspaceSize (& fftTable));
+
+	autoMelderProgress progress (title);
+	std::atomic <long> numberOfFramesDone (0);
+	MelderThread_parallelFor (1, thy nx, 0, [&] (long firstFrame, long lastFrame, int threadNumber) {
+		Melder_assert (threadNumber <= numberOfThreads);
+		double *frame = frames [threadNumber], *power = powers [threadNumber], *fftWorkspace = fftWorkspaces [threadNumber];
+		for (long iframe = firstFrame; iframe <= lastFrame; iframe ++) {
+			double t = Sampled_indexToX (thee, iframe);
+			long index = Sampled_xToNearestIndex (me, t - windowDuration / 2.0);   // as in Sound_into_Sound
+			for (long i = 1; i <= numberOfSamples; i ++) {
+				long j = index - 1 + i;
+				frame [i] = ( j < 1 || j > my nx ? 0.0 : my z [1] [j] ) * window -> z [1] [i];
+			}
+			for (long i = numberOfSamples + 1; i <= numberOfSamples_fft; i ++)
+				frame [i] = 0.0;
+			NUMfft_forward_withWorkspace (& fftTable, frame, fftWorkspace);
+			double re = frame [1] * amplitudeScaling;
+			power [1] = 0.5 * (powerScaling * (re * re));   // the bins at 0 Hz and at the Nyquist frequency don't count for two
+			for (long i = 2; i < numberOfFrequencies; i ++) {
+				re = frame [i + i - 2] * amplitudeScaling;
+				double im = frame [i + i - 1] * amplitudeScaling;
+				power [i] = powerScaling * (re * re + im * im);
+			}
+			re = frame [numberOfSamples_fft] * amplitudeScaling;
+			power [numberOfFrequencies] = 0.5 * (powerScaling * (re * re));
+			filterFrame (power, iframe);
 		}
-		thy z[i][frame] = p;
-	}
+		long numberOfFramesDoneSoFar = numberOfFramesDone += lastFrame - firstFrame + 1;
+		if (MelderThread_isMainThread ())
+			Melder_progress ((double) numberOfFramesDoneSoFar / thy nx, title, U": frame ", numberOfFramesDoneSoFar, U" out of ", thy nx, U".");
+	});
+	return window -> nx;
 }
 
 autoBarkSpectrogram Sound_to_BarkSpectrogram (Sound me, double analysisWidth, double dt, double f1_bark, double fmax_bark, double df_bark) {
 	try {
-		double nyquist = 0.5 / my dx, samplingFrequency = 2 * nyquist;
+		double nyquist = 0.5 / my dx;
 		double windowDuration = 2 * analysisWidth; /* gaussian window */
 		double zmax = NUMhertzToBark2 (nyquist);
 		double fmin_bark = 0;
@@ -140,26 +195,37 @@ autoBarkSpectrogram Sound_to_BarkSpectrogram (Sound me, double analysisWidth, do
 
 		long numberOfFrames; double t1;
 		Sampled_shortTermAnalysis (me, windowDuration, dt, & numberOfFrames, & t1);
-		autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
-		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
 		autoBarkSpectrogram thee = BarkSpectrogram_create (my xmin, my xmax, numberOfFrames, dt, t1, fmin_bark, fmax_bark, numberOfFilters, df_bark, f1_bark);
 
-		autoMelderProgress progess (U"BarkSpectrogram analysis");
-
-		for (long iframe = 1; iframe <= numberOfFrames; iframe++) {
-			double t = Sampled_indexToX (thee.get(), iframe);
-
-			Sound_into_Sound (me, sframe.get(), t - windowDuration / 2.0);
-			Sounds_multiply (sframe.get(), window.get());
-			Sound_into_BarkSpectrogram_frame (sframe.get(), thee.get(), iframe);
-
-			if (iframe % 10 == 1) {
-				Melder_progress ( (double) iframe / numberOfFrames,  U"BarkSpectrogram analysis: frame ",
-					iframe, U" from ", numberOfFrames, U".");
-			}
+		/*
+			The Sekey & Hanson filter has no finite support, so every filter weighs all frequency bins.
+			The filter is defined in the power domain; we therefore multiply the power with a (and not a^2).
+			integral (F(z),z=0..25) = 1.58/9
+		*/
+		FilterBank filterBank;
+		long numberOfFrequencies;
+		double frequencyStep;
+		Sound_getFilterBankGeometry (me, windowDuration, & numberOfFrequencies, & frequencyStep);
+		FilterBank_init (& filterBank, numberOfFilters, numberOfFrequencies, frequencyStep);
+		autoNUMvector <double> z (1, numberOfFrequencies);
+		for (long ifreq = 1; ifreq <= numberOfFrequencies; ifreq ++) {
+			double fhz = (ifreq - 1) * frequencyStep;
+			z [ifreq] = thy v_hertzToFrequency (fhz);
 		}
+		for (long ifilter = 1; ifilter <= numberOfFilters; ifilter ++) {
+			double z0 = thy y1 + (ifilter - 1) * thy dy;
+			filterBank.firstBin [ifilter] = 1;
+			filterBank.lastBin [ifilter] = numberOfFrequencies;
+			for (long ifreq = 1; ifreq <= numberOfFrequencies; ifreq ++)
+				filterBank.weights [ifilter] [ifreq] = NUMsekeyhansonfilter_amplitude (z0, z [ifreq]);
+		}
+
+		long numberOfSamples_window = Sound_analyseFilterBankFrames (me, thee.get(), windowDuration, U"BarkSpectrogram analysis",
+			[&] (const double power [], long iframe) {
+				FilterBank_filterFrame (& filterBank, power, thee.get(), iframe);
+			});
 		
-		_Spectrogram_windowCorrection ((Spectrogram) thee.get(), window -> nx);
+		_Spectrogram_windowCorrection ((Spectrogram) thee.get(), numberOfSamples_window);
 
 		return thee;
 	} catch (MelderError) {
@@ -167,28 +233,6 @@ autoBarkSpectrogram Sound_to_BarkSpectrogram (Sound me, double analysisWidth, do
 	}
 }
 
-static void Sound_into_MelSpectrogram_frame (Sound me, MelSpectrogram thee, long frame) {
-	autoSpectrum him = Sound_to_Spectrum_power (me);
-
-	for (long ifilter = 1; ifilter <= thy ny; ifilter ++) {
-		double power = 0;
-		double fc_mel = thy y1 + (ifilter - 1) * thy dy;
-		double fc_hz = thy v_frequencyToHertz (fc_mel);
-		double fl_hz = thy v_frequencyToHertz (fc_mel - thy dy);
-		double fh_hz =  thy v_frequencyToHertz (fc_mel + thy dy);
-		long ifrom, ito;
-		Sampled_getWindowSamples (him.get(), fl_hz, fh_hz, &ifrom, &ito);
-		for (long i = ifrom; i <= ito; i++) {
-			// Bin with a triangular filter the power (= amplitude-squared)
-
-			double f = his x1 + (i - 1) * his dx;
-			double a = NUMtriangularfilter_amplitude (fl_hz, fc_hz, fh_hz, f);
-			power += a * his z[1][i];
-		}
-		thy z[ifilter][frame] = power;
-	}
-}
-
 autoMelSpectrogram Sound_to_MelSpectrogram (Sound me, double analysisWidth, double dt, double f1_mel, double fmax_mel, double df_mel) {
 	try {
 		double t1, samplingFrequency = 1.0 / my dx, nyquist = 0.5 * samplingFrequency;
@@ -218,24 +262,40 @@ autoMelSpectrogram Sound_to_MelSpectrogram (Sound me, double analysisWidth, doub
 		fmax_mel = f1_mel + numberOfFilters * df_mel;
 
 		Sampled_shortTermAnalysis (me, windowDuration, dt, &numberOfFrames, &t1);
-		autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
-		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
 		autoMelSpectrogram thee = MelSpectrogram_create (my xmin, my xmax, numberOfFrames, dt, t1, fmin_mel, fmax_mel, numberOfFilters, df_mel, f1_mel);
 
-		autoMelderProgress progress (U"MelSpectrograms analysis");
-
-		for (long iframe = 1; iframe <= numberOfFrames; iframe++) {
-			double t = Sampled_indexToX (thee.get(), iframe);
-			Sound_into_Sound (me, sframe.get(), t - windowDuration / 2.0);
-			Sounds_multiply (sframe.get(), window.get());
-			Sound_into_MelSpectrogram_frame (sframe.get(), thee.get(), iframe);
-			
-			if (iframe % 10 == 1) {
-				Melder_progress ((double) iframe / numberOfFrames, U"Frame ", iframe, U" out of ", numberOfFrames, U".");
+		/*
+			Bin the power (= amplitude-squared) with triangular filters,
+			each of which is nonzero only between the centre frequencies of its neighbours.
+		*/
+		FilterBank filterBank;
+		long numberOfFrequencies;
+		double frequencyStep;
+		Sound_getFilterBankGeometry (me, windowDuration, & numberOfFrequencies, & frequencyStep);
+		FilterBank_init (& filterBank, numberOfFilters, numberOfFrequencies, frequencyStep);
+		autoSpectrum bins = Spectrum_create (0.5 * samplingFrequency, numberOfFrequencies);
+		bins -> dx = frequencyStep;   // as in Sound_to_Spectrum
+		for (long ifilter = 1; ifilter <= numberOfFilters; ifilter ++) {
+			double fc_mel = thy y1 + (ifilter - 1) * thy dy;
+			double fc_hz = thy v_frequencyToHertz (fc_mel);
+			double fl_hz = thy v_frequencyToHertz (fc_mel - thy dy);
+			double fh_hz =  thy v_frequencyToHertz (fc_mel + thy dy);
+			long ifrom, ito;
+			Sampled_getWindowSamples (bins.get(), fl_hz, fh_hz, & ifrom, & ito);
+			filterBank.firstBin [ifilter] = ifrom;
+			filterBank.lastBin [ifilter] = ito;
+			for (long i = ifrom; i <= ito; i ++) {
+				double f = bins -> x1 + (i - 1) * bins -> dx;
+				filterBank.weights [ifilter] [i] = NUMtriangularfilter_amplitude (fl_hz, fc_hz, fh_hz, f);
 			}
 		}
+
+		long numberOfSamples_window = Sound_analyseFilterBankFrames (me, thee.get(), windowDuration, U"MelSpectrogram analysis",
+			[&] (const double power [], long iframe) {
+				FilterBank_filterFrame (& filterBank, power, thee.get(), iframe);
+			});
 		
-		_Spectrogram_windowCorrection ((Spectrogram) thee.get(), window -> nx);
+		_Spectrogram_windowCorrection ((Spectrogram) thee.get(), numberOfSamples_window);
 
 		return thee;
 	} catch (MelderError) {
@@ -243,33 +303,6 @@ autoMelSpectrogram Sound_to_MelSpectrogram (Sound me, double analysisWidth, doub
 	}
 }
 
-/*
-	Analog formant filter response :
-	H(f) = i f B / (f1^2 - f^2 + i f B)
-*/
-static int Sound_into_Spectrogram_frame (Sound me, Spectrogram thee, long frame, double bw) {
-	Melder_assert (bw > 0);
-	autoSpectrum him = Sound_to_Spectrum_power (me);
-
-	for (long ifilter = 1; ifilter <= thy ny; ifilter ++) {
-		double p = 0;
-		double fc = thy y1 + (ifilter - 1) * thy dy;
-		double *pow = his z [1];
-		for (long ifreq = 1; ifreq <= his nx; ifreq ++) {
-			// H(f) = ifB / (fc^2 - f^2 + ifB)
-			// H(f)| = fB / sqrt ((fc^2 - f^2)^2 + f^2B^2)
-			//|H(f)|^2 = f^2B^2 / ((fc^2 - f^2)^2 + f^2B^2)
-			//         = 1 / (((fc^2 - f^2) /fB)^2 + 1)
-
-			double f = his x1 + (ifreq - 1) * his dx;
-			double a = NUMformantfilter_amplitude (fc, bw, f);
-			p += a * pow[ifreq];
-		}
-		thy z[ifilter][frame] = p;
-	}
-	return 1;
-}
-
 autoSpectrogram Sound_to_Spectrogram_pitchDependent (Sound me, double analysisWidth, double dt, double f1_hz, double fmax_hz, double df_hz, double relative_bw, double minimumPitch, double maximumPitch) {
 	try {
 		double floor = 80.0, ceiling = 600.0;
@@ -295,8 +328,8 @@ autoSpectrogram Sound_to_Spectrogram_pitchDependent (Sound me, double analysisWi
 autoSpectrogram Sound_and_Pitch_to_Spectrogram (Sound me, Pitch thee, double analysisWidth, double dt, double f1_hz, double fmax_hz, double df_hz, double relative_bw) {
 	try {
 		double t1, windowDuration = 2.0 * analysisWidth; /* gaussian window */
-		double nyquist = 0.5 / my dx, samplingFrequency = 2.0 * nyquist, fmin_hz = 0.0;
-		long numberOfFrames, f0_undefined = 0.0;
+		double nyquist = 0.5 / my dx, fmin_hz = 0.0;
+		long numberOfFrames;
 
 		if (my xmin > thy xmin || my xmax > thy xmax) Melder_throw
 			(U"The domain of the Sound is not included in the domain of the Pitch.");
@@ -327,32 +360,38 @@ autoSpectrogram Sound_and_Pitch_to_Spectrogram (Sound me, Pitch thee, double ana
 		Sampled_shortTermAnalysis (me, windowDuration, dt, &numberOfFrames, &t1);
 		autoSpectrogram him = Spectrogram_create (my xmin, my xmax, numberOfFrames, dt, t1, fmin_hz, fmax_hz, numberOfFilters, df_hz, f1_hz);
 
-		// Temporary objects
-
-		autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
-		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
-		autoMelderProgress progress (U"Sound & Pitch: To FormantFilter");
-		for (long iframe = 1; iframe <= numberOfFrames; iframe++) {
-			double t = Sampled_indexToX (him.get(), iframe);
-			double b, f0 = Pitch_getValueAtTime (thee, t, kPitch_unit_HERTZ, 0);
-
-			if (f0 == NUMundefined || f0 == 0.0) {
-				f0_undefined ++;
-				f0 = f0_median;
-			}
-			b = relative_bw * f0;
-			Sound_into_Sound (me, sframe.get(), t - windowDuration / 2.0);
-			Sounds_multiply (sframe.get(), window.get());
-
-			Sound_into_Spectrogram_frame (sframe.get(), him.get(), iframe, b);
-
-			if (iframe % 10 == 1) {
-				Melder_progress ( (double) iframe / numberOfFrames, U"Frame ", iframe, U" out of ",
-					numberOfFrames, U".");
-			}
-		}
+		/*
+			The bandwidths of the filters follow the pitch, so the filter weights are computed anew for every frame.
+			Analog formant filter response:
+				H(f) = i f B / (f1^2 - f^2 + i f B)
+				|H(f)|^2 = f^2B^2 / ((fc^2 - f^2)^2 + f^2B^2)
+				         = 1 / (((fc^2 - f^2) /fB)^2 + 1)
+		*/
+		long numberOfFrequencies;
+		double frequencyStep;
+		Sound_getFilterBankGeometry (me, windowDuration, & numberOfFrequencies, & frequencyStep);
+		long numberOfSamples_window = Sound_analyseFilterBankFrames (me, him.get(), windowDuration, U"Sound & Pitch: To FormantFilter",
+			[&] (const double power [], long iframe) {
+				double t = Sampled_indexToX (him.get(), iframe);
+				double f0 = Pitch_getValueAtTime (thee, t, kPitch_unit_HERTZ, 0);
+				if (f0 == NUMundefined || f0 == 0.0) {
+					f0 = f0_median;
+				}
+				double b = relative_bw * f0;
+				Melder_assert (b > 0);
+				for (long ifilter = 1; ifilter <= numberOfFilters; ifilter ++) {
+					double p = 0;
+					double fc = his y1 + (ifilter - 1) * his dy;
+					for (long ifreq = 1; ifreq <= numberOfFrequencies; ifreq ++) {
+						double f = (ifreq - 1) * frequencyStep;
+						double a = NUMformantfilter_amplitude (fc, b, f);
+						p += a * power [ifreq];
+					}
+					his z [ifilter] [iframe] = p;
+				}
+			});
 		
-		_Spectrogram_windowCorrection (him.get(), window -> nx);
+		_Spectrogram_windowCorrection (him.get(), numberOfSamples_window);
 
 		return him;
 	} catch (MelderError) {
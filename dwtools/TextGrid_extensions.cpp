@@ -542,7 +542,7 @@ void IntervalTier_removeBoundariesBetweenIdenticallyLabeledIntervals (IntervalTi
 			if (Melder_equ (thisInterval -> text, label)) {
 				TextInterval previousInterval = my intervals.at [iinterval - 1];
 				if (Melder_equ (previousInterval -> text, label)) {
-					Melder_free (previousInterval -> text);
+					TextInterval_removeText (previousInterval);
 					IntervalTier_removeLeftBoundary (me, iinterval);
 				}
 			}
@@ -607,9 +607,7 @@ void IntervalTier_changeLabels (IntervalTier me, long from, long to, const char3
 
 		for (long i = from; i <= to; i ++) {
 			TextInterval interval = my intervals.at [i];
-			Melder_free (interval -> text);
-			interval -> text = newlabels [i - from + 1];   // Transfer of ownership.
-			newlabels [i - from + 1] = nullptr;
+			TextInterval_setText (interval, newlabels [i - from + 1]);
 		}
 	} catch (MelderError) {
 		Melder_throw (me, U": labels not changed.");
@@ -641,9 +639,7 @@ void TextTier_changeLabels (TextTier me, long from, long to, const char32 *searc
 
 		for (long i = from; i <= to; i ++) {
 			TextPoint point = my points.at [i];
-			Melder_free (point -> mark);   // this discards the original mark, and dangles its reference copy in `marks`, which will not be used
-			point -> mark = newMarks [i - from + 1];   // move the new mark; this consists of a copy from A to B...
-			newMarks [i - from + 1] = nullptr;   // ...followed by zeroing A
+			TextPoint_setText (point, newMarks [i - from + 1]);   // this discards the original mark, and dangles its reference copy in `marks`, which will not be used
 		}
 	} catch (MelderError) {
 		Melder_throw (me, U": no labels changed.");
@@ -46,11 +46,18 @@
 #include "flac_FLAC_stream_decoder.h"
 #include "mp3.h"
 
+#if defined (_WIN32)
+	#include <windows.h>
+	#include <io.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
 Thing_implement (LongSound, Sampled, 0);
 Thing_implement (SoundAndLongSoundList, Ordered, 0);
 
 #define MARGIN  0.01
-#define USE_MEMMOVE  1
 
 static long prefs_bufferLength;
 
@@ -61,10 +68,21 @@ void LongSound_preferences () {
 long LongSound_getBufferSizePref_seconds () { return prefs_bufferLength; }
 void LongSound_setBufferSizePref_seconds (long size) { prefs_bufferLength = size < 10 ? 10 : size > 10000 ? 10000: size; }
 
+static void _LongSound_unmap (LongSound me) {
+	if (! my mappedFile) return;
+	#if defined (_WIN32)
+		UnmapViewOfFile (my mappedFile);
+	#else
+		munmap ((void *) my mappedFile, my mappedFileSize);
+	#endif
+	my mappedFile = nullptr;
+	my mappedFileSize = 0;
+}
+
 void structLongSound :: v_destroy () noexcept {
 	/*
-	 * The play callback may contain a pointer to my buffer.
-	 * That pointer is about to dangle, so kill the playback.
+	 * The sound that is playing may have come from me,
+	 * and its callback may refer to an editor of me, so kill the playback.
 	 */
 	MelderAudio_stopPlaying (MelderAudio_IMPLICIT);
 	if (mp3f)
@@ -74,28 +92,35 @@ void structLongSound :: v_destroy () noexcept {
 		FLAC__stream_decoder_delete (flacDecoder);
 	}
 	else if (f) fclose (f);
-	NUMvector_free <int16> (buffer, 0);
+	_LongSound_unmap (this);
+	for (long islot = 0; islot < numberOfCachedBlocks; islot ++)
+		NUMvector_free <float> (cachedBlocks [islot], 0);
+	NUMvector_free <float *> (cachedBlocks, 0);
+	NUMvector_free <long> (cachedBlockNumbers, 0);
+	NUMvector_free <unsigned long> (cachedBlockLastUses, 0);
 	LongSound_Parent :: v_destroy ();
 }
 
 void structLongSound :: v_info () {
-	static const char32 *encodingStrings [1+20] = { U"none",
+	static const char32 *encodingStrings [1+22] = { U"none",
 		U"linear 8 bit signed", U"linear 8 bit unsigned",
 		U"linear 16 bit big-endian", U"linear 16 bit little-endian",
 		U"linear 24 bit big-endian", U"linear 24 bit little-endian",
 		U"linear 32 bit big-endian", U"linear 32 bit little-endian",
 		U"mu-law", U"A-law", U"shorten", U"polyphone",
 		U"IEEE float 32 bit big-endian", U"IEEE float 32 bit little-endian",
-		U"FLAC", U"FLAC", U"FLAC", U"MP3", U"MP3", U"MP3" };
+		U"FLAC", U"FLAC", U"FLAC", U"MP3", U"MP3", U"MP3",
+		U"IEEE float 64 bit big-endian", U"IEEE float 64 bit little-endian" };
 	structDaata :: v_info ();
 	MelderInfo_writeLine (U"Duration: ", xmax - xmin, U" seconds");
 	MelderInfo_writeLine (U"File name: ", Melder_fileToPath (& file));
 	MelderInfo_writeLine (U"File type: ", audioFileType > Melder_NUMBER_OF_AUDIO_FILE_TYPES ? U"unknown" : Melder_audioFileTypeString (audioFileType));
 	MelderInfo_writeLine (U"Number of channels: ", numberOfChannels);
-	MelderInfo_writeLine (U"Encoding: ", encoding > 20 ? U"unknown" : encodingStrings [encoding]);
+	MelderInfo_writeLine (U"Encoding: ", encoding > 22 ? U"unknown" : encodingStrings [encoding]);
 	MelderInfo_writeLine (U"Sampling frequency: ", sampleRate, U" Hz");
 	MelderInfo_writeLine (U"Size: ", nx, U" samples");
 	MelderInfo_writeLine (U"Start of sample data: ", startOfData, U" bytes from the start of the file");
+	MelderInfo_writeLine (U"Memory-mapped: ", mappedFile ? U"yes" : U"no");
 }
 
 static void _LongSound_FLAC_convertFloats (LongSound me, const int32 * const samples[], long bitsPerSample, long numberOfSamples) {
@@ -107,7 +132,7 @@ static void _LongSound_FLAC_convertFloats (LongSound me, const int32 * const sam
 		case 32: multiplier = (1.0 / 32768.0 / 65536.0); break;
 		default: multiplier = 0.0;
 	}
-	for (long i = 0; i < 2; ++i) {
+	for (long i = 0; i < my numberOfChannels; ++i) {
 		const int32 *input = samples [i];
 		double *output = my compressedFloats [i];
 		if (! output ) continue;
@@ -158,7 +183,7 @@ static void _LongSound_FLAC_error (const FLAC__StreamDecoder * /* decoder */, FL
 }
 
 static void _LongSound_MP3_convertFloats (LongSound me, const MP3F_SAMPLE *channels [MP3F_MAX_CHANNELS], long numberOfSamples) {
-	for (long i = 0; i < 2; ++i) {
+	for (long i = 0; i < my numberOfChannels && i < MP3F_MAX_CHANNELS; ++i) {
 		const MP3F_SAMPLE *input = channels [i];
 		double *output = my compressedFloats [i];
 		if (! output ) continue;
@@ -193,6 +218,150 @@ static void _LongSound_MP3_convert (const MP3F_SAMPLE *channels [MP3F_MAX_CHANNE
 	my compressedSamplesLeft -= numberOfSamples;
 }
 
+static bool _LongSound_isMappable (int encoding) {
+	return encoding == Melder_LINEAR_8_SIGNED || encoding == Melder_LINEAR_8_UNSIGNED ||
+		encoding == Melder_LINEAR_16_BIG_ENDIAN || encoding == Melder_LINEAR_16_LITTLE_ENDIAN ||
+		encoding == Melder_LINEAR_24_BIG_ENDIAN || encoding == Melder_LINEAR_24_LITTLE_ENDIAN ||
+		encoding == Melder_LINEAR_32_BIG_ENDIAN || encoding == Melder_LINEAR_32_LITTLE_ENDIAN ||
+		encoding == Melder_IEEE_FLOAT_32_BIG_ENDIAN || encoding == Melder_IEEE_FLOAT_32_LITTLE_ENDIAN ||
+		encoding == Melder_IEEE_FLOAT_64_BIG_ENDIAN || encoding == Melder_IEEE_FLOAT_64_LITTLE_ENDIAN;
+}
+
+static void _LongSound_map (LongSound me) {
+	/*
+	 * Map the whole file read-only and privately. This is an optimization only:
+	 * if anything fails (e.g. a 10-gigabyte file in a 32-bit edition, or a truncated file),
+	 * we just read with fread, as for compressed files.
+	 */
+	my mappedFile = nullptr;
+	my mappedFileSize = 0;
+	if (! _LongSound_isMappable (my encoding)) return;
+	double numberOfBytesNeeded = my startOfData + (double) my nx * my numberOfChannels * my numberOfBytesPerSamplePoint;
+	#if defined (_WIN32)
+		HANDLE fileHandle = (HANDLE) _get_osfhandle (_fileno (my f));
+		LARGE_INTEGER fileSize;
+		if (fileHandle == INVALID_HANDLE_VALUE || ! GetFileSizeEx (fileHandle, & fileSize)) return;
+		if ((double) fileSize. QuadPart < numberOfBytesNeeded || (double) fileSize. QuadPart > (double) SIZE_MAX) return;
+		HANDLE mapping = CreateFileMapping (fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (! mapping) return;
+		void *view = MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle (mapping);   // the view keeps the mapping alive
+		if (! view) return;
+		my mappedFile = (const unsigned char *) view;
+		my mappedFileSize = (size_t) fileSize. QuadPart;
+	#else
+		struct stat fileStatus;
+		if (fstat (fileno (my f), & fileStatus) != 0) return;
+		if ((double) fileStatus. st_size < numberOfBytesNeeded || (double) fileStatus. st_size > (double) SIZE_MAX) return;
+		void *mapping = mmap (nullptr, (size_t) fileStatus. st_size, PROT_READ, MAP_PRIVATE, fileno (my f), 0);
+		if (mapping == MAP_FAILED) return;
+		my mappedFile = (const unsigned char *) mapping;
+		my mappedFileSize = (size_t) fileStatus. st_size;
+	#endif
+}
+
+/*
+ * Touching a mapped page beyond the end of the file raises SIGBUS, so if the file has shrunk since it was mapped
+ * (e.g. because it is being overwritten, by Praat or by another program), we drop the mapping and read with fread again,
+ * which yields zeroes for the missing samples. Windows does not let a file with a mapped view shrink.
+ */
+static bool _LongSound_isStillMapped (LongSound me) {
+	if (! my mappedFile) return false;
+	#if ! defined (_WIN32)
+		struct stat fileStatus;
+		if (fstat (fileno (my f), & fileStatus) != 0 || (double) fileStatus. st_size < (double) my mappedFileSize)
+			_LongSound_unmap (me);
+	#endif
+	return !! my mappedFile;
+}
+
+/*
+ * Decode one channel of the mapped sample frames [firstSample, firstSample + numberOfSamples - 1]
+ * into output [0], output [outputStride], output [2 * outputStride], ...
+ */
+template <typename T>
+static void _LongSound_MAP_decodeChannel (LongSound me, int channel, long firstSample, long numberOfSamples, T *output, long outputStride) {
+	const long frameSize = my numberOfChannels * my numberOfBytesPerSamplePoint;
+	const unsigned char *bytes = my mappedFile + my startOfData + (firstSample - 1) * (size_t) frameSize + (channel - 1) * my numberOfBytesPerSamplePoint;
+	switch (my encoding) {
+		case Melder_LINEAR_8_SIGNED: {
+			for (long isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize)
+				output [isamp * outputStride] = (T) ((int8) bytes [0] * (1.0 / 128));
+		} break;
+		case Melder_LINEAR_8_UNSIGNED: {
+			for (long isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize)
+				output [isamp * outputStride] = (T) (bytes [0] * (1.0 / 128) - 1.0);
+		} break;
+		case Melder_LINEAR_16_BIG_ENDIAN: {
+			for (long isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize)
+				output [isamp * outputStride] = (T) ((int16) (uint16) ((uint16) (bytes [0] << 8) | bytes [1]) * (1.0 / 32768));
+		} break;
+		case Melder_LINEAR_16_LITTLE_ENDIAN: {
+			for (long isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize)
+				output [isamp * outputStride] = (T) ((int16) (uint16) ((uint16) (bytes [1] << 8) | bytes [0]) * (1.0 / 32768));
+		} break;
+		case Melder_LINEAR_24_BIG_ENDIAN: {
+			for (long isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize) {
+				int32 value = (int32) ((uint32) bytes [0] << 24 | (uint32) bytes [1] << 16 | (uint32) bytes [2] << 8);
+				output [isamp * outputStride] = (T) (value * (1.0 / 32768 / 65536));
+			}
+		} break;
+		case Melder_LINEAR_24_LITTLE_ENDIAN: {
+			for (long isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize) {
+				int32 value = (int32) ((uint32) bytes [2] << 24 | (uint32) bytes [1] << 16 | (uint32) bytes [0] << 8);
+				output [isamp * outputStride] = (T) (value * (1.0 / 32768 / 65536));
+			}
+		} break;
+		case Melder_LINEAR_32_BIG_ENDIAN: {
+			for (long isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize) {
+				int32 value = (int32) ((uint32) bytes [0] << 24 | (uint32) bytes [1] << 16 | (uint32) bytes [2] << 8 | (uint32) bytes [3]);
+				output [isamp * outputStride] = (T) (value * (1.0 / 32768 / 65536));
+			}
+		} break;
+		case Melder_LINEAR_32_LITTLE_ENDIAN: {
+			for (long isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize) {
+				int32 value = (int32) ((uint32) bytes [3] << 24 | (uint32) bytes [2] << 16 | (uint32) bytes [1] << 8 | (uint32) bytes [0]);
+				output [isamp * outputStride] = (T) (value * (1.0 / 32768 / 65536));
+			}
+		} break;
+		case Melder_IEEE_FLOAT_32_BIG_ENDIAN: {
+			for (long isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize) {
+				uint32 bits = (uint32) bytes [0] << 24 | (uint32) bytes [1] << 16 | (uint32) bytes [2] << 8 | (uint32) bytes [3];
+				float value;
+				memcpy (& value, & bits, 4);
+				output [isamp * outputStride] = (T) value;
+			}
+		} break;
+		case Melder_IEEE_FLOAT_32_LITTLE_ENDIAN: {
+			for (long isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize) {
+				uint32 bits = (uint32) bytes [3] << 24 | (uint32) bytes [2] << 16 | (uint32) bytes [1] << 8 | (uint32) bytes [0];
+				float value;
+				memcpy (& value, & bits, 4);
+				output [isamp * outputStride] = (T) value;
+			}
+		} break;
+		case Melder_IEEE_FLOAT_64_BIG_ENDIAN: {
+			for (long isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize) {
+				uint64_t bits = (uint64_t) bytes [0] << 56 | (uint64_t) bytes [1] << 48 | (uint64_t) bytes [2] << 40 | (uint64_t) bytes [3] << 32 |
+					(uint64_t) bytes [4] << 24 | (uint64_t) bytes [5] << 16 | (uint64_t) bytes [6] << 8 | (uint64_t) bytes [7];
+				double value;
+				memcpy (& value, & bits, 8);
+				output [isamp * outputStride] = (T) value;
+			}
+		} break;
+		case Melder_IEEE_FLOAT_64_LITTLE_ENDIAN: {
+			for (long isamp = 0; isamp < numberOfSamples; isamp ++, bytes += frameSize) {
+				uint64_t bits = (uint64_t) bytes [7] << 56 | (uint64_t) bytes [6] << 48 | (uint64_t) bytes [5] << 40 | (uint64_t) bytes [4] << 32 |
+					(uint64_t) bytes [3] << 24 | (uint64_t) bytes [2] << 16 | (uint64_t) bytes [1] << 8 | (uint64_t) bytes [0];
+				double value;
+				memcpy (& value, & bits, 8);
+				output [isamp * outputStride] = (T) value;
+			}
+		} break;
+		default: Melder_fatal (U"LongSound: encoding ", my encoding, U" cannot be mapped.");
+	}
+}
+
 static void LongSound_init (LongSound me, MelderFile file) {
 	MelderFile_copy (file, & my file);
 	MelderFile_open (file);   // BUG: should be auto, but that requires an implemented .transfer()
@@ -209,21 +378,25 @@ static void LongSound_init (LongSound me, MelderFile file) {
 	my xmax = my nx * my dx;
 	my x1 = 0.5 * my dx;
 	my numberOfBytesPerSamplePoint = Melder_bytesPerSamplePoint (my encoding);
-	my bufferLength = prefs_bufferLength;
-	for (;;) {
-		my nmax = my bufferLength * my numberOfChannels * my sampleRate * (1 + 3 * MARGIN);
-		try {
-			my buffer = NUMvector <int16> (0, my nmax * my numberOfChannels);
-			break;
-		} catch (MelderError) {
-			my bufferLength *= 0.5;   // try 30, 15, or 7.5 seconds
-			if (my bufferLength < 5.0)   // too short to be good
-				throw;
-			Melder_clearError ();   // delete out-of-memory message
-		}
+	if ((my encoding == Melder_FLAC_COMPRESSION_16 || my encoding == Melder_MPEG_COMPRESSION_16) &&
+		my numberOfChannels > (long) (sizeof my compressedFloats / sizeof my compressedFloats [0]))
+	{
+		Melder_throw (U"LongSound supports at most ", (long) (sizeof my compressedFloats / sizeof my compressedFloats [0]),
+			U" channels in FLAC and MP3 files.");
 	}
-	my imin = 1;
-	my imax = 0;
+	my bufferLength = prefs_bufferLength;
+	/*
+	 * Enough slots for the maximum viewable part plus its margins, which may straddle two more blocks.
+	 * The blocks themselves are allocated only when needed.
+	 */
+	my numberOfBlocks = (my nx - 1) / LongSound_BLOCK_SIZE + 1;
+	my numberOfCachedBlocks = (long) ceil (my bufferLength * my sampleRate * (1.0 + 3.0 * MARGIN) / LongSound_BLOCK_SIZE) + 2;
+	if (my numberOfCachedBlocks > my numberOfBlocks) my numberOfCachedBlocks = my numberOfBlocks;
+	my cachedBlocks = NUMvector <float *> (0, my numberOfCachedBlocks - 1);
+	my cachedBlockNumbers = NUMvector <long> (0, my numberOfCachedBlocks - 1);
+	my cachedBlockLastUses = NUMvector <unsigned long> (0, my numberOfCachedBlocks - 1);
+	my cacheClock = 0;
+	_LongSound_map (me);
 	my flacDecoder = nullptr;
 	if (my audioFileType == Melder_FLAC) {
 		my flacDecoder = FLAC__stream_decoder_new ();
@@ -244,7 +417,11 @@ static void LongSound_init (LongSound me, MelderFile file) {
 void structLongSound :: v_copy (Daata thee_Daata) {
 	LongSound thee = static_cast <LongSound> (thee_Daata);
 	thy f = nullptr;
-	thy buffer = nullptr;
+	thy mappedFile = nullptr;
+	thy numberOfCachedBlocks = 0;
+	thy cachedBlocks = nullptr;
+	thy cachedBlockNumbers = nullptr;
+	thy cachedBlockLastUses = nullptr;
 	LongSound_init (thee, & file);
 }
 
@@ -259,8 +436,8 @@ autoLongSound LongSound_open (MelderFile file) {
 }
 
 static void _LongSound_FLAC_process (LongSound me, long firstSample, long numberOfSamples) {
-	my compressedSamplesLeft = numberOfSamples - 1;
-	if (! FLAC__stream_decoder_seek_absolute (my flacDecoder, firstSample))
+	my compressedSamplesLeft = numberOfSamples;
+	if (! FLAC__stream_decoder_seek_absolute (my flacDecoder, firstSample - 1))   // FLAC counts samples from 0
 		Melder_throw (U"Cannot seek in FLAC file ", & my file, U".");
 	while (my compressedSamplesLeft > 0) {
 		if (FLAC__stream_decoder_get_state (my flacDecoder) == FLAC__STREAM_DECODER_END_OF_STREAM)
@@ -277,12 +454,12 @@ static void _LongSound_FILE_seekSample (LongSound me, long firstSample) {
 
 static void _LongSound_FLAC_readAudioToShort (LongSound me, int16 *buffer, long firstSample, long numberOfSamples) {
 	my compressedMode = COMPRESSED_MODE_READ_SHORT;
-	my compressedShorts = buffer + 1;
+	my compressedShorts = buffer;
 	_LongSound_FLAC_process (me, firstSample, numberOfSamples);
 }
 
 static void _LongSound_MP3_process (LongSound me, long firstSample, long numberOfSamples) {
-	if (! mp3f_seek (my mp3f, firstSample))
+	if (! mp3f_seek (my mp3f, firstSample - 1))   // mp3f counts samples from 0
 		Melder_throw (U"Cannot seek in MP3 file ", & my file, U".");
 	my compressedSamplesLeft = numberOfSamples;
 	if (! mp3f_read (my mp3f, numberOfSamples))
@@ -291,8 +468,8 @@ static void _LongSound_MP3_process (LongSound me, long firstSample, long numberO
 
 static void _LongSound_MP3_readAudioToShort (LongSound me, int16 *buffer, long firstSample, long numberOfSamples) {
 	my compressedMode = COMPRESSED_MODE_READ_SHORT;
-	my compressedShorts = buffer + 1;
-	_LongSound_MP3_process (me, firstSample, numberOfSamples - 1);
+	my compressedShorts = buffer;
+	_LongSound_MP3_process (me, firstSample, numberOfSamples);
 }
 
 void LongSound_readAudioToFloat (LongSound me, double **buffer, long firstSample, long numberOfSamples) {
@@ -308,6 +485,9 @@ void LongSound_readAudioToFloat (LongSound me, double **buffer, long firstSample
 			my compressedFloats [ichan - 1] = & buffer [ichan] [1];
 		}
 		_LongSound_MP3_process (me, firstSample, numberOfSamples);
+	} else if (_LongSound_isStillMapped (me)) {
+		for (int ichan = 1; ichan <= my numberOfChannels; ichan ++)
+			_LongSound_MAP_decodeChannel (me, ichan, firstSample, numberOfSamples, & buffer [ichan] [1], 1);
 	} else {
 		_LongSound_FILE_seekSample (me, firstSample);
 		Melder_readAudioToFloat (my f, my numberOfChannels, my encoding, buffer, numberOfSamples);
@@ -342,26 +522,28 @@ autoSound LongSound_extractPart (LongSound me, double tmin, double tmax, int pre
 	}
 }
 
-static void _LongSound_readSamples (LongSound me, int16 *buffer, long imin, long imax) {
-	LongSound_readAudioToShort (me, buffer, imin, imax - imin + 1);
-}
-
 static void writePartToOpenFile (LongSound me, int audioFileType, long imin, long n, MelderFile file, int numberOfChannels_override, int numberOfBitsPerSamplePoint) {
-	long ibuffer, offset, numberOfBuffers, numberOfSamplesInLastBuffer;
-	offset = imin;
-	numberOfBuffers = (n - 1) / my nmax + 1;
-	numberOfSamplesInLastBuffer = (n - 1) % my nmax + 1;
-	if (file -> filePointer) for (ibuffer = 1; ibuffer <= numberOfBuffers; ibuffer ++) {
-		long numberOfSamplesToCopy = ibuffer < numberOfBuffers ? my nmax : numberOfSamplesInLastBuffer;
-		LongSound_readAudioToShort (me, my buffer, offset, numberOfSamplesToCopy);
-		offset += numberOfSamplesToCopy;
-		MelderFile_writeShortToAudio (file, numberOfChannels_override ? numberOfChannels_override : my numberOfChannels, Melder_defaultAudioFileEncoding (audioFileType, numberOfBitsPerSamplePoint), my buffer, numberOfSamplesToCopy);
-	}
 	/*
-	 * We "have" no samples any longer.
+	 * Copy in pieces of a fixed size, in full precision, so that e.g. 24-bit files can be saved as 24-bit files without loss.
+	 * A negative numberOfChannels_override selects a single channel (-1 = left, -2 = right).
 	 */
-	my imin = 1;
-	my imax = 0;
+	const long maximumNumberOfSamplesPerPiece = 4 * LongSound_BLOCK_SIZE;
+	autoNUMmatrix <double> piece (1, my numberOfChannels, 1, maximumNumberOfSamplesPerPiece);
+	int encoding = Melder_defaultAudioFileEncoding (audioFileType, numberOfBitsPerSamplePoint);
+	long offset = imin, numberOfSamplesLeft = n;
+	if (file -> filePointer) while (numberOfSamplesLeft > 0) {
+		long numberOfSamplesToCopy = numberOfSamplesLeft < maximumNumberOfSamplesPerPiece ? numberOfSamplesLeft : maximumNumberOfSamplesPerPiece;
+		{
+			autoMelderWarningOff nowarn;   // as in _LongSound_getBlock, missing samples at the end of a short file are saved as zeroes
+			LongSound_readAudioToFloat (me, piece.peek(), offset, numberOfSamplesToCopy);
+		}
+		if (numberOfChannels_override < 0)
+			MelderFile_writeFloatToAudio (file, 1, encoding, piece.peek() + (- numberOfChannels_override - 1), numberOfSamplesToCopy, false);
+		else
+			MelderFile_writeFloatToAudio (file, my numberOfChannels, encoding, piece.peek(), numberOfSamplesToCopy, false);
+		offset += numberOfSamplesToCopy;
+		numberOfSamplesLeft -= numberOfSamplesToCopy;
+	}
 }
 
 void LongSound_savePartAsAudioFile (LongSound me, int audioFileType, double tmin, double tmax, MelderFile file, int numberOfBitsPerSamplePoint) {
@@ -398,91 +580,77 @@ void LongSound_saveChannelAsAudioFile (LongSound me, int audioFileType, int chan
 	}
 }
 
-static void _LongSound_haveSamples (LongSound me, long imin, long imax) {
-	long n = imax - imin + 1;
-	Melder_assert (n <= my nmax);
-	/*
-	 * Included?
-	 */
-	if (imin >= my imin && imax <= my imax) return;
-	/*
-	 * Extendable?
-	 */
-	if (imin >= my imin && imax - my imin + 1 <= my nmax) {
-		_LongSound_readSamples (me, my buffer + (my imax - my imin + 1) * my numberOfChannels, my imax + 1, imax);
-		my imax = imax;
-		return;
+static float * _LongSound_getBlock (LongSound me, long iblock) {
+	Melder_assert (iblock >= 1 && iblock <= my numberOfBlocks);
+	my cacheClock ++;
+	long leastRecentlyUsedSlot = 0;
+	for (long islot = 0; islot < my numberOfCachedBlocks; islot ++) {
+		if (my cachedBlockNumbers [islot] == iblock) {
+			my cachedBlockLastUses [islot] = my cacheClock;
+			return my cachedBlocks [islot];
+		}
+		if (my cachedBlockLastUses [islot] < my cachedBlockLastUses [leastRecentlyUsedSlot])
+			leastRecentlyUsedSlot = islot;
 	}
-	/*
-	 * Determine the loadable imin..imax.
-	 * Add margins on both sides.
-	 */
-	imin -= MARGIN * n;
-	if (imin < 1) imin = 1;
-	imax = imin + (long) floor ((1.0 + 2.0 * MARGIN) * n);
-	if (imax > my nx) imax = my nx;
-	imin = imax - (long) floor ((1.0 + 2.0 * MARGIN) * n);
-	if (imin < 1) imin = 1;
-	Melder_assert (imax - imin + 1 <= my nmax);
-	/*
-	 * Overlap?
-	 */
-	if (imax < my imin || imin > my imax) {
-		/*
-		 * No overlap.
-		 */
-		_LongSound_readSamples (me, my buffer, imin, imax);
-	} else if (imin < my imin) {
+	long islot = leastRecentlyUsedSlot;
+	if (! my cachedBlocks [islot])
+		my cachedBlocks [islot] = NUMvector <float> (0, LongSound_BLOCK_SIZE * my numberOfChannels - 1);
+	my cachedBlockNumbers [islot] = 0;   // in case reading fails
+	long firstSample = (iblock - 1) * LongSound_BLOCK_SIZE + 1;
+	long numberOfSamples = iblock < my numberOfBlocks ? LongSound_BLOCK_SIZE : my nx - firstSample + 1;
+	if (_LongSound_isStillMapped (me)) {
+		for (int ichan = 1; ichan <= my numberOfChannels; ichan ++)
+			_LongSound_MAP_decodeChannel (me, ichan, firstSample, numberOfSamples, my cachedBlocks [islot] + (ichan - 1), my numberOfChannels);
+		my cachedBlockNumbers [islot] = iblock;
+		my cachedBlockLastUses [islot] = my cacheClock;
+		return my cachedBlocks [islot];
+	}
+	autoNUMmatrix <double> samples (1, my numberOfChannels, 1, numberOfSamples);
+	{
 		/*
-		 * Left overlap.
+		 * A file that is shorter than its header says gets zeroes for its missing samples here, without a warning,
+		 * because every block that is drawn or played comes by here; "Extract part" still warns.
 		 */
-		if (imax <= my imax) {
-			/*
-			 * Only left overlap (e.g. scrolling up).
-			 */
-			long nshift = (imax - my imin + 1) * my numberOfChannels, shift = (my imin - imin) * my numberOfChannels;
-			#if USE_MEMMOVE
-				memmove (my buffer + shift, my buffer, nshift * sizeof (int16));
-			#else
-				for (i = nshift - 1; i >= 0; i --)
-					my buffer [i + shift] = my buffer [i];
-			#endif
-			_LongSound_readSamples (me, my buffer, imin, my imin - 1);
-		} else {
-			/*
-			 * Left and right overlap (e.g. zooming out).
-			 */
-			long nshift = (my imax - my imin + 1) * my numberOfChannels, shift = (my imin - imin) * my numberOfChannels;
-			#if USE_MEMMOVE
-				memmove (my buffer + shift, my buffer, nshift * sizeof (int16));
-			#else
-				for (i = nshift - 1; i >= 0; i --)
-					my buffer [i + shift] = my buffer [i];
-			#endif
-			_LongSound_readSamples (me, my buffer, imin, my imin - 1);
-			_LongSound_readSamples (me, my buffer + (my imax - imin + 1) * my numberOfChannels, my imax + 1, imax);
+		autoMelderWarningOff nowarn;
+		LongSound_readAudioToFloat (me, samples.peek(), firstSample, numberOfSamples);
+	}
+	float *block = my cachedBlocks [islot];
+	for (long isample = 1; isample <= numberOfSamples; isample ++) {
+		for (long ichan = 1; ichan <= my numberOfChannels; ichan ++) {
+			* block ++ = (float) samples [ichan] [isample];
 		}
-	} else {
-		/*
-		 * Only right overlap (e.g. scrolling down).
-		 */
-		long nshift = (my imax - imin + 1) * my numberOfChannels, shift = (imin - my imin) * my numberOfChannels;
-		#if USE_MEMMOVE
-			memmove (my buffer, my buffer + shift, nshift * sizeof (int16));
-		#else
-			for (i = 0; i < nshift; i ++)
-				my buffer [i] = my buffer [i + shift];
-		#endif
-		_LongSound_readSamples (me, my buffer + (my imax - imin + 1) * my numberOfChannels, my imax + 1, imax);
 	}
-	my imin = imin, my imax = imax;
+	my cachedBlockNumbers [islot] = iblock;
+	my cachedBlockLastUses [islot] = my cacheClock;
+	return my cachedBlocks [islot];
+}
+
+const float * LongSound_peekSamples (LongSound me, long firstSample, long *lastSample) {
+	Melder_assert (firstSample >= 1 && firstSample <= my nx);
+	long iblock = (firstSample - 1) / LongSound_BLOCK_SIZE + 1;
+	long firstSampleOfBlock = (iblock - 1) * LongSound_BLOCK_SIZE + 1;
+	*lastSample = iblock < my numberOfBlocks ? firstSampleOfBlock + LongSound_BLOCK_SIZE - 1 : my nx;
+	return _LongSound_getBlock (me, iblock) + (firstSample - firstSampleOfBlock) * my numberOfChannels;
 }
 
 bool LongSound_haveWindow (LongSound me, double tmin, double tmax) {
 	long imin, imax;
 	long n = Sampled_getWindowSamples (me, tmin, tmax, & imin, & imax);
-	if ((1.0 + 2 * MARGIN) * n + 1 > my nmax) return false;
-	_LongSound_haveSamples (me, imin, imax);
+	if ((1.0 + 2 * MARGIN) * n + 1 > (my numberOfCachedBlocks - 2) * (double) LongSound_BLOCK_SIZE && my numberOfCachedBlocks < my numberOfBlocks)
+		return false;
+	/*
+	 * Read the window, plus margins on both sides, into the cache.
+	 */
+	imin -= (long) (MARGIN * n);
+	if (imin < 1) imin = 1;
+	imax += (long) (MARGIN * n);
+	if (imax > my nx) imax = my nx;
+	long isample = imin;
+	while (isample <= imax) {
+		long lastSample;
+		(void) LongSound_peekSamples (me, isample, & lastSample);
+		isample = lastSample + 1;
+	}
 	return true;
 }
 
@@ -492,19 +660,42 @@ void LongSound_getWindowExtrema (LongSound me, double tmin, double tmax, int cha
 	*minimum = 1.0;
 	*maximum = -1.0;
 	try {
-		LongSound_haveWindow (me, tmin, tmax);
+		if (imin > imax || ! LongSound_haveWindow (me, tmin, tmax)) return;
+		float minimum_float = 1e30f, maximum_float = -1e30f;
+		long isample = imin;
+		while (isample <= imax) {
+			long lastSample;
+			const float *samples = LongSound_peekSamples (me, isample, & lastSample) + (channel - 1);
+			if (lastSample > imax) lastSample = imax;
+			for (; isample <= lastSample; isample ++, samples += my numberOfChannels) {
+				float value = *samples;
+				if (value < minimum_float) minimum_float = value;
+				if (value > maximum_float) maximum_float = value;
+			}
+		}
+		*minimum = minimum_float;
+		*maximum = maximum_float;
 	} catch (MelderError) {
 		Melder_clearError ();
-		return;
 	}
-	long minimum_int = 32767, maximum_int = -32768;
-	for (long i = imin; i <= imax; i ++) {
-		long value = my buffer [(i - my imin) * my numberOfChannels + channel - 1];
-		if (value < minimum_int) minimum_int = value;
-		if (value > maximum_int) maximum_int = value;
+}
+
+/*
+ * For playing, which is always in 16 bits.
+ */
+static void _LongSound_copyToShort (LongSound me, long imin, long imax, int16 *to) {
+	long isample = imin;
+	while (isample <= imax) {
+		long lastSample;
+		const float *from = LongSound_peekSamples (me, isample, & lastSample);
+		if (lastSample > imax) lastSample = imax;
+		long n = (lastSample - isample + 1) * my numberOfChannels;
+		for (long i = 0; i < n; i ++) {
+			double value = round (from [i] * 32768.0);
+			* to ++ = (int16) (value < -32768.0 ? -32768.0 : value > 32767.0 ? 32767.0 : value);
+		}
+		isample = lastSample + 1;
 	}
-	*minimum = minimum_int / 32768.0;
-	*maximum = maximum_int / 32768.0;
 }
 
 static struct LongSoundPlay {
@@ -558,23 +749,20 @@ void LongSound_playPart (LongSound me, double tmin, double tmax,
 			thy silenceBefore = (long) (my sampleRate * MelderAudio_getOutputSilenceBefore ());
 			thy silenceAfter = (long) (my sampleRate * MelderAudio_getOutputSilenceAfter ());
 			if (thy callback) thy callback (thy boss, 1, tmin, tmax, tmin);
-			if (thy silenceBefore > 0 || thy silenceAfter > 0 || 1) {
-				thy resampledBuffer = Melder_calloc (int16, (thy silenceBefore + thy numberOfSamples + thy silenceAfter) * my numberOfChannels);
-				memcpy (& thy resampledBuffer [thy silenceBefore * my numberOfChannels], & my buffer [(i1 - my imin) * my numberOfChannels],
-					thy numberOfSamples * sizeof (int16) * my numberOfChannels);
-				MelderAudio_play16 (thy resampledBuffer, my sampleRate, thy silenceBefore + thy numberOfSamples + thy silenceAfter,
-					my numberOfChannels, melderPlayCallback, thee);
-			} else {
-				MelderAudio_play16 (my buffer + (i1 - my imin) * my numberOfChannels, my sampleRate,
-				   thy numberOfSamples, my numberOfChannels, melderPlayCallback, thee);
-			}
+			thy resampledBuffer = Melder_calloc (int16, (thy silenceBefore + thy numberOfSamples + thy silenceAfter) * my numberOfChannels);
+			_LongSound_copyToShort (me, i1, i2, & thy resampledBuffer [thy silenceBefore * my numberOfChannels]);
+			MelderAudio_play16 (thy resampledBuffer, my sampleRate, thy silenceBefore + thy numberOfSamples + thy silenceAfter,
+				my numberOfChannels, melderPlayCallback, thee);
 		} else {
 			long newSampleRate = bestSampleRate;
 			long newN = ((double) n * newSampleRate) / my sampleRate - 1;
 			long silenceBefore = (long) (newSampleRate * MelderAudio_getOutputSilenceBefore ());
 			long silenceAfter = (long) (newSampleRate * MelderAudio_getOutputSilenceAfter ());
+			long i2_from = i2 < my nx ? i2 + 1 : i2;   // the interpolation can look one sample beyond the window
+			autoNUMvector <int16> window ((long) 0, (i2_from - i1 + 2) * my numberOfChannels - 1);   // zeroed, which covers the end of the file
+			_LongSound_copyToShort (me, i1, i2_from, window.peek());
+			int16 *from = window.peek();
 			int16 *resampledBuffer = Melder_calloc (int16, (silenceBefore + newN + silenceAfter) * my numberOfChannels);
-			int16 *from = my buffer + (i1 - my imin) * my numberOfChannels;   // guaranteed: from [0 .. (my imax - my imin + 1) * nchan]
 			double t1 = my x1, dt = 1.0 / newSampleRate;
 			thy numberOfSamples = newN;
 			thy dt = dt;
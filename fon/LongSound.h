@@ -24,6 +24,8 @@
 #define COMPRESSED_MODE_READ_FLOAT 0
 #define COMPRESSED_MODE_READ_SHORT 1
 
+#define LongSound_BLOCK_SIZE  16384
+
 struct FLAC__StreamDecoder;
 struct FLAC__StreamEncoder;
 struct _MP3_FILE;
@@ -34,14 +36,31 @@ Thing_define (LongSound, Sampled) {
 	int audioFileType, numberOfChannels, encoding, numberOfBytesPerSamplePoint;
 	double sampleRate;
 	long startOfData;
-	double bufferLength;
-	int16 *buffer;   // this is always 16-bit, because will always play sounds in 16-bit, even those from 24-bit files
-	long imin, imax, nmax;
+	double bufferLength;   // the maximum viewable part, in seconds
+	/*
+	 * The samples that have been read are cached in blocks of LongSound_BLOCK_SIZE sample frames,
+	 * channels interleaved, as 32-bit floats. This is exact for 8-, 16- and 24-bit files and for 32-bit float files;
+	 * the samples of 32-bit linear and 64-bit float files are rounded to the 24 bits of precision of a float.
+	 * That is enough for what the cache is used for, namely drawing and 16-bit playing;
+	 * extracting and saving parts bypass the cache and read the file in full precision.
+	 * A block is allocated only when it is first needed; when all slots are in use,
+	 * the least recently used block is replaced.
+	 */
+	long numberOfBlocks, numberOfCachedBlocks;
+	float **cachedBlocks;   // [0..numberOfCachedBlocks-1]
+	long *cachedBlockNumbers;   // [0..numberOfCachedBlocks-1]; 0 means empty
+	unsigned long *cachedBlockLastUses;   // [0..numberOfCachedBlocks-1]
+	unsigned long cacheClock;
+	/*
+	 * Uncompressed files are mapped into memory if possible, so that blocks are decoded straight from the mapping.
+	 */
+	const unsigned char *mappedFile;   // null if not mapped
+	size_t mappedFileSize;
 	struct FLAC__StreamDecoder *flacDecoder;
 	struct _MP3_FILE *mp3f;
 	int compressedMode;
 	long compressedSamplesLeft;
-	double *compressedFloats [2];
+	double *compressedFloats [8];   // one per channel (FLAC allows up to 8)
 	int16 *compressedShorts;
 
 	void v_destroy () noexcept
@@ -62,11 +81,19 @@ autoSound LongSound_extractPart (LongSound me, double tmin, double tmax, int pre
 
 bool LongSound_haveWindow (LongSound me, double tmin, double tmax);
 /*
- * Returns 0 if error or if window exceeds buffer, otherwise 1;
+ * Returns false if the window exceeds what the block cache can hold at once (the maximum viewable part);
+ * otherwise reads the window into the cache and returns true.
  */
 
 void LongSound_getWindowExtrema (LongSound me, double tmin, double tmax, int channel, double *minimum, double *maximum);
 
+const float * LongSound_peekSamples (LongSound me, long firstSample, long *lastSample);
+/*
+ * Returns a pointer to sample frame 'firstSample' in the block cache, where channel c of sample frame i (i >= firstSample)
+ * is at [(i - firstSample) * numberOfChannels + (c - 1)], for all i up to *lastSample, which is the end of the cache block.
+ * The pointer is valid until the next call that reads from the LongSound.
+ */
+
 void LongSound_playPart (LongSound me, double tmin, double tmax,
 	Sound_PlayCallback callback, Thing boss);
 
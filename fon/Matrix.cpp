@@ -20,6 +20,7 @@
 #include "NUM2.h"
 #include "Formula.h"
 #include "Eigen.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "Matrix_def.h"
@@ -623,17 +624,48 @@ void Matrix_writeToHeaderlessSpreadsheetFile (Matrix me, MelderFile file) {
 	}
 }
 
-void Matrix_formula (Matrix me, const char32 *expression, Interpreter interpreter, Matrix target) {
-	try {
+#define Matrix_formula_BLOCK_SIZE  4096
+
+static void Matrix_formula_cells (FormulaProgram program, long rowmin, long rowmax, long colmin, long colmax, Matrix target) {
+	/*
+		Rows are cut into blocks of cells; if no cell depends on another, the blocks are computed in parallel,
+		otherwise they are computed one after another, in the order of the rows and columns.
+		A simple numeric program computes all cells of a block at once; other programs are run cell by cell.
+	*/
+	if (rowmax < rowmin || colmax < colmin)
+		return;
+	long numberOfBlocksPerRow = (colmax - colmin) / Matrix_formula_BLOCK_SIZE + 1;
+	long numberOfBlocks = (rowmax - rowmin + 1) * numberOfBlocksPerRow;
+	bool canRunBlocks = FormulaProgram_canRunBlocks (program);
+	auto computeBlocks = [&] (long firstBlock, long lastBlock, int /* threadNumber */) {
 		struct Formula_Result result;
-		Formula_compile (interpreter, me, expression, kFormula_EXPRESSION_TYPE_NUMERIC, true);
-		if (! target) target = me;
-		for (long irow = 1; irow <= my ny; irow ++) {
-			for (long icol = 1; icol <= my nx; icol ++) {
-				Formula_run (irow, icol, & result);
-				target -> z [irow] [icol] = result. result.numericResult;
+		for (long iblock = firstBlock; iblock <= lastBlock; iblock ++) {
+			long irow = rowmin + (iblock - 1) / numberOfBlocksPerRow;
+			long firstColumn = colmin + ((iblock - 1) % numberOfBlocksPerRow) * Matrix_formula_BLOCK_SIZE;
+			long lastColumn = firstColumn + Matrix_formula_BLOCK_SIZE - 1;
+			if (lastColumn > colmax) lastColumn = colmax;
+			double *targetRow = target -> z [irow];
+			if (canRunBlocks) {
+				FormulaProgram_runBlock (program, irow, firstColumn, lastColumn, targetRow);
+				continue;
+			}
+			for (long icol = firstColumn; icol <= lastColumn; icol ++) {
+				FormulaProgram_run (program, irow, icol, & result);
+				targetRow [icol] = result. result.numericResult;
 			}
 		}
+	};
+	if (FormulaProgram_isCellIndependent (program, target))
+		MelderThread_parallelFor (1, numberOfBlocks, 1, computeBlocks);
+	else
+		computeBlocks (1, numberOfBlocks, 1);
+}
+
+void Matrix_formula (Matrix me, const char32 *expression, Interpreter interpreter, Matrix target) {
+	try {
+		autoFormulaProgram program = Formula_compileProgram (interpreter, me, expression, kFormula_EXPRESSION_TYPE_NUMERIC, true);
+		if (! target) target = me;
+		Matrix_formula_cells (program.get(), 1, my ny, 1, my nx, target);
 	} catch (MelderError) {
 		Melder_throw (me, U": formula not completed.");
 	}
@@ -648,15 +680,9 @@ void Matrix_formula_part (Matrix me, double xmin, double xmax, double ymin, doub
 		long ixmin, ixmax, iymin, iymax;
 		(void) Matrix_getWindowSamplesX (me, xmin, xmax, & ixmin, & ixmax);
 		(void) Matrix_getWindowSamplesY (me, ymin, ymax, & iymin, & iymax);
-		struct Formula_Result result;
-		Formula_compile (interpreter, me, expression, kFormula_EXPRESSION_TYPE_NUMERIC, true);
+		autoFormulaProgram program = Formula_compileProgram (interpreter, me, expression, kFormula_EXPRESSION_TYPE_NUMERIC, true);
 		if (! target) target = me;
-		for (long irow = iymin; irow <= iymax; irow ++) {
-			for (long icol = ixmin; icol <= ixmax; icol ++) {
-				Formula_run (irow, icol, & result);
-				target -> z [irow] [icol] = result. result.numericResult;
-			}
-		}
+		Matrix_formula_cells (program.get(), iymin, iymax, ixmin, ixmax, target);
 	} catch (MelderError) {
 		Melder_throw (me, U": formula not completed.");
 	}
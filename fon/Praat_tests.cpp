@@ -47,6 +47,148 @@ static autoDaata newAutoData () {
 	return data;
 }
 
+/*
+	Write numberOfSamples random sample frames in the given encoding to a temporary file,
+	and report how many megabytes per second Melder_readAudioToFloat decodes from it.
+	The temporary file disappears when it is closed, which autofile also does if decoding throws.
+*/
+static void timeAudioDecoding (int encoding, const char32 *encodingName, int numberOfChannels, long numberOfSamples, int64 numberOfRepetitions) {
+	autofile f = tmpfile ();
+	if (! f) Melder_throw (U"Cannot create a temporary file.");
+	for (long i = 1; i <= numberOfSamples * numberOfChannels; i ++) {
+		double value = NUMrandomUniform (-0.9, 0.9);
+		switch (encoding) {
+			case Melder_LINEAR_8_SIGNED: binputi1 ((int) (value * 127), f); break;
+			case Melder_LINEAR_8_UNSIGNED: binputu1 ((unsigned int) (value * 127 + 128), f); break;
+			case Melder_LINEAR_16_BIG_ENDIAN: binputi2 ((int16) (value * 32767), f); break;
+			case Melder_LINEAR_16_LITTLE_ENDIAN: binputi2LE ((int16) (value * 32767), f); break;
+			case Melder_LINEAR_24_BIG_ENDIAN: binputi3 ((int32) (value * 8388607), f); break;
+			case Melder_LINEAR_24_LITTLE_ENDIAN: binputi3LE ((int32) (value * 8388607), f); break;
+			case Melder_LINEAR_32_BIG_ENDIAN: binputi4 ((int32) (value * 2147483647.0), f); break;
+			case Melder_LINEAR_32_LITTLE_ENDIAN: binputi4LE ((int32) (value * 2147483647.0), f); break;
+			case Melder_IEEE_FLOAT_32_BIG_ENDIAN: binputr4 (value, f); break;
+			case Melder_IEEE_FLOAT_32_LITTLE_ENDIAN: binputr4LE (value, f); break;
+			case Melder_IEEE_FLOAT_64_BIG_ENDIAN: binputr8 (value, f); break;
+			case Melder_IEEE_FLOAT_64_LITTLE_ENDIAN: {
+				uint64_t bits;
+				memcpy (& bits, & value, 8);
+				for (int ibyte = 0; ibyte < 8; ibyte ++)
+					binputu1 ((unsigned int) (bits >> (8 * ibyte)) & 0xFF, f);
+			} break;
+			default: binputu1 ((unsigned int) NUMrandomInteger (0, 255), f);   // mu-law, A-law
+		}
+	}
+	autoNUMmatrix <double> buffer (1, numberOfChannels, 1, numberOfSamples);
+	Melder_stopwatch ();
+	for (int64 irep = 1; irep <= numberOfRepetitions; irep ++) {
+		rewind (f);
+		Melder_readAudioToFloat (f, numberOfChannels, encoding, buffer.peek(), numberOfSamples);
+	}
+	double t = Melder_stopwatch ();
+	double numberOfMegabytes = (double) numberOfRepetitions * numberOfSamples * numberOfChannels * Melder_bytesPerSamplePoint (encoding) / 1e6;
+	MelderInfo_writeLine (encodingName, U": ", Melder_fixed (numberOfMegabytes / t, 1), U" MB/s");
+}
+
+/*
+	The ITU-T G.711 expansions, computed bit by bit rather than looked up,
+	so that they check the tables in melder_audiofiles.cpp instead of repeating them.
+*/
+static int muLawToLinear (unsigned int byte) {
+	unsigned int u = ~ byte & 0xFF;
+	int t = (int) (((u & 0x0F) << 3) + 0x84) << ((u & 0x70) >> 4);
+	return u & 0x80 ? 0x84 - t : t - 0x84;
+}
+static int aLawToLinear (unsigned int byte) {
+	unsigned int a = byte ^ 0x55;
+	int t = (int) (a & 0x0F) << 4, segment = (int) (a & 0x70) >> 4;
+	if (segment == 0) t += 8; else t = (t + 0x108) << (segment - 1);
+	return a & 0x80 ? t : - t;
+}
+
+/*
+	Write numberOfSamples sample frames in the given encoding to a temporary file, sample by sample,
+	with the extreme values first and random values after that;
+	then read them back with Melder_readAudioToFloat, and require every sample to come back exactly as written.
+*/
+static void checkAudioDecoding (int encoding, const char32 *encodingName, int numberOfChannels, long numberOfSamples) {
+	autofile f = tmpfile ();
+	if (! f) Melder_throw (U"Cannot create a temporary file.");
+	autoNUMmatrix <double> expected (1, numberOfChannels, 1, numberOfSamples);
+	for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
+		for (int ichan = 1; ichan <= numberOfChannels; ichan ++) {
+			long i = (isamp - 1) * numberOfChannels + ichan;   // the extremes go into the first two sample points
+			switch (encoding) {
+				case Melder_LINEAR_8_SIGNED: {
+					int value = i == 1 ? -128 : i == 2 ? 127 : (int) NUMrandomInteger (-128, 127);
+					binputi1 (value, f);
+					expected [ichan] [isamp] = value / 128.0;
+				} break;
+				case Melder_LINEAR_8_UNSIGNED: {
+					unsigned int value = i == 1 ? 0 : i == 2 ? 255 : (unsigned int) NUMrandomInteger (0, 255);
+					binputu1 (value, f);
+					expected [ichan] [isamp] = value / 128.0 - 1.0;
+				} break;
+				case Melder_LINEAR_16_BIG_ENDIAN:
+				case Melder_LINEAR_16_LITTLE_ENDIAN: {
+					int value = i == 1 ? -32768 : i == 2 ? 32767 : (int) NUMrandomInteger (-32768, 32767);
+					if (encoding == Melder_LINEAR_16_BIG_ENDIAN) binputi2 (value, f); else binputi2LE (value, f);
+					expected [ichan] [isamp] = value / 32768.0;
+				} break;
+				case Melder_LINEAR_24_BIG_ENDIAN:
+				case Melder_LINEAR_24_LITTLE_ENDIAN: {
+					int32 value = i == 1 ? -8388608 : i == 2 ? 8388607 : (int32) NUMrandomInteger (-8388608, 8388607);
+					if (encoding == Melder_LINEAR_24_BIG_ENDIAN) binputi3 (value, f); else binputi3LE (value, f);
+					expected [ichan] [isamp] = value / 8388608.0;
+				} break;
+				case Melder_LINEAR_32_BIG_ENDIAN:
+				case Melder_LINEAR_32_LITTLE_ENDIAN: {
+					int32 value = i == 1 ? INT32_MIN : i == 2 ? INT32_MAX :
+						(int32) (NUMrandomInteger (-32768, 32767) * 65536 + NUMrandomInteger (0, 65535));
+					if (encoding == Melder_LINEAR_32_BIG_ENDIAN) binputi4 (value, f); else binputi4LE (value, f);
+					expected [ichan] [isamp] = value / 2147483648.0;
+				} break;
+				case Melder_IEEE_FLOAT_32_BIG_ENDIAN:
+				case Melder_IEEE_FLOAT_32_LITTLE_ENDIAN: {
+					double value = (float) (i == 1 ? -1.0 : i == 2 ? 1.0 : NUMrandomUniform (-1.0, 1.0));
+					if (encoding == Melder_IEEE_FLOAT_32_BIG_ENDIAN) binputr4 (value, f); else binputr4LE (value, f);
+					expected [ichan] [isamp] = value;
+				} break;
+				case Melder_IEEE_FLOAT_64_BIG_ENDIAN:
+				case Melder_IEEE_FLOAT_64_LITTLE_ENDIAN: {
+					double value = i == 1 ? -1.0 : i == 2 ? 1.0 : NUMrandomUniform (-1.0, 1.0);
+					if (encoding == Melder_IEEE_FLOAT_64_BIG_ENDIAN) {
+						binputr8 (value, f);
+					} else {
+						uint64_t bits;
+						memcpy (& bits, & value, 8);
+						for (int ibyte = 0; ibyte < 8; ibyte ++)
+							binputu1 ((unsigned int) (bits >> (8 * ibyte)) & 0xFF, f);
+					}
+					expected [ichan] [isamp] = value;
+				} break;
+				case Melder_MULAW:
+				case Melder_ALAW: {
+					unsigned int value = i <= 256 ? (unsigned int) (i - 1) : (unsigned int) NUMrandomInteger (0, 255);   // every byte value at least once
+					binputu1 (value, f);
+					expected [ichan] [isamp] = (encoding == Melder_MULAW ? muLawToLinear (value) : aLawToLinear (value)) / 32768.0;
+				} break;
+				default: Melder_fatal (U"checkAudioDecoding: unknown encoding ", encoding, U".");
+			}
+		}
+	}
+	rewind (f);
+	autoNUMmatrix <double> buffer (1, numberOfChannels, 1, numberOfSamples);
+	Melder_readAudioToFloat (f, numberOfChannels, encoding, buffer.peek(), numberOfSamples);
+	for (int ichan = 1; ichan <= numberOfChannels; ichan ++) {
+		for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
+			if (buffer [ichan] [isamp] != expected [ichan] [isamp])
+				Melder_throw (encodingName, U", ", numberOfChannels, U" channels: sample ", isamp, U" of channel ", ichan,
+					U" was written as ", expected [ichan] [isamp], U" but read as ", buffer [ichan] [isamp], U".");
+		}
+	}
+	MelderInfo_writeLine (encodingName, U", ", numberOfChannels, U" channels: OK");
+}
+
 int Praat_tests (int itest, char32 *arg1, char32 *arg2, char32 *arg3, char32 *arg4) {
 	int64 n = Melder_atoi (arg1);
 	double t = 0.0;
@@ -327,6 +469,46 @@ int Praat_tests (int itest, char32 *arg1, char32 *arg2, char32 *arg3, char32 *ar
 				dataFun3 (data.get());
 			#endif
 		} break;
+		case kPraatTests_TIME_AUDIO_DECODING: {
+			long numberOfSamples = arg2 [0] == U'\0' ? 1000000 : Melder_atoi (arg2);
+			int numberOfChannels = arg3 [0] == U'\0' ? 2 : (int) Melder_atoi (arg3);
+			timeAudioDecoding (Melder_LINEAR_8_SIGNED, U"8-bit signed", numberOfChannels, numberOfSamples, n);
+			timeAudioDecoding (Melder_LINEAR_8_UNSIGNED, U"8-bit unsigned", numberOfChannels, numberOfSamples, n);
+			timeAudioDecoding (Melder_LINEAR_16_BIG_ENDIAN, U"16-bit big-endian", numberOfChannels, numberOfSamples, n);
+			timeAudioDecoding (Melder_LINEAR_16_LITTLE_ENDIAN, U"16-bit little-endian", numberOfChannels, numberOfSamples, n);
+			timeAudioDecoding (Melder_LINEAR_24_BIG_ENDIAN, U"24-bit big-endian", numberOfChannels, numberOfSamples, n);
+			timeAudioDecoding (Melder_LINEAR_24_LITTLE_ENDIAN, U"24-bit little-endian", numberOfChannels, numberOfSamples, n);
+			timeAudioDecoding (Melder_LINEAR_32_BIG_ENDIAN, U"32-bit big-endian", numberOfChannels, numberOfSamples, n);
+			timeAudioDecoding (Melder_LINEAR_32_LITTLE_ENDIAN, U"32-bit little-endian", numberOfChannels, numberOfSamples, n);
+			timeAudioDecoding (Melder_IEEE_FLOAT_32_BIG_ENDIAN, U"32-bit float big-endian", numberOfChannels, numberOfSamples, n);
+			timeAudioDecoding (Melder_IEEE_FLOAT_32_LITTLE_ENDIAN, U"32-bit float little-endian", numberOfChannels, numberOfSamples, n);
+			timeAudioDecoding (Melder_IEEE_FLOAT_64_BIG_ENDIAN, U"64-bit float big-endian", numberOfChannels, numberOfSamples, n);
+			timeAudioDecoding (Melder_IEEE_FLOAT_64_LITTLE_ENDIAN, U"64-bit float little-endian", numberOfChannels, numberOfSamples, n);
+			timeAudioDecoding (Melder_MULAW, U"mu-law", numberOfChannels, numberOfSamples, n);
+			timeAudioDecoding (Melder_ALAW, U"A-law", numberOfChannels, numberOfSamples, n);
+			MelderInfo_close ();
+			return 1;   // each encoding has reported its own speed, so there is no time per repetition to report
+		} break;
+		case kPraatTests_CHECK_AUDIO_DECODING: {
+			long numberOfSamples = arg2 [0] == U'\0' ? 100000 : Melder_atoi (arg2);
+			int numberOfChannels = arg3 [0] == U'\0' ? 2 : (int) Melder_atoi (arg3);
+			checkAudioDecoding (Melder_LINEAR_8_SIGNED, U"8-bit signed", numberOfChannels, numberOfSamples);
+			checkAudioDecoding (Melder_LINEAR_8_UNSIGNED, U"8-bit unsigned", numberOfChannels, numberOfSamples);
+			checkAudioDecoding (Melder_LINEAR_16_BIG_ENDIAN, U"16-bit big-endian", numberOfChannels, numberOfSamples);
+			checkAudioDecoding (Melder_LINEAR_16_LITTLE_ENDIAN, U"16-bit little-endian", numberOfChannels, numberOfSamples);
+			checkAudioDecoding (Melder_LINEAR_24_BIG_ENDIAN, U"24-bit big-endian", numberOfChannels, numberOfSamples);
+			checkAudioDecoding (Melder_LINEAR_24_LITTLE_ENDIAN, U"24-bit little-endian", numberOfChannels, numberOfSamples);
+			checkAudioDecoding (Melder_LINEAR_32_BIG_ENDIAN, U"32-bit big-endian", numberOfChannels, numberOfSamples);
+			checkAudioDecoding (Melder_LINEAR_32_LITTLE_ENDIAN, U"32-bit little-endian", numberOfChannels, numberOfSamples);
+			checkAudioDecoding (Melder_IEEE_FLOAT_32_BIG_ENDIAN, U"32-bit float big-endian", numberOfChannels, numberOfSamples);
+			checkAudioDecoding (Melder_IEEE_FLOAT_32_LITTLE_ENDIAN, U"32-bit float little-endian", numberOfChannels, numberOfSamples);
+			checkAudioDecoding (Melder_IEEE_FLOAT_64_BIG_ENDIAN, U"64-bit float big-endian", numberOfChannels, numberOfSamples);
+			checkAudioDecoding (Melder_IEEE_FLOAT_64_LITTLE_ENDIAN, U"64-bit float little-endian", numberOfChannels, numberOfSamples);
+			checkAudioDecoding (Melder_MULAW, U"mu-law", numberOfChannels, numberOfSamples);
+			checkAudioDecoding (Melder_ALAW, U"A-law", numberOfChannels, numberOfSamples);
+			MelderInfo_close ();
+			return 1;
+		} break;
 	}
 	MelderInfo_writeLine (Melder_single (t / n * 1e9), U" nanoseconds");
 	MelderInfo_close ();
@@ -41,6 +41,8 @@ enums_begin (kPraatTests, 0)
 	enums_add (kPraatTests, 21, TIME_STR32CPY, U"TimeStr32cpy")
 	enums_add (kPraatTests, 22, TIME_GRAPHICS_TEXT_TOP, U"TimeGraphicsTextTop")
 	enums_add (kPraatTests, 23, THING_AUTO, U"ThingAuto")
-enums_end (kPraatTests, 23, CHECK_RANDOM_1009_2009)
+	enums_add (kPraatTests, 24, TIME_AUDIO_DECODING, U"TimeAudioDecoding")
+	enums_add (kPraatTests, 25, CHECK_AUDIO_DECODING, U"CheckAudioDecoding")
+enums_end (kPraatTests, 25, CHECK_RANDOM_1009_2009)
 
 /* End of file Praat_tests_enums.h */
@@ -25,6 +25,7 @@
 #include "Sound.h"
 #include "Sound_extensions.h"
 #include "NUM2.h"
+#include "MelderThread.h"
 
 #include "enums_getText.h"
 #include "Sound_enums.h"
@@ -339,8 +340,7 @@ autoMatrix Sound_to_Matrix (Sound me) {
 
 autoSound Sound_upsample (Sound me) {
 	try {
-		long nfft = 1;
-		while (nfft < my nx + 2000) nfft *= 2;
+		long nfft = NUMfft_getGoodSize (my nx + 2000);
 		autoSound thee = Sound_create (my ny, my xmin, my xmax, my nx * 2, my dx / 2, my x1 - my dx / 4);
 		for (long channel = 1; channel <= my ny; channel ++) {
 			autoNUMvector<double> data (1, 2 * nfft);   // zeroing is important...
@@ -373,8 +373,8 @@ autoSound Sound_resample (Sound me, double samplingFrequency, long precision) {
 			Melder_throw (U"The resampled Sound would have no samples.");
 		autoSound filtered;
 		if (upfactor < 1.0) {   // need anti-aliasing filter?
-			long nfft = 1, antiTurnAround = 1000;
-			while (nfft < my nx + antiTurnAround * 2) nfft *= 2;
+			long antiTurnAround = 1000;
+			long nfft = NUMfft_getGoodSize (my nx + antiTurnAround * 2);
 			autoNUMvector<double> data (1, nfft);
 			filtered = Sound_create (my ny, my xmin, my xmax, my nx, my dx, my x1);
 			for (long channel = 1; channel <= my ny; channel ++) {
@@ -424,6 +424,114 @@ autoSound Sound_resample (Sound me, double samplingFrequency, long precision) {
 	}
 }
 
+/*
+	Finds L/M == ratio, with L <= maximumNumerator, by continued fractions.
+	Returns false if there is no such fraction.
+*/
+static bool findFraction (double ratio, long maximumNumerator, long *numerator, long *denominator) {
+	long p0 = 0, q0 = 1, p1 = 1, q1 = 0;   // the last two convergents
+	double x = ratio;
+	for (int iteration = 1; iteration <= 40; iteration ++) {
+		double a = floor (x);
+		if (a > 1e9) break;
+		long p2 = (long) a * p1 + p0, q2 = (long) a * q1 + q0;
+		if (p2 > maximumNumerator || q2 > 1000000000) break;
+		p0 = p1; q0 = q1; p1 = p2; q1 = q2;
+		if (fabs ((double) p1 / q1 - ratio) <= 1e-12 * ratio) {
+			*numerator = p1;
+			*denominator = q1;
+			return true;
+		}
+		if (x - a == 0.0) break;
+		x = 1.0 / (x - a);
+	}
+	return false;
+}
+
+autoSound Sound_resample_polyphase (Sound me, double samplingFrequency, long precision) {
+	const long maximumNumberOfPhases = 4096;
+	double upfactor = samplingFrequency * my dx;
+	if (fabs (upfactor - 1) < 1e-6) return Data_copy (me);
+	long numberOfPhases, step;   // the new sampling frequency is numberOfPhases / step times the old one
+	if (precision <= 1 || ! findFraction (upfactor, maximumNumberOfPhases, & numberOfPhases, & step))
+		return Sound_resample (me, samplingFrequency, precision);
+	try {
+		long numberOfSamples = lround ((my xmax - my xmin) * samplingFrequency);
+		if (numberOfSamples < 1)
+			Melder_throw (U"The resampled Sound would have no samples.");
+		autoSound thee = Sound_create (my ny, my xmin, my xmax, numberOfSamples, 1.0 / samplingFrequency,
+			0.5 * (my xmin + my xmax - (numberOfSamples - 1) / samplingFrequency));
+		/*
+			New sample i lies at old index u1 + (i - 1) * step / numberOfPhases,
+			so its fractional part takes only numberOfPhases different values.
+		*/
+		double u1 = Sampled_xToIndex (me, Sampled_indexToX (thee.get(), 1L));
+		long m1 = (long) floor (u1);
+		double f1 = u1 - m1;
+		/*
+			The filter: a sinc with its first zero at the lower of the two Nyquist periods,
+			under a raised-cosine window of 'precision' such periods (plus a half) on either side,
+			as in NUM_interpolate_sinc.
+		*/
+		double cutoff = upfactor < 1.0 ? (double) numberOfPhases / step : 1.0;   // relative to the old Nyquist frequency
+		double halfWindow = (precision + 0.5) / cutoff;   // in old samples
+		long numberOfTapsPerSide = (long) ceil (halfWindow);
+		long numberOfTaps = 2 * numberOfTapsPerSide;
+		autoNUMmatrix <double> filters (0, numberOfPhases - 1, 1, numberOfTaps);
+		autoNUMvector <long> carries ((long) 0, numberOfPhases - 1);
+		for (long phase = 0; phase < numberOfPhases; phase ++) {
+			double fraction = f1 + (double) phase / numberOfPhases;
+			carries [phase] = (long) floor (fraction);
+			fraction -= carries [phase];   // 0 <= fraction < 1
+			double *filter = filters [phase], sum = 0.0;
+			for (long itap = 1; itap <= numberOfTaps; itap ++) {
+				double t = fraction + numberOfTapsPerSide - itap;   // distance from the new sample to old sample m - numberOfTapsPerSide + itap
+				double weight = 0.0;
+				if (fabs (t) < halfWindow) {
+					double a = NUMpi * cutoff * t;
+					weight = ( a == 0.0 ? 1.0 : sin (a) / a ) * 0.5 * (1.0 + cos (NUMpi * t / halfWindow));
+				}
+				filter [itap] = weight;
+				sum += weight;
+			}
+			for (long itap = 1; itap <= numberOfTaps; itap ++) {
+				filter [itap] /= sum;   // unity gain at zero frequency for every phase
+			}
+		}
+		MelderThread_parallelFor (1, numberOfSamples, 4096, [&] (long firstSample, long lastSample, int /* threadNumber */) {
+			for (long channel = 1; channel <= my ny; channel ++) {
+				const double *from = my z [channel];
+				double *to = thy z [channel];
+				int64 position = (int64) (firstSample - 1) * step;   // in units of 1 / numberOfPhases old samples
+				long wholeSteps = (long) (position / numberOfPhases), phase = (long) (position % numberOfPhases);
+				for (long i = firstSample; i <= lastSample; i ++) {
+					long firstOld = m1 + wholeSteps + carries [phase] - numberOfTapsPerSide + 1;
+					const double *filter = filters [phase];
+					double value = 0.0;
+					if (firstOld >= 1 && firstOld + numberOfTaps - 1 <= my nx) {
+						const double *y = & from [firstOld - 1];
+						for (long itap = 1; itap <= numberOfTaps; itap ++)
+							value += filter [itap] * y [itap];
+					} else {
+						for (long itap = 1; itap <= numberOfTaps; itap ++) {
+							long iold = firstOld + itap - 1;
+							if (iold >= 1 && iold <= my nx)
+								value += filter [itap] * from [iold];
+						}
+					}
+					to [i] = value;
+					phase += step;
+					wholeSteps += phase / numberOfPhases;
+					phase %= numberOfPhases;
+				}
+			}
+		});
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": not resampled.");
+	}
+}
+
 autoSound Sounds_append (Sound me, double silenceDuration, Sound thee) {
 	try {
 		long nx_silence = lround (silenceDuration / my dx), nx = my nx + nx_silence + thy nx;
@@ -516,8 +624,7 @@ autoSound Sounds_convolve (Sound me, Sound thee, enum kSounds_convolve_scaling s
 		if (my dx != thy dx)
 			Melder_throw (U"The sampling frequencies of the two sounds have to be equal.");
 		long n1 = my nx, n2 = thy nx;
-		long n3 = n1 + n2 - 1, nfft = 1;
-		while (nfft < n3) nfft *= 2;
+		long n3 = n1 + n2 - 1, nfft = NUMfft_getGoodSize (n3);
 		autoNUMvector <double> data1 (1, nfft);
 		autoNUMvector <double> data2 (1, nfft);
 		long numberOfChannels = my ny > thy ny ? my ny : thy ny;
@@ -596,8 +703,7 @@ autoSound Sounds_crossCorrelate (Sound me, Sound thee, enum kSounds_convolve_sca
 			Melder_throw (U"The sampling frequencies of the two sounds have to be equal.");
 		long numberOfChannels = my ny > thy ny ? my ny : thy ny;
 		long n1 = my nx, n2 = thy nx;
-		long n3 = n1 + n2 - 1, nfft = 1;
-		while (nfft < n3) nfft *= 2;
+		long n3 = n1 + n2 - 1, nfft = NUMfft_getGoodSize (n3);
 		autoNUMvector <double> data1 (1, nfft);
 		autoNUMvector <double> data2 (1, nfft);
 		double my_xlast = my x1 + (n1 - 1) * my dx;
@@ -673,8 +779,7 @@ autoSound Sounds_crossCorrelate (Sound me, Sound thee, enum kSounds_convolve_sca
 
 autoSound Sound_autoCorrelate (Sound me, enum kSounds_convolve_scaling scaling, enum kSounds_convolve_signalOutsideTimeDomain signalOutsideTimeDomain) {
 	try {
-		long numberOfChannels = my ny, n1 = my nx, n2 = n1 + n1 - 1, nfft = 1;
-		while (nfft < n2) nfft *= 2;
+		long numberOfChannels = my ny, n1 = my nx, n2 = n1 + n1 - 1, nfft = NUMfft_getGoodSize (n2);
 		autoNUMvector <double> data (1, nfft);
 		double my_xlast = my x1 + (n1 - 1) * my dx;
 		autoSound thee = Sound_create (numberOfChannels, my xmin - my xmax, my xmax - my xmin, n2, my dx, my x1 - my_xlast);
@@ -116,6 +116,17 @@ autoSound Sound_resample (Sound me, double samplingFrequency, long precision);
 		precision >= 2: sinx/x interpolation with maximum depth equal to 'precision'.
 */
 
+autoSound Sound_resample_polyphase (Sound me, double samplingFrequency, long precision);
+/*
+	For sampling frequencies whose ratio is a fraction L/M with L not too large (e.g. 48000 -> 16000, 44100 -> 48000).
+	Every new sample is a weighted sum of at most 2 * precision / min (1, L/M) + 2 old samples,
+	with weights from a table of windowed sinc filters (one for each of the L phases),
+	which low-pass filters at the new Nyquist frequency if the sampling frequency goes down.
+	There is no separate anti-aliasing pass, so that the memory use does not grow with the duration beyond that of the result.
+	Outside the time domain, the signal is taken to be zero.
+	Other ratios, and precision <= 1, are handled by Sound_resample.
+*/
+
 autoSound Sounds_append (Sound me, double silenceDuration, Sound thee);
 /*
 	Function:
@@ -34,6 +34,8 @@
 
 #include "Sound_and_Spectrogram.h"
 #include "NUM2.h"
+#include "MelderThread.h"
+#include <atomic>
 
 #include "enums_getText.h"
 #include "Sound_and_Spectrogram_enums.h"
@@ -96,8 +98,6 @@ autoSpectrogram Sound_to_Spectrogram (Sound me, double effectiveAnalysisWidth, d
 		autoSpectrogram thee = Spectrogram_create (my xmin, my xmax, numberOfTimes, timeStep, t1,
 				0.0, fmax, numberOfFreqs, freqStep, 0.5 * (freqStep - binWidth_hertz));
 
-		autoNUMvector <double> frame (1, nsampFFT);
-		autoNUMvector <double> spec (1, nsampFFT);
 		autoNUMvector <double> window (1, nsamp_window);
 		autoNUMfft_Table fftTable;
 		NUMfft_Table_init (& fftTable, nsampFFT);
@@ -133,48 +133,83 @@ autoSpectrogram Sound_to_Spectrogram (Sound me, double effectiveAnalysisWidth, d
 		}
 		double oneByBinWidth = 1.0 / windowssq / binWidth_samples;
 
-		for (long iframe = 1; iframe <= numberOfTimes; iframe ++) {
-			double t = Sampled_indexToX (thee.get(), iframe);
-			long leftSample = Sampled_xToLowIndex (me, t), rightSample = leftSample + 1;
-			long startSample = rightSample - halfnsamp_window;
-			long endSample = leftSample + halfnsamp_window;
-			Melder_assert (startSample >= 1);
-			Melder_assert (endSample <= my nx);
-			for (long i = 1; i <= half_nsampFFT; i ++) {
-				spec [i] = 0.0;
+		/*
+		 * The frames are analysed in parallel, in chunks whose frames are Fourier-transformed as a batch.
+		 * The FFT table and the window are shared (read-only) by all threads;
+		 * every thread has its own frames, spectra and FFT workspace.
+		 */
+		const long numberOfFramesPerChunk = 16;
+		const long numberOfChunks = (numberOfTimes - 1) / numberOfFramesPerChunk + 1;
+		long numberOfThreads = MelderThread_getNumberOfThreads ();
+		if (numberOfThreads > numberOfChunks) numberOfThreads = numberOfChunks;
+		autoNUMmatrix <double> frames (1, numberOfThreads * numberOfFramesPerChunk, 1, nsampFFT);
+		autoNUMmatrix <double> specs (1, numberOfThreads * numberOfFramesPerChunk, 1, half_nsampFFT + 1);
+		autoNUMmatrix <double> fftWorkspaces (1, numberOfThreads, 1, NUMfft_Table_getBatchWorkspaceSize (& fftTable));
+
+		std::atomic <long> numberOfFramesDone (0);
+		MelderThread_parallelFor (1, numberOfTimes, numberOfFramesPerChunk, [&] (long firstFrame, long lastFrame, int threadNumber) {
+			Melder_assert (threadNumber <= numberOfThreads);
+			Melder_assert (lastFrame - firstFrame < numberOfFramesPerChunk);
+			long numberOfFramesInChunk = lastFrame - firstFrame + 1;
+			double **chunkFrames = frames.peek() + (threadNumber - 1) * numberOfFramesPerChunk;   // chunkFrames [1..numberOfFramesInChunk]
+			double **chunkSpecs = specs.peek() + (threadNumber - 1) * numberOfFramesPerChunk;
+			double *fftWorkspace = fftWorkspaces [threadNumber];
+			for (long ichunkFrame = 1; ichunkFrame <= numberOfFramesInChunk; ichunkFrame ++) {
+				double *spec = chunkSpecs [ichunkFrame];
+				for (long i = 1; i <= half_nsampFFT; i ++) {
+					spec [i] = 0.0;
+				}
 			}
 			for (long channel = 1; channel <= my ny; channel ++) {
-				for (long j = 1, i = startSample; j <= nsamp_window; j ++) {
-					frame [j] = my z [channel] [i ++] * window [j];
+				for (long ichunkFrame = 1; ichunkFrame <= numberOfFramesInChunk; ichunkFrame ++) {
+					long iframe = firstFrame + ichunkFrame - 1;
+					double *frame = chunkFrames [ichunkFrame];
+					double t = Sampled_indexToX (thee.get(), iframe);
+					long leftSample = Sampled_xToLowIndex (me, t), rightSample = leftSample + 1;
+					long startSample = rightSample - halfnsamp_window;
+					long endSample = leftSample + halfnsamp_window;
+					Melder_assert (startSample >= 1);
+					Melder_assert (endSample <= my nx);
+					for (long j = 1, i = startSample; j <= nsamp_window; j ++) {
+						frame [j] = my z [channel] [i ++] * window [j];
+					}
+					for (long j = nsamp_window + 1; j <= nsampFFT; j ++) frame [j] = 0.0f;
 				}
-				for (long j = nsamp_window + 1; j <= nsampFFT; j ++) frame [j] = 0.0f;
 
-				Melder_progress (iframe / (numberOfTimes + 1.0),
-					U"Sound to Spectrogram: analysis of frame ", iframe, U" out of ", numberOfTimes);
+				/* Compute Fast Fourier Transforms of the frames. */
 
-				/* Compute Fast Fourier Transform of the frame. */
+				NUMfft_forward_batch (& fftTable, numberOfFramesInChunk, chunkFrames, fftWorkspace);   // complex spectra
 
-				NUMfft_forward (& fftTable, frame.peek());   // complex spectrum
+				/* Add power spectra into spec [1..half_nsampFFT + 1]. */
 
-				/* Put power spectrum in frame [1..half_nsampFFT + 1]. */
-
-				spec [1] += frame [1] * frame [1];   // DC component
-				for (long i = 2; i <= half_nsampFFT; i ++)
-					spec [i] += frame [i + i - 2] * frame [i + i - 2] + frame [i + i - 1] * frame [i + i - 1];
-				spec [half_nsampFFT + 1] += frame [nsampFFT] * frame [nsampFFT];   // Nyquist frequency. Correct??
-			}
-			if (my ny > 1 ) for (long i = 1; i <= half_nsampFFT; i ++) {
-				spec [i] /= my ny;
+				for (long ichunkFrame = 1; ichunkFrame <= numberOfFramesInChunk; ichunkFrame ++) {
+					double *frame = chunkFrames [ichunkFrame], *spec = chunkSpecs [ichunkFrame];
+					spec [1] += frame [1] * frame [1];   // DC component
+					for (long i = 2; i <= half_nsampFFT; i ++)
+						spec [i] += frame [i + i - 2] * frame [i + i - 2] + frame [i + i - 1] * frame [i + i - 1];
+					spec [half_nsampFFT + 1] += frame [nsampFFT] * frame [nsampFFT];   // Nyquist frequency. Correct??
+				}
 			}
+			for (long ichunkFrame = 1; ichunkFrame <= numberOfFramesInChunk; ichunkFrame ++) {
+				long iframe = firstFrame + ichunkFrame - 1;
+				double *spec = chunkSpecs [ichunkFrame];
+				if (my ny > 1 ) for (long i = 1; i <= half_nsampFFT; i ++) {
+					spec [i] /= my ny;
+				}
 
-			/* Bin into frame [1..nBands]. */
-			for (long iband = 1; iband <= numberOfFreqs; iband ++) {
-				long leftsample = (iband - 1) * binWidth_samples + 1, rightsample = leftsample + binWidth_samples;
-				float power = 0.0f;
-				for (long i = leftsample; i < rightsample; i ++) power += spec [i];
-				thy z [iband] [iframe] = power * oneByBinWidth;
+				/* Bin into frame [1..nBands]. */
+				for (long iband = 1; iband <= numberOfFreqs; iband ++) {
+					long leftsample = (iband - 1) * binWidth_samples + 1, rightsample = leftsample + binWidth_samples;
+					float power = 0.0f;
+					for (long i = leftsample; i < rightsample; i ++) power += spec [i];
+					thy z [iband] [iframe] = power * oneByBinWidth;
+				}
 			}
-		}
+			long numberOfFramesDoneSoFar = numberOfFramesDone += lastFrame - firstFrame + 1;
+			if (MelderThread_isMainThread ())
+				Melder_progress (numberOfFramesDoneSoFar / (numberOfTimes + 1.0),
+					U"Sound to Spectrogram: analysed ", numberOfFramesDoneSoFar, U" out of ", numberOfTimes, U" frames");
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": spectrogram analysis not performed.");
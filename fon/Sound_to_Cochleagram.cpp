@@ -31,6 +31,24 @@
 #include "Sound_to_Cochleagram.h"
 #include "Sound_and_Spectrum.h"
 #include "Spectrum_to_Excitation.h"
+#include "NUM2.h"
+#include "MelderThread.h"
+#include <atomic>
+
+Thing_define (Sound_to_Cochleagram_Workspace, Thing) { public:
+	autoNUMvector <double> fft, fftWorkspace, inSig, outSig;
+};
+
+Thing_implement (Sound_to_Cochleagram_Workspace, Thing, 0);
+
+static autoSound_to_Cochleagram_Workspace Sound_to_Cochleagram_Workspace_create (NUMfft_Table fftTable, long nbark) {
+	autoSound_to_Cochleagram_Workspace me = Thing_new (Sound_to_Cochleagram_Workspace);
+	my fft.reset (1, fftTable -> n);
+	my fftWorkspace.reset (1, NUMfft_Table_getWorkspaceSize (fftTable));
+	my inSig.reset (1, nbark);
+	my outSig.reset (1, 2 * nbark);
+	return me;
+}
 
 autoCochleagram Sound_to_Cochleagram (Sound me, double dt, double df, double dt_window, double forwardMaskingTime) {
 	try {
@@ -45,7 +63,8 @@ autoCochleagram Sound_to_Cochleagram (Sound me, double dt, double df, double dt_
 		if (nFrames < 2) return autoCochleagram ();
 		double t1 = my x1 + 0.5 * (duration - my dx - (nFrames - 1) * dt);   // centre of first frame
 		autoCochleagram thee = Cochleagram_create (my xmin, my xmax, nFrames, dt, t1, df, nf);
-		autoSound window = Sound_createSimple (1, nsamp_window * my dx, 1.0 / my dx);
+
+		autoNUMvector <long> startSamples (1, nFrames);
 		for (long iframe = 1; iframe <= nFrames; iframe ++) {
 			double t = Sampled_indexToX (thee.get(), iframe);
 			long leftSample = Sampled_xToLowIndex (me, t);
@@ -63,45 +82,180 @@ autoCochleagram Sound_to_Cochleagram (Sound me, double dt, double df, double dt_
 					U".");
 				endSample = my nx;
 			}
+			startSamples [iframe] = startSample;
+		}
 
-			/* Copy a window to a frame. */
-			for (long i = 1; i <= nsamp_window; i ++)
-				window -> z [1] [i] =
-					( my ny == 1 ? my z[1][i+startSample-1] : 0.5 * (my z[1][i+startSample-1] + my z[2][i+startSample-1]) ) *
-					(0.5 - 0.5 * cos (2.0 * NUMpi * i / (nsamp_window + 1)));
-			autoSpectrum spec = Sound_to_Spectrum (window.get(), true);
-			autoExcitation excitation = Spectrum_to_Excitation (spec.get(), df);
-			for (long ifreq = 1; ifreq <= nf; ifreq ++)
-				thy z [ifreq] [iframe] = excitation -> z [1] [ifreq] + ( iframe > 1 ? dampingFactor * thy z [ifreq] [iframe - 1] : 0 );
+		/*
+			Everything that Sound_to_Spectrum and Spectrum_to_Excitation would compute anew for every frame,
+			but that is the same for all frames.
+		*/
+		autoNUMvector <double> window (1, nsamp_window);
+		for (long i = 1; i <= nsamp_window; i ++)
+			window [i] = 0.5 - 0.5 * cos (2.0 * NUMpi * i / (nsamp_window + 1));
+		long nfft = 2;
+		while (nfft < nsamp_window) nfft *= 2;
+		autoNUMfft_Table fftTable;
+		NUMfft_Table_init (& fftTable, nfft);
+		long numberOfFrequencies = nfft / 2 + 1;
+		double windowDx = 1.0 / (1.0 / my dx);
+		double scaling = windowDx, spectrumDx = 1.0 / (windowDx * nfft);
+
+		long nbark = (long) floor (25.6 / df + 0.5), halfnbark = nbark / 2;
+		Melder_assert (nf <= nbark);
+		autoNUMvector <double> auditoryFilter (1, nbark);
+		for (long i = 1; i <= nbark; i ++) {
+			double bark = df * (i - nbark/2) + 0.474;
+			auditoryFilter [i] = pow (10, (1.581 + 0.75 * bark - 1.75 * sqrt (1 + bark * bark)));
+		}
+		autoNUMvector <double> rFreqs (1, nbark + 1);
+		autoNUMvector <long> iFreqs (1, nbark + 1);
+		for (long i = 1; i <= nbark + 1; i ++) {
+			rFreqs [i] = Excitation_barkToHertz (df * (i - 1));
+			iFreqs [i] = (long) round (rFreqs [i] / spectrumDx + 1.0);
+		}
+
+		const long numberOfFramesPerChunk = 16;
+		long numberOfThreads = MelderThread_getNumberOfThreads ();
+		long numberOfChunks = (nFrames - 1) / numberOfFramesPerChunk + 1;
+		if (numberOfThreads > numberOfChunks) numberOfThreads = numberOfChunks;
+		std::vector <autoSound_to_Cochleagram_Workspace> workspaces;
+		for (long ithread = 1; ithread <= numberOfThreads; ithread ++)
+			workspaces. push_back (Sound_to_Cochleagram_Workspace_create (& fftTable, nbark));
+
+		/*
+			The excitation of every frame, computed as by Sound_to_Spectrum and Spectrum_to_Excitation
+			(in the same order, so with the same result), but without creating any objects.
+		*/
+		MelderThread_parallelFor (1, nFrames, numberOfFramesPerChunk, [&] (long firstFrame, long lastFrame, int threadNumber) {
+			Sound_to_Cochleagram_Workspace workspace = workspaces [threadNumber - 1]. get ();
+			double *data = workspace -> fft.peek(), *inSig = workspace -> inSig.peek(), *outSig = workspace -> outSig.peek();
+			for (long iframe = firstFrame; iframe <= lastFrame; iframe ++) {
+				long offset = startSamples [iframe] - 1;
+				for (long i = 1; i <= nsamp_window; i ++)
+					data [i] = ( my ny == 1 ? my z[1][i+offset] : 0.5 * (my z[1][i+offset] + my z[2][i+offset]) ) * window [i];
+				for (long i = nsamp_window + 1; i <= nfft; i ++)
+					data [i] = 0.0;
+				NUMfft_forward_withWorkspace (& fftTable, data, workspace -> fftWorkspace.peek());
+
+				for (long i = 1; i <= nbark; i ++) {
+					long low = iFreqs [i], high = iFreqs [i + 1] - 1;
+					if (low < 1) low = 1;
+					if (high > numberOfFrequencies) high = numberOfFrequencies;
+					inSig [i] = 0.0;
+					for (long j = low; j <= high; j ++) {
+						double re = ( j == 1 ? data [1] : j == numberOfFrequencies ? data [nfft] : data [j + j - 2] ) * scaling;
+						double im = ( j == 1 || j == numberOfFrequencies ? 0.0 : data [j + j - 1] * scaling );
+						inSig [i] += re * re + im * im;   // Pa2 s2
+					}
+					if (high >= low)
+						inSig [i] *= 2.0 * (rFreqs [i + 1] - rFreqs [i]) / (high - low + 1) * spectrumDx;   // Pa2: power density in this band
+				}
+
+				/*
+					Convolution with the auditory (masking) filter,
+					only for the elements outSig [halfnbark + 1 .. halfnbark + nbark] that are used.
+				*/
+				for (long k = halfnbark + 1; k <= halfnbark + nbark; k ++)
+					outSig [k] = 0.0;
+				for (long i = 1; i <= nbark; i ++) {
+					long jmin = halfnbark + 1 - i, jmax = halfnbark + nbark - i;
+					if (jmin < 1) jmin = 1;
+					if (jmax > nbark) jmax = nbark;
+					for (long j = jmin; j <= jmax; j ++)
+						outSig [i + j] += inSig [i] * auditoryFilter [j];
+				}
+
+				for (long ifreq = 1; ifreq <= nf; ifreq ++)
+					thy z [ifreq] [iframe] = Excitation_soundPressureToPhon (sqrt (outSig [ifreq + halfnbark]), 0.5 * df + (ifreq - 1) * df);
+			}
+		});
+
+		for (long ifreq = 1; ifreq <= nf; ifreq ++) {
+			double *excitation = thy z [ifreq];
+			for (long iframe = 2; iframe <= nFrames; iframe ++)
+				excitation [iframe] += dampingFactor * excitation [iframe - 1];
+			for (long iframe = 1; iframe <= nFrames; iframe ++)
+				excitation [iframe] *= integrationCorrection;
 		}
-		for (long iframe = 1; iframe <= nFrames; iframe ++)
-			for (long ifreq = 1; ifreq <= nf; ifreq ++)
-				thy z [ifreq] [iframe] *= integrationCorrection;
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": not converted to Cochleagram.");
 	}
 }
 
-static autoSound createGammatone (double midFrequency_Hertz, double samplingFrequency) {
+static long getGammatoneLength (double midFrequency_Hertz, double samplingFrequency) {
 	double lengthOfGammatone_seconds = 50.0 / midFrequency_Hertz;   // 50 periods
-	long lengthOfGammatone_samples;
+	return (long) (int32_t) round (lengthOfGammatone_seconds * samplingFrequency);   // as in Sound_createSimple
+}
+
+static void fillGammatone (double midFrequency_Hertz, double samplingFrequency, double gammatone [], long lengthOfGammatone_samples) {
 	/* EdB's alfa1: */
 	double latency = 1.95e-3 * pow (midFrequency_Hertz / 1000, -0.725) + 0.6e-3;
 	/* EdB's beta: */
 	double decayTime = 1e-3 * pow (midFrequency_Hertz / 1000, -0.663);
 	/* EdB's omega: */
 	double midFrequency_radPerSecond = 2 * NUMpi * midFrequency_Hertz;
-	autoSound gammatone = Sound_createSimple (1, lengthOfGammatone_seconds, samplingFrequency);
-	lengthOfGammatone_samples = gammatone -> nx;
 	for (long itime = 1; itime <= lengthOfGammatone_samples; itime ++) {
 		double time_seconds = (itime - 0.5) / samplingFrequency;
 		double timeAfterLatency = time_seconds - latency;
 		double x = timeAfterLatency / decayTime;
-		if (time_seconds > latency) gammatone -> z [1] [itime] =
-			x * x * x * exp (- x) * cos (midFrequency_radPerSecond * timeAfterLatency);
+		gammatone [itime] = time_seconds > latency ?
+			x * x * x * exp (- x) * cos (midFrequency_radPerSecond * timeAfterLatency) : 0.0;
+	}
+}
+
+Thing_define (Sound_to_Cochleagram_edb_Workspace, Thing) { public:
+	autoNUMvector <double> gammatone, block, fftWorkspace, basil;
+};
+
+Thing_implement (Sound_to_Cochleagram_edb_Workspace, Thing, 0);
+
+static autoSound_to_Cochleagram_edb_Workspace Sound_to_Cochleagram_edb_Workspace_create (long maximumFFTSize, long maximumFFTWorkspaceSize, long maximumResponseLength) {
+	autoSound_to_Cochleagram_edb_Workspace me = Thing_new (Sound_to_Cochleagram_edb_Workspace);
+	my gammatone.reset (1, maximumFFTSize);
+	my block.reset (1, maximumFFTSize);
+	my fftWorkspace.reset (1, maximumFFTWorkspaceSize);
+	my basil.reset (1, maximumResponseLength);
+	return me;
+}
+
+/*
+	The convolution of x [1..nx] with the gammatone, whose Fourier transform (of size fftTable -> n)
+	is in gammatone [1..nfft], goes into basil [1..nx + lengthOfGammatone - 1].
+	For a signal that is much longer than the gammatone, the signal is cut into blocks
+	of nfft - lengthOfGammatone + 1 samples, whose convolutions overlap and are added (overlap-add),
+	so that the transforms stay short; otherwise there is a single block.
+	The result is scaled as with kSounds_convolve_scaling_SUM.
+*/
+static void convolveWithGammatone (const double x [], long nx, const double gammatone [], long lengthOfGammatone,
+	NUMfft_Table fftTable, double block [], double fftWorkspace [], double basil [])
+{
+	long nfft = fftTable -> n, blockLength = nfft - lengthOfGammatone + 1, responseLength = nx + lengthOfGammatone - 1;
+	double scaling = 1.0 / nfft;
+	for (long i = 1; i <= responseLength; i ++)
+		basil [i] = 0.0;
+	for (long blockStart = 1; blockStart <= nx; blockStart += blockLength) {
+		long numberOfSamplesInBlock = nx - blockStart + 1;
+		if (numberOfSamplesInBlock > blockLength) numberOfSamplesInBlock = blockLength;
+		for (long i = 1; i <= numberOfSamplesInBlock; i ++)
+			block [i] = x [blockStart - 1 + i];
+		for (long i = numberOfSamplesInBlock + 1; i <= nfft; i ++)
+			block [i] = 0.0;
+		NUMfft_forward_withWorkspace (fftTable, block, fftWorkspace);
+		block [1] *= gammatone [1];
+		block [nfft] *= gammatone [nfft];
+		for (long i = 2; i < nfft; i += 2) {
+			double temp = block [i] * gammatone [i] - block [i + 1] * gammatone [i + 1];
+			block [i + 1] = block [i] * gammatone [i + 1] + block [i + 1] * gammatone [i];
+			block [i] = temp;
+		}
+		NUMfft_backward_withWorkspace (fftTable, block, fftWorkspace);
+		long numberOfOutputSamples = responseLength - blockStart + 1;
+		if (numberOfOutputSamples > numberOfSamplesInBlock + lengthOfGammatone - 1)
+			numberOfOutputSamples = numberOfSamplesInBlock + lengthOfGammatone - 1;
+		for (long i = 1; i <= numberOfOutputSamples; i ++)
+			basil [blockStart - 1 + i] += block [i] * scaling;
 	}
-	return gammatone;
 }
 
 autoCochleagram Sound_to_Cochleagram_edb
@@ -117,92 +271,156 @@ autoCochleagram Sound_to_Cochleagram_edb
 
 		autoCochleagram thee = Cochleagram_create (my xmin, my xmax, ntime, dtime, 0.5 * dtime, dfreq, nfreq);
 
-		/* Stages 1 and 2: outer- and middle-ear filtering. */
-		/* From acoustic sound to oval window. */
-
+		/*
+			The channels are independent, so they are computed in parallel.
+			The FFT size of each channel is a power of two, at least four times the length of its gammatone
+			(or large enough for the whole convolution, if that is smaller),
+			so that a few tables serve all channels.
+		*/
+		double samplingFrequency = 1.0 / my dx;
+		autoNUMvector <double> midFrequencies (1, nfreq);
+		autoNUMvector <long> gammatoneLengths (1, nfreq), fftSizeExponents (1, nfreq);
+		const long maximumFFTSizeExponent = 8 * sizeof (long) - 2;
+		autoNUMfft_Table fftTables [1 + maximumFFTSizeExponent];
+		long maximumFFTSize = 2, maximumFFTWorkspaceSize = 2, maximumResponseLength = 1;
 		for (long ifreq = 1; ifreq <= nfreq; ifreq ++) {
-			double *response = thy z [ifreq];
+			double midFrequency_Bark = (ifreq - 0.5) * dfreq;
+			midFrequencies [ifreq] = Excitation_barkToHertz (midFrequency_Bark);
+			long lengthOfGammatone = gammatoneLengths [ifreq] = getGammatoneLength (midFrequencies [ifreq], samplingFrequency);
+			if (lengthOfGammatone < 1)
+				Melder_throw (U"The gammatone at ", midFrequencies [ifreq], U" Hz is shorter than one sample.");
+			long responseLength = my nx + lengthOfGammatone - 1;
+			long nfft = 2, exponent = 1;
+			while (nfft < responseLength && nfft < 4 * lengthOfGammatone) {
+				if (exponent == maximumFFTSizeExponent)
+					Melder_throw (U"The gammatone at ", midFrequencies [ifreq], U" Hz is too long.");
+				nfft *= 2;
+				exponent ++;
+			}
+			fftSizeExponents [ifreq] = exponent;
+			if (fftTables [exponent]. n == 0) {
+				NUMfft_Table_init (& fftTables [exponent], nfft);
+				long fftWorkspaceSize = NUMfft_Table_getWorkspaceSize (& fftTables [exponent]);
+				if (fftWorkspaceSize > maximumFFTWorkspaceSize) maximumFFTWorkspaceSize = fftWorkspaceSize;
+			}
+			if (nfft > maximumFFTSize) maximumFFTSize = nfft;
+			if (responseLength > maximumResponseLength) maximumResponseLength = responseLength;
+		}
 
-			/* Stage 3: basilar membrane filtering by gammatones. */
-			/* From oval window to basilar membrane response. */
+		long numberOfThreads = MelderThread_getNumberOfThreads ();
+		if (numberOfThreads > nfreq) numberOfThreads = nfreq;
+		std::vector <autoSound_to_Cochleagram_edb_Workspace> workspaces;
+		for (long ithread = 1; ithread <= numberOfThreads; ithread ++)
+			workspaces. push_back (Sound_to_Cochleagram_edb_Workspace_create (maximumFFTSize, maximumFFTWorkspaceSize, maximumResponseLength));
 
-			double midFrequency_Bark = (ifreq - 0.5) * dfreq;
-			double midFrequency_Hertz = Excitation_barkToHertz (midFrequency_Bark);
-			autoSound gammatone = createGammatone (midFrequency_Hertz, 1.0 / my dx);
-			autoSound basil = Sounds_convolve (me, gammatone.get(), kSounds_convolve_scaling_SUM, kSounds_convolve_signalOutsideTimeDomain_ZERO);
-
-			/* Stage 4: detection = rectify + integrate + low-pass 500 Hz. */
-			/* From basilar membrane response to firing rate. */
-
-			if (hasSynapse) {
-				double dt = my dx;
-				double M = 1.0;   // maximum free transmitter
-				double A = 5.0, B = 300.0, g = 2000.0;   // determine permeability
-				double y = replenishmentRate;            // Meddis: 5.05
-				double l = lossRate, r = returnRate;     // Meddis: 2500, 6580
-				double x = reprocessingRate;             // Meddis: 66.31
-				double h = 50000;   // convert cleft contents to firing rate
-				double gdt = 1.0 - exp (- g * dt);
-				double ydt = 1.0 - exp (- y * dt);
-				double ldt = (1.0 - exp (- (l + r) * dt)) * l / (l + r);
-				double rdt = (1.0 - exp (- (l + r) * dt)) * r / (l + r);
-				double xdt = 1.0 - exp (- x * dt);
-				double kt = g * A / (A + B);   // membrane permeability
-				double c = M * y * kt / (l * kt + y * (l + r));   // cleft contents
-				double q = c * (l + r) / kt;   // free transmitter
-				double w = c * r / x;   // reprocessing store
-				for (long itime = 1; itime <= basil -> nx; itime ++) {
-					double splusA = basil -> z [1] [itime] * 10.0 + A;
-					double replenish = ( M > q ? ydt * (M - q) : 0.0 );
-					kt = ( splusA > 0.0 ? gdt * splusA / (splusA + B) : 0.0 );
-					double eject = kt * q;
-					double loss = ldt * c;
-					double reuptake = rdt * c;
-					double reprocess = xdt * w;
-					q = q + replenish - eject + reprocess;
-					c = c + eject - loss - reuptake;
-					w = w + reuptake - reprocess;
-					basil -> z [1] [itime] = h * c;
+		/*
+			The basilar-membrane response of each channel starts half a sample later than the sound,
+			as does the result of Sounds_convolve with a gammatone.
+		*/
+		double basil_x1 = my x1 + 0.5 / samplingFrequency;
+		std::atomic <long> numberOfSamplesOutsideResponse (0);
+		MelderThread_parallelFor (1, nfreq, 1, [&] (long firstChannel, long lastChannel, int threadNumber) {
+			Sound_to_Cochleagram_edb_Workspace workspace = workspaces [threadNumber - 1]. get ();
+			for (long ifreq = firstChannel; ifreq <= lastChannel; ifreq ++) {
+				double *response = thy z [ifreq];
+
+				/* Stages 1 and 2: outer- and middle-ear filtering. */
+				/* From acoustic sound to oval window. */
+
+				/* Stage 3: basilar membrane filtering by gammatones. */
+				/* From oval window to basilar membrane response. */
+
+				NUMfft_Table fftTable = & fftTables [fftSizeExponents [ifreq]];
+				long nfft = fftTable -> n, lengthOfGammatone = gammatoneLengths [ifreq];
+				double *gammatone = workspace -> gammatone.peek(), *basil = workspace -> basil.peek();
+				fillGammatone (midFrequencies [ifreq], samplingFrequency, gammatone, lengthOfGammatone);
+				for (long i = lengthOfGammatone + 1; i <= nfft; i ++)
+					gammatone [i] = 0.0;
+				NUMfft_forward_withWorkspace (fftTable, gammatone, workspace -> fftWorkspace.peek());
+				convolveWithGammatone (my z [1], my nx, gammatone, lengthOfGammatone,
+					fftTable, workspace -> block.peek(), workspace -> fftWorkspace.peek(), basil);
+				long basil_nx = my nx + lengthOfGammatone - 1;
+
+				/* Stage 4: detection = rectify + integrate + low-pass 500 Hz. */
+				/* From basilar membrane response to firing rate. */
+
+				if (hasSynapse) {
+					double dt = my dx;
+					double M = 1.0;   // maximum free transmitter
+					double A = 5.0, B = 300.0, g = 2000.0;   // determine permeability
+					double y = replenishmentRate;            // Meddis: 5.05
+					double l = lossRate, r = returnRate;     // Meddis: 2500, 6580
+					double x = reprocessingRate;             // Meddis: 66.31
+					double h = 50000;   // convert cleft contents to firing rate
+					double gdt = 1.0 - exp (- g * dt);
+					double ydt = 1.0 - exp (- y * dt);
+					double ldt = (1.0 - exp (- (l + r) * dt)) * l / (l + r);
+					double rdt = (1.0 - exp (- (l + r) * dt)) * r / (l + r);
+					double xdt = 1.0 - exp (- x * dt);
+					double kt = g * A / (A + B);   // membrane permeability
+					double c = M * y * kt / (l * kt + y * (l + r));   // cleft contents
+					double q = c * (l + r) / kt;   // free transmitter
+					double w = c * r / x;   // reprocessing store
+					for (long itime = 1; itime <= basil_nx; itime ++) {
+						double splusA = basil [itime] * 10.0 + A;
+						double replenish = ( M > q ? ydt * (M - q) : 0.0 );
+						kt = ( splusA > 0.0 ? gdt * splusA / (splusA + B) : 0.0 );
+						double eject = kt * q;
+						double loss = ldt * c;
+						double reuptake = rdt * c;
+						double reprocess = xdt * w;
+						q = q + replenish - eject + reprocess;
+						c = c + eject - loss - reuptake;
+						w = w + reuptake - reprocess;
+						basil [itime] = h * c;
+					}
 				}
-			}
-			
-			if (dtime == my dx) {
-				for (long itime = 1; itime <= ntime; itime ++)
-					response [itime] = basil -> z [1] [itime];
-			} else {
-				double d = dtime / basil -> dx / 2;
-				double factor = -6 / d / d;
-				double area = d * sqrt (NUMpi / 6);
-				double expmin6 = exp (-6), onebyoneminexpmin6 = 1 / (1 - expmin6);
-				for (long itime = 1; itime <= ntime; itime ++) {
-					double t1 = (itime - 1) * dtime;
-					double t2 = t1 + dtime;
-					double mean = 0.0;
-					long i1, i2;
-					long n = Matrix_getWindowSamplesX (basil.get(), t1, t2, & i1, & i2);
-					Melder_assert (n >= 1);
-					if (n <= 2) {
-						for (long isamp = i1; isamp <= i2; isamp ++)
-							mean += basil -> z [1] [isamp];
-						mean /= n;
-					} else {
-						double mu = floor ((i1 + i2) / 2.0);
-						long muint = (long) mu, dint = (long) d;
-						for (long isamp = muint - dint; isamp <= muint + dint; isamp ++) {
-							double y = 0;
-							if (isamp < 1 || isamp > basil -> nx)
-								Melder_casual (U"isamp ", isamp);
-							else
-								y = basil -> z [1] [isamp];
-							mean += y * onebyoneminexpmin6 * (exp (factor * (isamp - muint) *
-								(isamp - muint)) - expmin6);
+
+				if (dtime == my dx) {
+					for (long itime = 1; itime <= ntime; itime ++)
+						response [itime] = basil [itime];
+				} else {
+					double d = dtime / my dx / 2;
+					double factor = -6 / d / d;
+					double area = d * sqrt (NUMpi / 6);
+					double expmin6 = exp (-6), onebyoneminexpmin6 = 1 / (1 - expmin6);
+					long numberOfSamplesOutsideThisResponse = 0;
+					for (long itime = 1; itime <= ntime; itime ++) {
+						double t1 = (itime - 1) * dtime;
+						double t2 = t1 + dtime;
+						double mean = 0.0;
+						long i1 = 1 + (long) ceil ((t1 - basil_x1) / my dx), i2 = 1 + (long) floor ((t2 - basil_x1) / my dx);   // as Matrix_getWindowSamplesX
+						if (i1 < 1) i1 = 1;
+						if (i2 > basil_nx) i2 = basil_nx;
+						long n = i2 - i1 + 1;
+						Melder_assert (n >= 1);
+						if (n <= 2) {
+							for (long isamp = i1; isamp <= i2; isamp ++)
+								mean += basil [isamp];
+							mean /= n;
+						} else {
+							double mu = floor ((i1 + i2) / 2.0);
+							long muint = (long) mu, dint = (long) d;
+							for (long isamp = muint - dint; isamp <= muint + dint; isamp ++) {
+								double y = 0;
+								if (isamp < 1 || isamp > basil_nx)
+									numberOfSamplesOutsideThisResponse ++;
+								else
+									y = basil [isamp];
+								mean += y * onebyoneminexpmin6 * (exp (factor * (isamp - muint) *
+									(isamp - muint)) - expmin6);
+							}
+							mean /= area;
 						}
-						mean /= area;
+						response [itime] = mean;
 					}
-					response [itime] = mean;
+					numberOfSamplesOutsideResponse += numberOfSamplesOutsideThisResponse;
 				}
 			}
-		}
+		});
+		if (numberOfSamplesOutsideResponse > 0)
+			Melder_casual (U"Sound_to_Cochleagram_edb: ", (long) numberOfSamplesOutsideResponse,
+				U" samples outside the basilar membrane responses were taken as zero.");
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": not converted to Cochleagram (edb).");
@@ -31,17 +31,49 @@
 #include "Sound_to_Formant.h"
 #include "NUM2.h"
 #include "Polynomial.h"
+#include "MelderThread.h"
+#include <atomic>
 
+/*
+	Scratch space for one thread. Allocated before the threads start, so that no thread ever has to allocate memory.
+	A thread cannot warn or throw either, so it counts its problems here, and the main thread reports them afterwards.
+*/
+Thing_define (Sound_to_Formant_Workspace, Thing) { public:
+	autoNUMvector <double> frame, cof;
+	autoPolynomial polynomial;
+	autoRoots roots;
+	autoNUMvector <double> burgWorkspace, rootsWorkspace;
+	long numberOfFramesWithInfinities, numberOfFramesWithoutRoots, numberOfFramesWithMissingRoots, numberOfWrongFrames;
+};
+
+Thing_implement (Sound_to_Formant_Workspace, Thing, 0);
+
+static autoSound_to_Formant_Workspace Sound_to_Formant_Workspace_create (long nsamp_window, int numberOfPoles) {
+	autoSound_to_Formant_Workspace me = Thing_new (Sound_to_Formant_Workspace);
+	my frame.reset (1, nsamp_window);
+	my cof.reset (1, numberOfPoles);   // superfluous if which==2, but nobody uses that anyway
+	my polynomial = Polynomial_create (-1, 1, numberOfPoles);
+	my roots = Roots_create (numberOfPoles);
+	my burgWorkspace.reset (1, 2 * nsamp_window + numberOfPoles);
+	my rootsWorkspace.reset (1, numberOfPoles * (numberOfPoles + 3));
+	return me;
+}
+
+/*
+	The analysis of a frame puts at most numberOfPoles formants into formant [1..numberOfPoles] and their number into *numberOfFormants;
+	copying these into the Formant_Frame (which requires allocation) is left to the main thread.
+*/
 static void burg (double sample [], long nsamp_window, double cof [], int nPoles,
-	Formant_Frame frame, double nyquistFrequency, double safetyMargin)
+	Sound_to_Formant_Workspace workspace, Formant_Formant formant, long *numberOfFormants,
+	double nyquistFrequency, double safetyMargin)
 {
 	double a0;
-	NUMburg (sample, nsamp_window, cof, nPoles, & a0);
+	NUMburg_withWorkspace (sample, nsamp_window, cof, nPoles, & a0, workspace -> burgWorkspace.peek ());
 
 	/*
 	 * Convert LP coefficients to polynomial.
 	 */
-	autoPolynomial polynomial = Polynomial_create (-1, 1, nPoles);
+	Polynomial polynomial = workspace -> polynomial.get();
 	for (int i = 1; i <= nPoles; i ++)
 		polynomial -> coefficients [i] = - cof [nPoles - i + 1];
 	polynomial -> coefficients [nPoles + 1] = 1.0;
@@ -49,41 +81,32 @@ static void burg (double sample [], long nsamp_window, double cof [], int nPoles
 	/*
 	 * Find the roots of the polynomial.
 	 */
-	autoRoots roots = Polynomial_to_Roots (polynomial.get());
-	Roots_fixIntoUnitCircle (roots.get());
-
-	Melder_assert (frame -> nFormants == 0 && ! frame -> formant);
-
-	/*
-	 * First pass: count the formants.
-	 * The roots come in conjugate pairs, so we need only count those above the real axis.
-	 */
-	for (int i = roots -> min; i <= roots -> max; i ++) if (roots -> v [i]. im >= 0) {
-		double f = fabs (atan2 (roots -> v [i].im, roots -> v [i].re)) * nyquistFrequency / NUMpi;
-		if (f >= safetyMargin && f <= nyquistFrequency - safetyMargin)
-			frame -> nFormants ++;
+	Roots roots = workspace -> roots.get();
+	long numberOfRootsFound = Polynomial_into_Roots (polynomial, roots, & workspace -> rootsWorkspace [1]);
+	if (numberOfRootsFound < 1) {
+		workspace -> numberOfFramesWithoutRoots ++;
+		*numberOfFormants = 0;
+		return;
 	}
+	if (numberOfRootsFound < nPoles)
+		workspace -> numberOfFramesWithMissingRoots ++;
+	Roots_fixIntoUnitCircle (roots);
 
 	/*
-	 * Create space for formant data.
-	 */
-	if (frame -> nFormants > 0)
-		frame -> formant = NUMvector <structFormant_Formant> (1, frame -> nFormants);
-
-	/*
-	 * Second pass: fill in the formants.
+	 * Fill in the formants.
+	 * The roots come in conjugate pairs, so we need only count those above the real axis.
 	 */
-	int iformant = 0;
+	*numberOfFormants = 0;
 	for (int i = roots -> min; i <= roots -> max; i ++) if (roots -> v [i]. im >= 0.0) {
 		double f = fabs (atan2 (roots -> v [i].im, roots -> v [i].re)) * nyquistFrequency / NUMpi;
 		if (f >= safetyMargin && f <= nyquistFrequency - safetyMargin) {
-			Formant_Formant formant = & frame -> formant [++ iformant];
-			formant -> frequency = f;
-			formant -> bandwidth = -
+			Melder_assert (*numberOfFormants < nPoles);
+			Formant_Formant form = & formant [++ *numberOfFormants];
+			form -> frequency = f;
+			form -> bandwidth = -
 				log (roots -> v [i].re * roots -> v [i].re + roots -> v [i].im * roots -> v [i].im) * nyquistFrequency / NUMpi;
 		}
 	}
-	Melder_assert (iformant == frame -> nFormants);   // may fail if some frequency is NaN
 }
 
 static int findOneZero (int ijt, double vcx [], double a, double b, double *zero) {
@@ -93,16 +116,9 @@ static int findOneZero (int ijt, double vcx [], double a, double b, double *zero
 		fa = vcx [k] + a * fa;
 		fb = vcx [k] + b * fb;
 	}
-	if (fa * fb >= 0.0) {   // there should be a zero between a and b
-		Melder_casual (
-			U"There is no zero between ,", Melder_single (a),
-			U" and ", Melder_single (b),
-			U".\n    The function values are ", Melder_single (fa),
-			U" and ", Melder_single (fb),
-			U", respectively."
-		);
-		return 0;
-	}
+	if (fa * fb >= 0.0)   // there should be a zero between a and b
+		return 0;   // reported by the caller of splitLevinson
+
 	do {
 		fx = 0.0;
 		/*x = fa == fb ? 0.5 * (a + b) : a + fa * (a - b) / (fb - fa);*/
@@ -138,13 +154,8 @@ static int findNewZeroes (int ijt, double ppORIG [], int degree,
 	/* Fill an array with the new zeroes, which lie between the old zeroes. */
 	newZeroes [0] = 1.0;
 	for (i = 1; i <= half_degree; i ++) {
-		if (! findOneZero (ijt, px, zeroes [i - 1], zeroes [i], & newZeroes [i])) {
-			Melder_casual (
-				U"Degree ", degree,
-				U" not completed."
-			);
+		if (! findOneZero (ijt, px, zeroes [i - 1], zeroes [i], & newZeroes [i]))
 			return 0;
-		}
 	}
 	newZeroes [half_degree + 1] = -1.0;
 	/* Grow older. */
@@ -156,7 +167,7 @@ static int findNewZeroes (int ijt, double ppORIG [], int degree,
 static int splitLevinson (
 	double xw [], long nx,   // the windowed signal xw [1..nx]
 	int ncof,   // the coefficients cof [1..ncof]
-	Formant_Frame frame, double nyquistFrequency)   // put the results here
+	Formant_Formant formant, long *numberOfFormants, double nyquistFrequency)   // put the results here
 {
 	int result = 1;
 	double rx [100], zeroes [33];
@@ -211,23 +222,13 @@ static int splitLevinson (
 		}
 	}
 loopEnd:
-	/* First pass: count the poles. */
+	/* Fill in the poles. */
+	*numberOfFormants = 0;
 	for (int i = 1; i <= ncof / 2; i ++) {
 		if (zeroes [i] == 0.0 || zeroes [i] == -1.0) break;
-		frame -> nFormants ++;
-	}
-
-	/* Create space for formant data. */
-	if (frame -> nFormants > 0)
-	    frame -> formant = NUMvector <structFormant_Formant> (1, frame -> nFormants);
-
-	/* Second pass: fill in the poles. */
-	int iformant = 0;
-	for (int i = 1; i <= ncof / 2; i ++) {
-		Formant_Formant formant = & frame -> formant [++ iformant];
-		if (zeroes [i] == 0.0 || zeroes [i] == -1.0) break;
-		formant -> frequency =  acos (zeroes [i]) * nyquistFrequency / NUMpi;
-		formant -> bandwidth = 50.0;
+		Formant_Formant form = & formant [++ *numberOfFormants];
+		form -> frequency =  acos (zeroes [i]) * nyquistFrequency / NUMpi;
+		form -> bandwidth = 50.0;
 	}
 
 	return result;
@@ -284,8 +285,6 @@ static autoFormant Sound_to_Formant_any_inline (Sound me, double dt_in, int numb
 	}
 	autoFormant thee = Formant_create (my xmin, my xmax, nFrames, dt, t1, (numberOfPoles + 1) / 2);   // e.g. 11 poles -> maximally 6 formants
 	autoNUMvector <double> window (1, nsamp_window);
-	autoNUMvector <double> frame (1, nsamp_window);
-	autoNUMvector <double> cof (1, numberOfPoles);   // superfluous if which==2, but nobody uses that anyway
 
 	autoMelderProgress progress (U"Formant analysis...");
 
@@ -298,42 +297,96 @@ static autoFormant Sound_to_Formant_any_inline (Sound me, double dt_in, int numb
 		window [i] = (exp (-48.0 * (i - imid) * (i - imid) / (nsamp_window + 1) / (nsamp_window + 1)) - edge) / (1.0 - edge);
 	}
 
-	for (long iframe = 1; iframe <= nFrames; iframe ++) {
-		double t = Sampled_indexToX (thee.get(), iframe);
-		long leftSample = Sampled_xToLowIndex (me, t);
-		long rightSample = leftSample + 1;
-		long startSample = rightSample - halfnsamp_window;
-		long endSample = leftSample + halfnsamp_window;
-		double maximumIntensity = 0.0;
-		if (startSample < 1) startSample = 1;
-		if (endSample > my nx) endSample = my nx;
-		for (long i = startSample; i <= endSample; i ++) {
-			double value = Sampled_getValueAtSample (me, i, Sound_LEVEL_MONO, 0);
-			if (value * value > maximumIntensity) {
-				maximumIntensity = value * value;
+	/*
+	 * The frames are analysed in parallel. Every frame is independent of the others,
+	 * and every thread works in its own workspace, so the result does not depend on the number of threads.
+	 */
+	const long numberOfFramesPerChunk = 8;
+	const long numberOfChunks = (nFrames - 1) / numberOfFramesPerChunk + 1;
+	long numberOfThreads = MelderThread_getNumberOfThreads ();
+	if (numberOfThreads > numberOfChunks) numberOfThreads = numberOfChunks;
+	std::vector <autoSound_to_Formant_Workspace> workspaces;
+	for (long ithread = 1; ithread <= numberOfThreads; ithread ++)
+		workspaces. push_back (Sound_to_Formant_Workspace_create (nsamp_window, numberOfPoles));
+	autoNUMmatrix <structFormant_Formant> formants (1, nFrames, 1, numberOfPoles);
+	autoNUMvector <long> numberOfFormants (1, nFrames);
+
+	std::atomic <long> numberOfFramesDone (0);
+	MelderThread_parallelFor (1, nFrames, numberOfFramesPerChunk, [&] (long firstFrame, long lastFrame, int threadNumber) {
+		Melder_assert (threadNumber <= numberOfThreads);
+		Sound_to_Formant_Workspace workspace = workspaces [threadNumber - 1]. get ();
+		double *frame = workspace -> frame.peek();
+		for (long iframe = firstFrame; iframe <= lastFrame; iframe ++) {
+			double t = Sampled_indexToX (thee.get(), iframe);
+			long leftSample = Sampled_xToLowIndex (me, t);
+			long rightSample = leftSample + 1;
+			long startSample = rightSample - halfnsamp_window;
+			long endSample = leftSample + halfnsamp_window;
+			double maximumIntensity = 0.0;
+			if (startSample < 1) startSample = 1;
+			if (endSample > my nx) endSample = my nx;
+			for (long i = startSample; i <= endSample; i ++) {
+				double value = Sampled_getValueAtSample (me, i, Sound_LEVEL_MONO, 0);
+				if (value * value > maximumIntensity) {
+					maximumIntensity = value * value;
+				}
 			}
-		}
-		if (maximumIntensity == HUGE_VAL)
-			Melder_throw (U"Sound contains infinities.");
-		thy d_frames [iframe]. intensity = maximumIntensity;
-		if (maximumIntensity == 0.0) continue;   // Burg cannot stand all zeroes
-
-		/* Copy a pre-emphasized window to a frame. */
-		for (long j = 1, i = startSample; j <= nsamp_window; j ++)
-			frame [j] = Sampled_getValueAtSample (me, i ++, Sound_LEVEL_MONO, 0) * window [j];
-
-		if (which == 1) {
-			burg (frame.peek(), endSample - startSample + 1, cof.peek(), numberOfPoles, & thy d_frames [iframe], 0.5 / my dx, safetyMargin);
-		} else if (which == 2) {
-			if (! splitLevinson (frame.peek(), endSample - startSample + 1, numberOfPoles, & thy d_frames [iframe], 0.5 / my dx)) {
-				Melder_clearError ();
-				Melder_casual (U"(Sound_to_Formant:)"
-					U" Analysis results of frame ", iframe,
-					U" will be wrong."
-				);
+			if (maximumIntensity == HUGE_VAL) {
+				workspace -> numberOfFramesWithInfinities ++;
+				continue;
+			}
+			thy d_frames [iframe]. intensity = maximumIntensity;
+			if (maximumIntensity == 0.0) continue;   // Burg cannot stand all zeroes
+
+			/* Copy a pre-emphasized window to a frame. */
+			for (long j = 1, i = startSample; j <= nsamp_window; j ++)
+				frame [j] = Sampled_getValueAtSample (me, i ++, Sound_LEVEL_MONO, 0) * window [j];
+
+			if (which == 1) {
+				burg (frame, endSample - startSample + 1, workspace -> cof.peek(), numberOfPoles, workspace,
+					formants [iframe], & numberOfFormants [iframe], 0.5 / my dx, safetyMargin);
+			} else if (which == 2) {
+				if (! splitLevinson (frame, endSample - startSample + 1, numberOfPoles,
+					formants [iframe], & numberOfFormants [iframe], 0.5 / my dx))
+				{
+					workspace -> numberOfWrongFrames ++;
+				}
 			}
 		}
-		Melder_progress ((double) iframe / (double) nFrames, U"Formant analysis: frame ", iframe);
+		long numberOfFramesDoneSoFar = numberOfFramesDone += lastFrame - firstFrame + 1;
+		if (MelderThread_isMainThread ())
+			Melder_progress ((double) numberOfFramesDoneSoFar / (double) nFrames, U"Formant analysis: frame ", numberOfFramesDoneSoFar);
+	});
+
+	long numberOfFramesWithInfinities = 0, numberOfFramesWithoutRoots = 0, numberOfFramesWithMissingRoots = 0, numberOfWrongFrames = 0;
+	for (long ithread = 1; ithread <= numberOfThreads; ithread ++) {
+		Sound_to_Formant_Workspace workspace = workspaces [ithread - 1]. get ();
+		numberOfFramesWithInfinities += workspace -> numberOfFramesWithInfinities;
+		numberOfFramesWithoutRoots += workspace -> numberOfFramesWithoutRoots;
+		numberOfFramesWithMissingRoots += workspace -> numberOfFramesWithMissingRoots;
+		numberOfWrongFrames += workspace -> numberOfWrongFrames;
+	}
+	if (numberOfFramesWithInfinities > 0)
+		Melder_throw (U"Sound contains infinities.");
+	if (numberOfFramesWithoutRoots > 0)
+		Melder_throw (U"No roots found in ", numberOfFramesWithoutRoots, U" frames.");
+	if (numberOfFramesWithMissingRoots > 0)
+		Melder_warning (U"Not all roots were calculated in ", numberOfFramesWithMissingRoots, U" frames.");
+	if (numberOfWrongFrames > 0)
+		Melder_casual (U"(Sound_to_Formant:) Analysis results of ", numberOfWrongFrames, U" frames will be wrong.");
+
+	/*
+	 * Move the formants into the frames; this allocates memory, so we do it here in the main thread.
+	 */
+	for (long iframe = 1; iframe <= nFrames; iframe ++) {
+		Formant_Frame frame = & thy d_frames [iframe];
+		Melder_assert (frame -> nFormants == 0 && ! frame -> formant);
+		frame -> nFormants = numberOfFormants [iframe];
+		if (frame -> nFormants > 0) {
+			frame -> formant = NUMvector <structFormant_Formant> (1, frame -> nFormants);
+			for (long iformant = 1; iformant <= frame -> nFormants; iformant ++)
+				frame -> formant [iformant] = formants [iframe] [iformant];
+		}
 	}
 	Formant_sort (thee.get());
 	return thee;
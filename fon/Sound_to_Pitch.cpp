@@ -35,6 +35,7 @@
 #include "Sound_to_Pitch.h"
 #include "NUM2.h"
 #include "MelderThread.h"
+#include <atomic>
 
 #define AC_HANNING  0
 #define AC_GAUSS  1
@@ -242,102 +243,33 @@ static void Sound_into_PitchFrame (Sound me, Pitch_Frame pitchFrame, double t,
 	}
 }
 
-Thing_define (Sound_into_Pitch_Args, Thing) { public:
-	Sound sound;
-	Pitch pitch;
-	long firstFrame, lastFrame;
-	double minimumPitch;
-	int maxnCandidates, method;
-	double voicingThreshold, octaveCost, dt_window;
-	long nsamp_window, halfnsamp_window, maximumLag, nsampFFT, nsamp_period, halfnsamp_period, brent_ixmax, brent_depth;
-	double globalPeak, *window, *windowR;
-	bool isMainThread;
-	volatile int *cancelled;
-};
-
-Thing_implement (Sound_into_Pitch_Args, Thing, 0);
-
-static autoSound_into_Pitch_Args Sound_into_Pitch_Args_create (Sound sound, Pitch pitch,
-	long firstFrame, long lastFrame, double minimumPitch, int maxnCandidates, int method,
-	double voicingThreshold, double octaveCost,
-	double dt_window, long nsamp_window, long halfnsamp_window, long maximumLag, long nsampFFT,
-	long nsamp_period, long halfnsamp_period, long brent_ixmax, long brent_depth,
-	double globalPeak, double *window, double *windowR,
-	bool isMainThread, volatile int *cancelled)
-{
-	autoSound_into_Pitch_Args me = Thing_new (Sound_into_Pitch_Args);
-	my sound = sound;
-	my pitch = pitch;
-	my firstFrame = firstFrame;
-	my lastFrame = lastFrame;
-	my minimumPitch = minimumPitch;
-	my maxnCandidates = maxnCandidates;
-	my method = method;
-	my voicingThreshold = voicingThreshold;
-	my octaveCost = octaveCost;
-	my dt_window = dt_window;
-	my nsamp_window = nsamp_window;
-	my halfnsamp_window = halfnsamp_window;
-	my maximumLag = maximumLag;
-	my nsampFFT = nsampFFT;
-	my nsamp_period = nsamp_period;
-	my halfnsamp_period = halfnsamp_period;
-	my brent_ixmax = brent_ixmax;
-	my brent_depth = brent_depth;
-	my globalPeak = globalPeak;
-	my window = window;
-	my windowR = windowR;
-	my isMainThread = isMainThread;
-	my cancelled = cancelled;
-	return me;
-}
-
-MelderThread_MUTEX (mutex);
-bool mutex_inited;
-
-static MelderThread_RETURN_TYPE Sound_into_Pitch (Sound_into_Pitch_Args me)
-{
+/*
+	Scratch space for one thread. Allocated before the threads start, so that no thread ever has to allocate memory.
+*/
+Thing_define (Sound_into_Pitch_Workspace, Thing) { public:
 	autoNUMfft_Table fftTable;
 	autoNUMmatrix <double> frame;
 	autoNUMvector <double> ac, r, localMean;
 	autoNUMvector <long> imax;
-	{// scope
-		MelderThread_LOCK (mutex);
-		if (my method >= FCC_NORMAL) {   // cross-correlation
-			frame.reset (1, my sound -> ny, 1, my nsamp_window);
-		} else {   // autocorrelation
-			NUMfft_Table_init (& fftTable, my nsampFFT);
-			frame.reset (1, my sound -> ny, 1, my nsampFFT);
-			ac.reset (1, my nsampFFT);
-		}
-		r.reset (- my nsamp_window, my nsamp_window);
-		imax.reset (1, my maxnCandidates);
-		localMean.reset (1, my sound -> ny);
-		MelderThread_UNLOCK (mutex);
-	}
-	for (long iframe = my firstFrame; iframe <= my lastFrame; iframe ++) {
-		Pitch_Frame pitchFrame = & my pitch -> frame [iframe];
-		double t = Sampled_indexToX (my pitch, iframe);
-		if (my isMainThread) {
-			try {
-				Melder_progress (0.1 + 0.8 * (iframe - my firstFrame) / (my lastFrame - my firstFrame),
-					U"Sound to Pitch: analysing ", my lastFrame, U" frames");
-			} catch (MelderError) {
-				*my cancelled = 1;
-				throw;
-			}
-		} else if (*my cancelled) {
-			MelderThread_RETURN;
-		}
-		Sound_into_PitchFrame (my sound, pitchFrame, t,
-			my minimumPitch, my maxnCandidates, my method, my voicingThreshold, my octaveCost,
-			& fftTable, my dt_window, my nsamp_window, my halfnsamp_window,
-			my maximumLag, my nsampFFT, my nsamp_period, my halfnsamp_period,
-			my brent_ixmax, my brent_depth, my globalPeak,
-			frame.peek(), ac.peek(), my window, my windowR,
-			r.peek(), imax.peek(), localMean.peek());
+};
+
+Thing_implement (Sound_into_Pitch_Workspace, Thing, 0);
+
+static autoSound_into_Pitch_Workspace Sound_into_Pitch_Workspace_create (Sound sound, int method,
+	int maxnCandidates, long nsamp_window, long nsampFFT)
+{
+	autoSound_into_Pitch_Workspace me = Thing_new (Sound_into_Pitch_Workspace);
+	if (method >= FCC_NORMAL) {   // cross-correlation
+		my frame.reset (1, sound -> ny, 1, nsamp_window);
+	} else {   // autocorrelation
+		NUMfft_Table_init (& my fftTable, nsampFFT);
+		my frame.reset (1, sound -> ny, 1, nsampFFT);
+		my ac.reset (1, nsampFFT);
 	}
-	MelderThread_RETURN;
+	my r.reset (- nsamp_window, nsamp_window);
+	my imax.reset (1, maxnCandidates);
+	my localMean.reset (1, sound -> ny);
+	return me;
 }
 
 autoPitch Sound_to_Pitch_any (Sound me,
@@ -519,32 +451,39 @@ autoPitch Sound_to_Pitch_any (Sound me,
 
 		autoMelderProgress progress (U"Sound to Pitch...");
 
-		long numberOfFramesPerThread = 20;
-		int numberOfThreads = (nFrames - 1) / numberOfFramesPerThread + 1;
-		const int numberOfProcessors = MelderThread_getNumberOfProcessors ();
-		trace (numberOfProcessors, U" processors");
-		if (numberOfThreads > numberOfProcessors) numberOfThreads = numberOfProcessors;
-		if (numberOfThreads > 16) numberOfThreads = 16;
-		if (numberOfThreads < 1) numberOfThreads = 1;
-		numberOfFramesPerThread = (nFrames - 1) / numberOfThreads + 1;
-
-		if (! mutex_inited) { MelderThread_MUTEX_INIT (mutex); mutex_inited = true; }
-		autoSound_into_Pitch_Args args [16];
-		long firstFrame = 1, lastFrame = numberOfFramesPerThread;
-		volatile int cancelled = 0;
-		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
-			if (ithread == numberOfThreads) lastFrame = nFrames;
-			args [ithread - 1] = Sound_into_Pitch_Args_create (me, thee.get(),
-				firstFrame, lastFrame, minimumPitch, maxnCandidates, method,
-				voicingThreshold, octaveCost,
-				dt_window, nsamp_window, halfnsamp_window, maximumLag,
-				nsampFFT, nsamp_period, halfnsamp_period, brent_ixmax, brent_depth,
-				globalPeak, window.peek(), windowR.peek(),
-				ithread == numberOfThreads, & cancelled);
-			firstFrame = lastFrame + 1;
-			lastFrame += numberOfFramesPerThread;
-		}
-		MelderThread_run (Sound_into_Pitch, args, numberOfThreads);
+		/*
+		 * The frames are handed out to the threads in small chunks,
+		 * so that a thread that meets many expensive frames does not hold up the others.
+		 */
+		const long numberOfFramesPerChunk = 8;
+		const long numberOfChunks = (nFrames - 1) / numberOfFramesPerChunk + 1;
+		long numberOfThreads = MelderThread_getNumberOfThreads ();
+		if (numberOfThreads > numberOfChunks) numberOfThreads = numberOfChunks;
+		trace (numberOfThreads, U" threads");
+		std::vector <autoSound_into_Pitch_Workspace> workspaces;
+		for (long ithread = 1; ithread <= numberOfThreads; ithread ++)
+			workspaces. push_back (Sound_into_Pitch_Workspace_create (me, method, maxnCandidates, nsamp_window, nsampFFT));
+
+		std::atomic <long> numberOfFramesDone (0);
+		MelderThread_parallelFor (1, nFrames, numberOfFramesPerChunk, [&] (long firstFrame, long lastFrame, int threadNumber) {
+			Melder_assert (threadNumber <= numberOfThreads);
+			Sound_into_Pitch_Workspace workspace = workspaces [threadNumber - 1]. get ();
+			for (long iframe = firstFrame; iframe <= lastFrame; iframe ++) {
+				Pitch_Frame pitchFrame = & thy frame [iframe];
+				double t = Sampled_indexToX (thee.get(), iframe);
+				Sound_into_PitchFrame (me, pitchFrame, t,
+					minimumPitch, maxnCandidates, method, voicingThreshold, octaveCost,
+					& workspace -> fftTable, dt_window, nsamp_window, halfnsamp_window,
+					maximumLag, nsampFFT, nsamp_period, halfnsamp_period,
+					brent_ixmax, brent_depth, globalPeak,
+					workspace -> frame.peek(), workspace -> ac.peek(), window.peek(), windowR.peek(),
+					workspace -> r.peek(), workspace -> imax.peek(), workspace -> localMean.peek());
+			}
+			numberOfFramesDone += lastFrame - firstFrame + 1;
+			if (MelderThread_isMainThread ())
+				Melder_progress (0.1 + 0.8 * numberOfFramesDone / nFrames,
+					U"Sound to Pitch: analysing ", nFrames, U" frames");   // on cancel, the other threads stop after their current chunk
+		});
 
 		Melder_progress (0.95, U"Sound to Pitch: path finder");
 		Pitch_pathFinder (thee.get(), silenceThreshold, voicingThreshold,
@@ -19,6 +19,81 @@
 #include "TextGrid.h"
 #include "longchar.h"
 
+/*
+	The label index of a tier is valid only as long as no label in the tier has changed
+	and no interval or point has been added or removed.
+	The first condition is tracked by the items themselves, which know the index of their tier once it has been built,
+	and which invalidate it when their text changes or when they are removed;
+	additions are caught by comparing the number of items.
+	The keys are copies of the labels, so an outdated index can give wrong counts but never reads freed memory.
+	An index is built only on the second of two label queries between which nothing has changed,
+	so that code that alternates changing labels with querying them keeps scanning the tier linearly.
+*/
+Thing_implement (TierLabelIndex, Thing, 0);
+
+static void TierLabelIndex_invalidate (TierLabelIndex me) {
+	if (me)
+		my isUpToDate = false;
+}
+
+template <typename Items, typename LabelOf>
+static TierLabelIndex TierLabelIndex_get (autoTierLabelIndex *p_me, Items *items, LabelOf labelOf) {
+	if (! *p_me)
+		*p_me = Thing_new (TierLabelIndex);
+	TierLabelIndex me = p_me -> get ();
+	const long numberOfItems = items -> size;
+	if (! my isUpToDate || my numberOfItems != numberOfItems) {
+		for (long iitem = 1; iitem <= numberOfItems; iitem ++)
+			items -> at [iitem] -> d_labelIndex = me;   // from now on, each item invalidates the index when its label changes
+		my isUpToDate = true;
+		my numberOfItems = numberOfItems;
+		my isBuilt = false;
+		my groupOfLabel.clear ();
+		return nullptr;   // the first query after a change scans the tier
+	}
+	if (! my isBuilt) {
+		autoNUMvector <long> groupOfItem (1, numberOfItems);
+		long numberOfGroups = 0;
+		for (long iitem = 1; iitem <= numberOfItems; iitem ++) {
+			const char32 *label = labelOf (items -> at [iitem]);
+			auto insertion = my groupOfLabel.emplace (label ? label : U"", numberOfGroups + 1);
+			if (insertion.second)
+				numberOfGroups ++;
+			groupOfItem [iitem] = insertion.first -> second;
+		}
+		my firstPositions.reset (1, numberOfGroups + 1);
+		for (long iitem = 1; iitem <= numberOfItems; iitem ++)
+			my firstPositions [groupOfItem [iitem]] ++;
+		long position = 1;
+		for (long igroup = 1; igroup <= numberOfGroups; igroup ++) {
+			long numberOfItemsInGroup = my firstPositions [igroup];
+			my firstPositions [igroup] = position;
+			position += numberOfItemsInGroup;
+		}
+		my firstPositions [numberOfGroups + 1] = position;
+		my items.reset (1, numberOfItems);
+		for (long iitem = 1; iitem <= numberOfItems; iitem ++)
+			my items [my firstPositions [groupOfItem [iitem]] ++] = iitem;   // temporarily shifts each group start to the next group
+		for (long igroup = numberOfGroups; igroup > 1; igroup --)
+			my firstPositions [igroup] = my firstPositions [igroup - 1];
+		my firstPositions [1] = 1;
+		my isBuilt = true;
+	}
+	return me;
+}
+
+static void TierLabelIndex_find (TierLabelIndex me, const char32 *label, long *firstPosition, long *lastPosition) {
+	auto found = my groupOfLabel.find (label ? label : U"");
+	if (found == my groupOfLabel.end ()) {
+		*firstPosition = 1;
+		*lastPosition = 0;
+		return;
+	}
+	long group = found -> second;
+	*firstPosition = my firstPositions [group];
+	*lastPosition = my firstPositions [group + 1] - 1;
+}
+
 #include "oo_DESTROY.h"
 #include "TextGrid_def.h"
 #include "oo_COPY.h"
@@ -66,6 +141,7 @@ void TextPoint_setText (TextPoint me, const char32 *text) {
 		autostring32 newText = Melder_dup (text);
 		Melder_free (my mark);
 		my mark = newText.transfer();
+		TierLabelIndex_invalidate (my d_labelIndex);
 	} catch (MelderError) {
 		Melder_throw (me, U": text not set.");
 	}
@@ -100,6 +176,7 @@ void TextInterval_setText (TextInterval me, const char32 *text) {
 		 */
 		Melder_free (my text);
 		my text = newText.transfer();
+		TierLabelIndex_invalidate (my d_labelIndex);
 	} catch (MelderError) {
 		Melder_throw (U"Text interval: text not set.");
 	}
@@ -158,106 +235,163 @@ autoIntervalTier IntervalTier_create (double tmin, double tmax) {
 	}
 }
 
-long IntervalTier_timeToLowIndex (IntervalTier me, double t) {
-	long ileft = 1, iright = my intervals.size;
-	if (iright < 1) return 0;   // empty tier
-	TextInterval leftInterval = my intervals.at [ileft];
-	if (t < leftInterval -> xmin) return 0;   // very small t
-	TextInterval rightInterval = my intervals.at [iright];
-	if (t >= rightInterval -> xmax) return 0;   // very large t
+/*
+	Returns the first of the intervals ifirst through my intervals.size that ends after t
+	(or at t, if 'includingEnd'), or the last interval if none does.
+	Lookups at successive times, as in a loop over analysis frames, mostly hit the interval
+	of the latest lookup or the one after it, so these two are tried before a binary search.
+*/
+static long IntervalTier_findInterval (IntervalTier me, double t, long ifirst, bool includingEnd) {
+	long ilast = my intervals.size;
+	auto endsAfter = [&] (long iinterval) {
+		double xmax = my intervals.at [iinterval] -> xmax;
+		return includingEnd ? t <= xmax : t < xmax;
+	};
+	auto isTheInterval = [&] (long iinterval) {
+		return iinterval >= ifirst && iinterval <= ilast &&
+			(iinterval == ilast || endsAfter (iinterval)) && (iinterval == ifirst || ! endsAfter (iinterval - 1));
+	};
+	long latest = my d_latestIntervalNumber;
+	if (isTheInterval (latest))
+		return latest;
+	if (isTheInterval (latest + 1))
+		return my d_latestIntervalNumber = latest + 1;
+	long ileft = ifirst, iright = ilast;
 	while (ileft < iright) {
 		long imid = (ileft + iright) / 2;
-		TextInterval midInterval = my intervals.at [imid];
-		if (t >= midInterval -> xmax) {
-			ileft = imid + 1;
-		} else {
+		if (endsAfter (imid)) {
 			iright = imid;
+		} else {
+			ileft = imid + 1;
 		}
 	}
-	return ileft;
+	return my d_latestIntervalNumber = ileft;
+}
+
+long IntervalTier_timeToLowIndex (IntervalTier me, double t) {
+	if (my intervals.size < 1) return 0;   // empty tier
+	if (t < my intervals.at [1] -> xmin) return 0;   // very small t
+	if (t >= my intervals.at [my intervals.size] -> xmax) return 0;   // very large t
+	return IntervalTier_findInterval (me, t, 1, false);
 }
 
 long IntervalTier_timeToIndex (IntervalTier me, double t) {
-	long ileft = 1, iright = my intervals.size;
-	if (iright < 1) return 0;   // empty tier
-	TextInterval leftInterval = my intervals.at [ileft];
-	if (t < leftInterval -> xmin) return 0;   // very small t
-	TextInterval rightInterval = my intervals.at [iright];
-	if (t > rightInterval -> xmax) return 0;   // very large t
-	while (ileft < iright) {
-		long imid = (ileft + iright) / 2;
-		TextInterval midInterval = my intervals.at [imid];
-		if (t >= midInterval -> xmax) {
-			ileft = imid + 1;
-		} else {
-			iright = imid;
-		}
-	}
-	return ileft;
+	if (my intervals.size < 1) return 0;   // empty tier
+	if (t < my intervals.at [1] -> xmin) return 0;   // very small t
+	if (t > my intervals.at [my intervals.size] -> xmax) return 0;   // very large t
+	return IntervalTier_findInterval (me, t, 1, false);
 }
 
 long IntervalTier_timeToHighIndex (IntervalTier me, double t) {
-	long ileft = 1, iright = my intervals.size;
-	if (iright < 1) return 0;   // empty tier
-	TextInterval leftInterval = my intervals.at [ileft];
-	if (t <= leftInterval -> xmin) return 0;   // very small t
-	TextInterval rightInterval = my intervals.at [iright];
-	if (t > rightInterval -> xmax) return 0;   // very large t
-	while (ileft < iright) {
-		long imid = (ileft + iright) / 2;
-		TextInterval midInterval = my intervals.at [imid];
-		if (t > midInterval -> xmax) {
-			ileft = imid + 1;
-		} else {
-			iright = imid;
-		}
-	}
-	return ileft;
+	if (my intervals.size < 1) return 0;   // empty tier
+	if (t <= my intervals.at [1] -> xmin) return 0;   // very small t
+	if (t > my intervals.at [my intervals.size] -> xmax) return 0;   // very large t
+	return IntervalTier_findInterval (me, t, 1, true);
 }
 
 long IntervalTier_hasTime (IntervalTier me, double t) {
-	long ileft = 1, iright = my intervals.size;
-	if (iright < 1) return 0;   // empty tier
-	TextInterval leftInterval = my intervals.at [ileft];
-	if (t < leftInterval -> xmin) return 0;   // very small t
-	TextInterval rightInterval = my intervals.at [iright];
-	if (t > rightInterval -> xmax) return 0;   // very large t
-	while (ileft < iright) {
-		long imid = (ileft + iright) / 2;
-		TextInterval midInterval = my intervals.at [imid];
-		if (t >= midInterval -> xmax) {
-			ileft = imid + 1;
-		} else {
-			iright = imid;
-		}
-	}
+	if (my intervals.size < 1) return 0;   // empty tier
+	if (t < my intervals.at [1] -> xmin) return 0;   // very small t
+	if (t > my intervals.at [my intervals.size] -> xmax) return 0;   // very large t
+	long iinterval = IntervalTier_findInterval (me, t, 1, false);
 	/*
-	 * We now know that t is within interval ileft.
+	 * We now know that t is within interval iinterval.
 	 */
-	leftInterval = my intervals.at [ileft];
-	if (t == leftInterval -> xmin || t == leftInterval -> xmax) return ileft;
+	TextInterval interval = my intervals.at [iinterval];
+	if (t == interval -> xmin || t == interval -> xmax) return iinterval;
 	return 0;   // not found
 }
 
 long IntervalTier_hasBoundary (IntervalTier me, double t) {
-	long ileft = 2, iright = my intervals.size;
-	if (iright < 2) return 0;   // tier without inner boundaries
-	TextInterval leftInterval = my intervals.at [ileft];
-	if (t < leftInterval -> xmin) return 0;   // very small t
-	TextInterval rightInterval = my intervals.at [iright];
-	if (t >= rightInterval -> xmax) return 0;   // very large t
-	while (ileft < iright) {
-		long imid = (ileft + iright) / 2;
-		TextInterval midInterval = my intervals.at [imid];
-		if (t >= midInterval -> xmax) {
-			ileft = imid + 1;
-		} else {
-			iright = imid;
+	if (my intervals.size < 2) return 0;   // tier without inner boundaries
+	if (t < my intervals.at [2] -> xmin) return 0;   // very small t
+	if (t >= my intervals.at [my intervals.size] -> xmax) return 0;   // very large t
+	long iinterval = IntervalTier_findInterval (me, t, 2, false);
+	if (t == my intervals.at [iinterval] -> xmin) return iinterval;
+	return 0;   // not found
+}
+
+static TierLabelIndex IntervalTier_getLabelIndex (IntervalTier me) {
+	return TierLabelIndex_get (& my d_labelIndex, & my intervals,
+		[] (TextInterval interval) { return interval -> text; });
+}
+
+static TierLabelIndex TextTier_getLabelIndex (TextTier me) {
+	return TierLabelIndex_get (& my d_labelIndex, & my points,
+		[] (TextPoint point) { return point -> mark; });
+}
+
+/*
+	Calls visit (iinterval) for each interval whose text matches the criterion, in ascending order.
+*/
+template <typename Visit>
+static void IntervalTier_forEachIntervalWhere (IntervalTier me, int which_Melder_STRING, const char32 *criterion, Visit visit) {
+	if (which_Melder_STRING == kMelder_string_EQUAL_TO) {
+		if (TierLabelIndex index = IntervalTier_getLabelIndex (me)) {
+			long firstPosition, lastPosition;
+			TierLabelIndex_find (index, criterion, & firstPosition, & lastPosition);
+			for (long iposition = firstPosition; iposition <= lastPosition; iposition ++)
+				visit (index -> items [iposition]);
+			return;
 		}
 	}
-	leftInterval = my intervals.at [ileft];
-	if (t == leftInterval -> xmin) return ileft;
-	return 0;   // not found
+	for (long iinterval = 1; iinterval <= my intervals.size; iinterval ++) {
+		TextInterval interval = my intervals.at [iinterval];
+		if (Melder_stringMatchesCriterion (interval -> text, which_Melder_STRING, criterion))
+			visit (iinterval);
+	}
+}
+
+template <typename Visit>
+static void TextTier_forEachPointWhere (TextTier me, int which_Melder_STRING, const char32 *criterion, Visit visit) {
+	if (which_Melder_STRING == kMelder_string_EQUAL_TO) {
+		if (TierLabelIndex index = TextTier_getLabelIndex (me)) {
+			long firstPosition, lastPosition;
+			TierLabelIndex_find (index, criterion, & firstPosition, & lastPosition);
+			for (long iposition = firstPosition; iposition <= lastPosition; iposition ++)
+				visit (index -> items [iposition]);
+			return;
+		}
+	}
+	for (long ipoint = 1; ipoint <= my points.size; ipoint ++) {
+		TextPoint point = my points.at [ipoint];
+		if (Melder_stringMatchesCriterion (point -> mark, which_Melder_STRING, criterion))
+			visit (ipoint);
+	}
+}
+
+static long IntervalTier_countIntervalsWhere (IntervalTier me, int which_Melder_STRING, const char32 *criterion) {
+	if (which_Melder_STRING == kMelder_string_EQUAL_TO) {
+		if (TierLabelIndex index = IntervalTier_getLabelIndex (me)) {
+			long firstPosition, lastPosition;
+			TierLabelIndex_find (index, criterion, & firstPosition, & lastPosition);
+			return lastPosition - firstPosition + 1;
+		}
+	}
+	long count = 0;
+	for (long iinterval = 1; iinterval <= my intervals.size; iinterval ++) {
+		TextInterval interval = my intervals.at [iinterval];
+		if (Melder_stringMatchesCriterion (interval -> text, which_Melder_STRING, criterion))
+			count ++;
+	}
+	return count;
+}
+
+static long TextTier_countPointsWhere (TextTier me, int which_Melder_STRING, const char32 *criterion) {
+	if (which_Melder_STRING == kMelder_string_EQUAL_TO) {
+		if (TierLabelIndex index = TextTier_getLabelIndex (me)) {
+			long firstPosition, lastPosition;
+			TierLabelIndex_find (index, criterion, & firstPosition, & lastPosition);
+			return lastPosition - firstPosition + 1;
+		}
+	}
+	long count = 0;
+	for (long ipoint = 1; ipoint <= my points.size; ipoint ++) {
+		TextPoint point = my points.at [ipoint];
+		if (Melder_stringMatchesCriterion (point -> mark, which_Melder_STRING, criterion))
+			count ++;
+	}
+	return count;
 }
 
 void structTextGrid :: v_info () {
@@ -443,6 +577,14 @@ TextTier TextGrid_checkSpecifiedTierIsPointTier (TextGrid me, long tierNumber) {
 long TextGrid_countLabels (TextGrid me, long tierNumber, const char32 *text) {
 	try {
 		Function anyTier = TextGrid_checkSpecifiedTierNumberWithinRange (me, tierNumber);
+		if (text && text [0] != U'\0') {
+			/*
+			 * A nonempty text never matches a null label, so the label index can answer.
+			 */
+			if (anyTier -> classInfo == classIntervalTier)
+				return IntervalTier_countIntervalsWhere (static_cast <IntervalTier> (anyTier), kMelder_string_EQUAL_TO, text);
+			return TextTier_countPointsWhere (static_cast <TextTier> (anyTier), kMelder_string_EQUAL_TO, text);
+		}
 		long count = 0;
 		if (anyTier -> classInfo == classIntervalTier) {
 			IntervalTier tier = static_cast <IntervalTier> (anyTier);
@@ -467,15 +609,8 @@ long TextGrid_countLabels (TextGrid me, long tierNumber, const char32 *text) {
 
 long TextGrid_countIntervalsWhere (TextGrid me, long tierNumber, int which_Melder_STRING, const char32 *criterion) {
 	try {
-		long count = 0;
 		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
-		for (long iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
-			TextInterval interval = tier -> intervals.at [iinterval];
-			if (Melder_stringMatchesCriterion (interval -> text, which_Melder_STRING, criterion)) {
-				count ++;
-			}
-		}
-		return count;
+		return IntervalTier_countIntervalsWhere (tier, which_Melder_STRING, criterion);
 	} catch (MelderError) {
 		Melder_throw (me, U": intervals not counted.");
 	}
@@ -483,15 +618,8 @@ long TextGrid_countIntervalsWhere (TextGrid me, long tierNumber, int which_Melde
 
 long TextGrid_countPointsWhere (TextGrid me, long tierNumber, int which_Melder_STRING, const char32 *criterion) {
 	try {
-		long count = 0;
 		TextTier tier = TextGrid_checkSpecifiedTierIsPointTier (me, tierNumber);
-		for (long ipoint = 1; ipoint <= tier -> points.size; ipoint ++) {
-			TextPoint point = tier -> points.at [ipoint];
-			if (Melder_stringMatchesCriterion (point -> mark, which_Melder_STRING, criterion)) {
-				count ++;
-			}
-		}
-		return count;
+		return TextTier_countPointsWhere (tier, which_Melder_STRING, criterion);
 	} catch (MelderError) {
 		Melder_throw (me, U": points not counted.");
 	}
@@ -617,16 +745,10 @@ autoTextTier PointProcess_upto_TextTier (PointProcess me, const char32 *text) {
 autoPointProcess TextTier_getPoints (TextTier me, const char32 *text) {
 	try {
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
-		for (long i = 1; i <= my points.size; i ++) {
-			TextPoint point = my points.at [i];
-			if (text && text [0]) {
-				if (point -> mark && str32equ (text, point -> mark))
-					PointProcess_addPoint (thee.get(), point -> number);
-			} else {
-				if (! point -> mark || ! point -> mark [0])
-					PointProcess_addPoint (thee.get(), point -> number);
-			}
-		}
+		TextTier_forEachPointWhere (me, kMelder_string_EQUAL_TO, text, [&] (long ipoint) {
+			TextPoint point = my points.at [ipoint];
+			PointProcess_addPoint (thee.get(), point -> number);
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": points not converted to PointProcess.");
@@ -636,16 +758,10 @@ autoPointProcess TextTier_getPoints (TextTier me, const char32 *text) {
 autoPointProcess IntervalTier_getStartingPoints (IntervalTier me, const char32 *text) {
 	try {
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
-		for (long i = 1; i <= my intervals.size; i ++) {
-			TextInterval interval = my intervals.at [i];
-			if (text && text [0]) {
-				if (interval -> text && str32equ (text, interval -> text))
-					PointProcess_addPoint (thee.get(), interval -> xmin);
-			} else {
-				if (! interval -> text || ! interval -> text [0])
-					PointProcess_addPoint (thee.get(), interval -> xmin);
-			}
-		}
+		IntervalTier_forEachIntervalWhere (me, kMelder_string_EQUAL_TO, text, [&] (long iinterval) {
+			TextInterval interval = my intervals.at [iinterval];
+			PointProcess_addPoint (thee.get(), interval -> xmin);
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": starting points not gotten.");
@@ -655,16 +771,10 @@ autoPointProcess IntervalTier_getStartingPoints (IntervalTier me, const char32 *
 autoPointProcess IntervalTier_getEndPoints (IntervalTier me, const char32 *text) {
 	try {
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
-		for (long i = 1; i <= my intervals.size; i ++) {
-			TextInterval interval = my intervals.at [i];
-			if (text && text [0]) {
-				if (interval -> text && str32equ (text, interval -> text))
-					PointProcess_addPoint (thee.get(), interval -> xmax);
-			} else {
-				if (! interval -> text || ! interval -> text [0])
-					PointProcess_addPoint (thee.get(), interval -> xmax);
-			}
-		}
+		IntervalTier_forEachIntervalWhere (me, kMelder_string_EQUAL_TO, text, [&] (long iinterval) {
+			TextInterval interval = my intervals.at [iinterval];
+			PointProcess_addPoint (thee.get(), interval -> xmax);
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": end points not gotten.");
@@ -674,16 +784,10 @@ autoPointProcess IntervalTier_getEndPoints (IntervalTier me, const char32 *text)
 autoPointProcess IntervalTier_getCentrePoints (IntervalTier me, const char32 *text) {
 	try {
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
-		for (long i = 1; i <= my intervals.size; i ++) {
-			TextInterval interval = my intervals.at [i];
-			if (text && text [0]) {
-				if (interval -> text && str32equ (text, interval -> text))
-					PointProcess_addPoint (thee.get(), 0.5 * (interval -> xmin + interval -> xmax));
-			} else {
-				if (! interval -> text || ! interval -> text [0])
-					PointProcess_addPoint (thee.get(), 0.5 * (interval -> xmin + interval -> xmax));
-			}
-		}
+		IntervalTier_forEachIntervalWhere (me, kMelder_string_EQUAL_TO, text, [&] (long iinterval) {
+			TextInterval interval = my intervals.at [iinterval];
+			PointProcess_addPoint (thee.get(), 0.5 * (interval -> xmin + interval -> xmax));
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": centre points not gotten.");
@@ -694,12 +798,10 @@ autoPointProcess TextGrid_getStartingPoints (TextGrid me, long tierNumber, int w
 	try {
 		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
-		for (long iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
+		IntervalTier_forEachIntervalWhere (tier, which_Melder_STRING, criterion, [&] (long iinterval) {
 			TextInterval interval = tier -> intervals.at [iinterval];
-			if (Melder_stringMatchesCriterion (interval -> text, which_Melder_STRING, criterion)) {
-				PointProcess_addPoint (thee.get(), interval -> xmin);
-			}
-		}
+			PointProcess_addPoint (thee.get(), interval -> xmin);
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": starting points not converted to PointProcess.");
@@ -710,12 +812,10 @@ autoPointProcess TextGrid_getEndPoints (TextGrid me, long tierNumber, int which_
 	try {
 		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
-		for (long iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
+		IntervalTier_forEachIntervalWhere (tier, which_Melder_STRING, criterion, [&] (long iinterval) {
 			TextInterval interval = tier -> intervals.at [iinterval];
-			if (Melder_stringMatchesCriterion (interval -> text, which_Melder_STRING, criterion)) {
-				PointProcess_addPoint (thee.get(), interval -> xmax);
-			}
-		}
+			PointProcess_addPoint (thee.get(), interval -> xmax);
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": end points not converted to PointProcess.");
@@ -726,12 +826,10 @@ autoPointProcess TextGrid_getCentrePoints (TextGrid me, long tierNumber, int whi
 	try {
 		IntervalTier tier = TextGrid_checkSpecifiedTierIsIntervalTier (me, tierNumber);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
-		for (long iinterval = 1; iinterval <= tier -> intervals.size; iinterval ++) {
+		IntervalTier_forEachIntervalWhere (tier, which_Melder_STRING, criterion, [&] (long iinterval) {
 			TextInterval interval = tier -> intervals.at [iinterval];
-			if (Melder_stringMatchesCriterion (interval -> text, which_Melder_STRING, criterion)) {
-				PointProcess_addPoint (thee.get(), 0.5 * (interval -> xmin + interval -> xmax));
-			}
-		}
+			PointProcess_addPoint (thee.get(), 0.5 * (interval -> xmin + interval -> xmax));
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": centre points not converted to PointProcess.");
@@ -742,12 +840,10 @@ autoPointProcess TextGrid_getPoints (TextGrid me, long tierNumber, int which_Mel
 	try {
 		TextTier tier = TextGrid_checkSpecifiedTierIsPointTier (me, tierNumber);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
-		for (long ipoint = 1; ipoint <= tier -> points.size; ipoint ++) {
+		TextTier_forEachPointWhere (tier, which_Melder_STRING, criterion, [&] (long ipoint) {
 			TextPoint point = tier -> points.at [ipoint];
-			if (Melder_stringMatchesCriterion (point -> mark, which_Melder_STRING, criterion)) {
-				PointProcess_addPoint (thee.get(), point -> number);
-			}
-		}
+			PointProcess_addPoint (thee.get(), point -> number);
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": points not converted to PointProcess.");
@@ -761,15 +857,13 @@ autoPointProcess TextGrid_getPoints_preceded (TextGrid me, long tierNumber,
 	try {
 		TextTier tier = TextGrid_checkSpecifiedTierIsPointTier (me, tierNumber);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
-		for (long ipoint = 1; ipoint <= tier -> points.size; ipoint ++) {
+		TextTier_forEachPointWhere (tier, which_Melder_STRING, criterion, [&] (long ipoint) {
 			TextPoint point = tier -> points.at [ipoint];
-			if (Melder_stringMatchesCriterion (point -> mark, which_Melder_STRING, criterion)) {
-				TextPoint preceding = ( ipoint <= 1 ? nullptr : tier -> points.at [ipoint - 1] );
-				if (Melder_stringMatchesCriterion (preceding -> mark, which_Melder_STRING_precededBy, criterion_precededBy)) {
-					PointProcess_addPoint (thee.get(), point -> number);
-				}
+			TextPoint preceding = ( ipoint <= 1 ? nullptr : tier -> points.at [ipoint - 1] );
+			if (Melder_stringMatchesCriterion (preceding -> mark, which_Melder_STRING_precededBy, criterion_precededBy)) {
+				PointProcess_addPoint (thee.get(), point -> number);
 			}
-		}
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": points not converted to PointProcess.");
@@ -783,15 +877,13 @@ autoPointProcess TextGrid_getPoints_followed (TextGrid me, long tierNumber,
 	try {
 		TextTier tier = TextGrid_checkSpecifiedTierIsPointTier (me, tierNumber);
 		autoPointProcess thee = PointProcess_create (my xmin, my xmax, 10);
-		for (long ipoint = 1; ipoint <= tier -> points.size; ipoint ++) {
+		TextTier_forEachPointWhere (tier, which_Melder_STRING, criterion, [&] (long ipoint) {
 			TextPoint point = tier -> points.at [ipoint];
-			if (Melder_stringMatchesCriterion (point -> mark, which_Melder_STRING, criterion)) {
-				TextPoint following = ( ipoint >= tier -> points.size ? nullptr : tier -> points.at [ipoint + 1] );
-				if (Melder_stringMatchesCriterion (following -> mark, which_Melder_STRING_followedBy, criterion_followedBy)) {
-					PointProcess_addPoint (thee.get(), point -> number);
-				}
+			TextPoint following = ( ipoint >= tier -> points.size ? nullptr : tier -> points.at [ipoint + 1] );
+			if (Melder_stringMatchesCriterion (following -> mark, which_Melder_STRING_followedBy, criterion_followedBy)) {
+				PointProcess_addPoint (thee.get(), point -> number);
 			}
-		}
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": points not converted to PointProcess.");
@@ -836,27 +928,21 @@ autoPointProcess IntervalTier_PointProcess_endToCentre (IntervalTier tier, Point
 
 autoTableOfReal IntervalTier_downto_TableOfReal (IntervalTier me, const char32 *label) {
 	try {
-		long n = 0;
-		for (long i = 1; i <= my intervals.size; i ++) {
-			TextInterval interval = my intervals.at [i];
-			if (! label || (label [0] == U'\0' && ! interval -> text) || (interval -> text && str32equ (interval -> text, label)))
-				n ++;
-		}
+		int which_Melder_STRING = ( label ? kMelder_string_EQUAL_TO : kMelder_string_CONTAINS );   // no label means all intervals
+		long n = IntervalTier_countIntervalsWhere (me, which_Melder_STRING, label);
 		autoTableOfReal thee = TableOfReal_create (n, 3);
 		TableOfReal_setColumnLabel (thee.get(), 1, U"Start");
 		TableOfReal_setColumnLabel (thee.get(), 2, U"End");
 		TableOfReal_setColumnLabel (thee.get(), 3, U"Duration");
 		n = 0;
-		for (long i = 1; i <= my intervals.size; i ++) {
-			TextInterval interval = my intervals.at [i];
-			if (! label || (label [0] == U'\0' && ! interval -> text) || (interval -> text && str32equ (interval -> text, label))) {
-				n ++;
-				TableOfReal_setRowLabel (thee.get(), n, interval -> text ? interval -> text : U"");
-				thy data [n] [1] = interval -> xmin;
-				thy data [n] [2] = interval -> xmax;
-				thy data [n] [3] = interval -> xmax - interval -> xmin;
-			}
-		}
+		IntervalTier_forEachIntervalWhere (me, which_Melder_STRING, label, [&] (long iinterval) {
+			TextInterval interval = my intervals.at [iinterval];
+			n ++;
+			TableOfReal_setRowLabel (thee.get(), n, interval -> text ? interval -> text : U"");
+			thy data [n] [1] = interval -> xmin;
+			thy data [n] [2] = interval -> xmax;
+			thy data [n] [3] = interval -> xmax - interval -> xmin;
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": not converted to TableOfReal.");
@@ -869,23 +955,17 @@ autoTableOfReal IntervalTier_downto_TableOfReal_any (IntervalTier me) {
 
 autoTableOfReal TextTier_downto_TableOfReal (TextTier me, const char32 *label) {
 	try {
-		long n = 0;
-		for (long i = 1; i <= my points.size; i ++) {
-			TextPoint point = my points.at [i];
-			if (! label || (label [0] == U'\0' && ! point -> mark) || (point -> mark && str32equ (point -> mark, label)))
-				n ++;
-		}
+		int which_Melder_STRING = ( label ? kMelder_string_EQUAL_TO : kMelder_string_CONTAINS );   // no label means all points
+		long n = TextTier_countPointsWhere (me, which_Melder_STRING, label);
 		autoTableOfReal thee = TableOfReal_create (n, 1);
 		TableOfReal_setColumnLabel (thee.get(), 1, U"Time");
 		n = 0;
-		for (long i = 1; i <= my points.size; i ++) {
-			TextPoint point = my points.at [i];
-			if (! label || (label [0] == U'\0' && ! point -> mark) || (point -> mark && str32equ (point -> mark, label))) {
-				n ++;
-				TableOfReal_setRowLabel (thee.get(), n, point -> mark ? point -> mark : U"");
-				thy data [n] [1] = point -> number;
-			}
-		}
+		TextTier_forEachPointWhere (me, which_Melder_STRING, label, [&] (long ipoint) {
+			TextPoint point = my points.at [ipoint];
+			n ++;
+			TableOfReal_setRowLabel (thee.get(), n, point -> mark ? point -> mark : U"");
+			thy data [n] [1] = point -> number;
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": not converted to TableOfReal.");
@@ -1075,12 +1155,14 @@ void TextGrid_convertToBackslashTrigraphs (TextGrid me) {
 			Function anyTier = my tiers->at [itier];
 			if (anyTier -> classInfo == classIntervalTier) {
 				IntervalTier tier = static_cast <IntervalTier> (anyTier);
+				TierLabelIndex_invalidate (tier -> d_labelIndex.get());
 				for (long i = 1; i <= tier -> intervals.size; i ++) {
 					TextInterval interval = tier -> intervals.at [i];
 					genericize (& interval -> text, buffer.peek());
 				}
 			} else {
 				TextTier tier = static_cast <TextTier> (anyTier);
+				TierLabelIndex_invalidate (tier -> d_labelIndex.get());
 				for (long i = 1; i <= tier -> points.size; i ++) {
 					TextPoint point = tier -> points.at [i];
 					genericize (& point -> mark, buffer.peek());
@@ -1099,6 +1181,7 @@ void TextGrid_convertToUnicode (TextGrid me) {
 			Function anyTier = my tiers->at [itier];
 			if (anyTier -> classInfo == classIntervalTier) {
 				IntervalTier tier = static_cast <IntervalTier> (anyTier);
+				TierLabelIndex_invalidate (tier -> d_labelIndex.get());
 				for (long i = 1; i <= tier -> intervals.size; i ++) {
 					TextInterval interval = tier -> intervals.at [i];
 					if (interval -> text) {
@@ -1108,6 +1191,7 @@ void TextGrid_convertToUnicode (TextGrid me) {
 				}
 			} else {
 				TextTier tier = static_cast <TextTier> (anyTier);
+				TierLabelIndex_invalidate (tier -> d_labelIndex.get());
 				for (long i = 1; i <= tier -> points.size; i ++) {
 					TextPoint point = tier -> points.at [i];
 					if (point -> mark) {
@@ -1124,10 +1208,12 @@ void TextGrid_convertToUnicode (TextGrid me) {
 
 void TextInterval_removeText (TextInterval me) {
 	Melder_free (my text);
+	TierLabelIndex_invalidate (my d_labelIndex);
 }
 
 void TextPoint_removeText (TextPoint me) {
 	Melder_free (my mark);
+	TierLabelIndex_invalidate (my d_labelIndex);
 }
 
 void IntervalTier_removeText (IntervalTier me) {
@@ -23,10 +23,25 @@
 #include "Graphics.h"
 #include "TableOfReal.h"
 #include "Table.h"
+#include <string>
+#include <unordered_map>
 
 Collection_define (FunctionList, OrderedOf, Function) {
 };
 
+/*
+	The label index of a tier, private to TextGrid.cpp.
+	It maps each distinct label to the numbers of the intervals or points that carry it, in ascending order;
+	as usual in Praat, a null label counts as an empty label.
+*/
+Thing_define (TierLabelIndex, Thing) {
+	long numberOfItems;
+	bool isUpToDate, isBuilt;
+	std::unordered_map <std::u32string, long> groupOfLabel;   // owns copies of the labels
+	autoNUMvector <long> firstPositions;   // the items of group g are in positions [firstPositions [g] .. firstPositions [g + 1] - 1]
+	autoNUMvector <long> items;
+};
+
 #include "TextGrid_def.h"
 
 autoTextPoint TextPoint_create (double time, const char32 *mark);
@@ -1279,9 +1279,10 @@ static void gui_text_cb_changed (TextGridEditor me, GuiTextEvent /* event */) {
 			long selectedPoint = getSelectedPoint (me);
 			if (selectedPoint) {
 				TextPoint point = textTier -> points.at [selectedPoint];
-				Melder_free (point -> mark);
 				if (str32spn (text, U" \n\t") != str32len (text))   // any visible characters?
-				point -> mark = Melder_dup_f (text);
+					TextPoint_setText (point, text);
+				else
+					TextPoint_removeText (point);
 				FunctionEditor_redraw (me);
 				Editor_broadcastDataChanged (me);
 			}
@@ -2093,9 +2094,10 @@ void structTextGridEditor :: v_clickSelectionViewer (double xWC, double yWC) {
 				long selectedPoint = getSelectedPoint (this);
 				if (selectedPoint) {
 					TextPoint point = textTier -> points.at [selectedPoint];
-					Melder_free (point -> mark);
 					if (str32spn (newText.string, U" \n\t") != str32len (newText.string))   // any visible characters?
-					point -> mark = Melder_dup_f (newText.string);
+						TextPoint_setText (point, newText.string);
+					else
+						TextPoint_removeText (point);
 
 					our suppressRedraw = true;   // prevent valueChangedCallback from redrawing
 					trace (U"setting new text ", newText.string);
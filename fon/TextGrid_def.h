@@ -22,6 +22,13 @@ oo_DEFINE_CLASS (TextPoint, AnyPoint)
 
 	oo_STRING (mark)
 
+	#if oo_DECLARING
+		TierLabelIndex d_labelIndex;   // the index of the tier that contains this point, if built; items never change tiers
+	#endif
+	#if oo_DESTROYING
+		TierLabelIndex_invalidate (d_labelIndex);
+	#endif
+
 oo_END_CLASS (TextPoint)
 #undef ooSTRUCT
 
@@ -32,9 +39,14 @@ oo_DEFINE_CLASS (TextInterval, Function)
 	oo_STRING (text)
 
 	#if oo_DECLARING
+		TierLabelIndex d_labelIndex;   // the index of the tier that contains this interval, if built; items never change tiers
+
 		int v_domainQuantity ()
 			override { return MelderQuantity_TIME_SECONDS; }
 	#endif
+	#if oo_DESTROYING
+		TierLabelIndex_invalidate (d_labelIndex);
+	#endif
 
 oo_END_CLASS (TextInterval)
 #undef ooSTRUCT
@@ -48,9 +60,14 @@ oo_DEFINE_CLASS (TextTier, Function)   // a kind of AnyTier though
 	#if oo_DECLARING
 		AnyTier_METHODS
 
+		autoTierLabelIndex d_labelIndex;   // built on demand by the label queries; not copied or saved
+
 		int v_domainQuantity ()
 			override { return MelderQuantity_TIME_SECONDS; }
 	#endif
+	#if oo_DESTROYING
+		our points.removeAllItems ();   // while the label index that the items refer to still exists
+	#endif
 
 oo_END_CLASS (TextTier)
 #undef ooSTRUCT
@@ -62,6 +79,9 @@ oo_DEFINE_CLASS (IntervalTier, Function)
 	oo_COLLECTION_OF (SortedSetOfDoubleOf, intervals, TextInterval, 0)
 
 	#if oo_DECLARING
+		long d_latestIntervalNumber;   // where the latest time lookup ended; checked before use, so it cannot go stale
+		autoTierLabelIndex d_labelIndex;   // built on demand by the label queries; not copied or saved
+
 		int v_domainQuantity ()
 			override { return MelderQuantity_TIME_SECONDS; }
 		void v_shiftX (double xfrom, double xto)
@@ -69,6 +89,9 @@ oo_DEFINE_CLASS (IntervalTier, Function)
 		void v_scaleX (double xminfrom, double xmaxfrom, double xminto, double xmaxto)
 			override;
 	#endif
+	#if oo_DESTROYING
+		our intervals.removeAllItems ();   // while the label index that the items refer to still exists
+	#endif
 
 oo_END_CLASS (IntervalTier)
 #undef ooSTRUCT
@@ -598,10 +598,27 @@ void TimeSoundEditor_drawSound (TimeSoundEditor me, double globalMinimum, double
 			Graphics_function (my d_graphics.get(), sound -> z [ichan], first, last,
 				Sampled_indexToX (sound, first), Sampled_indexToX (sound, last));
 		} else {
-			Graphics_setWindow (my d_graphics.get(), my d_startWindow, my d_endWindow, minimum * 32768, maximum * 32768);
-			Graphics_function16 (my d_graphics.get(),
-				longSound -> buffer - longSound -> imin * nchan + (ichan - 1), nchan - 1, first, last,
-				Sampled_indexToX (longSound, first), Sampled_indexToX (longSound, last));
+			Graphics_setWindow (my d_graphics.get(), my d_startWindow, my d_endWindow, minimum, maximum);
+			/*
+			 * The samples live in cache blocks; draw the window block by block,
+			 * and connect the last sample of each piece to the first sample of the next.
+			 */
+			double previousX = 0.0, previousY = 0.0;
+			long isample = first;
+			while (isample <= last) {
+				long lastSample;
+				const float *samples = LongSound_peekSamples (longSound, isample, & lastSample);
+				if (lastSample > last) lastSample = last;
+				long numberOfSamplesInPiece = lastSample - isample + 1;
+				float *channelSamples = (float *) samples + (ichan - 1);   // channelSamples [i * nchan] is sample isample + i of this channel
+				double firstX = Sampled_indexToX (longSound, isample), lastX = Sampled_indexToX (longSound, lastSample);
+				if (isample > first)
+					Graphics_line (my d_graphics.get(), previousX, previousY, firstX, channelSamples [0]);
+				Graphics_functionFloat (my d_graphics.get(), channelSamples, nchan - 1, 0, numberOfSamplesInPiece - 1, firstX, lastX);
+				previousX = lastX;
+				previousY = channelSamples [(numberOfSamplesInPiece - 1) * nchan];
+				isample = lastSample + 1;
+			}
 		}
 		Graphics_resetViewport (my d_graphics.get(), vp);
 	}
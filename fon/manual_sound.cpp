@@ -980,6 +980,26 @@ NORMAL (U"A new Sound will appear in the list of objects, "
 	"For instance, the Sound \"hallo\" will give a new Sound \"hallo_10000\".")
 MAN_END
 
+MAN_BEGIN (U"Sound: Resample (polyphase)...", U"", 20161114)
+INTRO (U"A command that creates new @Sound objects from the selected Sounds, "
+	"like @@Sound: Resample...@, but faster and with less memory for long sounds.")
+ENTRY (U"Settings")
+TAG (U"##Sampling frequency (Hz)")
+DEFINITION (U"the new sampling frequency, in hertz. The ratio of the new and old sampling frequencies "
+	"has to be a fraction %L/%M with %L at most 4096, as in 48000 to 16000 Hz (1/3) or 44100 to 48000 Hz (160/147); "
+	"for other ratios, the command does the same as ##Resample...#.")
+TAG (U"##Precision")
+DEFINITION (U"the depth of the interpolation filter, in samples (standard is 50).")
+ENTRY (U"Algorithm")
+NORMAL (U"The new samples fall on only %L different positions between the old samples. "
+	"For each of these %L phases, Praat computes a table of filter weights beforehand: "
+	"a %sinc function windowed with a raised cosine, as in the %sinc interpolation of ##Resample...#. "
+	"If the sampling frequency goes down, this %sinc is stretched, so that the filter also performs the anti-aliasing; "
+	"there is no separate Fourier transform of the whole sound.")
+NORMAL (U"The result differs from that of ##Resample...# near the new Nyquist frequency (the filter has a transition band "
+	"rather than a brick wall) and near the edges (the signal is taken to be zero outside the time domain).")
+MAN_END
+
 MAN_BEGIN (U"Sound: Set value at sample number...", U"ppgb", 20140421)
 INTRO (U"A command to change a specified sample of the selected @Sound object.")
 ENTRY (U"Settings")
@@ -3279,6 +3279,7 @@ LIST_ITEM (U"• @@Write to console")
 LIST_ITEM (U"• @@Save as text file...")
 LIST_ITEM (U"• @@Save as short text file...")
 LIST_ITEM (U"• @@Save as binary file...")
+LIST_ITEM (U"• @@Save as mapped binary file...")
 ENTRY (U"Dynamic commands")
 NORMAL (U"Depending on the type of the selected object, the following commands may be available "
 	"in the #Save menu:")
@@ -3298,6 +3299,30 @@ NORMAL (U"These files are in a device-independent binary format, "
 	"and can be written and read on any machine.")
 MAN_END
 
+MAN_BEGIN (U"Save as mapped binary file...", U"", 20161117)
+INTRO (U"One of the commands in the @@Save menu@.")
+ENTRY (U"Availability")
+NORMAL (U"You can choose this command after selecting one or more @objects.")
+ENTRY (U"Behaviour")
+NORMAL (U"The Object window will ask you for a file name. "
+	"After you click OK, the objects will be written to a binary file on disk, "
+	"in a format that is meant for large numeric objects such as long Sounds, Spectrograms or Matrices.")
+ENTRY (U"Usage")
+NORMAL (U"The file can be read again with @@Read from file...@. "
+	"On most computers, the large arrays of numbers in the file are then not read into memory, "
+	"but are %mapped into memory: reading takes hardly any time, "
+	"and parts of the file are loaded only when they are needed. "
+	"If you change such an object, Praat makes a private copy of the changed part; "
+	"the file itself stays as it is.")
+NORMAL (U"While a mapped object is in the list of objects, you should not change its file with other programs. "
+	"You can overwrite the file from Praat itself: Praat then first copies the mapped data into memory.")
+ENTRY (U"File format")
+NORMAL (U"The format is the same as that of @@Save as binary file...@, except that arrays of real numbers "
+	"are stored in the byte order of most current computers (least significant byte first), "
+	"and that large arrays start at a multiple of 65536 bytes from the start of the file. "
+	"These files, too, can be written and read on any machine.")
+MAN_END
+
 MAN_BEGIN (U"Save as short text file...", U"ppgb", 20110129)
 INTRO (U"One of the commands in the @@Save menu@.")
 ENTRY (U"Availability")
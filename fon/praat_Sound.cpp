@@ -1335,6 +1335,16 @@ DO
 	CONVERT_EACH_END (my name, U"_", lround (newSamplingFrequency));
 }
 
+FORM (NEW_Sound_resample_polyphase, U"Sound: Resample (polyphase)", U"Sound: Resample (polyphase)...") {
+	POSITIVE4 (newSamplingFrequency, U"New sampling frequency (Hz)", U"16000.0")
+	NATURAL4 (precision, U"Precision (samples)", U"50")
+	OK
+DO
+	CONVERT_EACH (Sound)
+		autoSound result = Sound_resample_polyphase (me, newSamplingFrequency, precision);
+	CONVERT_EACH_END (my name, U"_", lround (newSamplingFrequency));
+}
+
 DIRECT (MODIFY_Sound_reverse) {
 	MODIFY_EACH (Sound)
 		Sound_reverse (me, 0.0, 0.0);
@@ -2364,6 +2374,7 @@ void praat_Sound_init () {
 		praat_addAction1 (classSound, 0, U"Extract part...", nullptr, 1, NEW_Sound_extractPart);
 		praat_addAction1 (classSound, 0, U"Extract part for overlap...", nullptr, 1, NEW_Sound_extractPartForOverlap);
 		praat_addAction1 (classSound, 0, U"Resample...", nullptr, 1, NEW_Sound_resample);
+		praat_addAction1 (classSound, 0, U"Resample (polyphase)...", nullptr, 1, NEW_Sound_resample_polyphase);
 		praat_addAction1 (classSound, 0, U"-- enhance --", nullptr, 1, nullptr);
 		praat_addAction1 (classSound, 0, U"Lengthen (overlap-add)...", nullptr, 1, NEW_Sound_lengthen_overlapAdd);
 		praat_addAction1 (classSound, 0,   U"Lengthen (PSOLA)...", U"*Lengthen (overlap-add)...", praat_DEPTH_1 | praat_DEPRECATED_2007, NEW_Sound_lengthen_overlapAdd);
@@ -409,6 +409,22 @@ double ** NUMmatrix_readBinary_r8 (long r1, long r2, long c1, long c2, FILE *f);
 	Throw an error message if anything went wrong.
 */
 
+#define NUMmatrix_MAPPED_ALIGNMENT  65536
+
+void NUMmatrix_setMappedBinary (bool mapped);
+/*
+	While mapped binary is on (as during Data_writeToMappedBinaryFile and while reading such a file),
+	NUMmatrix_writeBinary_r8 writes little-endian doubles, starting large matrices
+	at a multiple of NUMmatrix_MAPPED_ALIGNMENT bytes from the start of the file,
+	and NUMmatrix_readBinary_r8 maps such large matrices into memory (copy-on-write) where it can;
+	NUMmatrix_free unmaps them again.
+*/
+void NUMmatrix_unmapFile (const char *path);
+/*
+	Copy into memory all the matrices that are mapped from the file with this path,
+	so that the file can be overwritten without affecting them.
+*/
+
 typedef struct structNUMlinprog *NUMlinprog;
 void NUMlinprog_delete (NUMlinprog me);
 NUMlinprog NUMlinprog_new (bool maximize);
@@ -18,9 +18,19 @@
 
 #include "NUM.h"
 #include "melder.h"
+#include "MelderThread.h"
+#include <atomic>
+#if ! defined (_WIN32)
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
 
 static long theTotalNumberOfArrays;
 
+static bool NUMmatrix_unmap (char *cells);   // true if the cells were mapped from a file (and now are not)
+static std::atomic <long> theNumberOfMappedMatrices (0);
+
 long NUM_getTotalNumberOfArrays () { return theTotalNumberOfArrays; }
 
 /*** Generic memory routines for vectors. ***/
@@ -162,7 +172,8 @@ void * NUMmatrix (long elementSize, long row1, long row2, long col1, long col2)
 void NUMmatrix_free (long elementSize, void *m, long row1, long col1) {
 	if (! m) return;
 	char *dummy1 = ((char **) m) [row1] + col1 * elementSize;
-	Melder_free (dummy1);
+	if (theNumberOfMappedMatrices == 0 || ! NUMmatrix_unmap (dummy1))
+		Melder_free (dummy1);
 	char **dummy2 = (char **) m + row1;
 	Melder_free (dummy2);
 	theTotalNumberOfArrays -= 1;
@@ -255,15 +266,6 @@ bool NUMmatrix_equal (long elementSize, void *m1, void *m2, long row1, long row2
 		texexdent (file); \
 		if (feof (file -> filePointer) || ferror (file -> filePointer)) Melder_throw (U"Write error."); \
 	} \
-	void NUMmatrix_writeBinary_##storage (type **m, long row1, long row2, long col1, long col2, FILE *f) { \
-		if (row2 >= row1) { \
-			for (long irow = row1; irow <= row2; irow ++) { \
-				for (long icol = col1; icol <= col2; icol ++) \
-					binput##storage (m [irow] [icol], f); \
-			} \
-		} \
-		if (feof (f) || ferror (f)) Melder_throw (U"Write error."); \
-	} \
 	type ** NUMmatrix_readText_##storage (long row1, long row2, long col1, long col2, MelderReadText text, const char *name) { \
 		type **result = nullptr; \
 		try { \
@@ -280,6 +282,29 @@ bool NUMmatrix_equal (long elementSize, void *m1, void *m2, long row1, long row2
 			NUMmatrix_free (result, row1, col1); \
 			throw; \
 		} \
+	}
+
+FUNCTION (signed char, i1)
+FUNCTION (int, i2)
+FUNCTION (long, i4)
+FUNCTION (unsigned char, u1)
+FUNCTION (unsigned int, u2)
+FUNCTION (unsigned long, u4)
+FUNCTION (double, r4)
+FUNCTION (double, r8)
+FUNCTION (fcomplex, c8)
+FUNCTION (dcomplex, c16)
+#undef FUNCTION
+
+#define MATRIX_BINARY_FUNCTION(type,storage)  \
+	void NUMmatrix_writeBinary_##storage (type **m, long row1, long row2, long col1, long col2, FILE *f) { \
+		if (row2 >= row1) { \
+			for (long irow = row1; irow <= row2; irow ++) { \
+				for (long icol = col1; icol <= col2; icol ++) \
+					binput##storage (m [irow] [icol], f); \
+			} \
+		} \
+		if (feof (f) || ferror (f)) Melder_throw (U"Write error."); \
 	} \
 	type ** NUMmatrix_readBinary_##storage (long row1, long row2, long col1, long col2, FILE *f) { \
 		type **result = nullptr; \
@@ -294,16 +319,239 @@ bool NUMmatrix_equal (long elementSize, void *m1, void *m2, long row1, long row2
 		} \
 	}
 
-FUNCTION (signed char, i1)
-FUNCTION (int, i2)
-FUNCTION (long, i4)
-FUNCTION (unsigned char, u1)
-FUNCTION (unsigned int, u2)
-FUNCTION (unsigned long, u4)
-FUNCTION (double, r4)
-FUNCTION (double, r8)
-FUNCTION (fcomplex, c8)
-FUNCTION (dcomplex, c16)
-#undef FUNCTION
+MATRIX_BINARY_FUNCTION (signed char, i1)
+MATRIX_BINARY_FUNCTION (int, i2)
+MATRIX_BINARY_FUNCTION (long, i4)
+MATRIX_BINARY_FUNCTION (unsigned char, u1)
+MATRIX_BINARY_FUNCTION (unsigned int, u2)
+MATRIX_BINARY_FUNCTION (unsigned long, u4)
+MATRIX_BINARY_FUNCTION (double, r4)
+MATRIX_BINARY_FUNCTION (fcomplex, c8)
+MATRIX_BINARY_FUNCTION (dcomplex, c16)
+#undef MATRIX_BINARY_FUNCTION
+
+/*** Binary I/O for matrices of doubles, which can be mapped into memory. ***/
+
+/*
+	In a mapped binary file (see NUMmatrix_setMappedBinary), the cells of a matrix of doubles
+	are stored row after row as little-endian IEEE doubles rather than as big-endian ones.
+	If the cells take up at least NUMmatrix_MAPPED_ALIGNMENT bytes,
+	they are preceded by as many zero bytes as are needed to make them start
+	at a multiple of NUMmatrix_MAPPED_ALIGNMENT bytes from the start of the file;
+	on little-endian computers with memory mapping, such a matrix is then read by mapping
+	its part of the file into memory privately (copy-on-write), which takes no time and no swap space.
+	All other matrices are read into memory normally.
+*/
+
+static bool theMappedBinary;
+
+void NUMmatrix_setMappedBinary (bool mapped) {
+	theMappedBinary = mapped;
+}
+
+static int NUM_doubleByteOrder () {   // +1 = little-endian IEEE, -1 = big-endian IEEE, 0 = something else
+	static_assert (sizeof (double) == 8, "A double should take up eight bytes.");
+	static const unsigned char littleEndianOne [8] = { 0, 0, 0, 0, 0, 0, 0xF0, 0x3F };
+	static const unsigned char bigEndianOne [8] = { 0x3F, 0xF0, 0, 0, 0, 0, 0, 0 };
+	const double one = 1.0;
+	return memcmp (& one, littleEndianOne, 8) == 0 ? +1 : memcmp (& one, bigEndianOne, 8) == 0 ? -1 : 0;
+}
+
+static void NUM_swapDoubles (double *x, int64 n) {
+	for (int64 i = 0; i < n; i ++) {
+		unsigned char *bytes = (unsigned char *) & x [i];
+		for (int j = 0; j < 4; j ++) {
+			unsigned char dum = bytes [j];
+			bytes [j] = bytes [7 - j];
+			bytes [7 - j] = dum;
+		}
+	}
+}
+
+static int64 NUM_tell (FILE *f) {
+	#if defined (_WIN32)
+		return _ftelli64 (f);
+	#else
+		return ftello (f);
+	#endif
+}
+
+static void NUM_seek (FILE *f, int64 position) {
+	#if defined (_WIN32)
+		int status = _fseeki64 (f, position, SEEK_SET);
+	#else
+		int status = fseeko (f, (off_t) position, SEEK_SET);
+	#endif
+	if (status != 0)
+		Melder_throw (U"Cannot move to position ", position, U" in file.");
+}
+
+#if ! defined (_WIN32)
+	struct NUMmatrix_Mapping {
+		char *cells;
+		int64 numberOfBytes;
+		char **rows;   // as returned by NUMmatrix_readBinary_r8, i.e. rows [row1] is the first row
+		long row1, row2;
+		dev_t device;
+		ino_t inode;
+	};
+	static std::vector <NUMmatrix_Mapping> theMappings;
+	MelderThread_MUTEX (theMappingsMutex);
+#endif
+
+static bool NUMmatrix_unmap (char *cells) {
+	#if ! defined (_WIN32)
+		bool found = false;
+		MelderThread_LOCK (theMappingsMutex);
+		for (size_t i = 0; i < theMappings.size (); i ++) {
+			NUMmatrix_Mapping& mapping = theMappings [i];
+			if (mapping.cells == cells) {
+				munmap (mapping.cells, (size_t) mapping.numberOfBytes);
+				theMappings.erase (theMappings.begin () + i);
+				theNumberOfMappedMatrices -= 1;
+				found = true;
+				break;
+			}
+		}
+		MelderThread_UNLOCK (theMappingsMutex);
+		return found;
+	#else
+		(void) cells;
+		return false;
+	#endif
+}
+
+void NUMmatrix_unmapFile (const char *path) {
+	if (theNumberOfMappedMatrices == 0) return;
+	#if ! defined (_WIN32)
+		struct stat status;
+		if (stat (path, & status) != 0) return;   // nothing there, so nothing mapped from there
+		MelderThread_LOCK (theMappingsMutex);
+		for (size_t i = theMappings.size (); i > 0; i --) {
+			NUMmatrix_Mapping& mapping = theMappings [i - 1];
+			if (mapping.device != status.st_dev || mapping.inode != status.st_ino) continue;
+			char *cells = (char *) _Melder_malloc_f (mapping.numberOfBytes);
+			memcpy (cells, mapping.cells, (size_t) mapping.numberOfBytes);
+			for (long irow = mapping.row1; irow <= mapping.row2; irow ++)
+				mapping.rows [irow] = cells + (mapping.rows [irow] - mapping.cells);
+			munmap (mapping.cells, (size_t) mapping.numberOfBytes);
+			theMappings.erase (theMappings.begin () + (i - 1));
+			theNumberOfMappedMatrices -= 1;
+		}
+		MelderThread_UNLOCK (theMappingsMutex);
+	#else
+		(void) path;
+	#endif
+}
+
+#if ! defined (_WIN32)
+static double ** NUMmatrix_map_r8 (long row1, long row2, long col1, long col2, FILE *f, int64 position) {
+	long pageSize = sysconf (_SC_PAGESIZE);
+	if (pageSize <= 0 || NUMmatrix_MAPPED_ALIGNMENT % pageSize != 0) return nullptr;
+	int64 numberOfColumns = col2 - col1 + 1, numberOfBytes = (row2 - row1 + 1) * numberOfColumns * 8;
+	struct stat status;
+	if (fstat (fileno (f), & status) != 0) return nullptr;
+	if (status.st_size < position + numberOfBytes)
+		Melder_throw (U"Early end of file.");
+	void *cells = mmap (nullptr, (size_t) numberOfBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno (f), (off_t) position);
+	if (cells == MAP_FAILED) return nullptr;   // e.g. a file system that does not support mapping; read instead
+	double **result = (double **) _Melder_malloc_f ((row2 - row1 + 1) * (int64) sizeof (double *));
+	result -= row1;
+	result [row1] = (double *) cells - col1;
+	for (long irow = row1 + 1; irow <= row2; irow ++) result [irow] = result [irow - 1] + numberOfColumns;
+	MelderThread_LOCK (theMappingsMutex);
+	theMappings.push_back ({ (char *) cells, numberOfBytes, (char **) result, row1, row2, status.st_dev, status.st_ino });
+	theNumberOfMappedMatrices += 1;
+	MelderThread_UNLOCK (theMappingsMutex);
+	theTotalNumberOfArrays += 1;
+	return result;
+}
+#endif
+
+static void NUMmatrix_writeMappedBinary_r8 (double **m, long row1, long row2, long col1, long col2, FILE *f) {
+	int byteOrder = NUM_doubleByteOrder ();
+	if (byteOrder == 0)
+		Melder_throw (U"Cannot write a mapped binary file on a computer without IEEE doubles.");
+	int64 numberOfColumns = col2 - col1 + 1, numberOfBytes = (row2 - row1 + 1) * numberOfColumns * 8;
+	if (numberOfBytes >= NUMmatrix_MAPPED_ALIGNMENT) {
+		static const char zeroes [NUMmatrix_MAPPED_ALIGNMENT] = { 0 };
+		int64 position = NUM_tell (f);
+		if (position < 0) Melder_throw (U"Cannot determine position in file.");
+		int64 numberOfPaddingBytes = - position & (NUMmatrix_MAPPED_ALIGNMENT - 1);
+		fwrite (zeroes, 1, (size_t) numberOfPaddingBytes, f);
+	}
+	autoNUMvector <double> swapped (1, byteOrder < 0 ? numberOfColumns : 0);   // only big-endian computers need a buffer
+	for (long irow = row1; irow <= row2; irow ++) {
+		const double *cells = & m [irow] [col1];
+		if (byteOrder < 0) {
+			memcpy (& swapped [1], cells, (size_t) numberOfColumns * 8);
+			NUM_swapDoubles (& swapped [1], numberOfColumns);
+			cells = & swapped [1];
+		}
+		if (fwrite (cells, 8, (size_t) numberOfColumns, f) != (size_t) numberOfColumns) break;   // the caller reports the write error
+	}
+}
+
+static double ** NUMmatrix_readMappedBinary_r8 (long row1, long row2, long col1, long col2, FILE *f) {
+	int byteOrder = NUM_doubleByteOrder ();
+	if (byteOrder == 0)
+		Melder_throw (U"Cannot read a mapped binary file on a computer without IEEE doubles.");
+	int64 numberOfColumns = col2 - col1 + 1, numberOfBytes = (row2 - row1 + 1) * numberOfColumns * 8;
+	if (numberOfBytes >= NUMmatrix_MAPPED_ALIGNMENT) {
+		int64 position = NUM_tell (f);
+		if (position < 0) Melder_throw (U"Cannot determine position in file.");
+		position += - position & (NUMmatrix_MAPPED_ALIGNMENT - 1);
+		#if ! defined (_WIN32)
+			if (byteOrder > 0) {
+				double **result = NUMmatrix_map_r8 (row1, row2, col1, col2, f, position);
+				if (result) {
+					try {
+						NUM_seek (f, position + numberOfBytes);
+					} catch (MelderError) {
+						NUMmatrix_free (result, row1, col1);
+						throw;
+					}
+					return result;
+				}
+			}
+		#endif
+		NUM_seek (f, position);
+	}
+	autoNUMmatrix <double> result (row1, row2, col1, col2);
+	if (fread (& result [row1] [col1], 8, (size_t) (numberOfBytes / 8), f) != (size_t) (numberOfBytes / 8))
+		Melder_throw (U"Early end of file.");
+	if (byteOrder < 0)
+		NUM_swapDoubles (& result [row1] [col1], numberOfBytes / 8);
+	return result.transfer();
+}
+
+void NUMmatrix_writeBinary_r8 (double **m, long row1, long row2, long col1, long col2, FILE *f) {
+	if (row2 >= row1) {
+		if (theMappedBinary) {
+			NUMmatrix_writeMappedBinary_r8 (m, row1, row2, col1, col2, f);
+		} else {
+			for (long irow = row1; irow <= row2; irow ++) {
+				for (long icol = col1; icol <= col2; icol ++)
+					binputr8 (m [irow] [icol], f);
+			}
+		}
+	}
+	if (feof (f) || ferror (f)) Melder_throw (U"Write error.");
+}
+
+double ** NUMmatrix_readBinary_r8 (long row1, long row2, long col1, long col2, FILE *f) {
+	if (theMappedBinary)
+		return NUMmatrix_readMappedBinary_r8 (row1, row2, col1, col2, f);
+	double **result = nullptr;
+	try {
+		result = NUMmatrix <double> (row1, row2, col1, col2);
+		for (long irow = row1; irow <= row2; irow ++) for (long icol = col1; icol <= col2; icol ++)
+			result [irow] [icol] = bingetr8 (f);
+		return result;
+	} catch (MelderError) {
+		NUMmatrix_free (result, row1, col1);
+		throw;
+	}
+}
 
 /* End of file NUMarrays.cpp */
@@ -21,6 +21,11 @@
 #include "NUM2.h"
 #include "Formula.h"
 #include "SSCP.h"
+#include "MelderThread.h"
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <vector>
 
 #include "oo_DESTROY.h"
 #include "Table_def.h"
@@ -401,31 +406,20 @@ bool Table_isColumnNumeric_ErrorFalse (Table me, long columnNumber) {
 	return true;
 }
 
-static long stringCompare_column;
-
-static int stringCompare_NoError (const void *first, const void *second) {
-	TableRow me = * (TableRow *) first, thee = * (TableRow *) second;
-	char32 *firstString = my cells [stringCompare_column]. string;
-	char32 *secondString = thy cells [stringCompare_column]. string;
-	return str32cmp (firstString ? firstString : U"", secondString ? secondString : U"");
-}
-
-static void sortRowsByStrings_Assert (Table me, long columnNumber) {
-	Melder_assert (columnNumber >= 1 && columnNumber <= my numberOfColumns);
-	stringCompare_column = columnNumber;
-	qsort (& my rows.at [1], (unsigned long) my rows.size, sizeof (TableRow), stringCompare_NoError);
-}
-
-static int indexCompare_NoError (const void *first, const void *second) {
-	TableRow me = * (TableRow *) first, thee = * (TableRow *) second;
-	if (my sortingIndex < thy sortingIndex) return -1;
-	if (my sortingIndex > thy sortingIndex) return +1;
-	return 0;
-}
+struct Table_StringHash {
+	size_t operator() (const char32 *string) const {
+		size_t hash = 2166136261u;   // FNV-1a
+		for (; *string != U'\0'; string ++)
+			hash = (hash ^ (size_t) *string) * 16777619u;
+		return hash;
+	}
+};
 
-static void sortRowsByIndex_NoError (Table me) {
-	qsort (& my rows.at [1], (unsigned long) my rows.size, sizeof (TableRow), indexCompare_NoError);
-}
+struct Table_StringEqual {
+	bool operator() (const char32 *string1, const char32 *string2) const {
+		return str32equ (string1, string2);
+	}
+};
 
 void Table_numericize_Assert (Table me, long columnNumber) {
 	Melder_assert (columnNumber >= 1 && columnNumber <= my numberOfColumns);
@@ -439,24 +433,31 @@ void Table_numericize_Assert (Table me, long columnNumber) {
 				Melder_atof (string);
 		}
 	} else {
-		long iunique = 0;
-		const char32 *previousString = nullptr;
-		for (long irow = 1; irow <= my rows.size; irow ++) {
-			TableRow row = my rows.at [irow];
-			row -> sortingIndex = irow;
-		}
-		sortRowsByStrings_Assert (me, columnNumber);
+		/*
+		 * Every distinct string receives its alphabetical rank among the distinct strings.
+		 * Only the distinct strings have to be sorted; the rows find their string by hashing.
+		 */
+		std::unordered_map <const char32 *, long, Table_StringHash, Table_StringEqual> codeOfString;
+		std::vector <const char32 *> distinctStrings;
+		autoNUMvector <long> codes (1, my rows.size > 0 ? my rows.size : 1);
 		for (long irow = 1; irow <= my rows.size; irow ++) {
-			TableRow row = my rows.at [irow];
-			const char32 *string = row -> cells [columnNumber]. string;
+			const char32 *string = my rows.at [irow] -> cells [columnNumber]. string;
 			if (! string) string = U"";
-			if (! previousString || ! str32equ (string, previousString)) {
-				iunique ++;
-			}
-			row -> cells [columnNumber]. number = iunique;
-			previousString = string;
-		}
-		sortRowsByIndex_NoError (me);
+			auto found = codeOfString. emplace (string, (long) distinctStrings. size ());
+			if (found. second)
+				distinctStrings. push_back (string);
+			codes [irow] = found. first -> second;
+		}
+		std::vector <long> order (distinctStrings. size ());
+		for (size_t i = 0; i < order. size (); i ++)
+			order [i] = (long) i;
+		std::sort (order. begin (), order. end (),
+			[&] (long a, long b) { return str32cmp (distinctStrings [a], distinctStrings [b]) < 0; });
+		std::vector <long> rank (order. size ());
+		for (size_t i = 0; i < order. size (); i ++)
+			rank [order [i]] = (long) i + 1;
+		for (long irow = 1; irow <= my rows.size; irow ++)
+			my rows.at [irow] -> cells [columnNumber]. number = rank [codes [irow]];
 	}
 	my columnHeaders [columnNumber]. numericized = true;
 }
@@ -690,11 +691,109 @@ static void Table_columns_checkCrossSectionEmpty (char32 **factors, long nfactor
 	}
 }
 
+/*
+ * The rows of a table, grouped by identical (numericized) values in some columns.
+ * The groups are ordered as Table_sortRows_Assert would order them;
+ * within a group, the rows keep their original order.
+ */
+struct TableGroups {
+	long numberOfGroups;
+	autoNUMvector <long> rows;   // [1..my rows.size]: the row numbers, group by group
+	autoNUMvector <long> firstPositions;   // [1..numberOfGroups + 1]: where each group starts in `rows`
+	autoNUMvector <long> groupOfRow;   // [1..my rows.size]
+};
+
+namespace {
+	struct RowKeyHash {
+		double **keys;
+		long numberOfColumns;
+		size_t operator() (long irow) const {
+			size_t hash = 0;
+			for (long icol = 1; icol <= numberOfColumns; icol ++)
+				hash = hash * 1000003u ^ std::hash <double> () (keys [icol] [irow] + 0.0);   // + 0.0 turns -0.0 into 0.0
+			return hash;
+		}
+	};
+	struct RowKeyEqual {
+		double **keys;
+		long numberOfColumns;
+		bool operator() (long irow, long jrow) const {
+			for (long icol = 1; icol <= numberOfColumns; icol ++)
+				if (keys [icol] [irow] != keys [icol] [jrow]) return false;
+			return true;
+		}
+	};
+}
+
+static void Table_groupRows (Table me, const long *columns, long numberOfColumns, TableGroups *groups) {
+	long numberOfRows = my rows.size;
+	long size = numberOfRows > 0 ? numberOfRows : 1;
+	autoNUMmatrix <double> keys (1, numberOfColumns, 1, size);
+	for (long icol = 1; icol <= numberOfColumns; icol ++) {
+		Table_numericize_Assert (me, columns [icol]);
+		for (long irow = 1; irow <= numberOfRows; irow ++)
+			keys [icol] [irow] = my rows.at [irow] -> cells [columns [icol]]. number;
+	}
+	/*
+	 * Hash every row into the group with the same keys, numbering the groups in order of first appearance.
+	 */
+	RowKeyHash hash { keys.peek(), numberOfColumns };
+	RowKeyEqual equal { keys.peek(), numberOfColumns };
+	std::unordered_map <long, long, RowKeyHash, RowKeyEqual> groupOfFirstRow (16, hash, equal);
+	std::vector <long> firstRowOfGroup;
+	groups -> groupOfRow. reset (1, size);
+	long *groupOfRow = groups -> groupOfRow.peek();
+	for (long irow = 1; irow <= numberOfRows; irow ++) {
+		auto found = groupOfFirstRow. emplace (irow, (long) firstRowOfGroup. size ());
+		if (found. second)
+			firstRowOfGroup. push_back (irow);
+		groupOfRow [irow] = found. first -> second;
+	}
+	/*
+	 * Sort only the groups, not the rows.
+	 */
+	long numberOfGroups = (long) firstRowOfGroup. size ();
+	std::vector <long> order (numberOfGroups);
+	for (long igroup = 0; igroup < numberOfGroups; igroup ++)
+		order [igroup] = igroup;
+	std::sort (order. begin (), order. end (), [&] (long a, long b) {
+		long arow = firstRowOfGroup [a], brow = firstRowOfGroup [b];
+		for (long icol = 1; icol <= numberOfColumns; icol ++) {
+			if (keys [icol] [arow] < keys [icol] [brow]) return true;
+			if (keys [icol] [arow] > keys [icol] [brow]) return false;
+		}
+		return false;
+	});
+	std::vector <long> rank (numberOfGroups);
+	for (long igroup = 0; igroup < numberOfGroups; igroup ++)
+		rank [order [igroup]] = igroup + 1;
+	/*
+	 * Distribute the row numbers over the groups (a counting sort, which keeps the original order within each group).
+	 */
+	groups -> numberOfGroups = numberOfGroups;
+	groups -> firstPositions. reset (1, numberOfGroups + 1);
+	for (long irow = 1; irow <= numberOfRows; irow ++) {
+		groupOfRow [irow] = rank [groupOfRow [irow]];
+		groups -> firstPositions [groupOfRow [irow]] += 1;
+	}
+	long position = 1;
+	for (long igroup = 1; igroup <= numberOfGroups + 1; igroup ++) {
+		long numberOfRowsInGroup = groups -> firstPositions [igroup];
+		groups -> firstPositions [igroup] = position;
+		position += numberOfRowsInGroup;
+	}
+	groups -> rows. reset (1, size);
+	autoNUMvector <long> nextPositions (1, numberOfGroups > 0 ? numberOfGroups : 1);
+	for (long igroup = 1; igroup <= numberOfGroups; igroup ++)
+		nextPositions [igroup] = groups -> firstPositions [igroup];
+	for (long irow = 1; irow <= numberOfRows; irow ++)
+		groups -> rows [nextPositions [groupOfRow [irow]] ++] = irow;
+}
+
 autoTable Table_collapseRows (Table me, const char32 *factors_string, const char32 *columnsToSum_string,
 	const char32 *columnsToAverage_string, const char32 *columnsToMedianize_string,
 	const char32 *columnsToAverageLogarithmically_string, const char32 *columnsToMedianizeLogarithmically_string)
 {
-	bool originalChanged = false;
 	try {
 		Melder_assert (factors_string);
 
@@ -752,10 +851,6 @@ autoTable Table_collapseRows (Table me, const char32 *factors_string, const char
 			numberOfFactors + numberToSum + numberToAverage + numberToMedianize + numberToAverageLogarithmically + numberToMedianizeLogarithmically);
 		Melder_assert (thy numberOfColumns > 0);
 
-		autoNUMvector <double> sortingColumn;
-		if (numberToMedianize > 0 || numberToMedianizeLogarithmically > 0) {
-			sortingColumn.reset (1, my rows.size);
-		}
 		/*
 		 * Set the column names. Within the dependent variables, the same name may occur more than once.
 		 */
@@ -795,148 +890,111 @@ autoTable Table_collapseRows (Table me, const char32 *factors_string, const char
 			Table_numericize_checkDefined (me, columns [icol]);
 		}
 		/*
-		 * Remember the present sorting of the original table.
-		 * (This is safe: the sorting index may change only vacuously when numericizing.)
-		 * But this cannot be done before the previous block!
+		 * Group the rows by the factors (independent variables) only.
 		 */
-		for (long irow = 1; irow <= my rows.size; irow ++) {
-			TableRow row = my rows.at [irow];
-			row -> sortingIndex = irow;
-		}
+		TableGroups groups;
+		Table_groupRows (me, columns.peek(), numberOfFactors, & groups);   // this works only because the factors come first
 		/*
-		 * We will now sort the original table temporarily, by the factors (independent variables) only.
+		 * Copy the numbers of all the dependent columns we need into contiguous arrays, group by group,
+		 * so that every group can be aggregated without visiting the rows.
 		 */
-		Table_sortRows_Assert (me, columns.peek(), numberOfFactors);   /* This works only because the factors come first. */
-		originalChanged = true;
+		long numberOfRows = my rows.size;
+		autoNUMmatrix <double> numbers (1, thy numberOfColumns, 1, numberOfRows > 0 ? numberOfRows : 1);
+		for (long icol = numberOfFactors + 1; icol <= thy numberOfColumns; icol ++) {
+			for (long position = 1; position <= numberOfRows; position ++)
+				numbers [icol] [position] = my rows.at [groups. rows [position]] -> cells [columns [icol]]. number;
+		}
 		/*
-		 * Find stretches of identical factors.
+		 * Check the logarithmic columns in the order of the rows, so that we report the first offending cell.
 		 */
-		for (long irow = 1; irow <= my rows.size; irow ++) {
-			long rowmin = irow, rowmax = irow;
-			for (;;) {
-				bool identical = true;
-				if (++ rowmax > my rows.size) break;
-				for (long icol = 1; icol <= numberOfFactors; icol ++) {
-					if (my rows.at [rowmax] -> cells [columns [icol]]. number !=
-						my rows.at [rowmin] -> cells [columns [icol]]. number)
-					{
-						identical = false;
-						break;
-					}
-				}
-				if (! identical) break;
+		long firstLogarithmicColumn = numberOfFactors + numberToSum + numberToAverage + numberToMedianize + 1;
+		for (long icol = firstLogarithmicColumn; icol <= thy numberOfColumns; icol ++) {
+			for (long irow = 1; irow <= numberOfRows; irow ++) {
+				if (my rows.at [irow] -> cells [columns [icol]]. number <= 0.0)
+					Melder_throw (
+						U"The cell in column \"", thy columnHeaders [icol]. label,
+						U"\" of row ", irow, U" of ", me,
+						U" is not positive.\nCannot ",
+						icol < firstLogarithmicColumn + numberToAverageLogarithmically ? U"average" : U"medianize",
+						U" logarithmically.");
 			}
-			rowmax --;
-			/*
-			 * We have the stretch.
-			 */
-			Table_insertRow (thee.get(), thy rows.size + 1);
-			{
-				long icol = 0;
-				for (long i = 1; i <= numberOfFactors; i ++) {
-					++ icol;
-					Table_setStringValue (thee.get(), thy rows.size, icol,
-						my rows.at [rowmin] -> cells [columns [icol]]. string);
-				}
+		}
+		/*
+		 * Aggregate every group. The groups are independent, so they can be handled in parallel;
+		 * the medians sort the group's own part of the contiguous arrays in place.
+		 */
+		long numberOfGroups = groups. numberOfGroups;
+		autoNUMmatrix <double> results (1, thy numberOfColumns, 1, numberOfGroups > 0 ? numberOfGroups : 1);
+		MelderThread_parallelFor (1, numberOfGroups, 0, [&] (long firstGroup, long lastGroup, int /* threadNumber */) {
+			for (long igroup = firstGroup; igroup <= lastGroup; igroup ++) {
+				long first = groups. firstPositions [igroup], last = groups. firstPositions [igroup + 1] - 1;
+				long numberOfRowsInGroup = last - first + 1;
+				long icol = numberOfFactors;
 				for (long i = 1; i <= numberToSum; i ++) {
 					++ icol;
 					double sum = 0.0;
-					for (long jrow = rowmin; jrow <= rowmax; jrow ++) {
-						sum += my rows.at [jrow] -> cells [columns [icol]]. number;
-					}
-					Table_setNumericValue (thee.get(), thy rows.size, icol, sum);
+					for (long position = first; position <= last; position ++)
+						sum += numbers [icol] [position];
+					results [icol] [igroup] = sum;
 				}
 				for (long i = 1; i <= numberToAverage; i ++) {
 					++ icol;
 					double sum = 0.0;
-					for (long jrow = rowmin; jrow <= rowmax; jrow ++) {
-						sum += my rows.at [jrow] -> cells [columns [icol]]. number;
-					}
-					Table_setNumericValue (thee.get(), thy rows.size, icol, sum / (rowmax - rowmin + 1));
+					for (long position = first; position <= last; position ++)
+						sum += numbers [icol] [position];
+					results [icol] [igroup] = sum / numberOfRowsInGroup;
 				}
 				for (long i = 1; i <= numberToMedianize; i ++) {
 					++ icol;
-					for (long jrow = rowmin; jrow <= rowmax; jrow ++) {
-						sortingColumn [jrow] = my rows.at [jrow] -> cells [columns [icol]]. number;
-					}
-					NUMsort_d (rowmax - rowmin + 1, & sortingColumn [rowmin - 1]);
-					double median = NUMquantile (rowmax - rowmin + 1, & sortingColumn [rowmin - 1], 0.5);
-					Table_setNumericValue (thee.get(), thy rows.size, icol, median);
+					NUMsort_d (numberOfRowsInGroup, & numbers [icol] [first - 1]);
+					results [icol] [igroup] = NUMquantile (numberOfRowsInGroup, & numbers [icol] [first - 1], 0.5);
 				}
 				for (long i = 1; i <= numberToAverageLogarithmically; i ++) {
 					++ icol;
 					double sum = 0.0;
-					for (long jrow = rowmin; jrow <= rowmax; jrow ++) {
-						double value = my rows.at [jrow] -> cells [columns [icol]]. number;
-						if (value <= 0.0)
-							Melder_throw (
-								U"The cell in column \"", columnsToAverageLogarithmically [i],
-								U"\" of row ", jrow, U" of ", me,
-								U" is not positive.\nCannot average logarithmically.");
-						sum += log (value);
-					}
-					Table_setNumericValue (thee.get(), thy rows.size, icol, exp (sum / (rowmax - rowmin + 1)));
+					for (long position = first; position <= last; position ++)
+						sum += log (numbers [icol] [position]);
+					results [icol] [igroup] = exp (sum / numberOfRowsInGroup);
 				}
 				for (long i = 1; i <= numberToMedianizeLogarithmically; i ++) {
 					++ icol;
-					for (long jrow = rowmin; jrow <= rowmax; jrow ++) {
-						double value = my rows.at [jrow] -> cells [columns [icol]]. number;
-						if (value <= 0.0)
-							Melder_throw (
-								U"The cell in column \"", columnsToMedianizeLogarithmically [i],
-								U"\" of row ", jrow, U" of ", me,
-								U" is not positive.\nCannot medianize logarithmically.");
-						sortingColumn [jrow] = log (value);
-					}
-					NUMsort_d (rowmax - rowmin + 1, & sortingColumn [rowmin - 1]);
-					double median = NUMquantile (rowmax - rowmin + 1, & sortingColumn [rowmin - 1], 0.5);
-					Table_setNumericValue (thee.get(), thy rows.size, icol, exp (median));
+					for (long position = first; position <= last; position ++)
+						numbers [icol] [position] = log (numbers [icol] [position]);
+					NUMsort_d (numberOfRowsInGroup, & numbers [icol] [first - 1]);
+					results [icol] [igroup] = exp (NUMquantile (numberOfRowsInGroup, & numbers [icol] [first - 1], 0.5));
 				}
 				Melder_assert (icol == thy numberOfColumns);
 			}
-			irow = rowmax;
+		});
+		/*
+		 * Fill in the pooled table; the factors are copied from the first row of each group.
+		 */
+		for (long igroup = 1; igroup <= numberOfGroups; igroup ++) {
+			Table_appendRow (thee.get());
+			TableRow firstRow = my rows.at [groups. rows [groups. firstPositions [igroup]]];
+			for (long icol = 1; icol <= numberOfFactors; icol ++)
+				Table_setStringValue (thee.get(), igroup, icol, firstRow -> cells [columns [icol]]. string);
+			for (long icol = numberOfFactors + 1; icol <= thy numberOfColumns; icol ++)
+				Table_setNumericValue (thee.get(), igroup, icol, results [icol] [igroup]);
 		}
-		if (originalChanged) sortRowsByIndex_NoError (me);   // unsort the original table
 		return thee;
 	} catch (MelderError) {
-		if (originalChanged) sortRowsByIndex_NoError (me);   // unsort the original table   // UGLY
-		throw;
+		Melder_throw (me, U": rows not collapsed.");
 	}
 }
 
 static char32 ** _Table_getLevels (Table me, long column, long *numberOfLevels) {
-	try {
-		for (long irow = 1; irow <= my rows.size; irow ++) {
-			TableRow row = my rows.at [irow];
-			row -> sortingIndex = irow;
-		}
-		long columns [2] = { 0, column };
-		Table_sortRows_Assert (me, columns, 1);
-		*numberOfLevels = 0;
-		long irow = 1;
-		while (irow <= my rows.size) {
-			double value = my rows.at [irow] -> cells [column]. number;
-			(*numberOfLevels) ++;
-			while (++ irow <= my rows.size && my rows.at [irow] -> cells [column]. number == value) { }
-		}
-		autostring32vector result (1, *numberOfLevels);
-		*numberOfLevels = 0;
-		irow = 1;
-		while (irow <= my rows.size) {
-			double value = my rows.at [irow] -> cells [column]. number;
-			result [++ *numberOfLevels] = Melder_dup (Table_getStringValue_Assert (me, irow, column));
-			while (++ irow <= my rows.size && my rows.at [irow] -> cells [column]. number == value) { }
-		}
-		sortRowsByIndex_NoError (me);   // unsort the original table
-		return result.transfer();
-	} catch (MelderError) {
-		sortRowsByIndex_NoError (me);   // unsort the original table   // UGLY
-		throw;
-	}
+	TableGroups groups;
+	long columns [2] = { 0, column };
+	Table_groupRows (me, columns, 1, & groups);
+	*numberOfLevels = groups. numberOfGroups;
+	autostring32vector result (1, *numberOfLevels);
+	for (long ilevel = 1; ilevel <= *numberOfLevels; ilevel ++)
+		result [ilevel] = Melder_dup (Table_getStringValue_Assert (me, groups. rows [groups. firstPositions [ilevel]], column));
+	return result.transfer();
 }
 
 autoTable Table_rowsToColumns (Table me, const char32 *factors_string, long columnToTranspose, const char32 *columnsToExpand_string) {
-	bool originalChanged = false;
 	try {
 		Melder_assert (factors_string);
 
@@ -995,59 +1053,28 @@ autoTable Table_rowsToColumns (Table me, const char32 *factors_string, long colu
 			}
 		}
 		/*
-		 * Remember the present sorting of the original table.
-		 * (This is safe: the sorting index may change only vacuously when numericizing.)
-		 * But this cannot be done before the previous blocks that numericize!
-		 */
-		for (long irow = 1; irow <= my rows.size; irow ++) {
-			TableRow row = my rows.at [irow];
-			row -> sortingIndex = irow;
-		}
-		/*
-		 * We will now sort the original table temporarily, by the factors (independent variables) only.
+		 * Group the rows by the factors (independent variables) only,
+		 * and find the level of every row in the column to transpose.
 		 */
-		Table_sortRows_Assert (me, factorColumns.peek(), numberOfFactors);
-		originalChanged = true;
-		/*
-		 * Find stretches of identical factors.
-		 */
-		for (long irow = 1; irow <= my rows.size; irow ++) {
-			long rowmin = irow, rowmax = irow;
-			for (;;) {
-				bool identical = true;
-				if (++ rowmax > my rows.size) break;
-				for (long ifactor = 1; ifactor <= numberOfFactors; ifactor ++) {
-					if (my rows.at [rowmax] -> cells [factorColumns [ifactor]]. number !=
-						my rows.at [rowmin] -> cells [factorColumns [ifactor]]. number)
-					{
-						identical = false;
-						break;
-					}
-				}
-				if (! identical) break;
-			}
-			#if 0
-			if (rowmax - rowmin > numberOfLevels && ! warned) {
-				Melder_warning (U"Some rows of the original table have not been included in the new table. "
-					U"You could perhaps add more factors.");
-				warned = true;
-			}
-			#endif
-			rowmax --;
-			/*
-			 * We have the stretch.
-			 */
-			Table_insertRow (thee.get(), thy rows.size + 1);
+		TableGroups groups, levels;
+		Table_groupRows (me, factorColumns.peek(), numberOfFactors, & groups);
+		long transposeColumns [2] = { 0, columnToTranspose };
+		Table_groupRows (me, transposeColumns, 1, & levels);
+		Melder_assert (levels. numberOfGroups == numberOfLevels);
+		for (long igroup = 1; igroup <= groups. numberOfGroups; igroup ++) {
+			long first = groups. firstPositions [igroup], last = groups. firstPositions [igroup + 1] - 1;
+			Table_appendRow (thee.get());
 			TableRow thyRow = thy rows.at [thy rows.size];
+			TableRow firstRow = my rows.at [groups. rows [first]];
 			for (long ifactor = 1; ifactor <= numberOfFactors; ifactor ++) {
 				Table_setStringValue (thee.get(), thy rows.size, ifactor,
-					my rows.at [rowmin] -> cells [factorColumns [ifactor]]. string);
+					firstRow -> cells [factorColumns [ifactor]]. string);
 			}
 			for (long iexpand = 1; iexpand <= numberToExpand; iexpand ++) {
-				for (long jrow = rowmin; jrow <= rowmax; jrow ++) {
-					TableRow myRow = my rows.at [jrow];
-					double value = myRow -> cells [columnsToExpand [iexpand]]. number;
-					long level = lround (myRow -> cells [columnToTranspose]. number);
+				for (long position = first; position <= last; position ++) {
+					long irow = groups. rows [position];
+					double value = my rows.at [irow] -> cells [columnsToExpand [iexpand]]. number;
+					long level = levels. groupOfRow [irow];
 					long thyColumn = numberOfFactors + (iexpand - 1) * numberOfLevels + level;
 					if (thyRow -> cells [thyColumn]. string && ! warned) {
 						Melder_warning (U"Some information from the original table has not been included in the new table. "
@@ -1057,13 +1084,10 @@ autoTable Table_rowsToColumns (Table me, const char32 *factors_string, long colu
 					Table_setNumericValue (thee.get(), thy rows.size, thyColumn, value);
 				}
 			}
-			irow = rowmax;
 		}
-		if (originalChanged) sortRowsByIndex_NoError (me);   // unsort the original table
 		return thee;
 	} catch (MelderError) {
-		if (originalChanged) sortRowsByIndex_NoError (me);   // unsort the original table   // UGLY
-		throw;
+		Melder_throw (me, U": rows not converted to columns.");
 	}
 }
 
@@ -1972,29 +1996,39 @@ autoTable Table_readFromCharacterSeparatedTextFile (MelderFile file, char32 sepa
 		/*
 		 * Kill final new-line symbols.
 		 */
-		for (int64 length = str32len (string.peek()); length > 0 && string [length - 1] == U'\n'; length = str32len (string.peek())) string [length - 1] = U'\0';
+		int64 length = str32len (string.peek());
+		while (length > 0 && string [length - 1] == U'\n')
+			string [-- length] = U'\0';
 
 		/*
-		 * Count columns.
+		 * Find the beginning of every line, and terminate every line with a null character,
+		 * so that the rows can be read independently of each other.
 		 */
-		long ncol = 1;
-		const char32 *p = & string [0];
-		for (;;) {
-			char32 kar = *p++;
-			if (kar == U'\0') Melder_throw (U"No rows.");
-			if (kar == U'\n') break;
-			if (kar == separator) ncol ++;
+		long numberOfLines = 1;
+		for (int64 i = 0; i < length; i ++)
+			if (string [i] == U'\n') numberOfLines ++;
+		if (numberOfLines < 2)
+			Melder_throw (U"No rows.");
+		autoNUMvector <char32 *> lines (1, numberOfLines);
+		{// scope
+			long iline = 1;
+			lines [1] = & string [0];
+			for (int64 i = 0; i < length; i ++) {
+				if (string [i] == U'\n') {
+					string [i] = U'\0';
+					lines [++ iline] = & string [i + 1];
+				}
+			}
+			Melder_assert (iline == numberOfLines);
 		}
 
 		/*
-		 * Count rows.
+		 * Count columns.
 		 */
-		long nrow = 1;
-		for (;;) {
-			char32 kar = *p++;
-			if (kar == U'\0') break;
-			if (kar == U'\n') nrow ++;
-		}
+		long ncol = 1;
+		for (const char32 *p = lines [1]; *p != U'\0'; p ++)
+			if (*p == separator) ncol ++;
+		long nrow = numberOfLines - 1;
 
 		/*
 		 * Create empty table.
@@ -2004,43 +2038,59 @@ autoTable Table_readFromCharacterSeparatedTextFile (MelderFile file, char32 sepa
 		/*
 		 * Read column names.
 		 */
-		autoMelderString buffer;
-		p = & string [0];
-		for (long icol = 1; icol <= ncol; icol ++) {
-			MelderString_empty (& buffer);
-			while (*p != separator && *p != U'\n') {
-				Melder_assert (*p != U'\0');
-				MelderString_appendCharacter (& buffer, *p);
+		{// scope
+			autoMelderString buffer;
+			const char32 *p = lines [1];
+			for (long icol = 1; icol <= ncol; icol ++) {
+				MelderString_empty (& buffer);
+				while (*p != separator && *p != U'\0') {
+					MelderString_appendCharacter (& buffer, *p);
+					p ++;
+				}
 				p ++;
+				Table_setColumnLabel (me.get(), icol, buffer.string);
 			}
-			p ++;
-			Table_setColumnLabel (me.get(), icol, buffer.string);
 		}
 
 		/*
-		 * Read cells.
+		 * Read cells. The rows are independent, so they can be read in parallel;
+		 * every cell receives a string of exactly the right size.
+		 * If some rows have the wrong number of cells, we report the first of them.
 		 */
-		for (long irow = 1; irow <= nrow; irow ++) {
-			TableRow row = my rows.at [irow];
-			for (long icol = 1; icol <= ncol; icol ++) {
-				MelderString_empty (& buffer);
-				while (*p != separator && *p != U'\n' && *p != U'\0') {
-					MelderString_appendCharacter (& buffer, *p);
-					p ++;
-				}
-				if (*p == U'\0') {
-					if (irow != nrow) Melder_fatal (U"irow ", irow, U", nrow ", nrow, U", icol ", icol, U", ncol ", ncol);
-					if (icol != ncol) Melder_throw (U"Last row incomplete.");
-				} else if (*p == U'\n') {
-					if (icol != ncol) Melder_throw (U"Row ", irow, U" incomplete.");
-					p ++;
-				} else {
-					Melder_assert (*p == separator);
-					p ++;
+		std::atomic <long> firstIncompleteRow (0), firstOverfullRow (0);
+		auto remember = [] (std::atomic <long> & firstRow, long irow) {
+			long current = firstRow;
+			while ((current == 0 || irow < current) && ! firstRow. compare_exchange_weak (current, irow)) { }
+		};
+		MelderThread_parallelFor (1, nrow, 0, [&] (long firstRow, long lastRow, int /* threadNumber */) {
+			for (long irow = firstRow; irow <= lastRow; irow ++) {
+				TableRow row = my rows.at [irow];
+				const char32 *p = lines [irow + 1];
+				for (long icol = 1; icol <= ncol; icol ++) {
+					const char32 *cellStart = p;
+					while (*p != separator && *p != U'\0') p ++;
+					int64 cellLength = p - cellStart;
+					char32 *cell = Melder_malloc (char32, cellLength + 1);
+					memcpy (cell, cellStart, (size_t) cellLength * sizeof (char32));
+					cell [cellLength] = U'\0';
+					row -> cells [icol]. string = cell;
+					if (*p == U'\0') {
+						if (icol != ncol) {
+							remember (firstIncompleteRow, irow);
+							break;
+						}
+					} else {
+						p ++;   // skip the separator
+						if (icol == ncol)
+							remember (firstOverfullRow, irow);
+					}
 				}
-				row -> cells [icol]. string = Melder_dup (buffer.string);   // BUG? could be null
 			}
-		}
+		});
+		if (firstIncompleteRow != 0 && (firstOverfullRow == 0 || firstIncompleteRow < firstOverfullRow))
+			Melder_throw (U"Row ", (long) firstIncompleteRow, U" incomplete.");
+		if (firstOverfullRow != 0)
+			Melder_throw (U"Row ", (long) firstOverfullRow, U" has more than ", ncol, U" cells.");
 		return me;
 	} catch (MelderError) {
 		Melder_throw (U"Table object not read from character-separated text file ", file, U".");
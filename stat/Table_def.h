@@ -36,10 +36,6 @@ oo_DEFINE_CLASS (TableRow, Daata)
 	oo_LONG (numberOfColumns)
 	oo_STRUCT_VECTOR (TableCell, cells, numberOfColumns)
 
-	#if oo_DECLARING || oo_COPYING
-		oo_LONG (sortingIndex)
-	#endif
-
 oo_END_CLASS (TableRow)
 #undef ooSTRUCT
 
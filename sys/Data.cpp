@@ -167,6 +167,37 @@ void Data_writeToBinaryFile (Daata me, MelderFile file) {
 	}
 }
 
+namespace {
+	struct autoMappedBinary {   // switches the mapped format on for as long as a file is being written or read
+		bool d_on;
+		autoMappedBinary (bool on) : d_on (on) { if (d_on) NUMmatrix_setMappedBinary (true); }
+		~autoMappedBinary () { if (d_on) NUMmatrix_setMappedBinary (false); }
+	};
+}
+
+void Data_writeToMappedBinaryFile (Daata me, MelderFile file) {
+	try {
+		if (! Data_canWriteBinary (me))
+			Melder_throw (U"Objects of class ", my classInfo -> className, U" cannot be written to a generic binary file.");
+		autoMelderFile mfile = MelderFile_create (file);
+		if (fprintf (file -> filePointer, "ooMappedBinaryFile") < 0)
+			Melder_throw (U"Cannot write first bytes of file.");
+		binputi2 (Data_MAPPED_BINARY_FILE_VERSION, file -> filePointer);
+		binputw1 (
+			my classInfo -> version > 0 ?
+				Melder_cat (my classInfo -> className, U" ", my classInfo -> version) :
+				my classInfo -> className,
+			file -> filePointer);
+		{
+			autoMappedBinary mappedBinary (true);
+			Data_writeBinary (me, file -> filePointer);
+		}
+		mfile.close ();
+	} catch (MelderError) {
+		Melder_throw (me, U": not written to mapped binary file ", file, U".");
+	}
+}
+
 bool Data_canReadText (Daata me) {
 	return my v_writable ();
 }
@@ -234,7 +265,16 @@ autoDaata Data_readFromBinaryFile (MelderFile file) {
 		char *end = strstr (line, "ooBinaryFile");
 		autoDaata me;
 		int formatVersion;
-		if (end) {
+		bool mapped = false;
+		if (strncmp (line, "ooMappedBinaryFile", strlen ("ooMappedBinaryFile")) == 0) {
+			fseek (f, strlen ("ooMappedBinaryFile"), 0);
+			int containerVersion = bingeti2 (f);
+			if (containerVersion > Data_MAPPED_BINARY_FILE_VERSION)
+				Melder_throw (U"This mapped binary file was written by a newer version of Praat. Please upgrade Praat.");
+			autostring8 klas = bingets1 (f);
+			me = Thing_newFromClassName (Melder_peek8to32 (klas.peek()), & formatVersion).static_cast_move <structDaata> ();
+			mapped = true;
+		} else if (end) {
 			fseek (f, strlen ("ooBinaryFile"), 0);
 			autostring8 klas = bingets1 (f);
 			me = Thing_newFromClassName (Melder_peek8to32 (klas.peek()), & formatVersion).static_cast_move <structDaata> ();
@@ -250,7 +290,10 @@ autoDaata Data_readFromBinaryFile (MelderFile file) {
 			fread (line, 1, end - line + strlen ("BinaryFile"), f);
 		}
 		MelderFile_getParentDir (file, & Data_directoryBeingRead);
-		Data_readBinary (me.get(), f, formatVersion);
+		{
+			autoMappedBinary mappedBinary (mapped);
+			Data_readBinary (me.get(), f, formatVersion);
+		}
 		file -> format = structMelderFile :: Format :: binary;
 		f.close (file);
 		return me;
@@ -185,6 +185,19 @@ void Data_writeToBinaryFile (Daata me, MelderFile file);
 		The format of the file after this is the same as in Data_writeBinary.
 */
 
+#define Data_MAPPED_BINARY_FILE_VERSION  1
+
+void Data_writeToMappedBinaryFile (Daata me, MelderFile file);
+/*
+	Message:
+		"try to write yourself as binary data to a file that can be mapped into memory when read".
+	Description:
+		The file starts with "ooMappedBinaryFile", the version of this format, and your class name;
+		the format after this is the same as in Data_writeBinary, except that matrices of doubles
+		are written as little-endian doubles, large ones at a multiple of NUMmatrix_MAPPED_ALIGNMENT bytes,
+		so that Data_readFromBinaryFile can map them into memory instead of reading them.
+*/
+
 bool Data_canReadText (Daata me);
 /*
 	Message:
@@ -34,14 +34,16 @@
 #include "UiPause.h"
 #include "DemoEditor.h"
 
-static Interpreter theInterpreter;
-static autoInterpreter theLocalInterpreter;
-static Daata theSource;
-static const char32 *theExpression;
-static int theLevel = 1;
+/*
+	The state of the compiler and of the running program is thread-local,
+	so that different threads can compile and run formulas at the same time.
+*/
+static Melder_THREAD_LOCAL Interpreter theInterpreter;
+static Melder_THREAD_LOCAL Daata theSource;
+static Melder_THREAD_LOCAL const char32 *theExpression;
+static Melder_THREAD_LOCAL int theLevel = 1;
 #define MAXIMUM_NUMBER_OF_LEVELS  20
-static int theExpressionType [1 + MAXIMUM_NUMBER_OF_LEVELS];
-static bool theOptimize;
+static Melder_THREAD_LOCAL bool theOptimize;
 
 static struct Formula_NumericVector theZeroNumericVector = { 0, nullptr };
 static struct Formula_NumericMatrix theZeroNumericMatrix = { 0, 0, nullptr };
@@ -59,8 +61,8 @@ typedef struct structFormulaInstruction {
 	} content;
 } *FormulaInstruction;
 
-static FormulaInstruction lexan, parse;
-static int ilabel, ilexan, iparse, numberOfInstructions, numberOfStringConstants;
+static Melder_THREAD_LOCAL FormulaInstruction lexan, parse;
+static Melder_THREAD_LOCAL int ilabel, ilexan, iparse, numberOfInstructions, numberOfStringConstants;
 
 enum { GEENSYMBOOL_,
 
@@ -296,12 +298,12 @@ static const char32 *Formula_instructionNames [1 + hoogsteSymbool] = { U"",
 #define oudlees  (-- ilexan)
 
 static void formulefout (const char32 *message, int position) {
-	static MelderString truncatedExpression { 0 };
+	static Melder_THREAD_LOCAL MelderString truncatedExpression { 0 };
 	MelderString_ncopy (& truncatedExpression, theExpression, position + 1);
 	Melder_throw (message, U":\n" U_LEFT_GUILLEMET U" ", truncatedExpression.string);
 }
 
-static const char32 *languageNameCompare_searchString;
+static Melder_THREAD_LOCAL const char32 *languageNameCompare_searchString;
 
 static int languageNameCompare (const void *first, const void *second) {
 	int i = * (int *) first, j = * (int *) second;
@@ -310,7 +312,7 @@ static int languageNameCompare (const void *first, const void *second) {
 }
 
 static int Formula_hasLanguageName (const char32 *f) {
-	static int *index;
+	static Melder_THREAD_LOCAL int *index;
 	if (! index) {
 		index = NUMvector <int> (1, hoogsteInvoersymbool);
 		for (int tok = 1; tok <= hoogsteInvoersymbool; tok ++) {
@@ -358,7 +360,7 @@ static void Formula_lexan () {
 #define tokgetal(g)  lexan [itok]. content.number = (g)
 #define tokmatriks(m)  lexan [itok]. content.object = (m)
 
-	static MelderString token { 0 };   /* String to collect a symbol name in. */
+	static Melder_THREAD_LOCAL MelderString token { 0 };   /* String to collect a symbol name in. */
 #define stokaan MelderString_empty (& token);
 #define stokkar { MelderString_appendCharacter (& token, kar); nieuwkar; }
 #define stokuit (void) 0
@@ -813,7 +815,7 @@ static void pas (int symbol) {
 		const char32 *symbolName2 = Formula_instructionNames [lexan [ilexan]. symbol];
 		bool needQuotes1 = ( str32chr (symbolName1, U' ') == nullptr );
 		bool needQuotes2 = ( str32chr (symbolName2, U' ') == nullptr );
-		static MelderString melding { 0 };
+		static Melder_THREAD_LOCAL MelderString melding { 0 };
 		MelderString_copy (& melding,
 			U"Expected ", needQuotes1 ? U"\"" : nullptr, symbolName1, needQuotes1 ? U"\"" : nullptr,
 			U", but found ", needQuotes2 ? U"\"" : nullptr, symbolName2, needQuotes2 ? U"\"" : nullptr);
@@ -827,7 +829,7 @@ static bool pasArguments () {
     if (symbol == COLON_) return false;   // success: a function call like: myFunction: ...
     const char32 *symbolName2 = Formula_instructionNames [lexan [ilexan]. symbol];
     bool needQuotes2 = ( str32chr (symbolName2, U' ') == nullptr );
-    static MelderString melding { 0 };
+    static Melder_THREAD_LOCAL MelderString melding { 0 };
     MelderString_copy (& melding,
 		U"Expected \"(\" or \":\", but found ", needQuotes2 ? U"\"" : nullptr, symbolName2, needQuotes2 ? U"\"" : nullptr);
     formulefout (melding.string, lexan [ilexan]. position);
@@ -1909,22 +1911,148 @@ static void Formula_print (FormulaInstruction f) {
 	} while (symbol != END_);
 }
 
-void Formula_compile (Interpreter interpreter, Daata data, const char32 *expression, int expressionType, bool optimize) {
-	theInterpreter = interpreter;
-	if (! theInterpreter) {
-		if (! theLocalInterpreter) {
-			theLocalInterpreter = Interpreter_create (nullptr, nullptr);
-		}
-		theInterpreter = theLocalInterpreter.get();
-		for (std::unordered_map<std::u32string, InterpreterVariable>::iterator it = theInterpreter -> variablesMap. begin(); it != theInterpreter -> variablesMap. end(); it ++) {
-			InterpreterVariable var = it -> second;
-			forget (var);
+Thing_implement (FormulaProgram, Thing, 0);
+
+static inline bool Formula_instructionOwnsString (int symbol) {
+	return symbol == STRING_ || symbol == VARIABLE_NAME_ || symbol == INDEXED_NUMERIC_VARIABLE_ || symbol == INDEXED_STRING_VARIABLE_ || symbol == CALL_;
+}
+
+static void FormulaProgram_freeStrings (FormulaProgram me) {
+	for (int i = 1; i <= my numberOfInstructions; i ++)
+		if (Formula_instructionOwnsString (my instructions [i]. symbol))
+			Melder_free (my instructions [i]. content.string);
+	my numberOfInstructions = 0;
+}
+
+void structFormulaProgram :: v_destroy () noexcept {
+	FormulaProgram_freeStrings (this);
+	Melder_free (our instructions);
+	FormulaProgram_Parent :: v_destroy ();
+}
+
+/*
+	Whether running an instruction touches nothing but the stack and the objects it reads from.
+	This is an allow-list: every symbol that is not mentioned here has not been checked,
+	and is taken to change variables, selections, files, the Info window, the random generator,
+	the regular-expression engine or some other static state. A program that contains such a symbol
+	is not run by several threads at the same time.
+*/
+static inline bool Formula_isThreadSafeSymbol (int symbol) {
+	switch (symbol) {
+		/*
+			Values, operators and flow of control.
+		*/
+		case NUMBER_: case NUMBER_PI_: case NUMBER_E_: case NUMBER_UNDEFINED_: case TRUE_: case FALSE_:
+		case NOT_: case EQ_: case NE_: case LE_: case LT_: case GE_: case GT_:
+		case ADD_: case SUB_: case MUL_: case RDIV_: case IDIV_: case MOD_: case POWER_: case MINUS_: case SQR_:
+		case GOTO_: case IFTRUE_: case IFFALSE_: case LABEL_: case ADD_3DOWN_: case POP_2_: case END_:
+		/*
+			Reading from the object that the formula works on, or from other objects.
+		*/
+		case XMIN_: case XMAX_: case YMIN_: case YMAX_: case NX_: case NY_: case DX_: case DY_:
+		case ROW_: case COL_: case NROW_: case NCOL_: case ROWSTR_: case COLSTR_: case Y_: case X_:
+		case SELF0_: case SELFSTR0_: case SELFMATRIKS1_: case SELFMATRIKSSTR1_: case SELFMATRIKS2_: case SELFMATRIKSSTR2_:
+		case SELFFUNKTIE1_: case SELFFUNKTIE2_:
+		case OBJECTCELL0_: case OBJECTCELL1_: case OBJECTCELLSTR1_: case OBJECTCELL2_: case OBJECTCELLSTR2_:
+		case OBJECTLOCATION0_: case OBJECTLOCATION1_: case OBJECTLOCATION2_:
+		case MATRIKS0_: case MATRIKS1_: case MATRIKSSTR1_: case MATRIKS2_: case MATRIKSSTR2_:
+		case FUNKTIE0_: case FUNKTIE1_: case FUNKTIE2_:
+		/*
+			Reading variables.
+		*/
+		case STRING_: case NUMERIC_VARIABLE_: case NUMERIC_VECTOR_VARIABLE_: case NUMERIC_MATRIX_VARIABLE_: case STRING_VARIABLE_:
+		case NUMERIC_VECTOR_ELEMENT_: case NUMERIC_MATRIX_ELEMENT_:
+		/*
+			Pure numeric functions (not the random ones, and not NUMinvBinomialP and NUMinvBinomialQ, which use a static struct).
+		*/
+		case ABS_: case ROUND_: case FLOOR_: case CEILING_: case RECTIFY_: case RECTIFY_NUMVEC_:
+		case SQRT_: case SIN_: case COS_: case TAN_: case ARCSIN_: case ARCCOS_: case ARCTAN_: case SINC_: case SINCPI_:
+		case EXP_: case EXP_NUMVEC_: case EXP_NUMMAT_:
+		case SINH_: case COSH_: case TANH_: case ARCSINH_: case ARCCOSH_: case ARCTANH_:
+		case SIGMOID_: case SIGMOID_NUMVEC_: case SOFTMAX_NUMVEC_:
+		case INV_SIGMOID_: case ERF_: case ERFC_: case GAUSS_P_: case GAUSS_Q_: case INV_GAUSS_Q_:
+		case LOG2_: case LN_: case LOG10_: case LN_GAMMA_:
+		case HERTZ_TO_BARK_: case BARK_TO_HERTZ_: case PHON_TO_DIFFERENCE_LIMENS_: case DIFFERENCE_LIMENS_TO_PHON_:
+		case HERTZ_TO_MEL_: case MEL_TO_HERTZ_: case HERTZ_TO_SEMITONES_: case SEMITONES_TO_HERTZ_:
+		case ERB_: case HERTZ_TO_ERB_: case ERB_TO_HERTZ_:
+		case SUM_: case MEAN_: case STDEV_: case CENTER_:
+		case ARCTAN2_: case CHI_SQUARE_P_: case CHI_SQUARE_Q_: case INCOMPLETE_GAMMAP_:
+		case INV_CHI_SQUARE_Q_: case STUDENT_P_: case STUDENT_Q_: case INV_STUDENT_Q_:
+		case BETA_: case BETA2_: case BESSEL_I_: case BESSEL_K_: case LN_BETA_: case SOUND_PRESSURE_TO_PHON_:
+		case OUTER_NUMMAT_: case MUL_NUMVEC_:
+		case FISHER_P_: case FISHER_Q_: case INV_FISHER_Q_: case BINOMIAL_P_: case BINOMIAL_Q_: case INCOMPLETE_BETA_:
+		case MIN_: case MAX_: case IMIN_: case IMAX_:
+		case ZERO_NUMVEC_: case ZERO_NUMMAT_: case LINEAR_NUMVEC_: case LINEAR_NUMMAT_:
+		case NUMBER_OF_ROWS_: case NUMBER_OF_COLUMNS_: case HASH_:
+		/*
+			String functions that only allocate their result (not the regular-expression ones).
+		*/
+		case LENGTH_: case STRING_TO_NUMBER_: case LEFTSTR_: case RIGHTSTR_: case MIDSTR_:
+		case INDEX_: case RINDEX_: case STARTS_WITH_: case ENDS_WITH_: case REPLACESTR_:
+		case EXTRACT_NUMBER_: case EXTRACT_WORDSTR_: case EXTRACT_LINESTR_:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static Melder_THREAD_LOCAL FormulaInstruction theInstructions;
+static Melder_THREAD_LOCAL int programPointer;
+static Melder_THREAD_LOCAL struct structStackel *theStackMemory;
+#define Formula_STACK_SIZE  10000
+static Melder_THREAD_LOCAL Stackel theStack;
+static Melder_THREAD_LOCAL int w, wmax;   /* w = stack pointer; */
+
+/*
+	Running a formula changes theInterpreter, theSource and theOptimize, and a formula can compile and run other formulas
+	(e.g. with runScript or do), so the state of the outer formula is saved here and restored when the inner one is done.
+*/
+class autoFormulaState {
+	Interpreter interpreter;
+	Daata source;
+	bool optimize;
+	FormulaInstruction instructions;
+	int programPointer, w, wmax;
+	Stackel stack;
+public:
+	autoFormulaState () :
+		interpreter (theInterpreter), source (theSource), optimize (theOptimize), instructions (theInstructions),
+		programPointer (::programPointer), w (::w), wmax (::wmax), stack (theStack) { }
+	~autoFormulaState () {
+		theInterpreter = our interpreter;
+		theSource = our source;
+		theOptimize = our optimize;
+		theInstructions = our instructions;
+		::programPointer = our programPointer;
+		::w = our w;
+		::wmax = our wmax;
+		theStack = our stack;
+	}
+};
+
+/*
+	Compile into a new or a previously used program.
+*/
+static void FormulaProgram_compile (FormulaProgram me, Interpreter interpreter, Daata data, const char32 *expression, int expressionType, bool optimize) {
+	autoFormulaState savedState;
+	FormulaProgram_freeStrings (me);
+	if (interpreter) {
+		my interpreter = interpreter;
+	} else {
+		if (! my ownInterpreter) {
+			my ownInterpreter = Interpreter_create (nullptr, nullptr);   // for the loop variables of this formula only
+		} else {
+			for (std::unordered_map<std::u32string, InterpreterVariable>::iterator it = my ownInterpreter -> variablesMap. begin(); it != my ownInterpreter -> variablesMap. end(); it ++) {
+				InterpreterVariable var = it -> second;
+				forget (var);
+			}
+			my ownInterpreter -> variablesMap. clear ();
 		}
-		theInterpreter -> variablesMap. clear ();
+		my interpreter = my ownInterpreter.get();
 	}
+	theInterpreter = my interpreter;
 	theSource = data;
 	theExpression = expression;
-	theExpressionType [theLevel] = expressionType;
 	theOptimize = optimize;
 	if (! lexan) {
 		lexan = Melder_calloc_f (struct structFormulaInstruction, 3000);
@@ -1940,7 +2068,7 @@ void Formula_compile (Interpreter interpreter, Daata data, const char32 *express
 		ilexan = 1;
 		for (;;) {
 			int symbol = lexan [ilexan]. symbol;
-			if (symbol == STRING_ || symbol == VARIABLE_NAME_ || symbol == INDEXED_NUMERIC_VARIABLE_ || symbol == INDEXED_STRING_VARIABLE_ || symbol == CALL_) Melder_free (lexan [ilexan]. content.string);
+			if (Formula_instructionOwnsString (symbol)) Melder_free (lexan [ilexan]. content.string);
 			else if (symbol == END_) break;   /* Either the end of a formula, or the end of lexan. */
 			ilexan ++;
 		}
@@ -1959,14 +2087,139 @@ void Formula_compile (Interpreter interpreter, Daata data, const char32 *express
 	}
 	Formula_removeLabels ();
 	if (Melder_debug == 17) Formula_print (parse);
+
+	/*
+		Copy the program out of the thread's work space,
+		so that it stays valid when other formulas are compiled.
+	*/
+	my source = data;
+	my expressionType = expressionType;
+	my optimize = optimize;
+	if (numberOfInstructions > my numberOfAllocatedInstructions) {
+		Melder_free (my instructions);
+		my numberOfAllocatedInstructions = 0;
+		my instructions = Melder_calloc (struct structFormulaInstruction, 1 + numberOfInstructions);
+		my numberOfAllocatedInstructions = numberOfInstructions;
+	}
+	memcpy (& my instructions [1], & parse [1], numberOfInstructions * sizeof (struct structFormulaInstruction));
+	my numberOfInstructions = numberOfInstructions;
+	if (numberOfStringConstants > 0)
+		for (int i = 1; i <= numberOfInstructions; i ++)
+			if (Formula_instructionOwnsString (parse [i]. symbol))
+				my instructions [i]. content.string = Melder_dup_f (parse [i]. content.string);   // the original belongs to lexan
+	my isThreadSafe = false;   // until proven otherwise
+	my blockStackDepth = 0;
+	my refersToObjectNames = false;
+	for (int i = 1; lexan [i]. symbol != END_; i ++)
+		if (lexan [i]. symbol == MATRIKS_ || lexan [i]. symbol == MATRIKSSTR_)
+			my refersToObjectNames = true;
+}
+
+/*
+	Whether the program can be run on blocks of cells (see FormulaProgram_runBlock below),
+	and if so, how many blocks of values it needs on its stack; 0 means that it cannot.
+*/
+static bool Formula_hasImplicitCells (Daata thee) {
+	return thee && (thy v_hasGetCell () || thy v_hasGetVector () || thy v_hasGetMatrix ());
+}
+static int FormulaProgram_getBlockStackDepth (FormulaProgram me) {
+	if (my expressionType != kFormula_EXPRESSION_TYPE_NUMERIC)
+		return 0;
+	int depth = 0, maximumDepth = 0;
+	for (int i = 1; i <= my numberOfInstructions; i ++) {
+		FormulaInstruction instruction = & my instructions [i];
+		switch (instruction -> symbol) {
+			case NUMBER_: case NUMERIC_VARIABLE_: case TRUE_: case FALSE_: case ROW_: case COL_:
+				depth ++;
+				break;
+			case X_:
+				if (! my source || ! my source -> v_hasGetX ()) return 0;
+				depth ++;
+				break;
+			case Y_:
+				if (! my source || ! my source -> v_hasGetY ()) return 0;
+				depth ++;
+				break;
+			case SELF0_:
+				if (! Formula_hasImplicitCells (my source)) return 0;
+				depth ++;
+				break;
+			case MATRIKS0_:
+				if (! Formula_hasImplicitCells (instruction -> content.object)) return 0;
+				depth ++;
+				break;
+			case NOT_: case MINUS_: case SQR_:
+			case ABS_: case ROUND_: case FLOOR_: case CEILING_: case RECTIFY_:
+			case SQRT_: case SIN_: case COS_: case TAN_: case ARCSIN_: case ARCCOS_: case ARCTAN_: case SINC_: case SINCPI_:
+			case EXP_: case SINH_: case COSH_: case TANH_: case ARCSINH_: case ARCCOSH_: case ARCTANH_:
+			case SIGMOID_: case INV_SIGMOID_: case ERF_: case ERFC_: case GAUSS_P_: case GAUSS_Q_: case INV_GAUSS_Q_:
+			case LOG2_: case LN_: case LOG10_: case LN_GAMMA_:
+			case HERTZ_TO_BARK_: case BARK_TO_HERTZ_: case PHON_TO_DIFFERENCE_LIMENS_: case DIFFERENCE_LIMENS_TO_PHON_:
+			case HERTZ_TO_MEL_: case MEL_TO_HERTZ_: case HERTZ_TO_SEMITONES_: case SEMITONES_TO_HERTZ_:
+			case ERB_: case HERTZ_TO_ERB_: case ERB_TO_HERTZ_:
+				if (depth < 1) return 0;
+				break;
+			case EQ_: case NE_: case LE_: case LT_: case GE_: case GT_:
+			case ADD_: case SUB_: case MUL_: case RDIV_: case IDIV_: case MOD_: case POWER_: case ARCTAN2_:
+				if (depth < 2) return 0;
+				depth --;
+				break;
+			default:
+				return 0;   // control flow, strings, vectors, other objects, side effects
+		}
+		if (depth > maximumDepth) maximumDepth = depth;
+	}
+	return depth == 1 ? maximumDepth : 0;
+}
+
+autoFormulaProgram Formula_compileProgram (Interpreter interpreter, Daata data, const char32 *expression, int expressionType, bool optimize) {
+	autoFormulaProgram me = Thing_new (FormulaProgram);
+	FormulaProgram_compile (me.get(), interpreter, data, expression, expressionType, optimize);
+	my isThreadSafe = true;
+	for (int i = 1; i <= my numberOfInstructions; i ++)
+		if (! Formula_isThreadSafeSymbol (my instructions [i]. symbol))
+			my isThreadSafe = false;
+	my blockStackDepth = FormulaProgram_getBlockStackDepth (me.get());
+	return me;
+}
+
+bool FormulaProgram_isCellIndependent (FormulaProgram me, Daata target) {
+	if (! my isThreadSafe)
+		return false;
+	for (int i = 1; i <= my numberOfInstructions; i ++) {
+		FormulaInstruction instruction = & my instructions [i];
+		switch (instruction -> symbol) {
+			case SELFMATRIKS1_: case SELFMATRIKSSTR1_: case SELFMATRIKS2_: case SELFMATRIKSSTR2_:
+			case SELFFUNKTIE1_: case SELFFUNKTIE2_:
+				if (my source == target) return false;   // e.g. self [col - 1] reads a cell that may already have been written
+				break;
+			case MATRIKS1_: case MATRIKSSTR1_: case MATRIKS2_: case MATRIKSSTR2_:
+			case FUNKTIE0_: case FUNKTIE1_: case FUNKTIE2_:
+				if (instruction -> content.object == target) return false;
+				break;
+			case OBJECTCELL1_: case OBJECTCELLSTR1_: case OBJECTCELL2_: case OBJECTCELLSTR2_:
+			case OBJECTLOCATION0_: case OBJECTLOCATIONSTR0_: case OBJECTLOCATION1_: case OBJECTLOCATIONSTR1_:
+			case OBJECTLOCATION2_: case OBJECTLOCATIONSTR2_:
+				return false;   // the object is known only at run time, and could be the target
+		}
+	}
+	return true;
+}
+
+static Melder_THREAD_LOCAL FormulaProgram theCurrentPrograms [1 + MAXIMUM_NUMBER_OF_LEVELS];   // owned
+
+void Formula_compile (Interpreter interpreter, Daata data, const char32 *expression, int expressionType, bool optimize) {
+	if (theLevel > MAXIMUM_NUMBER_OF_LEVELS)
+		Melder_throw (U"Formula: too many nested scripts.");
+	if (! theCurrentPrograms [theLevel])
+		theCurrentPrograms [theLevel] = Thing_new (FormulaProgram). releaseToAmbiguousOwner ();
+	FormulaProgram_compile (theCurrentPrograms [theLevel], interpreter, data, expression, expressionType, optimize);
 }
 
 /*
  * Running.
  */
 
-static int programPointer;
-
 static void Stackel_cleanUp (Stackel me) {
 	if (my which == Stackel_STRING) {
 		Melder_free (my string);
@@ -1978,8 +2231,6 @@ static void Stackel_cleanUp (Stackel me) {
 		my numericMatrix = theZeroNumericMatrix;
 	}
 }
-static Stackel theStack;
-static int w, wmax;   /* w = stack pointer; */
 #define pop  & theStack [w --]
 static inline void pushNumber (double x) {
 	/* inline runs 10 to 20 percent faster on i386; here's the test script:
@@ -2484,7 +2735,7 @@ static void do_function_n_n (double (*f) (double)) {
 	if (x->which == Stackel_NUMBER) {
 		pushNumber (x->number == NUMundefined ? NUMundefined : f (x->number));
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires a numeric argument, not ", Stackel_whichText (x), U".");
 	}
 }
@@ -2499,7 +2750,7 @@ static void do_functionvec_n_n (double (*f) (double)) {
 		}
 		pushNumericVector (nelm, result);
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires a numeric vector argument, not ", Stackel_whichText (x), U".");
 	}
 	#else
@@ -2510,7 +2761,7 @@ static void do_functionvec_n_n (double (*f) (double)) {
 			x->numericVector.data [i] = f (x->numericVector.data [i]);
 		}
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires a numeric vector argument, not ", Stackel_whichText (x), U".");
 	}
 	#endif
@@ -2537,7 +2788,7 @@ static void do_softmax () {
 			x->numericVector.data [i] /= sum;
 		}
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires a numeric vector argument, not ", Stackel_whichText (x), U".");
 	}
 }
@@ -2810,7 +3061,7 @@ static void do_function_dd_d (double (*f) (double, double)) {
 		pushNumber (x->number == NUMundefined || y->number == NUMundefined ? NUMundefined :
 			f (x->number, y->number));
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires two numeric arguments, not ",
 			Stackel_whichText (x), U" and ", Stackel_whichText (y), U".");
 	}
@@ -2819,7 +3070,7 @@ static void do_function_dd_d_numvec (double (*f) (double, double)) {
 	Stackel n = pop;
 	Melder_assert (n -> which == Stackel_NUMBER);
 	if (n -> number != 3)
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol], U" requires three arguments.");
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol], U" requires three arguments.");
 	Stackel y = pop, x = pop, a = pop;
 	if (a->which == Stackel_NUMERIC_VECTOR && x->which == Stackel_NUMBER && y->which == Stackel_NUMBER) {
 		long numberOfElements = a->numericVector.numberOfElements;
@@ -2829,7 +3080,7 @@ static void do_function_dd_d_numvec (double (*f) (double, double)) {
 		}
 		pushNumericVector (numberOfElements, newData);
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires one vector argument and two numeric arguments, not ",
 			Stackel_whichText (a), U", ", Stackel_whichText (x), U" and ", Stackel_whichText (y), U".");
 	}
@@ -2838,7 +3089,7 @@ static void do_function_dd_d_nummat (double (*f) (double, double)) {
 	Stackel n = pop;
 	Melder_assert (n -> which == Stackel_NUMBER);
 	if (n -> number != 3)
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol], U" requires three arguments.");
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol], U" requires three arguments.");
 	Stackel y = pop, x = pop, a = pop;
 	if (a->which == Stackel_NUMERIC_MATRIX && x->which == Stackel_NUMBER && y->which == Stackel_NUMBER) {
 		long numberOfRows = a->numericMatrix.numberOfRows;
@@ -2851,7 +3102,7 @@ static void do_function_dd_d_nummat (double (*f) (double, double)) {
 		}
 		pushNumericMatrix (numberOfRows, numberOfColumns, newData);
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires one matrix argument and two numeric arguments, not ",
 			Stackel_whichText (a), U", ", Stackel_whichText (x), U" and ", Stackel_whichText (y), U".");
 	}
@@ -2860,7 +3111,7 @@ static void do_function_ll_l_numvec (long (*f) (long, long)) {
 	Stackel n = pop;
 	Melder_assert (n -> which == Stackel_NUMBER);
 	if (n -> number != 3)
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol], U" requires three arguments.");
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol], U" requires three arguments.");
 	Stackel y = pop, x = pop, a = pop;
 	if (a->which == Stackel_NUMERIC_VECTOR && x->which == Stackel_NUMBER) {
 		long numberOfElements = a->numericVector.numberOfElements;
@@ -2870,7 +3121,7 @@ static void do_function_ll_l_numvec (long (*f) (long, long)) {
 		}
 		pushNumericVector (numberOfElements, newData);
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires one vector argument and two numeric arguments, not ",
 			Stackel_whichText (a), U", ", Stackel_whichText (x), U" and ", Stackel_whichText (y), U".");
 	}
@@ -2879,7 +3130,7 @@ static void do_function_ll_l_nummat (long (*f) (long, long)) {
 	Stackel n = pop;
 	Melder_assert (n -> which == Stackel_NUMBER);
 	if (n -> number != 3)
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol], U" requires three arguments.");
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol], U" requires three arguments.");
 	Stackel y = pop, x = pop, a = pop;
 	if (a->which == Stackel_NUMERIC_MATRIX && x->which == Stackel_NUMBER && y->which == Stackel_NUMBER) {
 		long numberOfRows = a->numericMatrix.numberOfRows;
@@ -2892,7 +3143,7 @@ static void do_function_ll_l_nummat (long (*f) (long, long)) {
 		}
 		pushNumericMatrix (numberOfRows, numberOfColumns, newData);
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires one matrix argument and two numeric arguments, not ",
 			Stackel_whichText (a), U", ", Stackel_whichText (x), U" and ", Stackel_whichText (y), U".");
 	}
@@ -2903,7 +3154,7 @@ static void do_function_dl_d (double (*f) (double, long)) {
 		pushNumber (x->number == NUMundefined || y->number == NUMundefined ? NUMundefined :
 			f (x->number, lround (y->number)));
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires two numeric arguments, not ",
 			Stackel_whichText (x), U" and ", Stackel_whichText (y), U".");
 	}
@@ -2914,7 +3165,7 @@ static void do_function_ld_d (double (*f) (long, double)) {
 		pushNumber (x->number == NUMundefined || y->number == NUMundefined ? NUMundefined :
 			f (lround (x->number), y->number));
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires two numeric arguments, not ",
 			Stackel_whichText (x), U" and ", Stackel_whichText (y), U".");
 	}
@@ -2925,7 +3176,7 @@ static void do_function_ll_l (long (*f) (long, long)) {
 		pushNumber (x->number == NUMundefined || y->number == NUMundefined ? NUMundefined :
 			f (lround (x->number), lround (y->number)));
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires two numeric arguments, not ",
 			Stackel_whichText (x), U" and ", Stackel_whichText (y), U".");
 	}
@@ -2936,7 +3187,7 @@ static void do_function_dl_l (long (*f) (double, long)) {
 		pushNumber (x->number == NUMundefined || y->number == NUMundefined ? NUMundefined :
 			f (x->number, lround (y->number)));
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires two numeric arguments, not ",
 			Stackel_whichText (x), U" and ", Stackel_whichText (y), U".");
 	}
@@ -2965,7 +3216,7 @@ static void do_function_ddd_d (double (*f) (double, double, double)) {
 		pushNumber (x->number == NUMundefined || y->number == NUMundefined || z->number == NUMundefined ? NUMundefined :
 			f (x->number, y->number, z->number));
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires three numeric arguments, not ", Stackel_whichText (x), U", ",
 			Stackel_whichText (y), U", and ", Stackel_whichText (z), U".");
 	}
@@ -2976,7 +3227,7 @@ static void do_function_dll_d (double (*f) (double, long, long)) {
 		pushNumber (x->number == NUMundefined || y->number == NUMundefined || z->number == NUMundefined ? NUMundefined :
 			f (x->number, lround (y->number), lround (z->number)));
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires three numeric arguments, not ", Stackel_whichText (x), U", ",
 			Stackel_whichText (y), U", and ", Stackel_whichText (z), U".");
 	}
@@ -3051,7 +3302,7 @@ static void do_doStr () {
 		Melder_throw (U"The first argument of the function \"do$\" has to be a string, namely a menu command, and not ", Stackel_whichText (& stack [0]), U".");
 	const char32 *command = stack [0]. string;
 	if (theCurrentPraatObjects == & theForegroundPraatObjects && praatP. editor != nullptr) {
-		static MelderString info;
+		static Melder_THREAD_LOCAL MelderString info;
 		MelderString_empty (& info);
 		autoMelderDivertInfo divert (& info);
 		autostring32 command2 = Melder_dup (command);
@@ -3063,7 +3314,7 @@ static void do_doStr () {
 	{
 		Melder_throw (U"Commands that write files (including Quit) are not available inside manuals.");
 	} else {
-		static MelderString info;
+		static Melder_THREAD_LOCAL MelderString info;
 		MelderString_empty (& info);
 		autoMelderDivertInfo divert (& info);
 		autostring32 command2 = Melder_dup (command);
@@ -3570,7 +3821,7 @@ static void do_numberOfRows () {
 	if (array->which == Stackel_NUMERIC_MATRIX) {
 		pushNumber (array->numericMatrix.numberOfRows);
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires a matrix argument, not ", Stackel_whichText (array), U".");
 	}
 }
@@ -3583,7 +3834,7 @@ static void do_numberOfColumns () {
 	if (array->which == Stackel_NUMERIC_MATRIX) {
 		pushNumber (array->numericMatrix.numberOfColumns);
 	} else {
-		Melder_throw (U"The function ", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function ", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U" requires a matrix argument, not ", Stackel_whichText (array), U".");
 	}
 }
@@ -3628,7 +3879,7 @@ static void do_hash () {
 }
 
 static void do_numericVectorElement () {
-	InterpreterVariable vector = parse [programPointer]. content.variable;
+	InterpreterVariable vector = theInstructions [programPointer]. content.variable;
 	long element = 1;   // default
 	Stackel r = pop;
 	if (r -> which != Stackel_NUMBER)
@@ -3643,7 +3894,7 @@ static void do_numericVectorElement () {
 	pushNumber (vector -> numericVectorValue. data [element]);
 }
 static void do_numericMatrixElement () {
-	InterpreterVariable matrix = parse [programPointer]. content.variable;
+	InterpreterVariable matrix = theInstructions [programPointer]. content.variable;
 	long row = 1, column = 1;   // default
 	Stackel c = pop;
 	if (c -> which != Stackel_NUMBER)
@@ -3673,8 +3924,8 @@ static void do_indexedNumericVariable () {
 	int nindex = lround (n -> number);
 	if (nindex < 1)
 		Melder_throw (U"Indexed variables require at least one index.");
-	char32 *indexedVariableName = parse [programPointer]. content.string;
-	static MelderString totalVariableName { 0 };
+	char32 *indexedVariableName = theInstructions [programPointer]. content.string;
+	static Melder_THREAD_LOCAL MelderString totalVariableName { 0 };
 	MelderString_copy (& totalVariableName, indexedVariableName, U"[");
 	w -= nindex;
 	for (int iindex = 1; iindex <= nindex; iindex ++) {
@@ -3698,8 +3949,8 @@ static void do_indexedStringVariable () {
 	int nindex = lround (n -> number);
 	if (nindex < 1)
 		Melder_throw (U"Indexed variables require at least one index.");
-	char32 *indexedVariableName = parse [programPointer]. content.string;
-	static MelderString totalVariableName { 0 };
+	char32 *indexedVariableName = theInstructions [programPointer]. content.string;
+	static Melder_THREAD_LOCAL MelderString totalVariableName { 0 };
 	MelderString_copy (& totalVariableName, indexedVariableName, U"[");
 	w -= nindex;
 	for (int iindex = 1; iindex <= nindex; iindex ++) {
@@ -3900,7 +4151,7 @@ static void do_stringMatchesCriterion (int criterion) {
 		int result = Melder_stringMatchesCriterion (s->string, criterion, t->string);
 		pushNumber (result);
 	} else {
-		Melder_throw (U"The function \"", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function \"", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U"\" requires two strings, not ", Stackel_whichText (s), U" and ", Stackel_whichText (t), U".");
 	}
 }
@@ -3921,7 +4172,7 @@ static void do_index_regex (int backward) {
 			}
 		}
 	} else {
-		Melder_throw (U"The function \"", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function \"", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U"\" requires two strings, not ", Stackel_whichText (s), U" and ", Stackel_whichText (t), U".");
 	}
 }
@@ -3990,7 +4241,7 @@ static void do_extractNumber () {
 			}
 		}
 	} else {
-		Melder_throw (U"The function \"", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function \"", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U"\" requires two strings, not ", Stackel_whichText (s), U" and ", Stackel_whichText (t), U".");
 	}
 }
@@ -4024,7 +4275,7 @@ static void do_extractTextStr (bool singleWord) {
 		}
 		pushString (result.transfer());
 	} else {
-		Melder_throw (U"The function \"", Formula_instructionNames [parse [programPointer]. symbol],
+		Melder_throw (U"The function \"", Formula_instructionNames [theInstructions [programPointer]. symbol],
 			U"\" requires two strings, not ", Stackel_whichText (s), U" and ", Stackel_whichText (t), U".");
 	}
 }
@@ -4112,7 +4363,7 @@ static int praat_findObjectFromString (const char32 *name) {
 		/*
 		 * Find the object by its name.
 		 */
-		static MelderString buffer { 0 };
+		static Melder_THREAD_LOCAL MelderString buffer { 0 };
 		MelderString_copy (& buffer, name);
 		char32 *space = str32chr (buffer.string, U' ');
 		if (space == nullptr)
@@ -5049,7 +5300,7 @@ static void do_objectCell0 (long irow, long icol) {
 	}
 }
 static void do_matriks0 (long irow, long icol) {
-	Daata thee = parse [programPointer]. content.object;
+	Daata thee = theInstructions [programPointer]. content.object;
 	if (thy v_hasGetCell ()) {
 		pushNumber (thy v_getCell ());
 	} else if (thy v_hasGetVector ()) {
@@ -5137,7 +5388,7 @@ static void do_objectCell1 (long irow) {
 	}
 }
 static void do_matriks1 (long irow) {
-	Daata thee = parse [programPointer]. content.object;
+	Daata thee = theInstructions [programPointer]. content.object;
 	Stackel column = pop;
 	long icol = Stackel_getColumnNumber (column, thee);
 	if (thy v_hasGetVector ()) {
@@ -5175,7 +5426,7 @@ static void do_objectCellStr1 (long irow) {
 	}
 }
 static void do_matrixStr1 (long irow) {
-	Daata thee = parse [programPointer]. content.object;
+	Daata thee = theInstructions [programPointer]. content.object;
 	Stackel column = pop;
 	long icol = Stackel_getColumnNumber (column, thee);
 	if (thy v_hasGetVectorStr ()) {
@@ -5225,7 +5476,7 @@ static void do_objectCell2 () {
 	pushNumber (thy v_getMatrix (irow, icol));
 }
 static void do_matriks2 () {
-	Daata thee = parse [programPointer]. content.object;
+	Daata thee = theInstructions [programPointer]. content.object;
 	Stackel column = pop, row = pop;
 	long irow = Stackel_getRowNumber (row, thee);
 	long icol = Stackel_getColumnNumber (column, thee);
@@ -5244,7 +5495,7 @@ static void do_objectCellStr2 () {
 	pushString (result.transfer());
 }
 static void do_matriksStr2 () {
-	Daata thee = parse [programPointer]. content.object;
+	Daata thee = theInstructions [programPointer]. content.object;
 	Stackel column = pop, row = pop;
 	long irow = Stackel_getRowNumber (row, thee);
 	long icol = Stackel_getColumnNumber (column, thee);
@@ -5292,7 +5543,7 @@ static void do_objectLocation0 (long irow, long icol) {
 	}
 }
 static void do_funktie0 (long irow, long icol) {
-	Daata thee = parse [programPointer]. content.object;
+	Daata thee = theInstructions [programPointer]. content.object;
 	if (thy v_hasGetFunction0 ()) {
 		pushNumber (thy v_getFunction0 ());
 	} else if (thy v_hasGetFunction1 ()) {
@@ -5375,7 +5626,7 @@ static void do_objectLocation1 (long irow) {
 	}
 }
 static void do_funktie1 (long irow) {
-	Daata thee = parse [programPointer]. content.object;
+	Daata thee = theInstructions [programPointer]. content.object;
 	Stackel x = pop;
 	if (x->which == Stackel_NUMBER) {
 		if (thy v_hasGetFunction1 ()) {
@@ -5423,7 +5674,7 @@ static void do_objectLocation2 () {
 	}
 }
 static void do_funktie2 () {
-	Daata thee = parse [programPointer]. content.object;
+	Daata thee = theInstructions [programPointer]. content.object;
 	Stackel y = pop, x = pop;
 	if (x->which == Stackel_NUMBER && y->which == Stackel_NUMBER) {
 		if (! thy v_hasGetFunction2 ())
@@ -5434,7 +5685,7 @@ static void do_funktie2 () {
 	}
 }
 static void do_rowStr () {
-	Daata thee = parse [programPointer]. content.object;
+	Daata thee = theInstructions [programPointer]. content.object;
 	Stackel row = pop;
 	long irow = Stackel_getRowNumber (row, thee);
 	autostring32 result = Melder_dup (thy v_getRowStr (irow));
@@ -5443,7 +5694,7 @@ static void do_rowStr () {
 	pushString (result.transfer());
 }
 static void do_colStr () {
-	Daata thee = parse [programPointer]. content.object;
+	Daata thee = theInstructions [programPointer]. content.object;
 	Stackel col = pop;
 	long icol = Stackel_getColumnNumber (col, thee);
 	autostring32 result = Melder_dup (thy v_getColStr (icol));
@@ -5465,15 +5716,25 @@ static double NUMerf (double x) {
 	return 1.0 - NUMerfcc (x);
 }
 
-void Formula_run (long row, long col, struct Formula_Result *result) {
-	FormulaInstruction f = parse;
-	programPointer = 1;   // first symbol of the program
-	if (! theStack) theStack = Melder_calloc_f (struct structStackel, 10000);
-	if (! theStack)
+void FormulaProgram_run (FormulaProgram me, long row, long col, struct Formula_Result *result) {
+	autoFormulaState savedState;
+	if (! theStackMemory) theStackMemory = Melder_calloc_f (struct structStackel, Formula_STACK_SIZE);
+	if (! theStackMemory)
 		Melder_throw (U"Out of memory during formula computation.");
+	/*
+		If another formula is running on this thread, our stack starts above the part that it uses.
+	*/
+	theStack = theStack ? theStack + wmax : theStackMemory;
+	if (theStack - theStackMemory > Formula_STACK_SIZE - 1000)
+		Melder_throw (U"Formula: too many nested formulas.");
+	theInterpreter = my interpreter;
+	theSource = my source;
+	theOptimize = my optimize;
+	FormulaInstruction f = theInstructions = my instructions;
+	programPointer = 1;   // first symbol of the program
 	w = 0, wmax = 0;   // start new stack
 	try {
-		while (programPointer <= numberOfInstructions) {
+		while (programPointer <= my numberOfInstructions) {
 			int symbol;
 				switch (symbol = f [programPointer]. symbol) {
 
@@ -5482,13 +5743,11 @@ case NUMBER_: { pushNumber (f [programPointer]. content.number);
 } break; case ROW_: { pushNumber (row);
 } break; case COL_: { pushNumber (col);
 } break; case X_: {
-	Daata me = theSource;
-	if (! my v_hasGetX ()) Melder_throw (U"No values for \"x\" for this object.");
-	pushNumber (my v_getX (col));
+	if (! theSource -> v_hasGetX ()) Melder_throw (U"No values for \"x\" for this object.");
+	pushNumber (theSource -> v_getX (col));
 } break; case Y_: {
-	Daata me = theSource;
-	if (! my v_hasGetY ()) Melder_throw (U"No values for \"y\" for this object.");
-	pushNumber (my v_getY (row));
+	if (! theSource -> v_hasGetY ()) Melder_throw (U"No values for \"y\" for this object.");
+	pushNumber (theSource -> v_getY (row));
 } break; case NOT_: { do_not ();
 } break; case EQ_: { do_eq ();
 } break; case NE_: { do_ne ();
@@ -5811,18 +6070,18 @@ case NUMBER_: { pushNumber (f [programPointer]. content.number);
 	InterpreterVariable var = f [programPointer]. content.variable;
 	autostring32 string = Melder_dup (var -> stringValue);
 	pushString (string.transfer());
-} break; default: Melder_throw (U"Symbol \"", Formula_instructionNames [parse [programPointer]. symbol], U"\" without action.");
+} break; default: Melder_throw (U"Symbol \"", Formula_instructionNames [theInstructions [programPointer]. symbol], U"\" without action.");
 			} // endswitch
 			programPointer ++;
 		} // endwhile
 		if (w != 1) Melder_fatal (U"Formula: stackpointer ends at ", w, U" instead of 1.");
-		if (theExpressionType [theLevel] == kFormula_EXPRESSION_TYPE_NUMERIC) {
+		if (my expressionType == kFormula_EXPRESSION_TYPE_NUMERIC) {
 			if (theStack [1]. which == Stackel_STRING) Melder_throw (U"Found a string expression instead of a numeric expression.");
 			if (theStack [1]. which == Stackel_NUMERIC_VECTOR) Melder_throw (U"Found a vector expression instead of a numeric expression.");
 			if (theStack [1]. which == Stackel_NUMERIC_MATRIX) Melder_throw (U"Found a matrix expression instead of a numeric expression.");
 			result -> expressionType = kFormula_EXPRESSION_TYPE_NUMERIC;
 			result -> result.numericResult = theStack [1]. number;
-		} else if (theExpressionType [theLevel] == kFormula_EXPRESSION_TYPE_STRING) {
+		} else if (my expressionType == kFormula_EXPRESSION_TYPE_STRING) {
 			if (theStack [1]. which == Stackel_NUMBER)
 				Melder_throw (U"Found a numeric expression (value ", theStack [1]. number, U") instead of a string expression.");
 			if (theStack [1]. which == Stackel_NUMERIC_VECTOR) Melder_throw (U"Found a vector expression instead of a string expression.");
@@ -5830,14 +6089,14 @@ case NUMBER_: { pushNumber (f [programPointer]. content.number);
 			result -> expressionType = kFormula_EXPRESSION_TYPE_STRING;
 			result -> result.stringResult = theStack [1]. string;   // dangle...
 			theStack [1]. string = nullptr;   // ...undangle (and disown)
-		} else if (theExpressionType [theLevel] == kFormula_EXPRESSION_TYPE_NUMERIC_VECTOR) {
+		} else if (my expressionType == kFormula_EXPRESSION_TYPE_NUMERIC_VECTOR) {
 			if (theStack [1]. which == Stackel_NUMBER) Melder_throw (U"Found a numeric expression instead of a vector expression.");
 			if (theStack [1]. which == Stackel_STRING) Melder_throw (U"Found a string expression instead of a vector expression.");
 			if (theStack [1]. which == Stackel_NUMERIC_MATRIX) Melder_throw (U"Found a matrix expression instead of a vector expression.");
 			result -> expressionType = kFormula_EXPRESSION_TYPE_NUMERIC_VECTOR;
 			result -> result.numericVectorResult = theStack [1]. numericVector;   // dangle
 			theStack [1]. numericVector = theZeroNumericVector;   // ...undangle (and disown)
-		} else if (theExpressionType [theLevel] == kFormula_EXPRESSION_TYPE_NUMERIC_MATRIX) {
+		} else if (my expressionType == kFormula_EXPRESSION_TYPE_NUMERIC_MATRIX) {
 			if (theStack [1]. which == Stackel_NUMBER) Melder_throw (U"Found a numeric expression instead of a matrix expression.");
 			if (theStack [1]. which == Stackel_STRING) Melder_throw (U"Found a string expression instead of a matrix expression.");
 			if (theStack [1]. which == Stackel_NUMERIC_VECTOR) Melder_throw (U"Found a vector expression instead of a matrix expression.");
@@ -5845,7 +6104,7 @@ case NUMBER_: { pushNumber (f [programPointer]. content.number);
 			result -> result.numericMatrixResult = theStack [1]. numericMatrix;   // dangle
 			theStack [1]. numericMatrix = theZeroNumericMatrix;   // ...undangle (and disown)
 		} else {
-			Melder_assert (theExpressionType [theLevel] == kFormula_EXPRESSION_TYPE_UNKNOWN);
+			Melder_assert (my expressionType == kFormula_EXPRESSION_TYPE_UNKNOWN);
 			if (theStack [1]. which == Stackel_NUMBER) {
 				result -> expressionType = kFormula_EXPRESSION_TYPE_NUMERIC;
 				result -> result.numericResult = theStack [1]. number;
@@ -5879,4 +6138,267 @@ case NUMBER_: { pushNumber (f [programPointer]. content.number);
 	}
 }
 
+/*
+	Block evaluation: a program that FormulaProgram_canRunBlocks () is run once for up to Formula_BLOCK_SIZE cells of a row,
+	each instruction working on the whole block in a tight loop that the compiler can vectorize.
+	Values that are the same for all cells of the block (numbers, variables, row, y) are kept as a single number.
+	The element functions below give the same results as the do_xxx () functions above,
+	including the treatment of undefined values.
+*/
+#define Formula_BLOCK_SIZE  256
+
+typedef struct structBlockStackel {
+	bool isUniform;   // the same value for all cells of the block
+	double value;   // if uniform
+	double *values;   // if not uniform; base 0
+} *BlockStackel;
+
+static Melder_THREAD_LOCAL BlockStackel theBlockStack;   // base 1
+static Melder_THREAD_LOCAL double *theBlockValues;
+static Melder_THREAD_LOCAL int theBlockStackCapacity;
+
+template <double (*f) (double)>
+static inline double Block_defined (double x) { return x == NUMundefined ? NUMundefined : f (x); }
+static inline double Block_not (double x) { return x == NUMundefined ? NUMundefined : x == 0.0 ? 1.0 : 0.0; }
+static inline double Block_minus (double x) { return x == NUMundefined ? NUMundefined : - x; }
+static inline double Block_sqr (double x) { return x == NUMundefined ? NUMundefined : x * x; }
+static inline double Block_round (double x) { return x == NUMundefined ? NUMundefined : floor (x + 0.5); }
+static inline double Block_rectify (double x) { return x == NUMundefined ? NUMundefined : x > 0.0 ? x : 0.0; }
+static inline double Block_sqrt (double x) { return x == NUMundefined ? NUMundefined : x < 0.0 ? NUMundefined : sqrt (x); }
+static inline double Block_arcsin (double x) { return x == NUMundefined ? NUMundefined : fabs (x) > 1.0 ? NUMundefined : asin (x); }
+static inline double Block_arccos (double x) { return x == NUMundefined ? NUMundefined : fabs (x) > 1.0 ? NUMundefined : acos (x); }
+static inline double Block_log2 (double x) { return x == NUMundefined ? NUMundefined : x <= 0.0 ? NUMundefined : log (x) * NUMlog2e; }
+static inline double Block_ln (double x) { return x == NUMundefined ? NUMundefined : x <= 0.0 ? NUMundefined : log (x); }
+static inline double Block_log10 (double x) { return x == NUMundefined ? NUMundefined : x <= 0.0 ? NUMundefined : log10 (x); }
+
+static inline double Block_eq (double x, double y) { return x == y ? 1.0 : 0.0; }   // even if undefined
+static inline double Block_ne (double x, double y) { return x != y ? 1.0 : 0.0; }
+static inline double Block_le (double x, double y) { return x == NUMundefined || y == NUMundefined ? NUMundefined : x <= y ? 1.0 : 0.0; }
+static inline double Block_lt (double x, double y) { return x == NUMundefined || y == NUMundefined ? NUMundefined : x < y ? 1.0 : 0.0; }
+static inline double Block_ge (double x, double y) { return x == NUMundefined || y == NUMundefined ? NUMundefined : x >= y ? 1.0 : 0.0; }
+static inline double Block_gt (double x, double y) { return x == NUMundefined || y == NUMundefined ? NUMundefined : x > y ? 1.0 : 0.0; }
+static inline double Block_add (double x, double y) { return x == NUMundefined || y == NUMundefined ? NUMundefined : x + y; }
+static inline double Block_sub (double x, double y) { return x == NUMundefined || y == NUMundefined ? NUMundefined : x - y; }
+static inline double Block_mul (double x, double y) { return x == NUMundefined || y == NUMundefined ? NUMundefined : x * y; }
+static inline double Block_rdiv (double x, double y) {
+	return x == NUMundefined || y == NUMundefined ? NUMundefined : y == 0.0 ? NUMundefined : x / y;
+}
+static inline double Block_idiv (double x, double y) {
+	return x == NUMundefined || y == NUMundefined ? NUMundefined : y == 0.0 ? NUMundefined : floor (x / y);
+}
+static inline double Block_mod (double x, double y) {
+	return x == NUMundefined || y == NUMundefined ? NUMundefined : y == 0.0 ? NUMundefined : x - floor (x / y) * y;
+}
+static inline double Block_power (double x, double y) { return x == NUMundefined || y == NUMundefined ? NUMundefined : pow (x, y); }
+static inline double Block_arctan2 (double x, double y) { return x == NUMundefined || y == NUMundefined ? NUMundefined : atan2 (x, y); }
+
+template <double (*f) (double)>
+static void Block_function1 (BlockStackel x, long n) {
+	if (x->isUniform) {
+		x->value = f (x->value);
+		return;
+	}
+	double *xvalues = x->values;
+	for (long i = 0; i < n; i ++)
+		xvalues [i] = f (xvalues [i]);
+}
+
+template <double (*f) (double, double)>
+static void Block_function2 (BlockStackel x, BlockStackel y, long n) {
+	double *xvalues = x->values;
+	const double *yvalues = y->values;
+	if (x->isUniform) {
+		double xvalue = x->value;
+		if (y->isUniform) {
+			x->value = f (xvalue, y->value);
+			return;
+		}
+		for (long i = 0; i < n; i ++)
+			xvalues [i] = f (xvalue, yvalues [i]);
+		x->isUniform = false;
+	} else if (y->isUniform) {
+		double yvalue = y->value;
+		for (long i = 0; i < n; i ++)
+			xvalues [i] = f (xvalues [i], yvalue);
+	} else {
+		for (long i = 0; i < n; i ++)
+			xvalues [i] = f (xvalues [i], yvalues [i]);
+	}
+}
+
+static void Block_getCells (BlockStackel x, Daata thee, long row, long firstColumn, long n) {
+	if (thy v_hasGetCell ()) {
+		x->isUniform = true;
+		x->value = thy v_getCell ();
+	} else if (thy v_hasGetVector ()) {
+		x->isUniform = false;
+		for (long i = 0; i < n; i ++)
+			x->values [i] = thy v_getVector (row, firstColumn + i);
+	} else {
+		Melder_assert (thy v_hasGetMatrix ());
+		x->isUniform = false;
+		for (long i = 0; i < n; i ++)
+			x->values [i] = thy v_getMatrix (row, firstColumn + i);
+	}
+}
+
+static void FormulaProgram_runOneBlock (FormulaProgram me, long row, long firstColumn, long n, double *results) {
+	FormulaInstruction f = my instructions;
+	int blockStackPointer = 0;
+	for (int i = 1; i <= my numberOfInstructions; i ++) {
+		switch (f [i]. symbol) {
+			case NUMBER_: {
+				BlockStackel x = & theBlockStack [++ blockStackPointer];
+				x->isUniform = true;
+				x->value = f [i]. content.number;
+			} break; case NUMERIC_VARIABLE_: {
+				BlockStackel x = & theBlockStack [++ blockStackPointer];
+				x->isUniform = true;
+				x->value = f [i]. content.variable -> numericValue;
+			} break; case TRUE_: case FALSE_: {
+				BlockStackel x = & theBlockStack [++ blockStackPointer];
+				x->isUniform = true;
+				x->value = f [i]. symbol == TRUE_ ? 1.0 : 0.0;
+			} break; case ROW_: {
+				BlockStackel x = & theBlockStack [++ blockStackPointer];
+				x->isUniform = true;
+				x->value = row;
+			} break; case COL_: {
+				BlockStackel x = & theBlockStack [++ blockStackPointer];
+				x->isUniform = false;
+				for (long icell = 0; icell < n; icell ++)
+					x->values [icell] = firstColumn + icell;
+			} break; case X_: {
+				BlockStackel x = & theBlockStack [++ blockStackPointer];
+				x->isUniform = false;
+				for (long icell = 0; icell < n; icell ++)
+					x->values [icell] = my source -> v_getX (firstColumn + icell);
+			} break; case Y_: {
+				BlockStackel x = & theBlockStack [++ blockStackPointer];
+				x->isUniform = true;
+				x->value = my source -> v_getY (row);
+			} break; case SELF0_: {
+				Block_getCells (& theBlockStack [++ blockStackPointer], my source, row, firstColumn, n);
+			} break; case MATRIKS0_: {
+				Block_getCells (& theBlockStack [++ blockStackPointer], f [i]. content.object, row, firstColumn, n);
+			} break;
+			case NOT_: Block_function1 <Block_not> (& theBlockStack [blockStackPointer], n); break;
+			case MINUS_: Block_function1 <Block_minus> (& theBlockStack [blockStackPointer], n); break;
+			case SQR_: Block_function1 <Block_sqr> (& theBlockStack [blockStackPointer], n); break;
+			case ABS_: Block_function1 <Block_defined <fabs>> (& theBlockStack [blockStackPointer], n); break;
+			case ROUND_: Block_function1 <Block_round> (& theBlockStack [blockStackPointer], n); break;
+			case FLOOR_: Block_function1 <Block_defined <floor>> (& theBlockStack [blockStackPointer], n); break;
+			case CEILING_: Block_function1 <Block_defined <ceil>> (& theBlockStack [blockStackPointer], n); break;
+			case RECTIFY_: Block_function1 <Block_rectify> (& theBlockStack [blockStackPointer], n); break;
+			case SQRT_: Block_function1 <Block_sqrt> (& theBlockStack [blockStackPointer], n); break;
+			case SIN_: Block_function1 <Block_defined <sin>> (& theBlockStack [blockStackPointer], n); break;
+			case COS_: Block_function1 <Block_defined <cos>> (& theBlockStack [blockStackPointer], n); break;
+			case TAN_: Block_function1 <Block_defined <tan>> (& theBlockStack [blockStackPointer], n); break;
+			case ARCSIN_: Block_function1 <Block_arcsin> (& theBlockStack [blockStackPointer], n); break;
+			case ARCCOS_: Block_function1 <Block_arccos> (& theBlockStack [blockStackPointer], n); break;
+			case ARCTAN_: Block_function1 <Block_defined <atan>> (& theBlockStack [blockStackPointer], n); break;
+			case SINC_: Block_function1 <Block_defined <NUMsinc>> (& theBlockStack [blockStackPointer], n); break;
+			case SINCPI_: Block_function1 <Block_defined <NUMsincpi>> (& theBlockStack [blockStackPointer], n); break;
+			case EXP_: Block_function1 <Block_defined <exp>> (& theBlockStack [blockStackPointer], n); break;
+			case SINH_: Block_function1 <Block_defined <sinh>> (& theBlockStack [blockStackPointer], n); break;
+			case COSH_: Block_function1 <Block_defined <cosh>> (& theBlockStack [blockStackPointer], n); break;
+			case TANH_: Block_function1 <Block_defined <tanh>> (& theBlockStack [blockStackPointer], n); break;
+			case ARCSINH_: Block_function1 <Block_defined <NUMarcsinh>> (& theBlockStack [blockStackPointer], n); break;
+			case ARCCOSH_: Block_function1 <Block_defined <NUMarccosh>> (& theBlockStack [blockStackPointer], n); break;
+			case ARCTANH_: Block_function1 <Block_defined <NUMarctanh>> (& theBlockStack [blockStackPointer], n); break;
+			case SIGMOID_: Block_function1 <Block_defined <NUMsigmoid>> (& theBlockStack [blockStackPointer], n); break;
+			case INV_SIGMOID_: Block_function1 <Block_defined <NUMinvSigmoid>> (& theBlockStack [blockStackPointer], n); break;
+			case ERF_: Block_function1 <Block_defined <NUMerf>> (& theBlockStack [blockStackPointer], n); break;
+			case ERFC_: Block_function1 <Block_defined <NUMerfcc>> (& theBlockStack [blockStackPointer], n); break;
+			case GAUSS_P_: Block_function1 <Block_defined <NUMgaussP>> (& theBlockStack [blockStackPointer], n); break;
+			case GAUSS_Q_: Block_function1 <Block_defined <NUMgaussQ>> (& theBlockStack [blockStackPointer], n); break;
+			case INV_GAUSS_Q_: Block_function1 <Block_defined <NUMinvGaussQ>> (& theBlockStack [blockStackPointer], n); break;
+			case LOG2_: Block_function1 <Block_log2> (& theBlockStack [blockStackPointer], n); break;
+			case LN_: Block_function1 <Block_ln> (& theBlockStack [blockStackPointer], n); break;
+			case LOG10_: Block_function1 <Block_log10> (& theBlockStack [blockStackPointer], n); break;
+			case LN_GAMMA_: Block_function1 <Block_defined <NUMlnGamma>> (& theBlockStack [blockStackPointer], n); break;
+			case HERTZ_TO_BARK_: Block_function1 <Block_defined <NUMhertzToBark>> (& theBlockStack [blockStackPointer], n); break;
+			case BARK_TO_HERTZ_: Block_function1 <Block_defined <NUMbarkToHertz>> (& theBlockStack [blockStackPointer], n); break;
+			case PHON_TO_DIFFERENCE_LIMENS_: Block_function1 <Block_defined <NUMphonToDifferenceLimens>> (& theBlockStack [blockStackPointer], n); break;
+			case DIFFERENCE_LIMENS_TO_PHON_: Block_function1 <Block_defined <NUMdifferenceLimensToPhon>> (& theBlockStack [blockStackPointer], n); break;
+			case HERTZ_TO_MEL_: Block_function1 <Block_defined <NUMhertzToMel>> (& theBlockStack [blockStackPointer], n); break;
+			case MEL_TO_HERTZ_: Block_function1 <Block_defined <NUMmelToHertz>> (& theBlockStack [blockStackPointer], n); break;
+			case HERTZ_TO_SEMITONES_: Block_function1 <Block_defined <NUMhertzToSemitones>> (& theBlockStack [blockStackPointer], n); break;
+			case SEMITONES_TO_HERTZ_: Block_function1 <Block_defined <NUMsemitonesToHertz>> (& theBlockStack [blockStackPointer], n); break;
+			case ERB_: Block_function1 <Block_defined <NUMerb>> (& theBlockStack [blockStackPointer], n); break;
+			case HERTZ_TO_ERB_: Block_function1 <Block_defined <NUMhertzToErb>> (& theBlockStack [blockStackPointer], n); break;
+			case ERB_TO_HERTZ_: Block_function1 <Block_defined <NUMerbToHertz>> (& theBlockStack [blockStackPointer], n); break;
+			case EQ_: blockStackPointer --; Block_function2 <Block_eq> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			case NE_: blockStackPointer --; Block_function2 <Block_ne> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			case LE_: blockStackPointer --; Block_function2 <Block_le> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			case LT_: blockStackPointer --; Block_function2 <Block_lt> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			case GE_: blockStackPointer --; Block_function2 <Block_ge> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			case GT_: blockStackPointer --; Block_function2 <Block_gt> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			case ADD_: blockStackPointer --; Block_function2 <Block_add> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			case SUB_: blockStackPointer --; Block_function2 <Block_sub> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			case MUL_: blockStackPointer --; Block_function2 <Block_mul> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			case RDIV_: blockStackPointer --; Block_function2 <Block_rdiv> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			case IDIV_: blockStackPointer --; Block_function2 <Block_idiv> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			case MOD_: blockStackPointer --; Block_function2 <Block_mod> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			case POWER_: blockStackPointer --; Block_function2 <Block_power> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			case ARCTAN2_: blockStackPointer --; Block_function2 <Block_arctan2> (& theBlockStack [blockStackPointer], & theBlockStack [blockStackPointer + 1], n); break;
+			default: Melder_fatal (U"Formula: cannot run instruction ", Formula_instructionNames [f [i]. symbol], U" on a block.");
+		}
+	}
+	Melder_assert (blockStackPointer == 1);
+	BlockStackel result = & theBlockStack [1];
+	if (result->isUniform) {
+		for (long icell = 0; icell < n; icell ++)
+			results [icell] = result->value;
+	} else {
+		for (long icell = 0; icell < n; icell ++)
+			results [icell] = result->values [icell];
+	}
+}
+
+void FormulaProgram_runBlock (FormulaProgram me, long row, long firstColumn, long lastColumn, double *results) {
+	Melder_assert (my blockStackDepth > 0);
+	if (my blockStackDepth > theBlockStackCapacity) {
+		/*
+			The stack of this thread only grows, and lives as long as the thread, just as theStackMemory.
+		*/
+		Melder_free (theBlockStack);
+		Melder_free (theBlockValues);
+		theBlockStackCapacity = 0;
+		theBlockStack = Melder_calloc (struct structBlockStackel, 1 + my blockStackDepth);
+		theBlockValues = Melder_malloc (double, my blockStackDepth * Formula_BLOCK_SIZE);
+		theBlockStackCapacity = my blockStackDepth;
+		for (int istack = 1; istack <= theBlockStackCapacity; istack ++)
+			theBlockStack [istack]. values = & theBlockValues [(istack - 1) * Formula_BLOCK_SIZE];
+	}
+	for (long firstColumnOfBlock = firstColumn; firstColumnOfBlock <= lastColumn; firstColumnOfBlock += Formula_BLOCK_SIZE) {
+		long numberOfColumnsInBlock = lastColumn - firstColumnOfBlock + 1;
+		if (numberOfColumnsInBlock > Formula_BLOCK_SIZE) numberOfColumnsInBlock = Formula_BLOCK_SIZE;
+		FormulaProgram_runOneBlock (me, row, firstColumnOfBlock, numberOfColumnsInBlock, & results [firstColumnOfBlock]);
+	}
+}
+
+static void Formula_reinstateProgram (FormulaProgram program) {
+	if (theCurrentPrograms [theLevel])
+		forget (theCurrentPrograms [theLevel]);   // compiled by our own formula
+	theCurrentPrograms [theLevel] = program;
+}
+
+void Formula_run (long row, long col, struct Formula_Result *result) {
+	/*
+		The formula may compile other formulas on this level (e.g. with do),
+		so we keep our program alive, and reinstate it when we are done.
+	*/
+	FormulaProgram program = theCurrentPrograms [theLevel];
+	Melder_assert (program);
+	theCurrentPrograms [theLevel] = nullptr;
+	try {
+		FormulaProgram_run (program, row, col, result);
+	} catch (MelderError) {
+		Formula_reinstateProgram (program);
+		throw;
+	}
+	Formula_reinstateProgram (program);
+}
+
 /* End of file Formula.cpp */
@@ -73,6 +73,55 @@ struct Formula_Result {
 
 Thing_declare (Interpreter);
 
+/*
+	A compiled formula. Running it does not change it, and every run has its own stack,
+	so that a program for which isThreadSafe is true can be run by many threads at the same time.
+*/
+struct structFormulaInstruction;
+Thing_define (FormulaProgram, Thing) {
+	Interpreter interpreter;   // not owned; the variables in the instructions belong to this interpreter
+	autoInterpreter ownInterpreter;   // if the formula was compiled without an interpreter
+	Daata source;   // not owned
+	int expressionType;
+	bool optimize;
+	int numberOfInstructions, numberOfAllocatedInstructions;
+	struct structFormulaInstruction *instructions;   // base 1
+	bool isThreadSafe;
+	bool refersToObjectNames;   // e.g. Sound_hello [3] or Sound_hello.xmax, which are looked up when the formula is compiled
+	int blockStackDepth;   // 0 if the program cannot be run on blocks of cells
+
+	void v_destroy () noexcept
+		override;
+};
+
+autoFormulaProgram Formula_compileProgram (Interpreter interpreter, Daata data, const char32 *expression, int expressionType, bool optimize);
+
+void FormulaProgram_run (FormulaProgram me, long row, long col, struct Formula_Result *result);
+
+bool FormulaProgram_isCellIndependent (FormulaProgram me, Daata target);
+/*
+	Whether the results for all cells of `target` can be computed in any order and on any thread,
+	i.e. the program is thread-safe and reads no cell of `target` other than the one that its result goes into.
+*/
+
+inline static bool FormulaProgram_canRunBlocks (FormulaProgram me) { return my blockStackDepth > 0; }
+/*
+	Whether the program is a plain numeric expression of numbers, variables, row, col, x, y,
+	the cell of self or of another object at the current row and column, arithmetic, comparisons
+	and numeric functions of one or two arguments. Such a program is also cell-independent.
+*/
+
+void FormulaProgram_runBlock (FormulaProgram me, long row, long firstColumn, long lastColumn, double *results);
+/*
+	Compute the cells [row] [firstColumn..lastColumn] all at once, with each instruction working on many cells,
+	and put them into results [firstColumn..lastColumn]. The results are identical to those of FormulaProgram_run.
+	Precondition: FormulaProgram_canRunBlocks (me).
+*/
+
+/*
+	Compile and run a formula on the current script level;
+	the compiled program is kept until the next Formula_compile on the same level and thread.
+*/
 void Formula_compile (Interpreter interpreter, Daata data, const char32 *expression, int expressionType, bool optimize);
 
 void Formula_run (long row, long col, struct Formula_Result *result);
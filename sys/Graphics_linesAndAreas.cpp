@@ -957,6 +957,22 @@ void Graphics_function16 (Graphics me, int16_t yWC [], int stagger, long ix1, lo
 	}
 }
 
+void Graphics_functionFloat (Graphics me, float yWC [], int stagger, long ix1, long ix2, double x1WC, double x2WC) {
+	if (stagger == 1) {
+		#define STAGGER(i)  ((i) + (i))
+		MACRO_Graphics_function (float)
+		#undef STAGGER
+	} else if (stagger > 1) {
+		#define STAGGER(i)  ((stagger + 1) * (i))
+		MACRO_Graphics_function (float)
+		#undef STAGGER
+	} else {
+		#define STAGGER(i)  (i)
+		MACRO_Graphics_function (float)
+		#undef STAGGER
+	}
+}
+
 void Graphics_rectangle (Graphics me, double x1WC, double x2WC, double y1WC, double y2WC) {
 	my v_rectangle (wdx (x1WC), wdx (x2WC), wdy (y1WC), wdy (y2WC));
 	if (my recording) { op (RECTANGLE, 4); put (x1WC); put (x2WC); put (y1WC); put (y2WC); }
@@ -68,7 +68,46 @@ static autoInterpreterVariable InterpreterVariable_create (const char32 *key) {
 
 Thing_implement (Interpreter, Thing, 0);
 
+/*
+	The expressions on a script line are compiled when the line is run for the first time,
+	so that loops run from the compiled programs instead of lexing and parsing the same text again and again.
+	An expression is recognized by its text after the substitution of 'variables', its type,
+	and the procedure that its local variables belong to.
+	Compiled programs refer to the variables themselves, which stay in place until the script is run again,
+	but not to objects, which can disappear or change names, so expressions that name objects are compiled every time.
+*/
+#define Interpreter_MAXNUM_EXPRESSIONS_PER_LINE  8
+
+struct structInterpreterCompiledExpression {
+	int expressionType;
+	char32 *expression, *procedureName;
+	FormulaProgram program;
+};
+
+struct structInterpreterCompiledLine {
+	int numberOfExpressions;
+	struct structInterpreterCompiledExpression expressions [1 + Interpreter_MAXNUM_EXPRESSIONS_PER_LINE];
+};
+
+static void Interpreter_forgetCompiledLines (Interpreter me) {
+	for (long iline = 1; iline <= my numberOfCompiledLines; iline ++) {
+		struct structInterpreterCompiledLine *line = my compiledLines [iline];
+		if (! line) continue;
+		for (int iexpression = 1; iexpression <= line -> numberOfExpressions; iexpression ++) {
+			struct structInterpreterCompiledExpression *compiledExpression = & line -> expressions [iexpression];
+			Melder_free (compiledExpression -> expression);
+			Melder_free (compiledExpression -> procedureName);
+			forget (compiledExpression -> program);
+		}
+		Melder_free (line);
+	}
+	NUMvector_free (my compiledLines, 1);
+	my compiledLines = nullptr;
+	my numberOfCompiledLines = 0;
+}
+
 void structInterpreter :: v_destroy () noexcept {
+	Interpreter_forgetCompiledLines (this);
 	Melder_free (our environmentName);
 	for (int ipar = 1; ipar <= Interpreter_MAXNUM_PARAMETERS; ipar ++)
 		Melder_free (our arguments [ipar]);
@@ -731,6 +770,9 @@ void Interpreter_run (Interpreter me, char32 *text) {
 		 * Remember line starts and labels.
 		 */
 		lines.reset (1, numberOfLines);
+		Interpreter_forgetCompiledLines (me);
+		my compiledLines = NUMvector <struct structInterpreterCompiledLine *> (1, numberOfLines);
+		my numberOfCompiledLines = numberOfLines;
 		for (lineNumber = 1, command = text; lineNumber <= numberOfLines; lineNumber ++, command += str32len (command) + 1 + chopped) {
 			int length;
 			while (Melder_isblank (*command) || *command == UNICODE_NO_BREAK_SPACE) command ++;   // nbsp can occur for scripts copied from the manual
@@ -837,6 +879,7 @@ void Interpreter_run (Interpreter me, char32 *text) {
 		//}
 		for (lineNumber = 1; lineNumber <= numberOfLines; lineNumber ++) {
 			if (my stopped) break;
+			my lineNumber = lineNumber;
 			//trace (U"now at line ", lineNumber, U": ", lines [lineNumber]);
 			//for (int lineNumber2 = 1; lineNumber2 <= numberOfLines; lineNumber2 ++) {
 				//trace (U"  line ", lineNumber2, U": ", lines [lineNumber2]);
@@ -1943,6 +1986,8 @@ void Interpreter_run (Interpreter me, char32 *text) {
 		my numberOfLabels = 0;
 		my running = false;
 		my stopped = false;
+		my lineNumber = 0;
+		Interpreter_forgetCompiledLines (me);
 	} catch (MelderError) {
 		if (lineNumber > 0) {
 			bool normalExplicitExit = str32nequ (lines [lineNumber], U"exit ", 5) || Melder_hasError (U"Script exited.");
@@ -1957,6 +2002,8 @@ void Interpreter_run (Interpreter me, char32 *text) {
 		my numberOfLabels = 0;
 		my running = false;
 		my stopped = false;
+		my lineNumber = 0;
+		Interpreter_forgetCompiledLines (me);
 		if (str32equ (Melder_getError (), U"\nScript exited.\n")) {
 			Melder_clearError ();
 		} else {
@@ -1971,10 +2018,54 @@ void Interpreter_stop (Interpreter me) {
 //Melder_casual (U"Interpreter_stop out: ", Melder_pointer (me));
 }
 
+/*
+	The program for an expression on the current script line: a compiled one if available, otherwise a new one,
+	which is kept with the line if possible, and otherwise owned by `uncachedProgram`.
+*/
+static FormulaProgram Interpreter_compileExpression (Interpreter me, const char32 *expression, int expressionType,
+	autoFormulaProgram *uncachedProgram)
+{
+	struct structInterpreterCompiledLine *line = nullptr;
+	const char32 *procedureName = my procedureNames [my callDepth];
+	if (my lineNumber >= 1 && my lineNumber <= my numberOfCompiledLines) {
+		line = my compiledLines [my lineNumber];
+		if (line) {
+			for (int iexpression = 1; iexpression <= line -> numberOfExpressions; iexpression ++) {
+				struct structInterpreterCompiledExpression *compiledExpression = & line -> expressions [iexpression];
+				if (compiledExpression -> expressionType == expressionType &&
+					str32equ (compiledExpression -> expression, expression) &&
+					str32equ (compiledExpression -> procedureName, procedureName))
+				{
+					return compiledExpression -> program;
+				}
+			}
+		} else {
+			line = my compiledLines [my lineNumber] = Melder_calloc (struct structInterpreterCompiledLine, 1);
+		}
+	}
+	autoFormulaProgram program = Formula_compileProgram (me, nullptr, expression, expressionType, false);
+	if (! line || program -> refersToObjectNames || line -> numberOfExpressions >= Interpreter_MAXNUM_EXPRESSIONS_PER_LINE) {
+		/*
+			Expressions with objects are not kept, and neither are lines that produce ever new expressions,
+			such as "x = 'i'" in a loop. A program that is still running is never replaced.
+		*/
+		*uncachedProgram = program.move();
+		return uncachedProgram -> get();
+	}
+	autostring32 expressionCopy = Melder_dup (expression), procedureNameCopy = Melder_dup (procedureName);
+	struct structInterpreterCompiledExpression *compiledExpression = & line -> expressions [++ line -> numberOfExpressions];
+	compiledExpression -> expressionType = expressionType;
+	compiledExpression -> expression = expressionCopy.transfer();
+	compiledExpression -> procedureName = procedureNameCopy.transfer();
+	compiledExpression -> program = program.releaseToAmbiguousOwner();
+	return compiledExpression -> program;
+}
+
 void Interpreter_voidExpression (Interpreter me, const char32 *expression) {
-	Formula_compile (me, nullptr, expression, kFormula_EXPRESSION_TYPE_NUMERIC, false);
+	autoFormulaProgram uncachedProgram;
+	FormulaProgram program = Interpreter_compileExpression (me, expression, kFormula_EXPRESSION_TYPE_NUMERIC, & uncachedProgram);
 	struct Formula_Result result;
-	Formula_run (0, 0, & result);
+	FormulaProgram_run (program, 0, 0, & result);
 }
 
 void Interpreter_numericExpression (Interpreter me, const char32 *expression, double *value) {
@@ -1982,37 +2073,42 @@ void Interpreter_numericExpression (Interpreter me, const char32 *expression, do
 	if (str32str (expression, U"(=")) {
 		*value = Melder_atof (expression);
 	} else {
-		Formula_compile (me, nullptr, expression, kFormula_EXPRESSION_TYPE_NUMERIC, false);
+		autoFormulaProgram uncachedProgram;
+		FormulaProgram program = Interpreter_compileExpression (me, expression, kFormula_EXPRESSION_TYPE_NUMERIC, & uncachedProgram);
 		struct Formula_Result result;
-		Formula_run (0, 0, & result);
+		FormulaProgram_run (program, 0, 0, & result);
 		*value = result. result.numericResult;
 	}
 }
 
 void Interpreter_numericVectorExpression (Interpreter me, const char32 *expression, struct Formula_NumericVector *value) {
-	Formula_compile (me, nullptr, expression, kFormula_EXPRESSION_TYPE_NUMERIC_VECTOR, false);
+	autoFormulaProgram uncachedProgram;
+	FormulaProgram program = Interpreter_compileExpression (me, expression, kFormula_EXPRESSION_TYPE_NUMERIC_VECTOR, & uncachedProgram);
 	struct Formula_Result result;
-	Formula_run (0, 0, & result);
+	FormulaProgram_run (program, 0, 0, & result);
 	*value = result. result.numericVectorResult;
 }
 
 void Interpreter_numericMatrixExpression (Interpreter me, const char32 *expression, struct Formula_NumericMatrix *value) {
-	Formula_compile (me, nullptr, expression, kFormula_EXPRESSION_TYPE_NUMERIC_MATRIX, false);
+	autoFormulaProgram uncachedProgram;
+	FormulaProgram program = Interpreter_compileExpression (me, expression, kFormula_EXPRESSION_TYPE_NUMERIC_MATRIX, & uncachedProgram);
 	struct Formula_Result result;
-	Formula_run (0, 0, & result);
+	FormulaProgram_run (program, 0, 0, & result);
 	*value = result. result.numericMatrixResult;
 }
 
 void Interpreter_stringExpression (Interpreter me, const char32 *expression, char32 **value) {
-	Formula_compile (me, nullptr, expression, kFormula_EXPRESSION_TYPE_STRING, false);
+	autoFormulaProgram uncachedProgram;
+	FormulaProgram program = Interpreter_compileExpression (me, expression, kFormula_EXPRESSION_TYPE_STRING, & uncachedProgram);
 	struct Formula_Result result;
-	Formula_run (0, 0, & result);
+	FormulaProgram_run (program, 0, 0, & result);
 	*value = result. result.stringResult;
 }
 
 void Interpreter_anyExpression (Interpreter me, const char32 *expression, struct Formula_Result *result) {
-	Formula_compile (me, nullptr, expression, kFormula_EXPRESSION_TYPE_UNKNOWN, false);
-	Formula_run (0, 0, result);
+	autoFormulaProgram uncachedProgram;
+	FormulaProgram program = Interpreter_compileExpression (me, expression, kFormula_EXPRESSION_TYPE_UNKNOWN, & uncachedProgram);
+	FormulaProgram_run (program, 0, 0, result);
 }
 
 /* End of file Interpreter.cpp */
@@ -57,6 +57,9 @@ Thing_define (Interpreter, Thing) {
 	char32 dialogTitle [1+100], procedureNames [1+Interpreter_MAX_CALL_DEPTH] [100];
 	std::unordered_map <std::u32string, InterpreterVariable> variablesMap;
 	bool running, stopped;
+	long lineNumber;   // the script line that is being run, or 0
+	long numberOfCompiledLines;
+	struct structInterpreterCompiledLine **compiledLines;   // base 1; the expressions of each script line, while running
 
 	void v_destroy () noexcept
 		override;
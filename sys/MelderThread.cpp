@@ -0,0 +1,304 @@
+/* MelderThread.cpp
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MelderThread.h"
+#include "Preferences.h"
+
+#if Melder_HAS_THREADS
+	#include <atomic>
+	#include <condition_variable>
+	#include <exception>
+	#include <memory>
+	#include <mutex>
+	#include <thread>
+#endif
+
+#if defined (linux)
+	#include <sched.h>
+#endif
+
+static int thePreferredMaximumNumberOfThreads;   // 0 = automatic
+
+void MelderThread_prefs () {
+	Preferences_addInt (U"Melder.maximumNumberOfThreads", & thePreferredMaximumNumberOfThreads, 0);
+}
+
+int MelderThread_getNumberOfProcessors () {
+	static int numberOfProcessors = 0;
+	if (numberOfProcessors == 0) {
+		int result = 0;
+		#if defined (linux)
+			/*
+			 * Respect the CPU set that we were given (taskset, cgroups, batch schedulers).
+			 */
+			cpu_set_t cpuSet;
+			if (sched_getaffinity (0, sizeof (cpuSet), & cpuSet) == 0)
+				result = CPU_COUNT (& cpuSet);
+		#endif
+		#if Melder_HAS_THREADS
+			if (result <= 0)
+				result = (int) std::thread::hardware_concurrency ();
+		#endif
+		numberOfProcessors = result > 0 ? result : 1;
+	}
+	return numberOfProcessors;
+}
+
+#if Melder_HAS_THREADS
+	static const std::thread::id theMainThread = std::this_thread::get_id ();   // static initialization runs in the main thread
+#endif
+
+bool MelderThread_isMainThread () {
+	#if Melder_HAS_THREADS
+		return std::this_thread::get_id () == theMainThread;
+	#else
+		return true;   // parallel loops never leave the calling thread
+	#endif
+}
+
+static int theMaximumNumberOfThreads;   // 0 = not set by the program
+
+void MelderThread_setMaximumNumberOfThreads (int maximumNumberOfThreads) {
+	theMaximumNumberOfThreads = maximumNumberOfThreads < 0 ? 0 : maximumNumberOfThreads;
+}
+
+int MelderThread_getMaximumNumberOfThreads () {
+	if (theMaximumNumberOfThreads > 0)
+		return theMaximumNumberOfThreads;
+	static int environmentNumberOfThreads = -1;
+	if (environmentNumberOfThreads < 0) {
+		const char *environmentString = getenv ("PRAAT_NUMBER_OF_THREADS");
+		environmentNumberOfThreads = environmentString ? atoi (environmentString) : 0;
+		if (environmentNumberOfThreads < 0) environmentNumberOfThreads = 0;
+	}
+	if (environmentNumberOfThreads > 0)
+		return environmentNumberOfThreads;
+	if (thePreferredMaximumNumberOfThreads > 0)
+		return thePreferredMaximumNumberOfThreads;
+	return MelderThread_getNumberOfProcessors ();
+}
+
+int MelderThread_getNumberOfThreads () {
+	#if Melder_HAS_THREADS
+		return MelderThread_getMaximumNumberOfThreads ();
+	#else
+		return 1;
+	#endif
+}
+
+static Melder_THREAD_LOCAL bool theInsideParallelLoop;
+
+#if Melder_HAS_THREADS
+
+namespace {
+
+struct Slot {
+	std::mutex mutex;
+	long next, last;   // the part of the index range that this participant has not yet started
+};
+
+struct Pool {
+	std::mutex jobMutex;   // one parallel loop at a time
+	std::mutex wakeMutex;
+	std::condition_variable wake, done;
+	unsigned long generation = 0;
+	int numberOfWorkers = 0;   // excluding the calling thread
+	int numberOfBusyWorkers = 0;
+	std::vector <std::unique_ptr <Slot>> slots;   // one per participant; only resized between jobs
+
+	/*
+	 * The current job.
+	 */
+	int numberOfParticipants = 1;
+	long grainSize = 1;
+	MelderThread_Body body = nullptr;
+	void *closure = nullptr;
+	std::atomic <bool> cancelled { false };
+	std::mutex exceptionMutex;
+	std::exception_ptr firstException;
+	char32 firstErrorMessage [2000+1];   // the error buffer is thread-local, so the message of the first exception is copied here
+};
+
+}
+
+static Pool *thePool;   // never destroyed, because workers may still be waiting when the program exits
+
+static bool Pool_takeOwnChunk (Pool *me, int participant, long *first, long *last) {
+	Slot *slot = my slots [participant - 1]. get ();
+	std::lock_guard <std::mutex> lock (slot -> mutex);
+	if (slot -> next > slot -> last)
+		return false;
+	*first = slot -> next;
+	*last = slot -> next + my grainSize - 1;
+	if (*last > slot -> last) *last = slot -> last;
+	slot -> next = *last + 1;
+	return true;
+}
+
+static bool Pool_steal (Pool *me, int participant) {
+	for (int ivictim = 1; ivictim < my numberOfParticipants; ivictim ++) {
+		int victim = (participant - 1 + ivictim) % my numberOfParticipants;
+		Slot *victimSlot = my slots [victim]. get ();
+		long stolenFirst, stolenLast;
+		{// scope
+			std::lock_guard <std::mutex> lock (victimSlot -> mutex);
+			long numberOfRemainingIndexes = victimSlot -> last - victimSlot -> next + 1;
+			if (numberOfRemainingIndexes <= 0)
+				continue;
+			stolenLast = victimSlot -> last;
+			if (numberOfRemainingIndexes > my grainSize) {
+				stolenFirst = victimSlot -> next + numberOfRemainingIndexes / 2;   // take the upper half
+				victimSlot -> last = stolenFirst - 1;
+			} else {
+				stolenFirst = victimSlot -> next;   // take everything
+				victimSlot -> next = stolenLast + 1;
+			}
+		}
+		Slot *ownSlot = my slots [participant - 1]. get ();
+		std::lock_guard <std::mutex> lock (ownSlot -> mutex);
+		ownSlot -> next = stolenFirst;
+		ownSlot -> last = stolenLast;
+		return true;
+	}
+	return false;
+}
+
+static void Pool_participate (Pool *me, int participant) {
+	theInsideParallelLoop = true;
+	for (;;) {
+		if (my cancelled)
+			break;
+		long first, last;
+		if (! Pool_takeOwnChunk (me, participant, & first, & last)) {
+			if (! Pool_steal (me, participant))
+				break;
+			continue;
+		}
+		try {
+			my body (my closure, first, last, participant);
+		} catch (...) {
+			std::lock_guard <std::mutex> lock (my exceptionMutex);
+			if (! my firstException) {
+				my firstException = std::current_exception ();
+				str32ncpy (my firstErrorMessage, Melder_getError (), 2000);
+				my firstErrorMessage [2000] = U'\0';
+				long length = str32len (my firstErrorMessage);
+				if (length > 0 && my firstErrorMessage [length - 1] == U'\n')
+					my firstErrorMessage [length - 1] = U'\0';   // Melder_appendError will add it again
+			}
+			Melder_clearError ();
+			my cancelled = true;
+			break;
+		}
+	}
+	theInsideParallelLoop = false;
+}
+
+static void Pool_work (Pool *me, int participant, unsigned long generation) {
+	for (;;) {
+		{// scope
+			std::unique_lock <std::mutex> lock (my wakeMutex);
+			my wake. wait (lock, [=] { return my generation != generation; });
+			generation = my generation;
+			if (participant > my numberOfParticipants)
+				continue;   // not needed for this job
+		}
+		Pool_participate (me, participant);
+		std::lock_guard <std::mutex> lock (my wakeMutex);
+		if (-- my numberOfBusyWorkers == 0)
+			my done. notify_one ();
+	}
+}
+
+static void Pool_growTo (Pool *me, int numberOfParticipants) {
+	while ((int) my slots. size () < numberOfParticipants)
+		my slots. push_back (std::unique_ptr <Slot> (new Slot));
+	while (my numberOfWorkers < numberOfParticipants - 1) {
+		int participant = my numberOfWorkers + 2;   // participant 1 is the calling thread
+		std::thread (Pool_work, me, participant, my generation). detach ();
+		my numberOfWorkers ++;
+	}
+}
+
+#endif
+
+static void runSerially (long firstIndex, long lastIndex, long grainSize, MelderThread_Body body, void *closure) {
+	for (long first = firstIndex; first <= lastIndex; first += grainSize) {
+		long last = first + grainSize - 1;
+		if (last > lastIndex) last = lastIndex;
+		body (closure, first, last, 1);
+	}
+}
+
+void MelderThread_parallelFor_ (long firstIndex, long lastIndex, long grainSize, MelderThread_Body body, void *closure) {
+	long numberOfIndexes = lastIndex - firstIndex + 1;
+	if (numberOfIndexes <= 0)
+		return;
+	int numberOfParticipants = MelderThread_getNumberOfThreads ();
+	if (grainSize <= 0) {
+		grainSize = numberOfIndexes / (16L * numberOfParticipants);
+		if (grainSize < 1) grainSize = 1;
+	}
+	if (numberOfParticipants > (numberOfIndexes - 1) / grainSize + 1)
+		numberOfParticipants = (int) ((numberOfIndexes - 1) / grainSize + 1);
+	if (numberOfParticipants <= 1 || theInsideParallelLoop) {
+		runSerially (firstIndex, lastIndex, grainSize, body, closure);   // always so if we have no threads
+		return;
+	}
+	#if Melder_HAS_THREADS
+	static std::once_flag poolCreated;
+	std::call_once (poolCreated, [] { thePool = new Pool; });
+	Pool *me = thePool;
+	std::unique_lock <std::mutex> jobLock (my jobMutex, std::try_to_lock);
+	if (! jobLock. owns_lock ()) {
+		runSerially (firstIndex, lastIndex, grainSize, body, closure);   // another thread is using the pool
+		return;
+	}
+	Pool_growTo (me, numberOfParticipants);
+	my grainSize = grainSize;
+	my body = body;
+	my closure = closure;
+	my cancelled = false;
+	my firstException = nullptr;
+	for (int iparticipant = 1; iparticipant <= numberOfParticipants; iparticipant ++) {
+		Slot *slot = my slots [iparticipant - 1]. get ();
+		std::lock_guard <std::mutex> lock (slot -> mutex);
+		slot -> next = firstIndex + numberOfIndexes * (iparticipant - 1) / numberOfParticipants;
+		slot -> last = firstIndex + numberOfIndexes * iparticipant / numberOfParticipants - 1;
+	}
+	{// scope
+		std::lock_guard <std::mutex> lock (my wakeMutex);
+		my numberOfParticipants = numberOfParticipants;
+		my numberOfBusyWorkers = numberOfParticipants - 1;
+		my generation ++;
+	}
+	my wake. notify_all ();
+	Pool_participate (me, 1);
+	{// scope
+		std::unique_lock <std::mutex> lock (my wakeMutex);
+		my done. wait (lock, [=] { return my numberOfBusyWorkers == 0; });
+	}
+	if (my firstException) {
+		std::exception_ptr exception = my firstException;
+		my firstException = nullptr;
+		if (my firstErrorMessage [0] != U'\0')
+			Melder_appendError (my firstErrorMessage);
+		std::rethrow_exception (exception);
+	}
+	#endif
+}
+
+/* End of file MelderThread.cpp */
@@ -79,94 +79,75 @@
 	#define MelderThread_UNLOCK(_mutex)  _mutex = 0
 #endif
 
-static int MelderThread_getNumberOfProcessors () {
-	#if USE_WINTHREADS
-		return 8;
-	#elif USE_PTHREADS
-		return 8;
-	#elif USE_CPPTHREADS
-		return std::thread::hardware_concurrency ();
-	#else
-		return 1;
-	#endif
+/*
+	The thread pool.
+
+	Praat keeps one process-wide pool of worker threads, which is created the first time
+	a parallel loop is run and stays alive until the program exits.
+	A parallel loop is executed by the calling thread together with the workers;
+	each of them starts with an equal part of the index range, which it processes in chunks of `grainSize` indexes,
+	and when its own part is exhausted it steals half of the remaining work of another participant.
+
+	The number of threads is the number of processors that the process may run on
+	(as restricted by e.g. `taskset` or a batch scheduler), unless it is overridden
+	by the environment variable PRAAT_NUMBER_OF_THREADS or by the preference "Melder.maximumNumberOfThreads".
+
+	Where the compiler has no std::thread or thread_local (Melder_HAS_THREADS is 0, see melder.h),
+	there is no pool: the number of threads is 1, and every loop runs serially in the calling thread.
+*/
+
+int MelderThread_getNumberOfProcessors ();
+/*
+	Returns the number of processors available to this process, as detected from the system.
+*/
+
+void MelderThread_setMaximumNumberOfThreads (int maximumNumberOfThreads);
+/*
+	0 means: as many as there are processors.
+*/
+int MelderThread_getMaximumNumberOfThreads ();
+
+int MelderThread_getNumberOfThreads ();
+/*
+	The number of threads (including the calling thread) that will take part in a parallel loop.
+	A loop body is called with a thread number between 1 and this number,
+	which it can use as an index into per-thread scratch space.
+*/
+
+void MelderThread_prefs ();
+
+bool MelderThread_isMainThread ();
+/*
+	Whether we are running in the thread that started the program,
+	which is the only thread that can call Melder_progress () or other GUI functions.
+*/
+
+typedef void (*MelderThread_Body) (void *closure, long firstIndex, long lastIndex, int threadNumber);
+void MelderThread_parallelFor_ (long firstIndex, long lastIndex, long grainSize, MelderThread_Body body, void *closure);
+
+template <class F> void MelderThread_parallelFor (long firstIndex, long lastIndex, long grainSize, const F& body) {
+	MelderThread_parallelFor_ (firstIndex, lastIndex, grainSize,
+		[] (void *closure, long first, long last, int threadNumber) {
+			(* (const F *) closure) (first, last, threadNumber);
+		},
+		(void *) & body);
 }
+/*
+	Calls `body (first, last, threadNumber)` for consecutive subranges [first, last] that together cover
+	[firstIndex, lastIndex] exactly once; the subranges have at most `grainSize` elements,
+	and may run in any order and on any thread.
+	If `grainSize` is 0, a grain size is chosen that gives every thread about 16 chunks.
 
-#if USE_WINTHREADS
-	template <class T> void MelderThread_run (DWORD (WINAPI *func) (T *), _Thing_auto <T> *args, int numberOfThreads) {
-		if (numberOfThreads == 1) {
-			func (args [0].get());
-		} else {
-			std::vector <HANDLE> threads (numberOfThreads);
-			try {
-				for (int ithread = 1; ithread < numberOfThreads; ithread ++) {
-					threads [ithread - 1] = CreateThread (nullptr, 0,
-						(DWORD (WINAPI *)(void *)) func, (void *) args [ithread - 1].get(), 0, nullptr);
-				}
-				func (args [numberOfThreads - 1].get());
-			} catch (MelderError) {
-				for (int ithread = 1; ithread < numberOfThreads; ithread ++) {
-					WaitForSingleObject (threads [ithread - 1], INFINITE);
-					CloseHandle (threads [ithread - 1]);
-				}
-				throw;
-			}
-			for (int ithread = 1; ithread < numberOfThreads; ithread ++) {
-				WaitForSingleObject (threads [ithread - 1], INFINITE);
-				CloseHandle (threads [ithread - 1]);
-			}
-		}
-	}
-#elif USE_PTHREADS
-	template <class T> void MelderThread_run (void * (*func) (T *), _Thing_auto <T> *args, int numberOfThreads) {
-		if (numberOfThreads == 1) {
-			func (args [0].get());
-		} else {
-			std::vector <pthread_t> threads (numberOfThreads);
-			try {
-				for (int ithread = 1; ithread < numberOfThreads; ithread ++) {
-					(void) pthread_create (& threads [ithread - 1],
-						nullptr, (void*(*)(void *)) func, (void *) args [ithread - 1].get());
-				}
-				func (args [numberOfThreads - 1].get());
-			} catch (MelderError) {
-				for (int ithread = 1; ithread < numberOfThreads; ithread ++) {
-					pthread_join (threads [ithread - 1], nullptr);
-				}
-				throw;
-			}
-			for (int ithread = 1; ithread < numberOfThreads; ithread ++) {
-				pthread_join (threads [ithread - 1], nullptr);
-			}
-		}
-	}
-#elif USE_CPPTHREADS
-	template <class T> void MelderThread_run (void * (*func) (T *), _Thing_auto <T> *args, int numberOfThreads) {
-		if (numberOfThreads == 1) {
-			func (args [0].get());
-		} else {
-			std::vector <std::thread> thread (numberOfThreads);
-			try {
-				for (int ithread = 1; ithread < numberOfThreads; ithread ++) {
-					thread [ithread - 1] = std::thread (func, args [ithread - 1].get());
-				}
-				func (args [numberOfThreads - 1].get());
-			} catch (MelderError) {
-				for (int ithread = 1; ithread < numberOfThreads; ithread ++) {
-					if (thread [ithread - 1]. joinable ())
-						thread [ithread - 1]. join ();
-				}
-				throw;
-			}
-			for (int ithread = 1; ithread < numberOfThreads; ithread ++) {
-				thread [ithread - 1]. join ();
-			}
-		}
-	}
-#else
-	template <class T> void MelderThread_run (void (*func) (T *), _Thing_auto <T> *args, int numberOfThreads) {
-		func (args [0].get());
-	}
-#endif
+	Thread number 1 is always the calling thread, but the calling thread need not be the main thread:
+	a loop that runs serially because it was started from within another parallel loop
+	(or while another thread is running one) also gets thread number 1.
+	A body should therefore call Melder_progress () only if MelderThread_isMainThread ().
+	If a body throws, no new chunks are started, and the first exception is rethrown
+	in the calling thread after all threads have finished their current chunk,
+	together with the error message that the failing thread had collected in its own error buffer.
+	A parallel loop started from within another parallel loop (or while another thread
+	is running one) is executed serially in the calling thread.
+*/
 
 #endif
 /* End of file MelderThread.h */
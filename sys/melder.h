@@ -34,6 +34,26 @@
 #endif
 #include <stdbool.h>
 #include <functional>
+/*
+	Whether the compiler and its run-time library offer std::thread and thread_local.
+	MinGW with the win32 thread model has no std::thread, and Apple's clang before Xcode 8 has no thread_local;
+	there, MelderThread_parallelFor runs serially in the calling thread,
+	and variables declared Melder_THREAD_LOCAL are ordinary statics.
+*/
+#ifndef Melder_HAS_THREADS   // can be set from the command line, e.g. -DMelder_HAS_THREADS=0 for a single-threaded build
+	#if defined (__MINGW32__) && ! defined (_GLIBCXX_HAS_GTHREADS)
+		#define Melder_HAS_THREADS  0
+	#elif defined (__apple_build_version__) && __apple_build_version__ < 8000000
+		#define Melder_HAS_THREADS  0
+	#else
+		#define Melder_HAS_THREADS  1
+	#endif
+#endif
+#if Melder_HAS_THREADS
+	#define Melder_THREAD_LOCAL  thread_local
+#else
+	#define Melder_THREAD_LOCAL
+#endif
 /*
  * The following two lines are for obsolete (i.e. C99) versions of stdint.h
  */
@@ -751,10 +771,23 @@ int64 MelderString_deallocationCount ();
 int64 MelderString_allocationSize ();
 int64 MelderString_deallocationSize ();
 
+/*
+	A MelderReadText decodes its file incrementally from a fixed-size byte buffer,
+	so that the memory it uses does not grow with the size of the file.
+*/
 struct structMelderReadText {
-	char32 *string32, *readPointer32;
-	char *string8, *readPointer8;
+	FILE *file;
+	int type;   // 0 = 8-bit, 1 = big-endian UTF-16, 2 = little-endian UTF-16
 	unsigned long input8Encoding;
+	int64 textOffset;   // the file position of the first byte after the byte-order mark, if any
+	char8 *buffer;
+	int64 bufferOffset;   // the file position of buffer [0]
+	int64 bufferLength, bufferPosition;
+	char32 lookahead;   // the character after a carriage return, if it wasn't a linefeed
+	bool hasLookahead;
+	int64 numberOfNewlinesRead;
+	char32 *line;   // the result of MelderReadText_readLine; overwritten by the next call
+	int64 lineCapacity;
 };
 typedef struct structMelderReadText *MelderReadText;
 
@@ -1286,6 +1319,8 @@ const char32 * Melder_audioFileTypeString (int audioFileType);   // "AIFF", "AIF
 #define Melder_MPEG_COMPRESSION_16 18
 #define Melder_MPEG_COMPRESSION_24 19
 #define Melder_MPEG_COMPRESSION_32 20
+#define Melder_IEEE_FLOAT_64_BIG_ENDIAN  21
+#define Melder_IEEE_FLOAT_64_LITTLE_ENDIAN  22
 int Melder_defaultAudioFileEncoding (int audioFileType, int numberOfBitsPerSamplePoint);   /* BIG_ENDIAN, BIG_ENDIAN, LITTLE_ENDIAN, BIG_ENDIAN, LITTLE_ENDIAN */
 void MelderFile_writeAudioFileHeader (MelderFile file, int audioFileType, long sampleRate, long numberOfSamples, int numberOfChannels, int numberOfBitsPerSamplePoint);
 void MelderFile_writeAudioFileTrailer (MelderFile file, int audioFileType, long sampleRate, long numberOfSamples, int numberOfChannels, int numberOfBitsPerSamplePoint);
@@ -19,6 +19,7 @@
 #include "melder.h"
 #include "abcio.h"
 #include "math.h"
+#include "NUM.h"
 #include "flac_FLAC_metadata.h"
 #include "flac_FLAC_stream_decoder.h"
 #include "flac_FLAC_stream_encoder.h"
@@ -269,6 +270,7 @@ int Melder_bytesPerSamplePoint (int encoding) {
 		encoding == Melder_LINEAR_24_BIG_ENDIAN || encoding == Melder_LINEAR_24_LITTLE_ENDIAN ? 3 :
 		encoding == Melder_LINEAR_32_BIG_ENDIAN || encoding == Melder_LINEAR_32_LITTLE_ENDIAN ||
 		encoding == Melder_IEEE_FLOAT_32_BIG_ENDIAN || encoding == Melder_IEEE_FLOAT_32_LITTLE_ENDIAN ? 4 :
+		encoding == Melder_IEEE_FLOAT_64_BIG_ENDIAN || encoding == Melder_IEEE_FLOAT_64_LITTLE_ENDIAN ? 8 :
 		1;
 }
 
@@ -383,7 +385,8 @@ static void Melder_checkAiffFile (FILE *f, int *numberOfChannels, int *encoding,
 			*numberOfSamples = bingeti4 (f);
 			if (*numberOfSamples <= 0) Melder_throw (U"Too few samples ", *numberOfSamples, U").");
 			numberOfBitsPerSamplePoint = bingeti2 (f);
-			if (numberOfBitsPerSamplePoint > 32) Melder_throw (U"Too many bits per sample (", numberOfBitsPerSamplePoint, U"; the maximum is 32).");
+			if (numberOfBitsPerSamplePoint > (isAifc ? 64 : 32))
+				Melder_throw (U"Too many bits per sample (", numberOfBitsPerSamplePoint, U"; the maximum is ", isAifc ? 64 : 32, U").");
 			*encoding =
 				numberOfBitsPerSamplePoint > 24 ? Melder_LINEAR_32_BIG_ENDIAN :
 				numberOfBitsPerSamplePoint > 16 ? Melder_LINEAR_24_BIG_ENDIAN :
@@ -396,10 +399,18 @@ static void Melder_checkAiffFile (FILE *f, int *numberOfChannels, int *encoding,
 				 * Read compression data; should be "NONE" or "sowt".
 				 */
 				if (fread (data, 1, 4, f) < 4) Melder_throw (U"File too small: no compression info.");
-				if (! strnequ (data, "NONE", 4) && ! strnequ (data, "sowt", 4)) {
+				bool isFloat32 = strnequ (data, "fl32", 4) || strnequ (data, "FL32", 4);
+				bool isFloat64 = strnequ (data, "fl64", 4) || strnequ (data, "FL64", 4);
+				if (! strnequ (data, "NONE", 4) && ! strnequ (data, "sowt", 4) && ! isFloat32 && ! isFloat64) {
 					data [4] = '\0';
 					Melder_throw (U"Cannot read compressed AIFC files (compression type ", Melder_peek8to32 (data), U").");
 				}
+				if (isFloat32)
+					*encoding = Melder_IEEE_FLOAT_32_BIG_ENDIAN;
+				else if (isFloat64)
+					*encoding = Melder_IEEE_FLOAT_64_BIG_ENDIAN;
+				else if (numberOfBitsPerSamplePoint > 32)
+					Melder_throw (U"Too many bits per sample (", numberOfBitsPerSamplePoint, U"; the maximum is 32).");
 				if (strnequ (data, "sowt", 4))
 					*encoding =
 						numberOfBitsPerSamplePoint > 24 ? Melder_LINEAR_32_LITTLE_ENDIAN :
@@ -470,8 +481,10 @@ static void Melder_checkWavFile (FILE *f, int *numberOfChannels, int *encoding,
 				numberOfBitsPerSamplePoint = 16;   // the default
 			else if (numberOfBitsPerSamplePoint < 4)
 				Melder_throw (U"Too few bits per sample (", numberOfBitsPerSamplePoint, U"; the minimum is 4).");
-			else if (numberOfBitsPerSamplePoint > 32)
-				Melder_throw (U"Too few bits per sample (", numberOfBitsPerSamplePoint, U"; the maximum is 32).");
+			else if (numberOfBitsPerSamplePoint > 64)
+				Melder_throw (U"Too many bits per sample (", numberOfBitsPerSamplePoint, U"; the maximum is 64).");
+			else if (numberOfBitsPerSamplePoint > 32 && winEncoding != WAVE_FORMAT_IEEE_FLOAT && winEncoding != WAVE_FORMAT_EXTENSIBLE)
+				Melder_throw (U"Too many bits per sample (", numberOfBitsPerSamplePoint, U"; the maximum is 32).");
 			switch (winEncoding) {
 				case WAVE_FORMAT_PCM:
 					*encoding =
@@ -481,7 +494,7 @@ static void Melder_checkWavFile (FILE *f, int *numberOfChannels, int *encoding,
 						Melder_LINEAR_8_UNSIGNED;
 					break;
 				case WAVE_FORMAT_IEEE_FLOAT:
-					*encoding = Melder_IEEE_FLOAT_32_LITTLE_ENDIAN;
+					*encoding = numberOfBitsPerSamplePoint == 64 ? Melder_IEEE_FLOAT_64_LITTLE_ENDIAN : Melder_IEEE_FLOAT_32_LITTLE_ENDIAN;
 					break;
 				case WAVE_FORMAT_ALAW:
 					*encoding = Melder_ALAW;
@@ -501,6 +514,8 @@ static void Melder_checkWavFile (FILE *f, int *numberOfChannels, int *encoding,
 					(void) bingeti2LE (f);   // validBitsPerSample
 					(void) bingeti4LE (f);   // channelMask
 					uint16_t winEncoding2 = bingetu2LE (f);   // override
+					if (numberOfBitsPerSamplePoint > 32 && winEncoding2 != WAVE_FORMAT_IEEE_FLOAT)
+						Melder_throw (U"Too many bits per sample (", numberOfBitsPerSamplePoint, U"; the maximum is 32).");
 					switch (winEncoding2) {
 						case WAVE_FORMAT_PCM:
 							*encoding =
@@ -510,7 +525,7 @@ static void Melder_checkWavFile (FILE *f, int *numberOfChannels, int *encoding,
 								Melder_LINEAR_8_UNSIGNED;
 							break;
 						case WAVE_FORMAT_IEEE_FLOAT:
-							*encoding = Melder_IEEE_FLOAT_32_LITTLE_ENDIAN;
+							*encoding = numberOfBitsPerSamplePoint == 64 ? Melder_IEEE_FLOAT_64_LITTLE_ENDIAN : Melder_IEEE_FLOAT_32_LITTLE_ENDIAN;
 							break;
 						case WAVE_FORMAT_ALAW:
 							*encoding = Melder_ALAW;
@@ -852,353 +867,141 @@ static void Melder_readMp3File (FILE *f, int numberOfChannels, double **buffer,
 		Melder_throw (U"Error decoding MP3 file.");
 }
 
+/*
+ * Uncompressed sample data are read in blocks of about this many bytes, with a single fread per block;
+ * each block is then deinterleaved channel by channel, in loops simple enough for the compiler to vectorize.
+ */
+#define DECODE_BLOCK_SIZE  65536
+
+template <typename Decoder>
+static inline void decodeBlock (const uint8 *bytes, int numberOfChannels, int numberOfBytesPerSamplePoint,
+	double **buffer, long firstSample, long numberOfSamples, Decoder decode)
+{
+	const long frameSize = numberOfChannels * numberOfBytesPerSamplePoint;
+	for (int ichan = 1; ichan <= numberOfChannels; ichan ++) {
+		const uint8 *input = bytes + (ichan - 1) * numberOfBytesPerSamplePoint;
+		double *output = & buffer [ichan] [firstSample];
+		for (long isamp = 0; isamp < numberOfSamples; isamp ++)
+			output [isamp] = decode (input + isamp * frameSize);
+	}
+}
+
+static inline float floatFromBits (uint32 bits) {
+	float value;
+	memcpy (& value, & bits, 4);
+	return value;
+}
+
+static inline double doubleFromBits (uint64_t bits) {
+	double value;
+	memcpy (& value, & bits, 8);
+	return value;
+}
+
+static const char32 * encodingDescription (int encoding) {
+	switch (encoding) {
+		case Melder_LINEAR_8_SIGNED: case Melder_LINEAR_8_UNSIGNED: return U"8-bit";
+		case Melder_LINEAR_16_BIG_ENDIAN: case Melder_LINEAR_16_LITTLE_ENDIAN: return U"16-bit";
+		case Melder_LINEAR_24_BIG_ENDIAN: case Melder_LINEAR_24_LITTLE_ENDIAN: return U"24-bit";
+		case Melder_LINEAR_32_BIG_ENDIAN: case Melder_LINEAR_32_LITTLE_ENDIAN: return U"32-bit";
+		case Melder_IEEE_FLOAT_32_BIG_ENDIAN: case Melder_IEEE_FLOAT_32_LITTLE_ENDIAN: return U"32-bit floating point";
+		case Melder_IEEE_FLOAT_64_BIG_ENDIAN: case Melder_IEEE_FLOAT_64_LITTLE_ENDIAN: return U"64-bit floating point";
+		case Melder_MULAW: return U"8-bit mu-law";
+		case Melder_ALAW: return U"8-bit A-law";
+		default: return U"";
+	}
+}
+
+static void Melder_readUncompressedAudioToFloat (FILE *f, int numberOfChannels, int encoding, double **buffer, long numberOfSamples) {
+	const int numberOfBytesPerSamplePoint = Melder_bytesPerSamplePoint (encoding);
+	const long frameSize = numberOfChannels * numberOfBytesPerSamplePoint;
+	long numberOfSamplesPerBlock = DECODE_BLOCK_SIZE / frameSize;
+	if (numberOfSamplesPerBlock < 1) numberOfSamplesPerBlock = 1;
+	autoNUMvector <uint8> block ((long) 0, numberOfSamplesPerBlock * frameSize - 1);
+	for (long firstSample = 1; firstSample <= numberOfSamples; firstSample += numberOfSamplesPerBlock) {
+		long numberOfSamplesToRead = numberOfSamples - firstSample + 1;
+		if (numberOfSamplesToRead > numberOfSamplesPerBlock) numberOfSamplesToRead = numberOfSamplesPerBlock;
+		long numberOfSamplesRead = (long) fread (block.peek(), frameSize, numberOfSamplesToRead, f);   // whole sample frames only
+		const uint8 *bytes = block.peek();
+		switch (encoding) {
+			case Melder_LINEAR_8_SIGNED:
+				decodeBlock (bytes, numberOfChannels, 1, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return (int8) b [0] * (1.0 / 128); });
+			break; case Melder_LINEAR_8_UNSIGNED:
+				decodeBlock (bytes, numberOfChannels, 1, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return b [0] * (1.0 / 128) - 1.0; });
+			break; case Melder_LINEAR_16_BIG_ENDIAN:
+				decodeBlock (bytes, numberOfChannels, 2, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return (int16) (uint16) ((uint16) b [0] << 8 | b [1]) * (1.0 / 32768); });
+			break; case Melder_LINEAR_16_LITTLE_ENDIAN:
+				decodeBlock (bytes, numberOfChannels, 2, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return (int16) (uint16) ((uint16) b [1] << 8 | b [0]) * (1.0 / 32768); });
+			break; case Melder_LINEAR_24_BIG_ENDIAN:
+				decodeBlock (bytes, numberOfChannels, 3, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return (int32) ((uint32) b [0] << 24 | (uint32) b [1] << 16 | (uint32) b [2] << 8) * (1.0 / 32768 / 65536); });
+			break; case Melder_LINEAR_24_LITTLE_ENDIAN:
+				decodeBlock (bytes, numberOfChannels, 3, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return (int32) ((uint32) b [2] << 24 | (uint32) b [1] << 16 | (uint32) b [0] << 8) * (1.0 / 32768 / 65536); });
+			break; case Melder_LINEAR_32_BIG_ENDIAN:
+				decodeBlock (bytes, numberOfChannels, 4, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return (int32) ((uint32) b [0] << 24 | (uint32) b [1] << 16 | (uint32) b [2] << 8 | (uint32) b [3]) * (1.0 / 32768 / 65536); });
+			break; case Melder_LINEAR_32_LITTLE_ENDIAN:
+				decodeBlock (bytes, numberOfChannels, 4, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return (int32) ((uint32) b [3] << 24 | (uint32) b [2] << 16 | (uint32) b [1] << 8 | (uint32) b [0]) * (1.0 / 32768 / 65536); });
+			break; case Melder_IEEE_FLOAT_32_BIG_ENDIAN:
+				decodeBlock (bytes, numberOfChannels, 4, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return (double) floatFromBits ((uint32) b [0] << 24 | (uint32) b [1] << 16 | (uint32) b [2] << 8 | (uint32) b [3]); });
+			break; case Melder_IEEE_FLOAT_32_LITTLE_ENDIAN:
+				decodeBlock (bytes, numberOfChannels, 4, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return (double) floatFromBits ((uint32) b [3] << 24 | (uint32) b [2] << 16 | (uint32) b [1] << 8 | (uint32) b [0]); });
+			break; case Melder_IEEE_FLOAT_64_BIG_ENDIAN:
+				decodeBlock (bytes, numberOfChannels, 8, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return doubleFromBits (
+						(uint64_t) b [0] << 56 | (uint64_t) b [1] << 48 | (uint64_t) b [2] << 40 | (uint64_t) b [3] << 32 |
+						(uint64_t) b [4] << 24 | (uint64_t) b [5] << 16 | (uint64_t) b [6] << 8 | (uint64_t) b [7]); });
+			break; case Melder_IEEE_FLOAT_64_LITTLE_ENDIAN:
+				decodeBlock (bytes, numberOfChannels, 8, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return doubleFromBits (
+						(uint64_t) b [7] << 56 | (uint64_t) b [6] << 48 | (uint64_t) b [5] << 40 | (uint64_t) b [4] << 32 |
+						(uint64_t) b [3] << 24 | (uint64_t) b [2] << 16 | (uint64_t) b [1] << 8 | (uint64_t) b [0]); });
+			break; case Melder_MULAW:
+				decodeBlock (bytes, numberOfChannels, 1, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return ulaw2linear [b [0]] * (1.0 / 32768); });
+			break; case Melder_ALAW:
+				decodeBlock (bytes, numberOfChannels, 1, buffer, firstSample, numberOfSamplesRead,
+					[] (const uint8 *b) { return alaw2linear [b [0]] * (1.0 / 32768); });
+			break; default:
+				Melder_fatal (U"Melder_readUncompressedAudioToFloat: unknown encoding ", encoding, U".");
+		}
+		if (numberOfSamplesRead < numberOfSamplesToRead) {
+			for (int ichan = 1; ichan <= numberOfChannels; ichan ++)
+				for (long isamp = firstSample + numberOfSamplesRead; isamp <= numberOfSamples; isamp ++)
+					buffer [ichan] [isamp] = 0.0;
+			Melder_warning (U"File too small (", numberOfChannels, U"-channel ", encodingDescription (encoding), U").\n"
+				U"Missing samples were set to zero.");
+			return;
+		}
+	}
+}
+
 void Melder_readAudioToFloat (FILE *f, int numberOfChannels, int encoding, double **buffer, long numberOfSamples) {
 	try {
 		switch (encoding) {
-			case Melder_LINEAR_8_SIGNED: {
-				try {
-					for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-						for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-							int8 value;
-							if (fread (& value, 1, 1, f) < 1) throw MelderError ();
-							buffer [ichan] [isamp] = value * (1.0 / 128);
-						}
-					}
-				} catch (MelderError) {
-					Melder_clearError ();
-					Melder_warning (U"File too small (", numberOfChannels, U"-channel 8-bit).\nMissing samples set to zero.");
-				}
-			} break;
+			case Melder_LINEAR_8_SIGNED:
 			case Melder_LINEAR_8_UNSIGNED:
-				try {
-					for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-						for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-							buffer [ichan] [isamp] = bingetu1 (f) * (1.0 / 128) - 1.0;
-						}
-					}
-				} catch (MelderError) {
-					Melder_clearError ();
-					Melder_warning (U"File too small (", numberOfChannels, U"-channel 8-bit).\nMissing samples set to zero.");
-				}
-				break;
 			case Melder_LINEAR_16_BIG_ENDIAN:
 			case Melder_LINEAR_16_LITTLE_ENDIAN:
 			case Melder_LINEAR_24_BIG_ENDIAN:
 			case Melder_LINEAR_24_LITTLE_ENDIAN:
 			case Melder_LINEAR_32_BIG_ENDIAN:
 			case Melder_LINEAR_32_LITTLE_ENDIAN:
-			{
-				int numberOfBytesPerSamplePerChannel =
-					encoding == Melder_LINEAR_16_BIG_ENDIAN || encoding == Melder_LINEAR_16_LITTLE_ENDIAN ? 2 :
-					encoding == Melder_LINEAR_24_BIG_ENDIAN || encoding == Melder_LINEAR_24_LITTLE_ENDIAN ? 3 : 4;
-				double numberOfBytes_f = (double) numberOfChannels * (double) numberOfSamples * (double) numberOfBytesPerSamplePerChannel;
-				if (isinf (numberOfBytes_f) || numberOfBytes_f > (double) (1LL << 53)) {
-					Melder_throw (U"Cannot read ", numberOfBytes_f, U" bytes, "
-						U"because that crosses the 9-petabyte limit.");
-				}
-				if (numberOfBytes_f > (double) SIZE_MAX) {
-					Melder_throw (U"Cannot read ", numberOfBytes_f, U" bytes. "
-						U"Perhaps try a 64-bit edition of Praat?");
-				}
-				Melder_assert (numberOfBytes_f >= 0.0);
-				size_t numberOfBytes = (size_t) numberOfBytes_f;   // cast is safe because overflow and signedness have been checked
-				uint8 *bytes = (uint8 *) & buffer [numberOfChannels] [numberOfSamples] + sizeof (double) - numberOfBytes;
-				/*
-				 * Read 16-bit data into the last quarter of the buffer,
-				 * or 24-bit data into the last three-eighths of the buffer,
-				 * or 32-bit data into the last half of the buffer.
-				 */
-				size_t numberOfBytesRead = fread (bytes, 1, numberOfBytes, f);
-				if (numberOfChannels == 1) {
-					switch (encoding) {
-						case Melder_LINEAR_16_BIG_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								unsigned char byte1 = * bytes ++, byte2 = * bytes ++;
-								int value = (int) (int16_t) (((uint16_t) byte1 << 8) | (uint16_t) byte2);   // extend sign
-								buffer [1] [isamp] = value * (1.0 / 32768);
-							}
-						} break;
-						case Melder_LINEAR_16_LITTLE_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								unsigned char byte1 = * bytes ++, byte2 = * bytes ++;
-								int value = (int) (int16_t) (((uint16_t) byte2 << 8) | (uint16_t) byte1);   // extend sign
-								buffer [1] [isamp] = value * (1.0 / 32768);
-							}
-						} break;
-						case Melder_LINEAR_24_BIG_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								unsigned char byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++;
-								int32 value = (int32)
-									((uint32) ((uint32) byte1 << 24) |
-									 (uint32) ((uint32) byte2 << 16) |
-											  ((uint32) byte3 << 8));
-								buffer [1] [isamp] = value * (1.0 / 32768 / 65536);
-							}
-						} break;
-						case Melder_LINEAR_24_LITTLE_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								unsigned char byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++;
-								int32 value = (int32)
-									((uint32) ((uint32) byte3 << 24) |
-									 (uint32) ((uint32) byte2 << 16) |
-											  ((uint32) byte1 << 8));
-								buffer [1] [isamp] = value * (1.0 / 32768 / 65536);
-							}
-						} break;
-						case Melder_LINEAR_32_BIG_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								unsigned char byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++, byte4 = * bytes ++;
-								int32 value = (int32)
-									((uint32) ((uint32) byte1 << 24) |
-									 (uint32) ((uint32) byte2 << 16) |
-									 (uint32) ((uint32) byte3 << 8) |
-											   (uint32) byte4);
-								buffer [1] [isamp] = value * (1.0 / 32768 / 65536);
-							}
-						} break;
-						case Melder_LINEAR_32_LITTLE_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								unsigned char byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++, byte4 = * bytes ++;
-								int32 value = (int32)
-									((uint32) ((uint32) byte4 << 24) |
-									 (uint32) ((uint32) byte3 << 16) |
-									 (uint32) ((uint32) byte2 << 8) |
-											   (uint32) byte1);
-								buffer [1] [isamp] = value * (1.0 / 32768 / 65536);
-							}
-						} break;
-					}
-				} else if (numberOfChannels <= (int) sizeof (double) / numberOfBytesPerSamplePerChannel) {
-					switch (encoding) {
-						case Melder_LINEAR_16_BIG_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									uint8 byte1 = * bytes ++, byte2 = * bytes ++;
-									int value = (int) (int16) (uint16) ((uint16) ((uint16) byte1 << 8) | (uint16) byte2);
-									buffer [ichan] [isamp] = value * (1.0 / 32768);
-								}
-							}
-						} break;
-						case Melder_LINEAR_16_LITTLE_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									uint8 byte1 = * bytes ++, byte2 = * bytes ++;
-									int value = (int) (int16) (uint16) ((uint16) ((uint16) byte2 << 8) | (uint16) byte1);
-									buffer [ichan] [isamp] = value * (1.0 / 32768);
-								}
-							}
-						} break;
-						case Melder_LINEAR_24_BIG_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++;
-									uint32 unsignedValue =
-										(uint32) ((uint32) byte1 << 16) |
-										(uint32) ((uint32) byte2 << 8) |
-												  (uint32) byte3;
-									if ((byte1 & 128) != 0) unsignedValue |= 0xFF000000;   // extend sign
-									buffer [ichan] [isamp] = (int32_t) unsignedValue * (1.0 / 8388608);
-								}
-							}
-						} break;
-						case Melder_LINEAR_24_LITTLE_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++;
-									uint32 unsignedValue = ((uint32) byte3 << 16) | ((uint32) byte2 << 8) | (uint32) byte1;
-									if ((byte3 & 128) != 0) unsignedValue |= 0xFF000000;
-									buffer [ichan] [isamp] = (int32) unsignedValue * (1.0 / 8388608);
-								}
-							}
-						} break;
-						case Melder_LINEAR_32_BIG_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++, byte4 = * bytes ++;
-									int32 value = (int32)
-										((uint32) ((uint32) byte1 << 24) |
-										 (uint32) ((uint32) byte2 << 16) |
-										 (uint32) ((uint32) byte3 << 8) |
-												   (uint32) byte4);
-									buffer [ichan] [isamp] = value * (1.0 / 32768 / 65536);
-								}
-							}
-						} break;
-						case Melder_LINEAR_32_LITTLE_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++, byte4 = * bytes ++;
-									int32 value = (int32)
-										((uint32) ((uint32) byte4 << 24) |
-										 (uint32) ((uint32) byte3 << 16) |
-										 (uint32) ((uint32) byte2 << 8) |
-												   (uint32) byte1);
-									buffer [ichan] [isamp] = value * (1.0 / 32768 / 65536);
-								}
-							}
-						} break;
-					}
-				} else {
-					Melder_assert (sizeof (double) == 8);
-					int32_t *ints = (int32_t *) & buffer [1] [1];
-					switch (encoding) {
-						case Melder_LINEAR_16_BIG_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									uint8 byte1 = * bytes ++, byte2 = * bytes ++;
-									int32 value = (int32)
-										((uint32) ((uint32) byte1 << 24) |
-										 (uint32) ((uint32) byte2 << 16));
-									* ints ++ = value;
-									* ints ++ = 0;   // the marker
-								}
-							}
-						} break;
-						case Melder_LINEAR_16_LITTLE_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									uint8 byte1 = * bytes ++, byte2 = * bytes ++;
-									int32 value = (int32)
-										(((uint32) byte2 << 24) |
-										 ((uint32) byte1 << 16));
-									* ints ++ = value;
-									* ints ++ = 0;   // the marker
-								}
-							}
-						} break;
-						case Melder_LINEAR_24_BIG_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++;
-									int32 value = (int32)
-										(((uint32) byte1 << 24) |
-										 ((uint32) byte2 << 16) |
-										 ((uint32) byte3 << 8));
-									* ints ++ = value;
-									* ints ++ = 0;   // the marker
-								}
-							}
-						} break;
-						case Melder_LINEAR_24_LITTLE_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++;
-									int32 value = (int32)
-										(((uint32) byte3 << 24) |
-										 ((uint32) byte2 << 16) |
-										 ((uint32) byte1 << 8));
-									* ints ++ = value;
-									* ints ++ = 0;   // the marker
-								}
-							}
-						} break;
-						case Melder_LINEAR_32_BIG_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++, byte4 = * bytes ++;
-									int32 value = (int32)
-										(((uint32) byte1 << 24) |
-										 ((uint32) byte2 << 16) |
-										 ((uint32) byte3 << 8) |
-										  (uint32) byte4);
-									* ints ++ = value;
-									* ints ++ = 0;   // the marker
-								}
-							}
-						} break;
-						case Melder_LINEAR_32_LITTLE_ENDIAN: {
-							for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-								for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-									uint8 byte1 = * bytes ++, byte2 = * bytes ++, byte3 = * bytes ++, byte4 = * bytes ++;
-									int32 value = (int32)
-										(((uint32) byte4 << 24) |
-										 ((uint32) byte3 << 16) |
-										 ((uint32) byte2 << 8) |
-										  (uint32) byte1);
-									* ints ++ = value;
-									* ints ++ = 0;   // the marker
-								}
-							}
-						}
-					}
-					double *doubles = & buffer [1] [1];
-					long n = numberOfSamples * numberOfChannels;
-					for (long i = 0; i < n; i ++) {
-						int32_t *valuePosition = (int32_t *) & doubles [i];
-						int32_t *markerPosition = valuePosition + 1;
-						if (! *markerPosition) {
-							int32_t value = *valuePosition;
-							long ichan = i / numberOfSamples, isamp = i % numberOfSamples;
-							for (long other = isamp * numberOfChannels + ichan; other != i; ) {
-								int32_t *otherValuePosition = (int32_t *) & doubles [other];
-								*valuePosition = *otherValuePosition;
-								*markerPosition = 1;
-								valuePosition = otherValuePosition;
-								markerPosition = valuePosition + 1;
-								ichan = other / numberOfSamples, isamp = other % numberOfSamples;
-								other = isamp * numberOfChannels + ichan;
-							}
-							*valuePosition = value;
-							*markerPosition = 1;
-						}
-					}
-					for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-						for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-							buffer [ichan] [isamp] = * (int32_t *) & buffer [ichan] [isamp] * (1.0 / 32768 / 65536);
-						}
-					}
-				}
-				if (numberOfBytesRead < numberOfBytes)
-					Melder_warning (U"File too small (", numberOfChannels, U"-channel ", numberOfBytesPerSamplePerChannel * 8, U"-bit).\n"
-						U"Missing samples were set to zero.");
-			} break;
 			case Melder_IEEE_FLOAT_32_BIG_ENDIAN:
-				try {
-					for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-						for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-							buffer [ichan] [isamp] = bingetr4 (f);
-						}
-					}
-				} catch (MelderError) {
-					Melder_clearError ();
-					Melder_warning (U"File too small (", numberOfChannels, U"-channel 32-bit floating point).\nMissing samples set to zero.");
-				}
-				break;
 			case Melder_IEEE_FLOAT_32_LITTLE_ENDIAN:
-				try {
-					for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-						for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-							buffer [ichan] [isamp] = bingetr4LE (f);
-						}
-					}
-				} catch (MelderError) {
-					Melder_clearError ();
-					Melder_warning (U"File too small (", numberOfChannels, U"-channel 32-bit floating point).\nMissing samples set to zero.");
-				}
-				break;
+			case Melder_IEEE_FLOAT_64_BIG_ENDIAN:
+			case Melder_IEEE_FLOAT_64_LITTLE_ENDIAN:
 			case Melder_MULAW:
-				try {
-					for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-						for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-							buffer [ichan] [isamp] = ulaw2linear [bingetu1 (f)] * (1.0 / 32768);
-						}
-					}
-				} catch (MelderError) {
-					Melder_clearError ();
-					Melder_warning (U"File too small (", numberOfChannels, U"-channel 8-bit " "-law).\nMissing samples set to zero.");
-				}
-				break;
 			case Melder_ALAW:
-				try {
-					for (long isamp = 1; isamp <= numberOfSamples; isamp ++) {
-						for (long ichan = 1; ichan <= numberOfChannels; ichan ++) {
-							buffer [ichan] [isamp] = alaw2linear [bingetu1 (f)] * (1.0 / 32768);
-						}
-					}
-				} catch (MelderError) {
-					Melder_clearError ();
-					Melder_warning (U"File too small (", numberOfChannels, U"-channel 8-bit A-law).\nMissing samples set to zero.");
-				}
+				Melder_readUncompressedAudioToFloat (f, numberOfChannels, encoding, buffer, numberOfSamples);
 				break;
 			case Melder_FLAC_COMPRESSION_16:
 			case Melder_FLAC_COMPRESSION_24:
@@ -1283,6 +1086,20 @@ void Melder_readAudioToShort (FILE *f, int numberOfChannels, int encoding, short
 					buffer [i] = bingetr4LE (f) * 32768;   // BUG: truncation; not ideal
 				}
 				break;
+			case Melder_IEEE_FLOAT_64_BIG_ENDIAN:
+				for (i = 0; i < n; i ++) {
+					buffer [i] = bingetr8 (f) * 32768;   // BUG: truncation; not ideal
+				}
+				break;
+			case Melder_IEEE_FLOAT_64_LITTLE_ENDIAN:
+				for (i = 0; i < n; i ++) {
+					uint8 b [8];
+					if (fread (b, 1, 8, f) < 8) Melder_throw (U"File too small (64-bit floating point).");
+					buffer [i] = doubleFromBits (
+						(uint64_t) b [7] << 56 | (uint64_t) b [6] << 48 | (uint64_t) b [5] << 40 | (uint64_t) b [4] << 32 |
+						(uint64_t) b [3] << 24 | (uint64_t) b [2] << 16 | (uint64_t) b [1] << 8 | (uint64_t) b [0]) * 32768;   // BUG: truncation; not ideal
+				}
+				break;
 			case Melder_MULAW:
 				for (i = 0; i < n; i ++) {
 					buffer [i] = ulaw2linear [bingetu1 (f)];
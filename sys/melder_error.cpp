@@ -30,7 +30,11 @@ void Melder_setErrorProc (void (*error) (const char32 *)) {
 	theError = error ? error : defaultError;
 }
 
-static char32 errors [2000+1];   // safe in low-memory situations
+/*
+	One error buffer per thread, so that threads that run parts of a parallel loop cannot garble each other's messages;
+	MelderThread_parallelFor hands the message of the first failing thread over to the calling thread.
+*/
+static Melder_THREAD_LOCAL char32 errors [2000+1];   // safe in low-memory situations
 
 static void appendError (const char32 *message) {
 	if (! message) return;
@@ -63,6 +63,7 @@ using namespace std;
 #include <errno.h>
 #include "abcio.h"
 #include "melder.h"
+#include "NUM.h"
 
 //#include "flac_FLAC_stream_encoder.h"
 extern "C" int  FLAC__stream_encoder_finish (FLAC__StreamEncoder *);
@@ -592,6 +593,8 @@ FILE * Melder_fopen (MelderFile file, const char *type) {
 		#if defined (_WIN32) && ! defined (__CYGWIN__)
 			f = _wfopen (Melder_peek32toW (file -> path), Melder_peek32toW (Melder_peek8to32 (type)));
 		#else
+			if (file -> openForWriting)
+				NUMmatrix_unmapFile (utf8path);   // a mapped file should not change under the matrices that were read from it
 			f = fopen ((char *) utf8path, type);
 		#endif
 	}
@@ -21,117 +21,181 @@
 #include "abcio.h"
 #define my  me ->
 
-char32 MelderReadText_getChar (MelderReadText me) {
-	if (my string32) {
-		if (* my readPointer32 == U'\0') return U'\0';
-		return * my readPointer32 ++;
-	} else {
-		if (* my readPointer8 == '\0') return U'\0';
+#define MelderReadText_BUFFER_SIZE  65536
+
+static bool MelderReadText_fillBuffer (MelderReadText me) {
+	if (my bufferPosition < my bufferLength) return true;
+	my bufferOffset += my bufferLength;
+	my bufferPosition = 0;
+	my bufferLength = (int64) fread (my buffer, sizeof (char8), MelderReadText_BUFFER_SIZE, my file);
+	if (my bufferLength == 0 && ferror (my file))
+		Melder_throw (U"Error reading text file.");
+	return my bufferLength > 0;
+}
+
+inline static int MelderReadText_getByte (MelderReadText me) {
+	if (my bufferPosition >= my bufferLength && ! MelderReadText_fillBuffer (me)) return -1;
+	return my buffer [my bufferPosition ++];
+}
+
+static void MelderReadText_seek (MelderReadText me, int64 position) {
+	if (fseeko (my file, position, SEEK_SET) < 0)
+		Melder_throw (U"Cannot move in text file.");
+	my bufferOffset = position;
+	my bufferLength = 0;
+	my bufferPosition = 0;
+}
+
+inline static char32 MelderReadText_getContinuationByte (MelderReadText me) {
+	int kar;
+	do { kar = MelderReadText_getByte (me); } while (kar == 0);   // null bytes are ignored
+	return kar < 0 ? 0 : (char32) kar;
+}
+
+static char32 MelderReadText_getUtf16Unit (MelderReadText me) {
+	int firstByte = MelderReadText_getByte (me);
+	if (firstByte < 0) return 0;
+	int secondByte = MelderReadText_getByte (me);
+	if (secondByte < 0) return 0;   // odd final byte
+	return my type == 1 ? (char32) (firstByte << 8 | secondByte) : (char32) (secondByte << 8 | firstByte);
+}
+
+/*
+	Returns the next character of the file without interpreting carriage returns,
+	or null at the end of the file.
+*/
+static char32 MelderReadText_decodeCharacter (MelderReadText me) {
+	if (my type == 0) {
+		int byte;
+		do { byte = MelderReadText_getByte (me); } while (byte == 0);   // null bytes are ignored
+		if (byte < 0) return U'\0';
+		char32 kar1 = (char32) byte;
 		if (my input8Encoding == kMelder_textInputEncoding_UTF8) {
-			char32 kar1 = (char32) (char8) * my readPointer8 ++;
 			if (kar1 <= 0x00007F) {
 				return kar1;
 			} else if (kar1 <= 0x0000DF) {
-				char32 kar2 = (char32) (char8) * my readPointer8 ++;
+				char32 kar2 = MelderReadText_getContinuationByte (me);
 				return ((kar1 & 0x00001F) << 6) | (kar2 & 0x00003F);
 			} else if (kar1 <= 0x0000EF) {
-				char32 kar2 = (char32) (char8) * my readPointer8 ++;
-				char32 kar3 = (char32) (char8) * my readPointer8 ++;
+				char32 kar2 = MelderReadText_getContinuationByte (me);
+				char32 kar3 = MelderReadText_getContinuationByte (me);
 				return ((kar1 & 0x00000F) << 12) | ((kar2 & 0x00003F) << 6) | (kar3 & 0x00003F);
 			} else if (kar1 <= 0x0000F4) {
-				char32 kar2 = (char32) (char8) * my readPointer8 ++;
-				char32 kar3 = (char32) (char8) * my readPointer8 ++;
-				char32 kar4 = (char32) (char8) * my readPointer8 ++;
+				char32 kar2 = MelderReadText_getContinuationByte (me);
+				char32 kar3 = MelderReadText_getContinuationByte (me);
+				char32 kar4 = MelderReadText_getContinuationByte (me);
 				return ((kar1 & 0x000007) << 18) | ((kar2 & 0x00003F) << 12) | ((kar3 & 0x00003F) << 6) | (kar4 & 0x00003F);
 			} else {
 				return UNICODE_REPLACEMENT_CHARACTER;
 			}
 		} else if (my input8Encoding == kMelder_textInputEncoding_MACROMAN) {
-			return Melder_decodeMacRoman [(char8) * my readPointer8 ++];
+			return Melder_decodeMacRoman [kar1];
 		} else if (my input8Encoding == kMelder_textInputEncoding_WINDOWS_LATIN1) {
-			return Melder_decodeWindowsLatin1 [(char8) * my readPointer8 ++];
+			return Melder_decodeWindowsLatin1 [kar1];
+		} else {
+			return kar1;   // ISO Latin-1
+		}
+	} else {
+		char32 kar1 = MelderReadText_getUtf16Unit (me);
+		if (kar1 < 0xD800) {
+			return kar1;
+		} else if (kar1 < 0xDC00) {
+			char32 kar2 = MelderReadText_getUtf16Unit (me);
+			if (kar2 >= 0xDC00 && kar2 <= 0xDFFF) {
+				return 0x010000 + ((kar1 & 0x0003FF) << 10) + (kar2 & 0x0003FF);
+			} else {
+				return UNICODE_REPLACEMENT_CHARACTER;
+			}
+		} else if (kar1 < 0xE000) {
+			return UNICODE_REPLACEMENT_CHARACTER;
 		} else {
-			/* Unknown encoding. */
-			return (char32) (char8) * my readPointer8 ++;
+			return kar1;
 		}
 	}
 }
 
-char32 * MelderReadText_readLine (MelderReadText me) {
-	if (my string32) {
-		Melder_assert (my readPointer32);
-		Melder_assert (! my readPointer8);
-		if (*my readPointer32 == U'\0') {   // tried to read past end of file
-			return nullptr;
-		}
-		char32 *result = my readPointer32;
-		char32 *newline = str32chr (result, U'\n');
-		if (newline) {
-			*newline = U'\0';
-			my readPointer32 = newline + 1;
-		} else {
-			my readPointer32 += str32len (result);
+char32 MelderReadText_getChar (MelderReadText me) {
+	if (my type == 0 && ! my hasLookahead && my bufferPosition < my bufferLength) {
+		/*
+			Fast path for the most common case: an ASCII character in an 8-bit text.
+		*/
+		char8 byte = my buffer [my bufferPosition];
+		if (byte > 0 && byte <= 0x7F && byte != '\r') {
+			my bufferPosition ++;
+			if (byte == '\n') my numberOfNewlinesRead += 1;
+			return (char32) byte;
 		}
-		return result;
+	}
+	char32 kar;
+	if (my hasLookahead) {
+		kar = my lookahead;
+		my hasLookahead = false;
 	} else {
-		Melder_assert (my string8);
-		Melder_assert (! my readPointer32);
-		Melder_assert (my readPointer8);
-		if (*my readPointer8 == '\0') {   // tried to read past end of file
-			return nullptr;
-		}
-		char *result8 = my readPointer8;
-		char *newline = strchr (result8, '\n');
-		if (newline) {
-			*newline = '\0';
-			my readPointer8 = newline + 1;
-		} else {
-			my readPointer8 += strlen (result8);
+		kar = MelderReadText_decodeCharacter (me);
+	}
+	if (kar == U'\r') {   // Windows (CR LF) or Macintosh (CR) line break
+		char32 next = MelderReadText_decodeCharacter (me);
+		if (next != U'\n') {
+			my lookahead = next;
+			my hasLookahead = true;
 		}
-		static char32 *text32 = nullptr;
-		static int64 size = 0;
-		int64 sizeNeeded = (int64) strlen (result8) + 1;
-		if (sizeNeeded > size) {
-			Melder_free (text32);
-			text32 = Melder_malloc_f (char32, sizeNeeded + 100);
-			size = sizeNeeded + 100;
+		kar = U'\n';
+	}
+	if (kar == U'\n') my numberOfNewlinesRead += 1;
+	return kar;
+}
+
+char32 * MelderReadText_readLine (MelderReadText me) {
+	char32 kar = MelderReadText_getChar (me);
+	if (kar == U'\0') {   // tried to read past end of file
+		return nullptr;
+	}
+	int64 length = 0;
+	for (; kar != U'\0' && kar != U'\n'; kar = MelderReadText_getChar (me)) {
+		if (length + 1 >= my lineCapacity) {
+			int64 newCapacity = 2 * my lineCapacity + 100;
+			my line = (char32 *) Melder_realloc (my line, newCapacity * (int64) sizeof (char32));
+			my lineCapacity = newCapacity;
 		}
-		Melder_8to32_inline (result8, text32, my input8Encoding);
-		return text32;
+		my line [length ++] = kar;
 	}
+	if (! my line) {
+		my line = Melder_malloc (char32, 100);
+		my lineCapacity = 100;
+	}
+	my line [length] = U'\0';
+	return my line;
 }
 
 int64 MelderReadText_getNumberOfLines (MelderReadText me) {
-	int64 n = 0;
-	if (my string32) {
-		char32 *p = & my string32 [0];
-		for (; *p != U'\0'; p ++) if (*p == U'\n') n ++;
-		if (p - my string32 > 1 && p [-1] != U'\n') n ++;
-	} else {
-		char *p = & my string8 [0];
-		for (; *p != '\0'; p ++) if (*p == '\n') n ++;
-		if (p - my string8 > 1 && p [-1] != '\n') n ++;
+	/*
+		Count the lines in a separate pass through the file,
+		and return to where we were.
+	*/
+	int64 position = my bufferOffset + my bufferPosition;
+	char32 lookahead = my lookahead;
+	bool hasLookahead = my hasLookahead;
+	int64 numberOfNewlinesRead = my numberOfNewlinesRead;
+	MelderReadText_seek (me, my textOffset);
+	my hasLookahead = false;
+	my numberOfNewlinesRead = 0;
+	int64 numberOfCharacters = 0;
+	char32 kar, previous = U'\0';
+	while ((kar = MelderReadText_getChar (me)) != U'\0') {
+		numberOfCharacters += 1;
+		previous = kar;
 	}
+	int64 n = my numberOfNewlinesRead;
+	if (numberOfCharacters > 1 && previous != U'\n') n ++;
+	MelderReadText_seek (me, position);
+	my lookahead = lookahead;
+	my hasLookahead = hasLookahead;
+	my numberOfNewlinesRead = numberOfNewlinesRead;
 	return n;
 }
 
 const char32 * MelderReadText_getLineNumber (MelderReadText me) {
-	int64 result = 1;
-	if (my string32) {
-		char32 *p = my string32;
-		while (my readPointer32 - p > 0) {
-			if (*p == U'\0' || *p == U'\n') result ++;
-			p ++;
-		}
-	} else {
-		char *p = my string8;
-		while (my readPointer8 - p > 0) {
-			if (*p == '\0' || *p == '\n') result ++;
-			p ++;
-		}
-		return Melder_integer (result);
-	}
-	return Melder_integer (result);
+	return Melder_integer (my numberOfNewlinesRead + 1);
 }
 
 static size_t fread_multi (char *buffer, size_t numberOfBytes, FILE *f) {
@@ -152,7 +216,7 @@ static size_t fread_multi (char *buffer, size_t numberOfBytes, FILE *f) {
 	return numberOfBytesRead;
 }
 
-static char32 * _MelderFile_readText (MelderFile file, char **string8) {
+char32 * MelderFile_readText (MelderFile file) {
 	try {
 		int type = 0;   // 8-bit
 		autostring32 text;
@@ -194,29 +258,17 @@ static char32 * _MelderFile_readText (MelderFile file, char **string8) {
 			 * Count and repair null bytes.
 			 */
 			if (length > 0) {
-				int64 numberOfNullBytes = 0;
-				for (char *p = & text8bit [length - 1]; (int64) (p - text8bit.peek()) >= 0; p --) {
-					if (*p == '\0') {
-						numberOfNullBytes += 1;
-						/*
-						 * Shift.
-						 */
-						for (char *q = p; (int64) (q - text8bit.peek()) < length; q ++) {
-							*q = q [1];
-						}
-					}
+				char *to = text8bit.peek();
+				for (const char *from = text8bit.peek(); (int64) (from - text8bit.peek()) < length; from ++) {
+					if (*from != '\0') * to ++ = *from;
 				}
+				*to = '\0';
+				int64 numberOfNullBytes = length - (int64) (to - text8bit.peek());
 				if (numberOfNullBytes > 0) {
 					Melder_warning (U"Ignored ", numberOfNullBytes, U" null bytes in text file ", file, U".");
 				}
 			}
-			if (string8) {
-				*string8 = text8bit.transfer();
-				(void) Melder_killReturns_inline (*string8);
-				return nullptr;   // OK
-			} else {
-				text.reset (Melder_8to32 (text8bit.peek(), 0));
-			}
+			text.reset (Melder_8to32 (text8bit.peek(), 0));
 		} else {
 			length = length / 2 - 1;   // Byte Order Mark subtracted. Length = number of UTF-16 codes
 			text.reset (Melder_malloc (char32, length + 1));
@@ -275,46 +327,100 @@ static char32 * _MelderFile_readText (MelderFile file, char **string8) {
 	}
 }
 
-char32 * MelderFile_readText (MelderFile file) {
-	return _MelderFile_readText (file, nullptr);
-}
-
 MelderReadText MelderReadText_createFromFile (MelderFile file) {
-	autoMelderReadText me = Melder_calloc (struct structMelderReadText, 1);
-	my string32 = _MelderFile_readText (file, & my string8);
-	if (my string32) {
-		my readPointer32 = & my string32 [0];
-	} else {
-		Melder_assert (my string8);
-		my readPointer8 = & my string8 [0];
-		my input8Encoding = Melder_getInputEncoding ();
-		if (my input8Encoding == kMelder_textInputEncoding_UTF8 ||
-			my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_ISO_LATIN1 ||
-			my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_WINDOWS_LATIN1 ||
-			my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_MACROMAN)
-		{
-			if (Melder_str8IsValidUtf8 (my string8)) {
-				my input8Encoding = kMelder_textInputEncoding_UTF8;
-			} else if (my input8Encoding == kMelder_textInputEncoding_UTF8) {
-				Melder_throw (U"Text is not valid UTF-8; please try a different text input encoding.");
-			} else if (my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_ISO_LATIN1) {
-				my input8Encoding = kMelder_textInputEncoding_ISO_LATIN1;
-			} else if (my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_WINDOWS_LATIN1) {
-				my input8Encoding = kMelder_textInputEncoding_WINDOWS_LATIN1;
-			} else if (my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_MACROMAN) {
-				my input8Encoding = kMelder_textInputEncoding_MACROMAN;
+	try {
+		autoMelderReadText me = Melder_calloc (struct structMelderReadText, 1);
+		my file = Melder_fopen (file, "rb");
+		my buffer = Melder_malloc (char8, MelderReadText_BUFFER_SIZE);
+		int firstByte = MelderReadText_getByte (me.peek()), secondByte = MelderReadText_getByte (me.peek());
+		if (firstByte == 0xFE && secondByte == 0xFF) {
+			my type = 1;   // big-endian 16-bit
+			my textOffset = 2;
+		} else if (firstByte == 0xFF && secondByte == 0xFE) {
+			my type = 2;   // little-endian 16-bit
+			my textOffset = 2;
+		} else if (firstByte == 0xEF && secondByte == 0xBB && MelderReadText_getByte (me.peek()) == 0xBF) {
+			my textOffset = 3;   // UTF-8 with BOM
+		}
+		if (my type == 0) {
+			my input8Encoding = Melder_getInputEncoding ();
+			if (my input8Encoding == 0) {
+				#if defined (macintosh)
+					my input8Encoding = kMelder_textInputEncoding_UTF8_THEN_MACROMAN;
+				#elif defined (_WIN32)
+					my input8Encoding = kMelder_textInputEncoding_UTF8_THEN_WINDOWS_LATIN1;
+				#else
+					my input8Encoding = kMelder_textInputEncoding_UTF8_THEN_ISO_LATIN1;
+				#endif
+			}
+			/*
+				Before we decode anything, go through the bytes once to count null bytes
+				and to find out whether the text is valid UTF-8.
+			*/
+			MelderReadText_seek (me.peek(), my textOffset);
+			int64 numberOfNullBytes = 0;
+			bool isValidUtf8 = true;
+			int numberOfContinuationBytesExpected = 0;
+			while (MelderReadText_fillBuffer (me.peek())) {
+				const char8 *p = & my buffer [my bufferPosition], *end = & my buffer [my bufferLength];
+				my bufferPosition = my bufferLength;
+				for (; p < end; p ++) {
+					char8 byte = *p;
+					if (byte > 0 && byte <= 0x7F && numberOfContinuationBytesExpected == 0) {
+						;
+					} else if (byte == 0) {
+						numberOfNullBytes += 1;
+					} else if (numberOfContinuationBytesExpected > 0) {
+						if ((byte & 0xC0) != 0x80) isValidUtf8 = false;
+						numberOfContinuationBytesExpected -= 1;
+					} else if (byte <= 0xC1) {
+						isValidUtf8 = false;
+					} else if (byte <= 0xDF) {
+						numberOfContinuationBytesExpected = 1;
+					} else if (byte <= 0xEF) {
+						numberOfContinuationBytesExpected = 2;
+					} else if (byte <= 0xF4) {
+						numberOfContinuationBytesExpected = 3;
+					} else {
+						isValidUtf8 = false;
+					}
+				}
+			}
+			if (numberOfContinuationBytesExpected > 0) isValidUtf8 = false;   // truncated final character
+			if (numberOfNullBytes > 0)
+				Melder_warning (U"Ignored ", numberOfNullBytes, U" null bytes in text file ", file, U".");
+			if (my input8Encoding == kMelder_textInputEncoding_UTF8 ||
+				my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_ISO_LATIN1 ||
+				my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_WINDOWS_LATIN1 ||
+				my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_MACROMAN)
+			{
+				if (isValidUtf8) {
+					my input8Encoding = kMelder_textInputEncoding_UTF8;
+				} else if (my input8Encoding == kMelder_textInputEncoding_UTF8) {
+					Melder_throw (U"Text is not valid UTF-8; please try a different text input encoding.");
+				} else if (my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_ISO_LATIN1) {
+					my input8Encoding = kMelder_textInputEncoding_ISO_LATIN1;
+				} else if (my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_WINDOWS_LATIN1) {
+					my input8Encoding = kMelder_textInputEncoding_WINDOWS_LATIN1;
+				} else if (my input8Encoding == kMelder_textInputEncoding_UTF8_THEN_MACROMAN) {
+					my input8Encoding = kMelder_textInputEncoding_MACROMAN;
+				}
 			}
 		}
+		MelderReadText_seek (me.peek(), my textOffset);
+		return me.transfer();
+	} catch (MelderError) {
+		Melder_throw (U"Error reading file ", file, U".");
 	}
-	return me.transfer();
 }
 
 MelderReadText MelderReadText_createFromString (const char32 *string);
 
 void MelderReadText_delete (MelderReadText me) {
 	if (! me) return;
-	Melder_free (my string32);
-	Melder_free (my string8);
+	if (my file) fclose (my file);
+	Melder_free (my buffer);
+	Melder_free (my line);
 	Melder_free (me);
 }
 
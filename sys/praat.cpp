@@ -40,6 +40,7 @@
 #include "praat_version.h"
 #include "site.h"
 #include "machine.h"
+#include "MelderThread.h"
 #include "Printer.h"
 #include "ScriptEditor.h"
 #include "Strings_.h"
@@ -1004,6 +1005,7 @@ static void installPraatShellPreferences () {
 	Site_prefs ();   // print command...
 	Melder_audio_prefs ();   // asynchronicity, silence after...
 	Melder_textEncoding_prefs ();
+	MelderThread_prefs ();   // maximum number of threads
 	Printer_prefs ();   // paper size, printer command...
 	structTextEditor :: f_preferences ();   // font size...
 }
@@ -23,6 +23,7 @@
 #include "ButtonEditor.h"
 #include "DataEditor.h"
 #include "site.h"
+#include "MelderThread.h"
 #include "GraphicsP.h"
 //#include <string>
 
@@ -362,6 +363,17 @@ DO
 	Melder_debug = debugOption;
 END }
 
+FORM (PRAAT_debugMultiThreading, U"Debug multi-threading", nullptr) {
+	LABEL (U"", U"Analyses that run in parallel will use at most this many threads.")
+	LABEL (U"", U"Zero means: as many threads as there are processors.")
+	INTEGER4 (maximumNumberOfThreads, U"Maximum number of threads", U"0")
+OK
+DO
+	if (maximumNumberOfThreads < 0)
+		Melder_throw (U"The maximum number of threads cannot be negative.");
+	MelderThread_setMaximumNumberOfThreads (maximumNumberOfThreads);
+END }
+
 DIRECT (INFO_listReadableTypesOfObjects) {
 	Thing_listReadableClasses ();
 END }
@@ -477,6 +489,18 @@ FORM_SAVE (SAVE_Data_writeToBinaryFile, U"Save Object(s) as one binary file", nu
 	}
 END }
 
+FORM_SAVE (SAVE_Data_writeToMappedBinaryFile, U"Save Object(s) as one mapped binary file", nullptr, nullptr) {
+	if (theCurrentPraatObjects -> totalSelection == 1) {
+		LOOP {
+			iam (Daata);
+			Data_writeToMappedBinaryFile (me, file);
+		}
+	} else {
+		autoCollection set = praat_getSelectedObjects ();
+		Data_writeToMappedBinaryFile (set.get(), file);
+	}
+END }
+
 FORM (PRAAT_ManPages_saveToHtmlDirectory, U"Save all pages as HTML files", nullptr) {
 	LABEL (U"", U"Type a directory name:")
 	TEXTFIELD4 (directory, U"directory", U"")
@@ -693,6 +717,7 @@ void praat_addMenus (GuiWindow window) {
 	praat_addMenuCommand (U"Objects", U"Technical", U"Report system properties", nullptr, 0, INFO_reportSystemProperties);
 	praat_addMenuCommand (U"Objects", U"Technical", U"Report graphical properties", nullptr, 0, INFO_reportGraphicalProperties);
 	praat_addMenuCommand (U"Objects", U"Technical", U"Debug...", nullptr, 0, PRAAT_debug);
+	praat_addMenuCommand (U"Objects", U"Technical", U"Debug multi-threading...", nullptr, 0, PRAAT_debugMultiThreading);
 	praat_addMenuCommand (U"Objects", U"Technical", U"-- api --", nullptr, 0, nullptr);
 	praat_addMenuCommand (U"Objects", U"Technical", U"List readable types of objects", nullptr, 0, INFO_listReadableTypesOfObjects);
 	praat_addMenuCommand (U"Objects", U"Technical", U"Create C interface...", nullptr, 0, INFO_praat_library_createC);
@@ -705,6 +730,7 @@ void praat_addMenus (GuiWindow window) {
 	praat_addAction1 (classDaata, 0,   U"Write to short text file...", nullptr, praat_DEPRECATED_2011, SAVE_Data_writeToShortTextFile);
 	praat_addAction1 (classDaata, 0, U"Save as binary file...", nullptr, 0, SAVE_Data_writeToBinaryFile);
 	praat_addAction1 (classDaata, 0,   U"Write to binary file...", nullptr, praat_DEPRECATED_2011, SAVE_Data_writeToBinaryFile);
+	praat_addAction1 (classDaata, 0, U"Save as mapped binary file...", nullptr, 0, SAVE_Data_writeToMappedBinaryFile);
 
 	praat_addAction1 (classManPages, 1, U"Save to HTML directory...", nullptr, 0, PRAAT_ManPages_saveToHtmlDirectory);
 	praat_addAction1 (classManPages, 1, U"View", nullptr, 0, WINDOW_ManPages_view);